@@ -0,0 +1,133 @@
+#ifndef ADLADAPTERTABLE_H
+#define ADLADAPTERTABLE_H
+
+#include <vector>
+
+#include "adlmaincontrol.h"
+#include "structs.h"
+
+/* Physical adapters seen by ADL, built once from the adapter list. ADL reports
+ * many logical adapters (one per display output) for one GPU, they are merged
+ * by PCI location and the first active logical adapter is used for all calls.
+ * Overdrive parameters and default performance levels do not change while
+ * the program runs, they are read on first use and cached.
+ *
+ * Overdrive6 and OverdriveN are mapped to the Overdrive5 model: ranges in
+ * ADLODParameters and performance levels with clocks in 10 kHz and voltage
+ * in mV. Overdrive6 has two levels (minimal and maximal clocks) without
+ * voltages. OverdriveN has separate core and memory levels, the table has as
+ * many levels as the longer list and the last level of the shorter list is
+ * repeated. */
+class ADLAdapterTable
+{
+
+private:
+
+    struct Adapter
+    {
+        int adlIndex;
+        AdapterInfo info;
+        bool odParametersRead;
+        int odVersion;
+        ADLODParameters odParameters;
+        int coreLevelsNum;
+        int memoryLevelsNum;
+        bool powerControlSupported;
+        ADLODParameterRange powerControlRange;
+        int defaultPowerControl;
+        std::vector<ADLODPerformanceLevel> defaultPerfLevels;
+    };
+
+    ADLMainControl& mainControl;
+
+    std::vector<Adapter> adapters;
+
+    Adapter& getODAdapter(int index);
+
+    static bool isBeforeInPCI(const AdapterInfo& info1, const AdapterInfo& info2);
+
+    void readOD6Parameters(Adapter& adapter);
+
+    void readODNParameters(Adapter& adapter);
+
+    void readPerfLevels(const Adapter& adapter, bool isDefault, std::vector<ADLODPerformanceLevel>& perfLevels);
+
+public:
+
+    // assigns cards to adapters in order of PCI locations
+    explicit ADLAdapterTable(ADLMainControl& _mainControl);
+
+    int getAdaptersNum() const
+    {
+        return adapters.size();
+    }
+
+    // index of adapter for ADLMainControl calls
+    int getADLIndex(int index) const
+    {
+        return adapters[index].adlIndex;
+    }
+
+    // adapter info with name filled from PCI database if ADL does not give it
+    const AdapterInfo& getAdapterInfo(int index) const
+    {
+        return adapters[index].info;
+    }
+
+    // 5, 6 or 7 (OverdriveN), 0 if Overdrive is not supported
+    int getODVersion(int index)
+    {
+        return getODAdapter(index).odVersion;
+    }
+
+    // ranges are zero if not settable
+    const ADLODParameters& getODParameters(int index);
+
+    int getPerfLevelsNum(int index)
+    {
+        return getODParameters(index).iNumberOfPerformanceLevels;
+    }
+
+    // levels really having own core clock (less than levels number only for OverdriveN)
+    int getCoreLevelsNum(int index)
+    {
+        return getODAdapter(index).coreLevelsNum;
+    }
+
+    int getMemoryLevelsNum(int index)
+    {
+        return getODAdapter(index).memoryLevelsNum;
+    }
+
+    const std::vector<ADLODPerformanceLevel>& getDefaultPerfLevels(int index);
+
+    // current performance levels, not cached
+    void getPerfLevels(int index, std::vector<ADLODPerformanceLevel>& perfLevels);
+
+    void setPerfLevels(int index, const std::vector<ADLODPerformanceLevel>& perfLevels);
+
+    // power control (Overdrive6) or power limit (OverdriveN) in percent
+    bool hasPowerControl(int index)
+    {
+        return getODAdapter(index).powerControlSupported;
+    }
+
+    const ADLODParameterRange& getPowerControlRange(int index)
+    {
+        return getODAdapter(index).powerControlRange;
+    }
+
+    int getDefaultPowerControl(int index)
+    {
+        return getODAdapter(index).defaultPowerControl;
+    }
+
+    int getPowerControl(int index);
+
+    void setPowerControl(int index, int value);
+
+    void getIdentities(std::vector<AdapterIdentity>& identities) const;
+
+};
+
+#endif /* ADLADAPTERTABLE_H */
@@ -2,7 +2,10 @@
 #define ADLMAINCONTROL_H
 
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include <unistd.h>
 #include <fcntl.h>
 #include <CL/cl.h>
@@ -13,30 +16,68 @@
 
 #include "atiadlhandle.h"
 
+/* Without X11 server ADL works through the file descriptor of a card device
+ * (/dev/ati/cardN). Every card has own descriptor, opened on first call for
+ * an adapter of that card and kept until the end. Calls are serialized and
+ * the descriptor of the adapter's card is given to ADL before a call, so
+ * adapters can be used from many threads. */
 class ADLMainControl
 {
 
 private:
 
+    /* locks calls to ADL and selects card of adapter */
+    class CardLock
+    {
+
+    private:
+
+        std::lock_guard<std::mutex> lock;
+
+    public:
+
+        CardLock(const ADLMainControl& mainControl, int adapterIndex);
+
+    };
+
     const ATIADLHandle& handle;
 
-    int fd;
+    int defaultCard;
+
+    mutable std::mutex mutex;
+
+    mutable std::map<int, int> cardFds;
+
+    std::map<int, int> adapterCards;
+
+    mutable int currentCard;
 
     bool mainControlCreated;
 
     bool withX;
 
+    static int openCard(int card);
+
+    void selectCard(int adapterIndex) const;
+
 public:
 
     explicit ADLMainControl(const ATIADLHandle& handle, int devId);
 
     ~ADLMainControl();
 
+    // card (device number) of adapter used without X11 server, default is devId of constructor
+    void setAdapterCard(int adapterIndex, int card);
+
+    // number of opened card devices
+    int getOpenedCardsNum() const;
+
     int getAdaptersNum() const;
 
     bool isAdapterActive(int adapterIndex) const;
 
-    void getAdapterInfo(AdapterInfo* infos) const;
+    // adaptersNum is the number given by getAdaptersNum
+    void getAdapterInfo(int adaptersNum, AdapterInfo* infos) const;
 
     void getCurrentActivity(int adapterIndex, ADLPMActivity& activity) const;
 
@@ -56,6 +97,36 @@ public:
 
     void setODPerformanceLevels(int adapterIndex, int perfLevelsNum, ADLODPerformanceLevel* perfLevels) const;
 
+    // Overdrive version usable for adapter: 5, 6 or 7 (OverdriveN), 0 if not supported by adapter or library
+    int getODVersion(int adapterIndex) const;
+
+    void getOD6Capabilities(int adapterIndex, ADLOD6Capabilities& capabilities) const;
+
+    // minimal and maximal clocks of performance state
+    void getOD6PerformanceLevels(int adapterIndex, bool isDefault, ADLOD6PerformanceLevel* perfLevels) const;
+
+    void setOD6PerformanceLevels(int adapterIndex, const ADLOD6PerformanceLevel* perfLevels) const;
+
+    void getOD6PowerControlInfo(int adapterIndex, ADLOD6PowerControlInfo& info) const;
+
+    // power control in percent
+    int getOD6PowerControl(int adapterIndex, int& defaultValue) const;
+
+    void setOD6PowerControl(int adapterIndex, int value) const;
+
+    void getODNCapabilities(int adapterIndex, ADLODNCapabilities& capabilities) const;
+
+    // system (core) or memory clock levels, maxLevelsNum from capabilities
+    void getODNPerformanceLevels(int adapterIndex, bool memory, bool isDefault, int maxLevelsNum,
+                                 std::vector<ADLODNPerformanceLevel>& perfLevels) const;
+
+    void setODNPerformanceLevels(int adapterIndex, bool memory, const std::vector<ADLODNPerformanceLevel>& perfLevels) const;
+
+    // TDP limit in percent
+    int getODNPowerLimit(int adapterIndex) const;
+
+    void setODNPowerLimit(int adapterIndex, int value) const;
+
 };
 
 #endif /* ADLMAINCONTROL_H */
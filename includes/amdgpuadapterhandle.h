@@ -8,6 +8,7 @@
 #endif
 
 #include "amdgpuadapterinfo.h"
+#include "amdgpuattributes.h"
 
 class AMDGPUAdapterHandle
 {
@@ -18,7 +19,14 @@ private:
 
     std::vector<uint32_t> amdDevices;
 
-    std::vector<uint32_t> hwmonIndices;
+    std::vector<AMDGPUAttributePaths> attributePaths;    // resolved when adapter is found
+
+    static bool isAMDCard(unsigned int cardIndex);
+
+    static unsigned int findHwmonIndex(unsigned int cardIndex);
+
+    static void getFanRestoreWrites(const AMDGPUAttributePaths& paths, unsigned int controllerIndex,
+                                    std::vector<AMDGPUSysfsWrite>& writes);
 
 public:
 
@@ -31,15 +39,140 @@ public:
 
     AMDGPUAdapterInfo parseAdapterInfo(int index);
 
-    void setFanSpeed(int index, int fanSpeed) const;
+    // plain value of attribute in the unit of its descriptor, NaN if it is not available
+    double getAttribute(int adapterIndex, AMDGPUAttribute attribute) const;
+
+    // reads attributes in the given order, like getAttribute
+    void getAttributes(int adapterIndex, const std::vector<AMDGPUAttribute>& attributes, std::vector<double>& values) const;
+
+    // name of attribute with a path (of getRestoreWrites), false if it is not an attribute of adapter
+    bool findAttributeName(int adapterIndex, const std::string& path, std::string& name) const
+    {
+        return attributePaths[adapterIndex].findName(path, name);
+    }
+
+    // writes value (one command) to attribute with name (like pwm2_enable), throws Error if it fails
+    void writeAttribute(int adapterIndex, const std::string& name, const std::string& value) const;
+
+    // N of /sys/class/drm/cardN
+    unsigned int getCardIndex(int adapterIndex) const
+    {
+        return amdDevices[adapterIndex];
+    }
+
+    // adapter index of /sys/class/drm/cardN, -1 if it is not an adapter
+    int findCard(unsigned int cardIndex) const;
 
-    void setFanSpeedToDefault(int adapterIndex) const;
+    /* probes a card that appeared (or was reset) without rescanning the others,
+     * returns its adapter index, -1 if it is not an AMD card */
+    int addCard(unsigned int cardIndex);
+
+    // adapters after the removed card move down by one, returns false if it is not an adapter
+    bool removeCard(unsigned int cardIndex);
+
+    // fan speed in percent of pwmN+1 of thermal controller
+    void setFanSpeed(int adapterIndex, unsigned int controllerIndex, int fanSpeed) const;
+
+    void setFanSpeedToDefault(int adapterIndex, unsigned int controllerIndex) const;
+
+    // fanN_input, fanN_target and range of fan of thermal controller (fanN+1)
+    void getFanRPMControl(int adapterIndex, unsigned int controllerIndex, AMDGPUFanRPMControl& control) const;
+
+    // fan speed in RPM read from fanN_input
+    unsigned int getFanRPM(int adapterIndex, unsigned int controllerIndex) const;
+
+    // enables manual fan control by fanN_enable and writes fanN_target
+    void setFanRPMTarget(int adapterIndex, unsigned int controllerIndex, unsigned int rpm) const;
+
+    // disables manual fan control by fanN_enable (if present) and pwmN_enable
+    void setFanRPMToDefault(int adapterIndex, unsigned int controllerIndex) const;
+
+    // number of pwmN channels of hwmon
+    unsigned int getFanControllersNum(int adapterIndex) const;
+
+    // labelled temp, fan, in and power channels of hwmon, ordered by type and channel
+    void getSensors(int adapterIndex, std::vector<AMDGPUSensor>& sensors) const;
 
     void setOverdriveCoreParam(int adapterIndex, unsigned int coreOD) const;
 
     void setOverdriveMemoryParam(int adapterIndex, unsigned int memoryOD) const;
 
+    // board power in uW, -1 if not available
+    int getPower(int adapterIndex) const;
+
+    // gpu_busy_percent, -1 if not available
+    int getGPULoad(int adapterIndex) const;
+
+    // mem_busy_percent, -1 if not available
+    int getMemoryLoad(int adapterIndex) const;
+
+    // reads debugfs amdgpu_pm_info (needs root), returns false if it is not available
+    bool getPMInfo(int adapterIndex, AMDGPUPMInfo& pmInfo) const;
+
+    // reads mem_info_vram_*, mem_info_vis_vram_* and mem_info_gtt_*, returns false if kernel does not have them
+    bool getMemoryUsage(int adapterIndex, AMDGPUMemoryUsage& usage) const;
+
+    // clocks of active states of pp_dpm_sclk and pp_dpm_mclk in MHz, 0 if not available
+    void getCurrentClocks(int adapterIndex, unsigned int& coreClock, unsigned int& memoryClock) const;
+
+    // clock of the active state and the highest clock of pp_dpm_sclk or pp_dpm_mclk in MHz, 0 if not available
+    void getDPMClock(int adapterIndex, DPMDomain domain, unsigned int& activeClock, unsigned int& highestClock) const;
+
+    /* writes restoring current Overdrive clocks and voltages, power cap, mode, speed or RPM target
+     * of every fan, power profile (with heuristics of CUSTOM) and performance level,
+     * in the order they must be applied */
+    void getRestoreWrites(int adapterIndex, std::vector<AMDGPUSysfsWrite>& writes) const;
+
+    // temperature in millidegrees Celsius
+    unsigned int getTemperature(int adapterIndex) const;
+
+    // temp1_crit in millidegrees Celsius
+    unsigned int getCriticalTemperature(int adapterIndex) const;
+
+    // power cap in uW, returns false if adapter does not have power1_cap
+    bool getPowerCap(int adapterIndex, unsigned int& powerCap) const;
+
+    // reads power1_cap_min and power1_cap_max, returns false if adapter does not have power1_cap
+    bool getPowerCapRange(int adapterIndex, unsigned int& powerCapMin, unsigned int& powerCapMax) const;
+
+    // power cap in uW
+    void setPowerCap(int adapterIndex, unsigned int powerCap) const;
+
+    void setPowerCapToDefault(int adapterIndex) const;
+
     void getPerformanceClocks(int adapterIndex, unsigned int& coreClock, unsigned int& memoryClock) const;
+
+    // reads pp_od_clk_voltage, returns false if adapter does not have it
+    bool getODClockVoltage(int adapterIndex, AMDGPUODTable& table) const;
+
+    // writes changed levels of table and commits them
+    void setODClockVoltage(int adapterIndex, const AMDGPUODTable& table) const;
+
+    // restores default clocks and voltages of pp_od_clk_voltage
+    void resetODClockVoltage(int adapterIndex) const;
+
+    // reads pp_power_profile_mode, returns false if adapter does not have it
+    bool getPowerProfiles(int adapterIndex, AMDGPUPowerProfileTable& table) const;
+
+    // command is profile index followed by values of custom profile, the performance level is not changed
+    void setPowerProfile(int adapterIndex, const std::string& command) const;
+
+    // reads power_dpm_force_performance_level, returns false if adapter does not have it
+    bool getPerformanceLevel(int adapterIndex, std::string& level) const;
+
+    void setPerformanceLevel(int adapterIndex, const std::string& level) const;
+
+    // number of states in pp_dpm_sclk, pp_dpm_mclk or pp_dpm_pcie, 0 if not available
+    unsigned int getDPMStatesNum(int adapterIndex, DPMDomain domain) const;
+
+    // allows only given states, needs the manual performance level
+    void setDPMStatesMask(int adapterIndex, DPMDomain domain, const std::vector<int>& states) const;
+
+    // PCI slot name like 0000:01:00.0, stable across re-enumeration of cards
+    std::string getSlotName(int adapterIndex) const;
+
+    // PCI location and device ID from sysfs, without reading other attributes
+    void getIdentity(int adapterIndex, AdapterIdentity& identity) const;
 };
 
 #endif /* AMDGPUADAPTERHANDLE_H */
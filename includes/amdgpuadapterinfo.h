@@ -11,6 +11,51 @@ extern "C" {
 }
 
 #include "adlmaincontrol.h"
+#include "structs.h"
+#include "amdgpuodtable.h"
+#include "amdgpupminfo.h"
+#include "amdgpupowerprofiletable.h"
+
+/* RPM control of fanN of hwmon */
+struct AMDGPUFanRPMControl
+{
+    bool available;     // fanN_input exists
+    bool hasTarget;     // fanN_target is readable, so the driver keeps the speed set by it
+    unsigned int min;   // RPM, fanN_min, 0 if not given
+    unsigned int max;   // RPM, fanN_max, 0 if not given
+};
+
+/* value written to a sysfs attribute */
+struct AMDGPUSysfsWrite
+{
+    std::string path;
+    std::string value;
+};
+
+/* mem_info_* attributes of device, in bytes */
+struct AMDGPUMemoryUsage
+{
+    bool available;
+    unsigned long long vramTotal;
+    unsigned long long vramUsed;
+    unsigned long long visibleVramTotal;    // CPU visible part of VRAM
+    unsigned long long visibleVramUsed;
+    unsigned long long gttTotal;            // system memory mapped for GPU
+    unsigned long long gttUsed;
+};
+
+/* Channel of hwmon, like temp2 ('junction') or fan1. Values are in C (temp), RPM (fan),
+ * V (in) or W (power); limits are NaN if not available. Thermal controller N
+ * (partId of fanspeed) is the fan of pwmN+1. */
+struct AMDGPUSensor
+{
+    std::string type;       // temp, fan, in or power
+    unsigned int channel;   // number in the attribute name
+    std::string label;      // *_label, or type with channel if there is no label
+    double value;
+    double critical;        // temp*_crit
+    double emergency;       // temp*_emergency
+};
 
 struct AMDGPUAdapterInfo
 {
@@ -34,7 +79,19 @@ struct AMDGPUAdapterInfo
     unsigned int tempCritical;
     unsigned int busLanes;
     unsigned int busSpeed;
-    int gpuLoad;
+    int gpuLoad;                // percent, -1 if not available
+    int memoryLoad;             // percent, -1 if not available
+    int power;                  // uW, -1 if not available
+    bool powerCapAvailable;
+    unsigned int powerCap;      // uW
+    unsigned int powerCapMin;   // uW
+    unsigned int powerCapMax;   // uW
+    AMDGPUODTable odTable;
+    AMDGPUPowerProfileTable powerProfiles;
+    AMDGPUMemoryUsage memoryUsage;
+    std::vector<AMDGPUSensor> sensors;
+    AMDGPUPMInfo pmInfo;        // read only if gpu_busy_percent is not available
+    std::string performanceLevel;   // empty if not available
 };
 
 #endif /* AMDGPUADAPTERINFO_H */
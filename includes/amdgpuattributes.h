@@ -0,0 +1,161 @@
+#ifndef AMDGPUATTRIBUTES_H
+#define AMDGPUATTRIBUTES_H
+
+#include <string>
+#include <vector>
+
+/* sysfs attributes of an adapter, in the order of the descriptor table */
+enum class AMDGPUAttribute
+{
+    VENDOR,
+    DEVICE_ID,
+    PP_SCLK_OD,
+    PP_MCLK_OD,
+    PP_DPM_SCLK,
+    PP_DPM_MCLK,
+    PP_DPM_PCIE,
+    PP_OD_CLK_VOLTAGE,
+    PP_POWER_PROFILE_MODE,
+    PERFORMANCE_LEVEL,
+    GPU_BUSY_PERCENT,
+    MEM_BUSY_PERCENT,
+    MEM_INFO_VRAM_TOTAL,
+    MEM_INFO_VRAM_USED,
+    MEM_INFO_VIS_VRAM_TOTAL,
+    MEM_INFO_VIS_VRAM_USED,
+    MEM_INFO_GTT_TOTAL,
+    MEM_INFO_GTT_USED,
+    TEMP1_INPUT,
+    TEMP1_CRIT,
+    TEMP2_INPUT,
+    TEMP2_CRIT,
+    TEMP3_INPUT,
+    TEMP3_CRIT,
+    POWER1_AVERAGE,
+    POWER1_INPUT,
+    POWER1_CAP,
+    POWER1_CAP_MIN,
+    POWER1_CAP_MAX,
+    PWM1,
+    PWM1_ENABLE,
+    PWM1_MIN,
+    PWM1_MAX,
+    FAN1_ENABLE,
+    FAN1_INPUT,
+    COUNT
+};
+
+/* attributes of every thermal controller (pwmN and fanN of hwmon), in the order of
+ * the channel descriptor table */
+enum class AMDGPUChannelAttribute
+{
+    PWM,
+    PWM_ENABLE,
+    PWM_MIN,
+    PWM_MAX,
+    FAN_INPUT,
+    FAN_TARGET,
+    FAN_ENABLE,
+    FAN_MIN,
+    FAN_MAX,
+    COUNT
+};
+
+enum class AMDGPUAttributeBase
+{
+    DEVICE,     // /sys/class/drm/cardN/device
+    HWMON       // hwmon of device
+};
+
+enum class AMDGPUAttributeFormat
+{
+    VALUE,      // single number
+    STRING,     // single line
+    TABLE       // lines parsed by their own parsers (DPM states, OD table, profiles)
+};
+
+struct AMDGPUAttributeDescriptor
+{
+    AMDGPUAttribute attribute;
+    AMDGPUAttributeBase base;
+    const char* name;
+    AMDGPUAttributeFormat format;
+    const char* unit;   // of value multiplied by scale, empty if none
+    double scale;
+};
+
+struct AMDGPUChannelAttributeDescriptor
+{
+    AMDGPUChannelAttribute attribute;
+    const char* type;       // "pwm" or "fan"
+    const char* suffix;     // after channel number, like "_enable"
+};
+
+/* Paths of the attributes of one adapter, resolved once when the adapter is found,
+ * also for every thermal controller (pwmN present at that time) and for debugfs. */
+class AMDGPUAttributePaths
+{
+
+private:
+
+    std::string devicePath;
+
+    std::string hwmonPath;
+
+    std::string pmInfoPath;
+
+    std::vector<std::string> paths;     // by AMDGPUAttribute
+
+    std::vector<std::string> channelPaths;  // by controller index, then AMDGPUChannelAttribute
+
+public:
+
+    AMDGPUAttributePaths(unsigned int cardIndex, unsigned int hwmonIndex);
+
+    const std::string& getDevicePath() const
+    {
+        return devicePath;
+    }
+
+    const std::string& getHwmonPath() const
+    {
+        return hwmonPath;
+    }
+
+    const char* get(AMDGPUAttribute attribute) const
+    {
+        return paths[int(attribute)].c_str();
+    }
+
+    // debugfs amdgpu_pm_info
+    const char* getPMInfo() const
+    {
+        return pmInfoPath.c_str();
+    }
+
+    // number of pwmN channels of hwmon
+    unsigned int getChannelsNum() const
+    {
+        return channelPaths.size() / size_t(AMDGPUChannelAttribute::COUNT);
+    }
+
+    // attribute of thermal controller (controller 1 has pwm2_enable), throws Error if controller is not present
+    const char* getChannel(AMDGPUChannelAttribute attribute, unsigned int controllerIndex) const;
+
+    // name of attribute or channel attribute with this path (like pwm2_enable), false if it has none
+    bool findName(const std::string& path, std::string& name) const;
+
+    // path of attribute or channel attribute with this name, nullptr if adapter does not have it
+    const char* findPath(const std::string& name) const;
+
+    static const AMDGPUAttributeDescriptor& GetDescriptor(AMDGPUAttribute attribute);
+
+    // attribute with this name (like pp_sclk_od), false if name is not in the table
+    static bool FindName(const std::string& name, AMDGPUAttribute& attribute);
+
+    // true for names of attributes and of channel attributes of any controller
+    static bool IsName(const std::string& name);
+
+};
+
+#endif /* AMDGPUATTRIBUTES_H */
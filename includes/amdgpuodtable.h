@@ -0,0 +1,65 @@
+#ifndef AMDGPUODTABLE_H
+#define AMDGPUODTABLE_H
+
+#include <istream>
+#include <string>
+#include <vector>
+
+struct AMDGPUODLevel
+{
+    unsigned int index;
+    unsigned int clock;     // MHz
+    unsigned int voltage;   // mV, 0 if not given for this level
+    bool changed;
+};
+
+struct AMDGPUODRange
+{
+    unsigned int min;
+    unsigned int max;
+    bool isSet;
+};
+
+/* Contents of pp_od_clk_voltage. Polaris and Vega10 list clock and voltage
+ * for every DPM state in OD_SCLK/OD_MCLK, Vega20 and Navi list the minimum and
+ * maximum clocks in OD_SCLK/OD_MCLK and voltages in OD_VDDC_CURVE. */
+struct AMDGPUODTable
+{
+    std::vector<AMDGPUODLevel> coreLevels;
+    std::vector<AMDGPUODLevel> memoryLevels;
+    std::vector<AMDGPUODLevel> voltageCurve;
+    AMDGPUODRange coreClockRange;
+    AMDGPUODRange memoryClockRange;
+    AMDGPUODRange voltageRange;
+
+    AMDGPUODTable();
+
+    bool isAvailable() const
+    {
+        return !coreLevels.empty() || !memoryLevels.empty();
+    }
+
+    // levels changed by vcore: the voltage curve if present, otherwise core levels
+    std::vector<AMDGPUODLevel>& getVoltageLevels()
+    {
+        return voltageCurve.empty() ? coreLevels : voltageCurve;
+    }
+
+    const std::vector<AMDGPUODLevel>& getVoltageLevels() const
+    {
+        return voltageCurve.empty() ? coreLevels : voltageCurve;
+    }
+
+    // commands for changed levels ('s', 'm', 'vc'), without commit
+    void getCommands(std::vector<std::string>& commands) const;
+
+    // level with index partId, or the last level for LAST_PERFLEVEL; nullptr if not found
+    static AMDGPUODLevel* FindLevel(std::vector<AMDGPUODLevel>& levels, int partId);
+
+    static const AMDGPUODLevel* FindLevel(const std::vector<AMDGPUODLevel>& levels, int partId);
+
+    static void Parse(std::istream& is, AMDGPUODTable& table);
+
+};
+
+#endif /* AMDGPUODTABLE_H */
@@ -0,0 +1,32 @@
+#ifndef AMDGPUPMINFO_H
+#define AMDGPUPMINFO_H
+
+#include <istream>
+
+/* Values of debugfs amdgpu_pm_info, -1 if not given. Kernels print clocks and
+ * voltages as lines like '300 MHz (SCLK)' or '0.800 V (VDDGFX)' and other
+ * values as 'GPU Load: 5 %'. Older kernels print only 'GPU load'. */
+struct AMDGPUPMInfo
+{
+    int coreClock;      // MHz
+    int memoryClock;    // MHz
+    int vddgfx;         // mV
+    double gfxPower;    // W (average GPU)
+    int temperature;    // C
+    int gpuLoad;        // percent
+    int memoryLoad;     // percent
+
+    AMDGPUPMInfo();
+
+    bool isAvailable() const
+    {
+        return coreClock >= 0 || memoryClock >= 0 || vddgfx >= 0 || gfxPower >= 0.0 || temperature >= 0 ||
+            gpuLoad >= 0 || memoryLoad >= 0;
+    }
+
+    // reads the whole file at once and parses it in one pass
+    static void Parse(std::istream& is, AMDGPUPMInfo& info);
+
+};
+
+#endif /* AMDGPUPMINFO_H */
@@ -0,0 +1,45 @@
+#ifndef AMDGPUPOWERPROFILETABLE_H
+#define AMDGPUPOWERPROFILETABLE_H
+
+#include <istream>
+#include <string>
+#include <vector>
+
+struct AMDGPUPowerProfile
+{
+    unsigned int index;
+    std::string name;
+    bool active;
+    // heuristics values, one row per clock domain on Navi and one row on older GPUs
+    std::vector<std::vector<std::string> > rows;
+
+    /* commands of pp_power_profile_mode selecting this profile; for CUSTOM they set
+     * its heuristics too, one command per clock domain */
+    void getCommands(std::vector<std::string>& commands) const;
+};
+
+/* Contents of pp_power_profile_mode. The layout differs between GPU generations:
+ * Polaris and Vega10 print one line per profile with heuristics as columns,
+ * Vega20 and Navi print heuristics of every clock domain in lines after the profile,
+ * APUs print names only. */
+struct AMDGPUPowerProfileTable
+{
+    std::vector<std::string> columns;
+    std::vector<AMDGPUPowerProfile> profiles;
+
+    bool isAvailable() const
+    {
+        return !profiles.empty();
+    }
+
+    // active profile, nullptr if none is marked
+    const AMDGPUPowerProfile* getActive() const;
+
+    // profile by index or by name (case insensitive), nullptr if not found
+    const AMDGPUPowerProfile* find(const std::string& nameOrIndex) const;
+
+    static void Parse(std::istream& is, AMDGPUPowerProfileTable& table);
+
+};
+
+#endif /* AMDGPUPOWERPROFILETABLE_H */
@@ -5,21 +5,52 @@
 
 #include "adlmaincontrol.h"
 #include "amdgpuadapterhandle.h"
+#include "outputwriter.h"
 
 class AmdGpuProAdapters
 {
 
 private:
 
-  static void printMemoryClocks(const AMDGPUAdapterInfo adapterInfo);
+  static void printMemoryClocks(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo);
 
-  static void printCoreClocks(const AMDGPUAdapterInfo adapterInfo);
+  static void printCoreClocks(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo);
 
-  static void printTemperature(const AMDGPUAdapterInfo adapterInfo);
+  static void printTemperature(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo);
 
-  static void printGpuLoad(const AMDGPUAdapterInfo adapterInfo);
+  static void printGpuLoad(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo);
 
-  static void printAdapterSummary(const AMDGPUAdapterInfo adapterInfo, int i);
+  static void printPower(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo);
+
+  static void printAdapterSummary(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo, int i);
+
+  static void printODLevels(OutputBuffer& out, const char* name, const std::vector<AMDGPUODLevel>& levels);
+
+  static void printODRange(OutputBuffer& out, const char* name, const AMDGPUODRange& range, const char* unit);
+
+  static void printODTable(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo);
+
+  static void printPowerProfiles(OutputBuffer& out, const AMDGPUPowerProfileTable& table);
+
+  static void printPMInfo(OutputBuffer& out, const AMDGPUPMInfo& pmInfo);
+
+  static void printMemoryUsage(OutputBuffer& out, const AMDGPUMemoryUsage& usage);
+
+  static void printSensors(OutputBuffer& out, const std::vector<AMDGPUSensor>& sensors, bool verbose);
+
+  static void writeSensors(OutputWriter& writer, const std::vector<AMDGPUSensor>& sensors);
+
+  static void writeMemoryUsage(OutputWriter& writer, const AMDGPUMemoryUsage& usage);
+
+  static void writePMInfo(OutputWriter& writer, const AMDGPUPMInfo& pmInfo);
+
+  static void writePowerProfiles(OutputWriter& writer, const AMDGPUPowerProfileTable& table);
+
+  static void writeODLevels(OutputWriter& writer, const char* name, const std::vector<AMDGPUODLevel>& levels);
+
+  static void writeODRange(OutputWriter& writer, const char* name, const AMDGPUODRange& range, double divider);
+
+  static void writeODTable(OutputWriter& writer, const AMDGPUODTable& table);
 
 public:
 
@@ -27,6 +58,8 @@ public:
 
   static void PrintInfoVerbose(AMDGPUAdapterHandle& handle, const std::vector<int>& choosenAdapters, bool useChoosen);
 
+  static void PrintInfoStructured(AMDGPUAdapterHandle& handle, const std::vector<int>& choosenAdapters, bool useChoosen, OutputWriter& writer);
+
 };
 
 #endif /* AMDGPUPROADAPTERS_H */
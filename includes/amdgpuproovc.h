@@ -1,38 +1,93 @@
 #ifndef AMDGPUPROOVC_H
 #define AMDGPUPROOVC_H
 
+#include <string>
 #include <vector>
 
 #include "amdgpuadapterhandle.h"
 #include "structs.h"
 #include "conststrings.h"
+#include "ovcplan.h"
+#include "outputbuffer.h"
+#include "adapterslist.h"
+
+/* adapter state needed to check and apply the parameters */
+/* only the parts needed by actions of the adapter are read, the others stay empty */
+struct AMDGPUOvcState
+{
+    PerfClocks perfClocks;
+    AMDGPUODTable odTable;
+    std::string odTableError;       // non-empty if pp_od_clk_voltage could not be parsed
+    PowerCapRange powerCapRange;
+    AMDGPUPowerProfileTable powerProfiles;
+    std::string performanceLevel;   // empty if not available
+    unsigned int coreStatesNum;
+    unsigned int memoryStatesNum;
+    unsigned int pcieStatesNum;
+    unsigned int fanControllersNum;
+    std::vector<AMDGPUFanRPMControl> fanRPMControls;   // per thermal controller
+};
 
 class AmdGpuProOvc
 {
 
 private:
 
-    static void setFanSpeeds(int adaptersNum, std::vector<FanSpeedSetup> fanSpeedSetups, AMDGPUAdapterHandle& Handle_);
+    static void getState(const AMDGPUAdapterHandle& handle_, const OVCPlan& plan, int adapterIndex, AMDGPUOvcState& state);
+
+    static bool isODType(OVCParamType type);
+
+    static const std::vector<AMDGPUODLevel>* getODLevels(const AMDGPUODTable& table, OVCParamType type);
+
+    static void checkODParameter(const OVCPlan& plan, int action, const AMDGPUODTable& table, std::ostream& errors, bool& failed);
+
+    static void checkFanRPM(const OVCPlan& plan, int action, const AMDGPUOvcState& state, std::ostream& errors, bool& failed);
+
+    static void checkPowerCap(const OVCPlan& plan, int action, const PowerCapRange& powerCapRange, std::ostream& errors, bool& failed);
+
+    static bool getPowerProfileCommand(const OVCPlan& plan, int action, const AMDGPUPowerProfileTable& powerProfiles,
+                                       std::string& command, std::string& profileName);
+
+    static void checkPowerProfile(const OVCPlan& plan, int action, const AMDGPUPowerProfileTable& powerProfiles, std::ostream& errors,
+                                  bool& failed);
+
+    static int findAction(const OVCPlan& plan, int adapterIndex, OVCParamType type);
+
+    static std::string getPerformanceLevel(const OVCPlan& plan, int action);
+
+    static bool switchesToManualLevel(const OVCPlan& plan, int adapterIndex, const AMDGPUOvcState& state);
+
+    static void checkPerformanceLevel(const OVCPlan& plan, int action, const AMDGPUOvcState& state, std::ostream& errors, bool& failed);
+
+    static DPMDomain getDPMDomain(OVCParamType type);
+
+    static unsigned int getDPMStatesNum(const AMDGPUOvcState& state, DPMDomain domain);
+
+    static bool getDPMStates(const OVCPlan& plan, int action, unsigned int statesNum, std::vector<int>& states);
 
-    static void checkFanSpeeds(const std::vector<OVCParameter>& ovcParams, bool& failed);
+    static void checkDPMStatesMask(const OVCPlan& plan, int adapterIndex, int action, const AMDGPUOvcState& state, std::ostream& errors,
+                                   bool& failed);
 
-    static void checkAdapterIndicies(const std::vector<OVCParameter>& ovcParams, int adaptersNum, bool & failed);
+    static void checkParameters(const OVCPlan& plan, const std::vector<AMDGPUOvcState>& states, std::ostream& errors, bool& failed);
 
-    static void checkParameters(const std::vector<OVCParameter>& ovcParams, int adaptersNum, const std::vector<PerfClocks>& perfClocksList, bool & failed);
+    static void throwErrorOnFailed(std::ostream& errors, bool failed);
 
-    static void throwErrorOnFailed(bool failed);
+    static void printChanges(const OVCPlan& plan, const std::vector<AMDGPUOvcState>& states);
 
-    static void printFanSpeedChanges(const std::vector<OVCParameter>& ovcParams, int adaptersNum);
+    static void setODParameters(AMDGPUAdapterHandle& handle_, const OVCPlan& plan, int adapterIndex, const AMDGPUODTable& odTable);
 
-    static void printParameterChanges(const std::vector<OVCParameter>& ovcParams, int adaptersNum);
+    static void setPerformanceLevelAndMasks(AMDGPUAdapterHandle& handle_, const OVCPlan& plan, int adapterIndex,
+                                            const AMDGPUOvcState& state);
 
-    static void setFanSpeedSetup(std::vector<FanSpeedSetup>& fanSpeedSetups, const std::vector<OVCParameter>& ovcParams, int adaptersNum);
+    static void setFanRPM(AMDGPUAdapterHandle& handle_, const OVCPlan& plan, int adapterIndex, int action);
 
-    static void setParameters(AMDGPUAdapterHandle& handle_, const std::vector<OVCParameter>& ovcParams, int adaptersNum, const std::vector<PerfClocks>& perfClocksList);
+    static void setParameters(AMDGPUAdapterHandle& handle_, const OVCPlan& plan, const std::vector<AMDGPUOvcState>& states);
 
 public:
 
-    static void Set(AMDGPUAdapterHandle& Handle_, const std::vector<OVCParameter>& OvcParams, const std::vector<PerfClocks>& PerfClocksList);
+    /* clocks and voltages of adapters having pp_od_clk_voltage (non-empty odTable of state) are set per level.
+     * Errors in parameters are written to Errors before Error is thrown */
+    static void Set(AMDGPUAdapterHandle& Handle_, const std::vector<OVCParameter>& OvcParams, bool Report, std::ostream& Errors);
 
 };
 
@@ -4,6 +4,7 @@
 #include "amdgpuproovc.h"
 #include "amdgpuproadapters.h"
 #include "structs.h"
+#include "profile.h"
 
 
 class AmdGpuProProcessing
@@ -13,15 +14,19 @@ private:
 
     AMDGPUAdapterHandle handle;
 
-    void setOvcParameters(std::vector<OVCParameter> ovcParameters);
-
-    void printAdapterInfo(bool printVerbose, std::vector<int> chosenAdapters, bool useAdaptersList, bool chooseAllAdapters);
+    void printAdapterInfo(bool printVerbose, std::vector<int> chosenAdapters, bool useAdaptersList, bool chooseAllAdapters, OutputFormat format);
 
     void validateAdapterList(bool useAdaptersList, std::vector<int> chosenAdapters);
 
+    void compileProfile(const Profile& profile, std::vector<OVCParameter>& ovcParameters);
+
 public:
 
-    void Process(std::vector<OVCParameter> OvcParameters, bool UseAdaptersList, std::vector<int> ChosenAdapters, bool ChooseAllAdapters, bool PrintVerbose);
+    void Process(std::vector<OVCParameter> OvcParameters, bool UseAdaptersList, std::vector<int> ChosenAdapters, bool ChooseAllAdapters, bool PrintVerbose,
+                 OutputFormat Format, const Profile& Profile_);
+
+    static void SetOvcParameters(AMDGPUAdapterHandle& Handle_, const std::vector<OVCParameter>& OvcParameters, bool Report,
+                                 std::ostream& Errors);
 
 };
 
@@ -9,6 +9,8 @@
 
 #include "../dependencies/ADL_SDK_V10.2/include/adl_sdk.h"
 #include "error.h"
+#include "timingtrace.h"
+#include "iostats.h"
 
 class ATIADLHandle
 {
@@ -33,9 +35,25 @@ private:
     typedef int (*ADL_Overdrive5_FanSpeedToDefault_Set_T)(int adapterIndex, int thermalCtrlIndex);
     typedef int (*ADL_Overdrive5_ODPerformanceLevels_Set_T)(int adapterIndex, ADLODPerformanceLevels* odPerformanceLevels);
 
+    typedef int (*ADL_Overdrive_Caps_T)(int adapterIndex, int* supported, int* enabled, int* version);
+
+    typedef int (*ADL_Overdrive6_Capabilities_Get_T)(int adapterIndex, ADLOD6Capabilities* capabilities);
+    typedef int (*ADL_Overdrive6_StateInfo_Get_T)(int adapterIndex, int stateType, ADLOD6StateInfo* stateInfo);
+    typedef int (*ADL_Overdrive6_State_Set_T)(int adapterIndex, int stateType, ADLOD6StateInfo* stateInfo);
+    typedef int (*ADL_Overdrive6_PowerControlInfo_Get_T)(int adapterIndex, ADLOD6PowerControlInfo* powerControlInfo);
+    typedef int (*ADL_Overdrive6_PowerControl_Get_T)(int adapterIndex, int* currentValue, int* defaultValue);
+    typedef int (*ADL_Overdrive6_PowerControl_Set_T)(int adapterIndex, int value);
+
+    typedef int (*ADL_OverdriveN_Capabilities_Get_T)(int adapterIndex, ADLODNCapabilities* capabilities);
+    typedef int (*ADL_OverdriveN_Clocks_T)(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels);
+    typedef int (*ADL_OverdriveN_PowerLimit_T)(int adapterIndex, ADLODNPowerLimitSetting* powerLimit);
+
     void* handle;
     void* getSym(const char* name);
 
+    // nullptr if library does not have symbol
+    void* getOptionalSym(const char* name);
+
     ADL_Main_Control_Create_T pADL_Main_Control_Create;
     ADL_Main_Control_Destroy_T pADL_Main_Control_Destroy;
     ADL_ConsoleMode_FileDescriptor_Set_T pADL_ConsoleMode_FileDescriptor_Set;
@@ -52,6 +70,22 @@ private:
     ADL_Overdrive5_FanSpeedToDefault_Set_T pADL_Overdrive5_FanSpeedToDefault_Set;
     ADL_Overdrive5_ODPerformanceLevels_Set_T pADL_Overdrive5_ODPerformanceLevels_Set;
 
+    // optional, older libraries have only Overdrive5
+    ADL_Overdrive_Caps_T pADL_Overdrive_Caps;
+    ADL_Overdrive6_Capabilities_Get_T pADL_Overdrive6_Capabilities_Get;
+    ADL_Overdrive6_StateInfo_Get_T pADL_Overdrive6_StateInfo_Get;
+    ADL_Overdrive6_State_Set_T pADL_Overdrive6_State_Set;
+    ADL_Overdrive6_PowerControlInfo_Get_T pADL_Overdrive6_PowerControlInfo_Get;
+    ADL_Overdrive6_PowerControl_Get_T pADL_Overdrive6_PowerControl_Get;
+    ADL_Overdrive6_PowerControl_Set_T pADL_Overdrive6_PowerControl_Set;
+    ADL_OverdriveN_Capabilities_Get_T pADL_OverdriveN_Capabilities_Get;
+    ADL_OverdriveN_Clocks_T pADL_OverdriveN_SystemClocks_Get;
+    ADL_OverdriveN_Clocks_T pADL_OverdriveN_SystemClocks_Set;
+    ADL_OverdriveN_Clocks_T pADL_OverdriveN_MemoryClocks_Get;
+    ADL_OverdriveN_Clocks_T pADL_OverdriveN_MemoryClocks_Set;
+    ADL_OverdriveN_PowerLimit_T pADL_OverdriveN_PowerLimit_Get;
+    ADL_OverdriveN_PowerLimit_T pADL_OverdriveN_PowerLimit_Set;
+
 public:
 
     ATIADLHandle();
@@ -76,6 +110,34 @@ public:
     void Overdrive5_FanSpeedToDefault_Set(int adapterIndex, int thermalCtrlIndex) const;
     void Overdrive5_ODPerformanceLevels_Set(int adapterIndex, ADLODPerformanceLevels* odPerformanceLevels) const;
 
+    bool hasOverdriveCaps() const
+    {
+        return pADL_Overdrive_Caps != nullptr;
+    }
+
+    // all Overdrive6 functions used by program are present
+    bool hasOverdrive6() const;
+
+    // all OverdriveN functions used by program are present
+    bool hasOverdriveN() const;
+
+    void Overdrive_Caps(int adapterIndex, int* supported, int* enabled, int* version) const;
+
+    void Overdrive6_Capabilities_Get(int adapterIndex, ADLOD6Capabilities* capabilities) const;
+    void Overdrive6_StateInfo_Get(int adapterIndex, int stateType, ADLOD6StateInfo* stateInfo) const;
+    void Overdrive6_State_Set(int adapterIndex, int stateType, ADLOD6StateInfo* stateInfo) const;
+    void Overdrive6_PowerControlInfo_Get(int adapterIndex, ADLOD6PowerControlInfo* powerControlInfo) const;
+    void Overdrive6_PowerControl_Get(int adapterIndex, int* currentValue, int* defaultValue) const;
+    void Overdrive6_PowerControl_Set(int adapterIndex, int value) const;
+
+    void OverdriveN_Capabilities_Get(int adapterIndex, ADLODNCapabilities* capabilities) const;
+    void OverdriveN_SystemClocks_Get(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels) const;
+    void OverdriveN_SystemClocks_Set(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels) const;
+    void OverdriveN_MemoryClocks_Get(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels) const;
+    void OverdriveN_MemoryClocks_Set(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels) const;
+    void OverdriveN_PowerLimit_Get(int adapterIndex, ADLODNPowerLimitSetting* powerLimit) const;
+    void OverdriveN_PowerLimit_Set(int adapterIndex, ADLODNPowerLimitSetting* powerLimit) const;
+
 };
 
 #endif /* ATIADLHANDLE_H */
@@ -0,0 +1,80 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <csignal>
+#include <regex>
+#include <string>
+
+#include "tunebackend.h"
+
+/* workload run by the tuner at every tried setting */
+class Benchmark
+{
+
+public:
+
+    virtual ~Benchmark()
+    {}
+
+    // returns false if benchmark failed (adapter is not stable at current settings)
+    virtual bool run(int adapterIndex, double& metric) = 0;
+
+    // stops the running benchmark, called from a signal handler
+    virtual void interrupt()
+    {}
+
+};
+
+/* Runs command by shell with AMDCOVC_ADAPTER set to the adapter index and takes
+ * the metric from the last match of the regular expression (ECMAScript syntax) in
+ * its output: the first group, or the whole match if the expression has no groups.
+ * Nonzero exit status of command means failure. A command running longer than the
+ * timeout (a hung adapter) is killed with its process group and also fails. */
+class CommandBenchmark: public Benchmark
+{
+
+private:
+
+    std::string command;
+
+    std::regex metricRegex;
+
+    unsigned int timeout;   // s
+
+    volatile sig_atomic_t processGroup;     // of running command, 0 if none
+
+    // runs command, returns false if it failed or was killed after timeout
+    bool runCommand(int adapterIndex, std::string& output);
+
+public:
+
+    CommandBenchmark(const std::string& _command, const std::string& metricPattern, unsigned int _timeout);
+
+    bool run(int adapterIndex, double& metric);
+
+    // kills process group of running command
+    void interrupt();
+
+};
+
+/* throughput of SimulatedTuneBackend */
+class SimulatedBenchmark: public Benchmark
+{
+
+private:
+
+    const SimulatedTuneBackend& backend;
+
+public:
+
+    explicit SimulatedBenchmark(const SimulatedTuneBackend& _backend) : backend(_backend)
+    {}
+
+    bool run(int adapterIndex, double& metric)
+    {
+        return backend.getThroughput(adapterIndex, metric);
+    }
+
+};
+
+#endif /* BENCHMARK_H */
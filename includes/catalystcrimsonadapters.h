@@ -4,23 +4,32 @@
 #include <vector>
 
 #include "amdgpuadapterhandle.h"
+#include "adladaptertable.h"
 #include "adlmaincontrol.h"
 #include "pciaccess.h"
+#include "outputwriter.h"
 
 class CatalystCrimsonAdapters
 {
 
 private:
 
+  static void writeODParameterRange(OutputWriter& writer, const char* name, const ADLODParameterRange& range, double divider);
+
+  static void writePerformanceLevels(OutputWriter& writer, const char* name, const std::vector<ADLODPerformanceLevel>& perfLevels);
+
 public:
 
-  static void PrintInfo(ADLMainControl& mainControl, int adaptersNum, const std::vector<int>& activeAdapters, const std::vector<int>& choosenAdapters,
-                                bool useChoosen);
+  static void PrintInfo(ADLMainControl& mainControl, ADLAdapterTable& adapterTable, const std::vector<int>& choosenAdapters, bool useChoosen);
+
+  static void PrintInfoVerbose(ADLMainControl& mainControl, ADLAdapterTable& adapterTable, const std::vector<int>& choosenAdapters,
+                               bool useChoosen);
 
-  static void PrintInfoVerbose(ADLMainControl& mainControl, int adaptersNum, const std::vector<int>& activeAdapters,
-                                       const std::vector<int>& choosenAdapters, bool useChoosen);
+  static void PrintInfoStructured(ADLMainControl& mainControl, ADLAdapterTable& adapterTable, const std::vector<int>& choosenAdapters,
+                                  bool useChoosen, OutputWriter& writer);
 
-  static void GetActiveAdaptersIndices(ADLMainControl& mainControl, int adaptersNum, std::vector<int>& activeAdapters);
+  // device ID from UDID like 'PCI_VEN_1002&DEV_67DF&...', -1 if not present
+  static int ParseDeviceIdFromUDID(const char* udid);
 
 };
 
@@ -4,18 +4,31 @@
 #include <vector>
 #include <cmath>
 
+#include "adladaptertable.h"
 #include "adlmaincontrol.h"
 #include "structs.h"
 #include "conststrings.h"
+#include "ovcplan.h"
+#include "outputbuffer.h"
 
 class CatalystCrimsonOvc
 {
 
 private:
 
+  static bool isAMDGPUOnly(OVCParamType type);
+
+  // last level is counted separately for memory clock (OverdriveN)
+  static int getPerfLevel(const OVCPlan& plan, int action, ADLAdapterTable& adapterTable, int adapterIndex);
+
+  static void checkParameters(const OVCPlan& plan, ADLAdapterTable& adapterTable, std::ostream& errors, bool& failed);
+
+  static void printChanges(const OVCPlan& plan, ADLAdapterTable& adapterTable);
+
 public:
 
-  static void Set(ADLMainControl& MainControl, const std::vector<int>& ActiveAdapters, const std::vector<OVCParameter>& OvcParams);
+  static void Set(ADLMainControl& MainControl, ADLAdapterTable& AdapterTable, const std::vector<OVCParameter>& OvcParams,
+                  bool Report, std::ostream& Errors);
 
 };
 
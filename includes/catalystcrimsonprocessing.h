@@ -8,18 +8,20 @@
 #include "structs.h"
 #include "atiadlhandle.h"
 #include "adapterslist.h"
+#include "profile.h"
 
 class CatalystCrimsonProcessing
 {
 
 private:
 
-    void checkAdapterList(bool useAdaptersList, std::vector<int> chosenAdapters, std::vector<int> activeAdapters);
+    void checkAdapterList(bool useAdaptersList, std::vector<int> chosenAdapters, int adaptersNum);
 
 public:
 
-    void Process(ATIADLHandle Handle_, bool UseAdaptersList, std::vector<int> ChosenAdapters, std::vector<OVCParameter> OvcParameters,
-                 bool ChooseAllAdapters, bool PrintVerbose);
+    void Process(const ATIADLHandle& Handle_, bool UseAdaptersList, std::vector<int> ChosenAdapters, std::vector<OVCParameter> OvcParameters,
+                 bool ChooseAllAdapters, bool PrintVerbose, OutputFormat Format,
+                 const Profile& Profile_);
 
 };
 
@@ -6,6 +6,7 @@
 #include "conststrings.h"
 #include "structs.h"
 #include "adapterslist.h"
+#include "profile.h"
 
 class CliParameters
 {
@@ -22,10 +23,16 @@ private:
 
   bool chooseAllAdapters;
 
-  bool parseOVCParameter(const char* string, OVCParameter& param);
+  OutputFormat outputFormat;
+
+  bool fieldsSelected;
+
+  Profile profile;
 
 public:
 
+  static bool ParseOVCParameter(const char* string, OVCParameter& param, std::ostream& errors);
+
   bool SetPrintHelp(const char* Argvi);
 
   void CheckPrintHelp(bool PrintHelp);
@@ -44,11 +51,21 @@ public:
 
   bool SetUseAdaptersListEquals(const char* Argvi);
 
-  bool SetUseAdaptersList(const char** Argv, int Argc, int I);
+  bool SetUseAdaptersList(const char** Argv, int Argc, int& I);
 
   bool ParseParametersOrFail(const char* Argvi);
 
-  bool ParseAdaptersList(const char** Argv, int Argc, int I);
+  bool ParseAdaptersList(const char** Argv, int Argc, int& I);
+
+  bool SetTraceTiming(const char* Argvi);
+
+  bool SetPrintStats(const char* Argvi);
+
+  bool SetOutputFormat(const char* Argvi);
+
+  bool SetOutputFields(const char* Argvi);
+
+  bool SetProfile(const char** Argv, int Argc, int& I);
 };
 
 #endif /* CLIPARAMETERS_H */
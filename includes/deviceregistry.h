@@ -0,0 +1,100 @@
+#ifndef DEVICEREGISTRY_H
+#define DEVICEREGISTRY_H
+
+#include <string>
+#include <vector>
+
+#include "amdgpuadapterhandle.h"
+
+enum class DeviceEventType
+{
+    ADDED,      // adapter appeared (again)
+    REMOVED,    // adapter fell off the bus or its driver was unbound
+    CHANGED     // adapter was reset, hwmon was probed again
+};
+
+struct DeviceEvent
+{
+    DeviceEventType type;
+    int adapterId;
+};
+
+/* Keeps adapters of a handle up to date for long-running modes by listening for
+ * kernel uevents of the drm subsystem (NETLINK_KOBJECT_UEVENT). Only the card of
+ * an event is probed, the other adapters are not rescanned.
+ *
+ * Adapters are identified by ids that stay stable while cards come and go: the
+ * initial adapters get ids equal to their indices, an adapter appearing again in
+ * the same PCI slot gets its old id back, a new one gets the next id. Handle
+ * indices can change after removals, so they are looked up by GetHandleIndex
+ * every time they are used.
+ *
+ * InjectUevent processes a message in the kernel format (ACTION@DEVPATH followed
+ * by NUL-terminated KEY=VALUE pairs) as if it came from netlink, for tests. */
+class DeviceRegistry
+{
+
+private:
+
+    struct Entry
+    {
+        std::string slotName;   // PCI slot name
+        unsigned int cardIndex;
+        int handleIndex;        // -1 if adapter is not present
+    };
+
+    AMDGPUAdapterHandle& handle;
+
+    std::vector<Entry> entries;     // index is adapter id
+
+    int socketFd;   // -1 if uevents are not available
+
+    int findEntry(unsigned int cardIndex) const;
+
+    void updateHandleIndices();
+
+    static bool parseCardIndex(const std::string& devPath, unsigned int& cardIndex);
+
+    void removeEntry(int entryIndex, std::vector<DeviceEvent>& events);
+
+    void addCard(unsigned int cardIndex, std::vector<DeviceEvent>& events);
+
+    void resynchronize(std::vector<DeviceEvent>& events);
+
+    void processUevent(const char* data, size_t size, std::vector<DeviceEvent>& events);
+
+    void receiveUevents(std::vector<DeviceEvent>& events);
+
+public:
+
+    explicit DeviceRegistry(AMDGPUAdapterHandle& _handle);
+
+    ~DeviceRegistry();
+
+    DeviceRegistry(const DeviceRegistry&) = delete;
+
+    DeviceRegistry& operator=(const DeviceRegistry&) = delete;
+
+    // false if netlink socket could not be opened, adapters are fixed then
+    bool IsListening() const
+    {
+        return socketFd >= 0;
+    }
+
+    // number of adapter ids given so far, including removed adapters
+    unsigned int GetAdaptersNum() const
+    {
+        return entries.size();
+    }
+
+    // current index of adapter in handle, -1 if it is not present
+    int GetHandleIndex(int adapterId) const;
+
+    // waits up to timeout ms, processing uevents as they come, appends changes of adapters
+    void Poll(unsigned int timeout, std::vector<DeviceEvent>& events);
+
+    void InjectUevent(const std::string& message, std::vector<DeviceEvent>& events);
+
+};
+
+#endif /* DEVICEREGISTRY_H */
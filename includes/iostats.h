@@ -0,0 +1,119 @@
+#ifndef IOSTATS_H
+#define IOSTATS_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <cstdint>
+
+class IOStats
+{
+
+public:
+
+    enum class Operation
+    {
+        READ,
+        WRITE,
+        CALL
+    };
+
+    // bucket 0 holds latencies below 1 us, bucket i holds [2^(i-1), 2^i) us
+    static const int BUCKETS_NUM = 24;
+
+    struct Entry
+    {
+        uint64_t opens;
+        uint64_t reads;
+        uint64_t writes;
+        uint64_t calls;
+        uint64_t errors;
+        uint64_t totalNs;
+        uint64_t maxNs;
+        uint64_t buckets[BUCKETS_NUM];
+    };
+
+private:
+
+    static bool enabled;
+
+    static std::map<std::pair<std::string, std::string>, Entry> entries;
+
+    static std::mutex entriesMutex;
+
+    static void classifySysfsPath(const char* path, std::string& adapter, std::string& attribute);
+
+    static void record(const std::string& adapter, const std::string& attribute, Operation operation, bool failed, uint64_t durationNs);
+
+    static uint64_t getBucketUpperBound(int bucket);
+
+    static uint64_t getPercentile(const Entry& entry, double percentile);
+
+public:
+
+    // measures one sysfs access (by file path) or one ADL entry point call (by name)
+    class Scope
+    {
+
+    private:
+
+        const char* group;
+
+        const char* name;
+
+        Operation operation;
+
+        bool active;
+
+        bool failed;
+
+        std::chrono::steady_clock::time_point start;
+
+    public:
+
+        Scope(const char* path, Operation _operation) : group(nullptr), name(path), operation(_operation), active(enabled), failed(false)
+        {
+            if (active)
+            {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        Scope(const char* _group, const char* _name, Operation _operation) : group(_group), name(_name), operation(_operation),
+            active(enabled), failed(false)
+        {
+            if (active)
+            {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~Scope();
+
+        void setFailed()
+        {
+            failed = true;
+        }
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    static void Enable();
+
+    static bool IsEnabled()
+    {
+        return enabled;
+    }
+
+    static void Print(std::ostream& os);
+
+    static void Finish();
+
+};
+
+#endif /* IOSTATS_H */
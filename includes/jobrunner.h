@@ -0,0 +1,61 @@
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "amdgpuadapterhandle.h"
+#include "deviceregistry.h"
+#include "outputbuffer.h"
+
+/* telemetry of adapter collected while the job runs */
+struct JobStats
+{
+    int adapterIndex;
+    unsigned int samples;
+    double energy;          // J, integrated board power, negative if power is not available
+    double temperatureMin;  // C
+    double temperatureMax;
+    double temperatureSum;
+    double coreClockSum;    // MHz
+    double coreClockMax;
+    double memoryClockSum;
+    double memoryClockMax;
+    double lastPower;       // W, power of the previous sample
+};
+
+/* Runs a command with the settings of a profile and parameters applied to the chosen
+ * adapters. While the command runs, adapters are sampled: board power is integrated
+ * into energy, temperatures and clocks are summarized. The previous settings are
+ * restored when the command ends, when the wrapper gets a terminating signal or
+ * crashes, and by the next job if the wrapper was killed (see SettingsJournal). */
+class JobRunner
+{
+
+private:
+
+    AMDGPUAdapterHandle& handle;
+
+    DeviceRegistry registry;    // adapters that disappear are not sampled
+
+    std::vector<int> adapters;
+
+    unsigned int sampleInterval;   // ms
+
+    void sample(std::vector<JobStats>& stats, double interval);
+
+    static void writeStats(OutputBuffer& out, const JobStats& stats, double duration);
+
+public:
+
+    JobRunner(AMDGPUAdapterHandle& _handle, const std::vector<int>& _adapters, unsigned int _sampleInterval);
+
+    // runs command until it ends, returns its exit status (128 + signal if it was killed)
+    int Run(const std::vector<std::string>& command, std::vector<JobStats>& stats, double& duration);
+
+    // amdcovc exec [OPTIONS] [PARAM ...] -- COMMAND [ARG ...]
+    static int Main(int argc, const char** argv);
+
+};
+
+#endif /* JOBRUNNER_H */
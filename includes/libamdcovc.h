@@ -0,0 +1,98 @@
+#ifndef LIBAMDCOVC_H
+#define LIBAMDCOVC_H
+
+/*
+ * C API of the libamdcovc library.
+ *
+ * A context picks the AMD Catalyst/Crimson (ADL) backend if libatiadlxx.so is available,
+ * otherwise the AMDGPU(-PRO) sysfs backend, exactly like the amdcovc program.
+ * Adapter indices are the same as printed by amdcovc. A context is not thread-safe;
+ * use one context per thread.
+ *
+ * ADL state is global to the process, so all contexts with the ADL backend share one
+ * ADL instance, created with the first of them and destroyed with the last one.
+ * The ADL backend allows only one caller at a time per process: calls of these
+ * contexts are serialized, a call waits until the call of another thread ends.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AMDCOVC_API_VERSION 2
+
+enum
+{
+    AMDCOVC_OK = 0,
+    AMDCOVC_ERROR = -1,
+    AMDCOVC_INVALID_ARGUMENT = -2,
+    AMDCOVC_INVALID_PARAMETERS = -3
+};
+
+enum
+{
+    AMDCOVC_BACKEND_ADL = 1,
+    AMDCOVC_BACKEND_AMDGPU = 2
+};
+
+typedef struct amdcovc_context amdcovc_context;
+
+/*
+ * Adapter snapshot. The caller must set 'size' to sizeof(amdcovc_adapter_info);
+ * new fields are only ever appended, so older callers keep working.
+ * Fields unknown for the backend are set to -1.
+ */
+typedef struct amdcovc_adapter_info
+{
+    unsigned int size;
+    int backend;
+    int busNo;
+    int deviceNo;
+    int funcNo;
+    int vendorId;
+    int deviceId;
+    char name[128];
+    double coreClock;           /* MHz */
+    double memoryClock;         /* MHz */
+    double vddc;                /* V */
+    int coreOD;                 /* percent */
+    int memoryOD;               /* percent */
+    int gpuLoad;                /* percent */
+    double temperature;         /* C */
+    double tempCritical;        /* C */
+    double fanSpeed;            /* percent */
+    int defaultFanSpeed;        /* 1 if fan speed is controlled automatically */
+    int busLanes;
+    int busSpeed;
+    int perfLevel;
+    double power;               /* W */
+    double powerCap;            /* W */
+} amdcovc_adapter_info;
+
+int amdcovc_get_api_version(void);
+
+/* on failure the reason is copied to error (truncated to errorSize, may be NULL if errorSize is 0) */
+int amdcovc_create(amdcovc_context** context, char* error, size_t errorSize);
+
+void amdcovc_destroy(amdcovc_context* context);
+
+int amdcovc_get_backend(const amdcovc_context* context);
+
+int amdcovc_get_adapters_num(amdcovc_context* context, int* adaptersNum);
+
+int amdcovc_get_adapter_info(amdcovc_context* context, int adapterIndex, amdcovc_adapter_info* info);
+
+/* parameters use the amdcovc command line syntax, e.g. "coreclk:0=1100", "fanspeed:0-3=default".
+ * Nothing is printed; reasons of rejected parameters are returned by amdcovc_get_last_error, one per line */
+int amdcovc_apply(amdcovc_context* context, const char* const* parameters, int parametersNum);
+
+/* message of the last failed call on this context (empty if none) */
+const char* amdcovc_get_last_error(const amdcovc_context* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBAMDCOVC_H */
@@ -0,0 +1,57 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <string>
+#include <unistd.h>
+
+/* Collects one snapshot of output and emits it with a single write().
+ * Numbers are formatted without the C++ locale: integers as plain digits,
+ * doubles like '%g' with 6 significant digits and always '.' as decimal point. */
+class OutputBuffer
+{
+
+private:
+
+    std::string buffer;
+
+    int fd;
+
+public:
+
+    explicit OutputBuffer(int _fd = STDOUT_FILENO, size_t capacity = 16384);
+
+    ~OutputBuffer();
+
+    OutputBuffer& operator<<(const char* value);
+
+    OutputBuffer& operator<<(const std::string& value);
+
+    OutputBuffer& operator<<(char value);
+
+    OutputBuffer& operator<<(int value);
+
+    OutputBuffer& operator<<(unsigned int value);
+
+    OutputBuffer& operator<<(long value);
+
+    OutputBuffer& operator<<(unsigned long value);
+
+    OutputBuffer& operator<<(double value);
+
+    const std::string& str() const
+    {
+        return buffer;
+    }
+
+    // writes the collected output and clears buffer
+    void Flush();
+
+    static void AppendUnsigned(std::string& out, unsigned long value);
+
+    static void AppendInteger(std::string& out, long value);
+
+    static void AppendDouble(std::string& out, double value);
+
+};
+
+#endif /* OUTPUTBUFFER_H */
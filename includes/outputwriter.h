@@ -0,0 +1,270 @@
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "outputbuffer.h"
+
+enum class OutputFormat
+{
+    TEXT,
+    JSON,
+    CSV,
+    KV
+};
+
+/* Streaming writer for machine-readable output. Values are appended to the output
+ * buffer as they are supplied, no document tree is built. Objects and arrays can be nested inside records;
+ * CSV and KV flatten nested names with '.'. */
+class OutputWriter
+{
+
+    friend class FilteredOutputWriter;
+
+private:
+
+    static std::vector<std::string> selectedFields;
+
+protected:
+
+    OutputBuffer& out;
+
+    explicit OutputWriter(OutputBuffer& _out) : out(_out) { }
+
+    virtual void writeValue(const char* name, const std::string& text, bool isString) = 0;
+
+public:
+
+    static const int SCHEMA_VERSION = 1;
+
+    static bool ParseFormat(const char* string, OutputFormat& format);
+
+    // writer is filtered if fields were selected by SelectFields
+    static std::unique_ptr<OutputWriter> Create(OutputFormat format, OutputBuffer& out);
+
+    // comma-separated list of flattened names ('memory.vramUsed'), a name selects also all fields inside it
+    static void SelectFields(const char* list);
+
+    virtual ~OutputWriter() { }
+
+    virtual void BeginDocument() = 0;
+
+    virtual void EndDocument() = 0;
+
+    virtual void BeginRecord() = 0;
+
+    virtual void EndRecord() = 0;
+
+    // name is ignored for objects that are array elements
+    virtual void BeginObject(const char* name) = 0;
+
+    virtual void EndObject() = 0;
+
+    virtual void BeginArray(const char* name) = 0;
+
+    virtual void EndArray() = 0;
+
+    virtual void Field(const char* name, const std::vector<unsigned int>& values) = 0;
+
+    void Field(const char* name, const std::string& value);
+
+    void Field(const char* name, const char* value);
+
+    void Field(const char* name, int value);
+
+    void Field(const char* name, unsigned int value);
+
+    void Field(const char* name, double value);
+
+    void Field(const char* name, bool value);
+
+};
+
+class JsonOutputWriter: public OutputWriter
+{
+
+private:
+
+    std::vector<bool> firstInLevel;
+
+    void writeSeparator();
+
+    void writeKey(const char* name);
+
+    void writeString(const std::string& string);
+
+protected:
+
+    void writeValue(const char* name, const std::string& text, bool isString);
+
+public:
+
+    explicit JsonOutputWriter(OutputBuffer& out) : OutputWriter(out) { }
+
+    void BeginDocument();
+
+    void EndDocument();
+
+    void BeginRecord();
+
+    void EndRecord();
+
+    void BeginObject(const char* name);
+
+    void EndObject();
+
+    void BeginArray(const char* name);
+
+    void EndArray();
+
+    void Field(const char* name, const std::vector<unsigned int>& values);
+
+};
+
+/* Adapters have different sensors and power profiles, so rows are kept until the end
+ * of the document; the header has the columns of all records, missing cells are empty. */
+class CsvOutputWriter: public OutputWriter
+{
+
+private:
+
+    typedef std::vector<std::pair<std::string, std::string> > Row;
+
+    std::vector<std::string> path;
+
+    std::vector<std::string> header;
+
+    std::vector<Row> rows;
+
+    std::string getFullName(const char* name) const;
+
+    void writeCell(const std::string& text);
+
+protected:
+
+    void writeValue(const char* name, const std::string& text, bool isString);
+
+public:
+
+    explicit CsvOutputWriter(OutputBuffer& out) : OutputWriter(out) { }
+
+    void BeginDocument();
+
+    void EndDocument();
+
+    void BeginRecord();
+
+    void EndRecord();
+
+    void BeginObject(const char* name);
+
+    void EndObject();
+
+    void BeginArray(const char* name);
+
+    void EndArray();
+
+    void Field(const char* name, const std::vector<unsigned int>& values);
+
+};
+
+class KvOutputWriter: public OutputWriter
+{
+
+private:
+
+    struct Level
+    {
+        std::string name;
+        bool isArray;
+        int index;
+    };
+
+    std::vector<Level> path;
+
+    std::string getFullName(const char* name) const;
+
+protected:
+
+    void writeValue(const char* name, const std::string& text, bool isString);
+
+public:
+
+    explicit KvOutputWriter(OutputBuffer& out) : OutputWriter(out) { }
+
+    void BeginDocument();
+
+    void EndDocument();
+
+    void BeginRecord();
+
+    void EndRecord();
+
+    void BeginObject(const char* name);
+
+    void EndObject();
+
+    void BeginArray(const char* name);
+
+    void EndArray();
+
+    void Field(const char* name, const std::vector<unsigned int>& values);
+
+};
+
+/* Passes only selected fields to another writer. Objects and arrays are written
+ * only when some field inside them is selected; records are always written. */
+class FilteredOutputWriter: public OutputWriter
+{
+
+private:
+
+    struct Level
+    {
+        std::string name;
+        bool isArray;
+        bool isElement;
+        bool written;
+    };
+
+    std::unique_ptr<OutputWriter> writer;
+
+    std::vector<std::string> fields;
+
+    std::vector<Level> path;
+
+    bool isSelected(const char* name) const;
+
+    void writeLevels();
+
+protected:
+
+    void writeValue(const char* name, const std::string& text, bool isString);
+
+public:
+
+    FilteredOutputWriter(std::unique_ptr<OutputWriter> _writer, OutputBuffer& out, const std::vector<std::string>& _fields);
+
+    void BeginDocument();
+
+    void EndDocument();
+
+    void BeginRecord();
+
+    void EndRecord();
+
+    void BeginObject(const char* name);
+
+    void EndObject();
+
+    void BeginArray(const char* name);
+
+    void EndArray();
+
+    void Field(const char* name, const std::vector<unsigned int>& values);
+
+};
+
+#endif /* OUTPUTWRITER_H */
@@ -0,0 +1,91 @@
+#ifndef OVCPLAN_H
+#define OVCPLAN_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "structs.h"
+
+/* Overdrive parameters compiled into flat per-adapter actions (struct of arrays).
+ * Actions of adapter A are [getActionsBegin(A), getActionsEnd(A)), in the order of
+ * the parameters. If several parameters set the same thing (type and level) for
+ * an adapter, only the last one is kept.
+ * The plan refers to the parameters for messages, so it must not outlive them. */
+class OVCPlan
+{
+
+private:
+
+    std::vector<int> adapterOffsets;
+
+    std::vector<OVCParamType> types;
+
+    std::vector<int> partIds;
+
+    std::vector<double> values;
+
+    std::vector<char> useDefaults;
+
+    std::vector<const OVCParameter*> sources;
+
+    void removeOverridden(int adaptersNum);
+
+public:
+
+    // reports parameters with adapter indices out of range to errors and sets failed
+    OVCPlan(const std::vector<OVCParameter>& params, int adaptersNum, std::ostream& errors, bool& failed);
+
+    int getAdaptersNum() const
+    {
+        return adapterOffsets.size() - 1;
+    }
+
+    int getActionsBegin(int adapterIndex) const
+    {
+        return adapterOffsets[adapterIndex];
+    }
+
+    int getActionsEnd(int adapterIndex) const
+    {
+        return adapterOffsets[adapterIndex + 1];
+    }
+
+    bool hasActions(int adapterIndex) const
+    {
+        return adapterOffsets[adapterIndex] != adapterOffsets[adapterIndex + 1];
+    }
+
+    OVCParamType getType(int action) const
+    {
+        return types[action];
+    }
+
+    int getPartId(int action) const
+    {
+        return partIds[action];
+    }
+
+    double getValue(int action) const
+    {
+        return values[action];
+    }
+
+    bool isDefault(int action) const
+    {
+        return useDefaults[action] != 0;
+    }
+
+    const std::string& getText(int action) const
+    {
+        return sources[action]->text;
+    }
+
+    const std::string& getArgText(int action) const
+    {
+        return sources[action]->argText;
+    }
+
+};
+
+#endif /* OVCPLAN_H */
@@ -5,6 +5,8 @@
 #define LINUX 1
 #endif
 
+#include <string>
+
 #include "amdgpuadapterinfo.h"
 
 class PCIAccess
@@ -16,7 +18,7 @@ public:
 
     static void InitializePCIAccess();
 
-    static void GetFromPCI_AMDGPU(const char* rlink, AMDGPUAdapterInfo& adapterInfo);
+    static void GetFromPCI_AMDGPU(const std::string& slotName, AMDGPUAdapterInfo& adapterInfo);
 
     static void GetFromPCI(int deviceIndex, AdapterInfo& adapterInfo);
 
@@ -0,0 +1,86 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <string>
+#include <vector>
+
+#include "adapterslist.h"
+#include "structs.h"
+
+/* Overdrive profile file. Sections select adapters, entries are parameters
+ * without adapter list:
+ *
+ *   [all]                  every adapter
+ *   [device 0x67df]        adapters with this PCI device ID
+ *   [pci 01:00.0]          adapter at this PCI location (bus:device.function, hex)
+ *   [adapter 0-3,5]        adapters with these indices
+ *   coreclk = 1150
+ *   vcore:2 = 0.95
+ *   fanspeed = default
+ *
+ * If sections set the same parameter for an adapter, the more specific section wins
+ * (adapter > pci > device > all), then the later line. */
+class Profile
+{
+
+private:
+
+    enum class Selector
+    {
+        ALL,
+        DEVICE,
+        PCI,
+        ADAPTER
+    };
+
+    struct Section
+    {
+        Selector selector;
+        std::vector<int> adapters;
+        unsigned int domain;    // 0 if not given
+        unsigned int busNo;
+        unsigned int deviceNo;
+        unsigned int funcNo;
+        unsigned int deviceId;
+        int line;
+        std::string text;
+    };
+
+    struct Entry
+    {
+        size_t section;
+        OVCParameter param;
+        int line;
+    };
+
+    std::string filename;
+
+    std::vector<Section> sections;
+
+    std::vector<Entry> entries;
+
+    void parseSection(const std::string& text, int line);
+
+    void parseEntry(const std::string& text, int line);
+
+    bool matches(const Section& section, const AdapterIdentity& adapter) const;
+
+    std::string getLocation(int line) const;
+
+public:
+
+    bool IsLoaded() const
+    {
+        return !filename.empty();
+    }
+
+    // parses and validates the whole file, throws Error with file and line on first error
+    void Load(const char* filename);
+
+    /* resolves sections against the adapters and appends one parameter per adapter
+     * and setting to ovcParameters, grouped by adapter */
+    void Compile(const std::vector<AdapterIdentity>& adapters, std::vector<OVCParameter>& ovcParameters) const;
+
+};
+
+#endif /* PROFILE_H */
@@ -0,0 +1,64 @@
+#ifndef SETTINGSJOURNAL_H
+#define SETTINGSJOURNAL_H
+
+#include <csignal>
+#include <string>
+#include <vector>
+
+#include "amdgpuadapterhandle.h"
+
+/* Settings of adapters to restore when a job ends. The restore writes of every adapter
+ * are also kept in a journal file, locked while the job runs, so settings left by
+ * a killed wrapper are restored by the next job on that adapter. Journals are keyed by
+ * PCI slot and attributes by name, like in SettingsSnapshot, as card and hwmon indices
+ * can change after a reboot or a reset of adapter:
+ *
+ *   # amdcovc journal of adapter 0000:01:00.0
+ *   pp_sclk_od<TAB>0
+ *
+ * RestoreFromSignal only opens, writes and closes files, so it can be called
+ * from a signal handler. */
+class SettingsJournal
+{
+
+private:
+
+    struct Adapter
+    {
+        int index;
+        int fd;
+        std::string path;
+        std::vector<AMDGPUSysfsWrite> writes;
+    };
+
+    std::string directory;
+
+    std::vector<Adapter> adapters;
+
+    volatile sig_atomic_t restored;
+
+    static bool writeRaw(const AMDGPUSysfsWrite& write);
+
+    static std::string format(const AMDGPUAdapterHandle& handle, int adapterIndex, const std::vector<AMDGPUSysfsWrite>& writes);
+
+    // writes are attribute names and values
+    static void parse(const std::string& content, std::vector<AMDGPUSysfsWrite>& writes);
+
+public:
+
+    explicit SettingsJournal(const std::string& _directory);
+
+    ~SettingsJournal();
+
+    /* locks journal of adapter (throws Error if another job holds it), restores settings
+     * left by an interrupted job and records the current settings */
+    void Begin(const AMDGPUAdapterHandle& handle, int adapterIndex);
+
+    // restores settings of all adapters and removes journals, returns false if some write failed
+    bool Restore();
+
+    void RestoreFromSignal();
+
+};
+
+#endif /* SETTINGSJOURNAL_H */
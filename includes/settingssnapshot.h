@@ -0,0 +1,90 @@
+#ifndef SETTINGSSNAPSHOT_H
+#define SETTINGSSNAPSHOT_H
+
+#include <string>
+#include <vector>
+
+#include "amdgpuadapterhandle.h"
+
+/* Settings of adapters written by 'amdcovc save' and applied again by 'amdcovc restore',
+ * for example at boot. They are the writes of getRestoreWrites (Overdrive table, Overdrive
+ * percents, power cap, fans, power profile and performance level). Adapters are keyed
+ * by PCI slot and attributes by name, so the file survives changes of card and hwmon indices:
+ *
+ *   # amdcovc settings
+ *   [pci 0000:01:00.0]
+ *   pp_od_clk_voltage = s 7 1150 1100
+ *   pp_od_clk_voltage = c
+ *   pp_sclk_od = 0
+ *   power1_cap = 150000000
+ *   power_dpm_force_performance_level = auto
+ *
+ * A restore reads the current settings first and writes only the different ones. */
+class SettingsSnapshot
+{
+
+private:
+
+    struct Write
+    {
+        std::string name;   // of attribute, like pwm1_enable
+        std::string value;
+    };
+
+    struct Adapter
+    {
+        std::string slotName;
+        std::vector<Write> writes;
+        int line;
+    };
+
+    struct Result
+    {
+        int handleIndex;    // -1 if adapter is not present
+        unsigned int written;
+        unsigned int skipped;
+        std::vector<Write> writes;
+        std::string error;
+    };
+
+    std::string filename;
+
+    std::vector<Adapter> adapters;
+
+    std::string getLocation(int line) const;
+
+    static bool normalizeSlotName(const std::string& text, std::string& slotName);
+
+    static void getWrites(const AMDGPUAdapterHandle& handle, int adapterIndex, std::vector<Write>& writes);
+
+    static void getChangedWrites(const std::vector<Write>& current, const std::vector<Write>& saved, std::vector<Write>& writes);
+
+    static void apply(const AMDGPUAdapterHandle& handle, const Adapter& adapter, Result& result);
+
+public:
+
+    // current settings of these adapters
+    void Capture(const AMDGPUAdapterHandle& handle, const std::vector<int>& adapterIndices);
+
+    // throws Error with file and line on first error
+    void Load(const char* filename);
+
+    // writes whole file under temporary name and renames it
+    void Save(const char* filename) const;
+
+    /* applies settings of all adapters in parallel, prints results (and writes if verbose),
+     * returns false if some adapter is not present or some write failed */
+    bool Apply(const AMDGPUAdapterHandle& handle, bool verbose) const;
+
+    // true if adapters of all PCI slots are present
+    bool IsPresent(const AMDGPUAdapterHandle& handle) const;
+
+    // amdcovc save [OPTIONS] FILE
+    static int SaveMain(int argc, const char** argv);
+
+    // amdcovc restore [OPTIONS] FILE
+    static int RestoreMain(int argc, const char** argv);
+
+};
+
+#endif /* SETTINGSSNAPSHOT_H */
@@ -52,6 +52,13 @@ struct PerfClocks
     unsigned int memoryClock;
 };
 
+struct PowerCapRange
+{
+    unsigned int min;   // uW
+    unsigned int max;   // uW
+    bool isAvailable;
+};
+
 enum class OVCParamType
 {
     CORE_CLOCK,
@@ -59,7 +66,32 @@ enum class OVCParamType
     VDDC_VOLTAGE,
     FAN_SPEED,
     CORE_OD,
-    MEMORY_OD
+    MEMORY_OD,
+    POWER_CAP,
+    POWER_CONTROL,
+    POWER_PROFILE,
+    PERFORMANCE_LEVEL,
+    CORE_CLOCK_MASK,
+    MEMORY_CLOCK_MASK,
+    PCIE_MASK,
+    FAN_RPM
+};
+
+enum class DPMDomain
+{
+    CORE,
+    MEMORY,
+    PCIE
+};
+
+struct AdapterIdentity
+{
+    int index;
+    unsigned int domain;    // PCI domain, 0 if backend does not report it
+    unsigned int busNo;
+    unsigned int deviceNo;
+    unsigned int funcNo;
+    unsigned int deviceId;
 };
 
 struct OVCParameter
@@ -70,6 +102,7 @@ struct OVCParameter
     int partId;
     double value;
     bool useDefault;
+    std::string text;   // value of textual parameters (powerprofile, perflevel, state masks)
     std::string argText;
 };
 
@@ -0,0 +1,24 @@
+#ifndef SUBCOMMANDOPTIONS_H
+#define SUBCOMMANDOPTIONS_H
+
+#include <string>
+#include <vector>
+
+/* options of subcommands (tune, exec) */
+class SubcommandOptions
+{
+
+public:
+
+    // option given as '--name VALUE' or '--name=VALUE', throws Error if value is missing
+    static bool Get(const char** argv, int argc, int& i, const char* name, std::string& value);
+
+    // positive number, throws Error naming the option if invalid
+    static unsigned int ParseUnsigned(const std::string& value, const char* name);
+
+    // indices of adapters from list (all adapters if empty), throws Error if some index is out of range
+    static void GetAdapters(const std::string& list, int adaptersNum, std::vector<int>& adapters);
+
+};
+
+#endif /* SUBCOMMANDOPTIONS_H */
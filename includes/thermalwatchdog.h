@@ -0,0 +1,124 @@
+#ifndef THERMALWATCHDOG_H
+#define THERMALWATCHDOG_H
+
+#include <string>
+#include <vector>
+
+#include "outputbuffer.h"
+#include "watchdogbackend.h"
+
+/* reasons of emergency revert, combined as bits */
+enum WatchdogTrip
+{
+    WATCHDOG_TEMPERATURE = 1,   // some temperature reached its limit
+    WATCHDOG_FAN_STALL = 2      // fan does not spin although it is driven
+};
+
+enum class WatchdogEventType
+{
+    TRIPPED,            // reverted, or the first revert failed
+    RECOVERED,          // temperatures and fan are normal again
+    SAMPLE_FAILED,      // first failed sample, adapter is not watched until it can be read
+    SAMPLE_RESUMED      // adapter can be read again
+};
+
+struct WatchdogEvent
+{
+    WatchdogEventType type;
+    double time;                // seconds since the epoch
+    int adapterIndex;
+    unsigned int trips;         // WatchdogTrip bits
+    int channel;                // temperature at limit (1-3), 0 if none
+    double temperature;         // C
+    double limit;               // C
+    double fanRPM;
+    double fanDuty;             // percent
+    double reactionLatency;     // s, from start of detecting sample to end of revert
+    double faultLatency;        // s, from start of injected fault to end of revert, NaN if not known
+    unsigned int attempts;      // reverts including failed ones
+    std::string error;          // of revert or sample, empty if none
+};
+
+/* Samples temperatures and fan of adapters at short intervals and reverts an adapter
+ * (Overdrive to 0, fan to 100%) in the same pass as the sample that found a temperature
+ * at its limit (critical temperature minus margin, or a fixed limit) or a stalled fan:
+ * fan below stallRPM while its PWM duty is at least stallDuty for stallTime. Events are
+ * printed after all adapters are sampled, so printing does not delay a revert.
+ * The adapter is reverted once, until its temperatures and fan are normal again;
+ * a failed revert is tried again at every sample while the adapter trips.
+ * Failed samples are counted and reported when they start and end. */
+class ThermalWatchdog
+{
+
+private:
+
+    struct AdapterState
+    {
+        double limits[WatchdogTemperaturesNum];     // C, NaN if channel is not watched
+        bool tripped;           // reverted
+        double stallStart;      // s, negative if fan spins
+        unsigned int reverts;
+        unsigned int failedReverts;     // since the last successful revert
+        unsigned int failedSamples;
+        bool sampleFailing;
+    };
+
+    WatchdogBackend& backend;
+
+    double stallRPM;
+
+    double stallDuty;       // percent
+
+    double stallTime;       // s
+
+    double temperatureMargin;   // C
+
+    double temperatureLimit;    // C, 0 if critical temperatures are used
+
+    std::vector<AdapterState> adapters;     // by adapter index of backend
+
+    std::vector<double> latencies;  // of reverts, s
+
+    AdapterState& getAdapter(int adapterIndex);
+
+    unsigned int check(AdapterState& state, const WatchdogSample& sample, double time, WatchdogEvent& event) const;
+
+public:
+
+    // temperatureLimit replaces critical temperatures minus temperatureMargin if it is positive
+    ThermalWatchdog(WatchdogBackend& _backend, double _temperatureMargin, double _temperatureLimit, double _stallRPM,
+                    double _stallDuty, double _stallTime);
+
+    // reads limits of adapter again, after it appeared or was reset
+    void Refresh(int adapterIndex);
+
+    // samples adapter, reverts it at once if it trips, appends new events
+    void Update(int adapterIndex, std::vector<WatchdogEvent>& events);
+
+    // reaction latencies of all reverts in s
+    const std::vector<double>& GetLatencies() const
+    {
+        return latencies;
+    }
+
+    unsigned int GetReverts(int adapterIndex)
+    {
+        return getAdapter(adapterIndex).reverts;
+    }
+
+    unsigned int GetFailedSamples(int adapterIndex)
+    {
+        return getAdapter(adapterIndex).failedSamples;
+    }
+
+    // time of steady clock in s
+    static double GetTime();
+
+    static void WriteEvent(OutputBuffer& out, const WatchdogEvent& event);
+
+    // amdcovc watchdog [OPTIONS]
+    static int Main(int argc, const char** argv);
+
+};
+
+#endif /* THERMALWATCHDOG_H */
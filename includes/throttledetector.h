@@ -0,0 +1,116 @@
+#ifndef THROTTLEDETECTOR_H
+#define THROTTLEDETECTOR_H
+
+#include <string>
+#include <vector>
+
+#include "amdgpuadapterhandle.h"
+#include "outputbuffer.h"
+
+/* reasons of throttling, combined as bits */
+enum ThrottleReason
+{
+    THROTTLE_THERMAL = 1,   // temperature near temp1_crit
+    THROTTLE_POWER = 2,     // board power near power1_cap
+    THROTTLE_UNKNOWN = 4    // neither of them, for example current or VRM limits
+};
+
+/* state of adapter read by the detector */
+struct ThrottleSample
+{
+    unsigned int coreClock;         // MHz, active state of pp_dpm_sclk
+    unsigned int coreTarget;        // MHz, the highest allowed state of pp_dpm_sclk, 0 if not known
+    unsigned int memoryClock;       // MHz, active state of pp_dpm_mclk
+    unsigned int memoryTarget;      // MHz, the highest allowed state of pp_dpm_mclk, 0 if not known
+    int load;                       // percent, -1 if not available
+    double temperature;             // C, NaN if not available
+    double criticalTemperature;     // C, NaN if not available
+    double power;                   // W, negative if not available
+    double powerCap;                // W, negative if not available
+};
+
+struct ThrottleEvent
+{
+    double time;            // seconds since the epoch
+    int adapterIndex;
+    DPMDomain domain;       // CORE or MEMORY
+    bool throttled;         // false if throttling ended
+    unsigned int reasons;   // ThrottleReason bits
+    unsigned int clock;     // MHz
+    unsigned int target;    // MHz
+    double temperature;
+    double criticalTemperature;
+    double power;
+    double powerCap;
+    double duration;        // s, time of throttling when it ended
+};
+
+/* Compares the active DPM states with the highest ones (set by coreclk and memclk).
+ * A busy adapter (load at least loadThreshold, or unknown load) running below the
+ * highest state is throttled. The reasons are correlated with the temperature against
+ * temp1_crit and with the board power against power1_cap. Events are emitted when
+ * throttling starts, when its reasons change and when it ends. Adapters are followed
+ * through DeviceRegistry, so they can disappear and appear again while watched. */
+class ThrottleDetector
+{
+
+private:
+
+    struct DomainState
+    {
+        bool throttled;
+        unsigned int reasons;
+        double startTime;
+        double throttledTime;   // s, total
+    };
+
+    struct AdapterState
+    {
+        int adapterIndex;
+        DomainState core;
+        DomainState memory;
+        double lastTime;
+    };
+
+    double temperatureMargin;   // C
+
+    double powerMargin;         // fraction of power cap
+
+    int loadThreshold;          // percent
+
+    std::vector<AdapterState> adapters;
+
+    AdapterState& getAdapter(int adapterIndex);
+
+    void updateDomain(DomainState& state, int adapterIndex, DPMDomain domain, unsigned int clock, unsigned int target,
+                      const ThrottleSample& sample, double time, double interval, std::vector<ThrottleEvent>& events) const;
+
+public:
+
+    ThrottleDetector(double _temperatureMargin, double _powerMargin, int _loadThreshold);
+
+    // reasons of throttling at this sample
+    unsigned int GetReasons(const ThrottleSample& sample) const;
+
+    // compares sample with the previous state of adapter, appends new events
+    void Update(int adapterIndex, const ThrottleSample& sample, double time, std::vector<ThrottleEvent>& events);
+
+    // adapter was not sampled (failed sample, removed or reset), time until its next sample is not counted
+    void Skip(int adapterIndex);
+
+    // total time of throttling in s
+    double GetThrottledTime(int adapterIndex, DPMDomain domain);
+
+    static void ReadSample(const AMDGPUAdapterHandle& handle, int adapterIndex, ThrottleSample& sample);
+
+    // local time with milliseconds of time in s since the epoch
+    static void WriteTime(OutputBuffer& out, double time);
+
+    static void WriteEvent(OutputBuffer& out, const ThrottleEvent& event);
+
+    // amdcovc throttle [OPTIONS]
+    static int Main(int argc, const char** argv);
+
+};
+
+#endif /* THROTTLEDETECTOR_H */
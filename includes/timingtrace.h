@@ -0,0 +1,104 @@
+#ifndef TIMINGTRACE_H
+#define TIMINGTRACE_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class TimingTrace
+{
+
+private:
+
+    struct Event
+    {
+        const char* category;
+        std::string name;
+        int64_t start;
+        int64_t duration;
+        unsigned int threadId;
+    };
+
+    static bool enabled;
+
+    static std::string outputFile;
+
+    static std::vector<Event> events;
+
+    static std::mutex eventsMutex;
+
+    static std::chrono::steady_clock::time_point origin;
+
+    static unsigned int getThreadId();
+
+    static void record(const char* category, std::string& name, std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end);
+
+    static void writeChromeTrace();
+
+    static void printSummary();
+
+public:
+
+    class Span
+    {
+
+    private:
+
+        const char* category;
+
+        std::string name;
+
+        std::chrono::steady_clock::time_point start;
+
+        bool active;
+
+    public:
+
+        Span(const char* _category, const char* _name) : category(_category), active(enabled)
+        {
+            if (active)
+            {
+                name = _name;
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        Span(const char* _category, const char* _name, const char* detail) : category(_category), active(enabled)
+        {
+            if (active)
+            {
+                name = _name;
+                name += ' ';
+                name += detail;
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~Span()
+        {
+            if (active)
+            {
+                record(category, name, start, std::chrono::steady_clock::now());
+            }
+        }
+
+        Span(const Span&) = delete;
+
+        Span& operator=(const Span&) = delete;
+    };
+
+    static void Enable(const char* OutputFile);
+
+    static bool IsEnabled()
+    {
+        return enabled;
+    }
+
+    static void Finish();
+
+};
+
+#endif /* TIMINGTRACE_H */
@@ -0,0 +1,119 @@
+#ifndef TUNEBACKEND_H
+#define TUNEBACKEND_H
+
+#include <mutex>
+#include <vector>
+
+#include "amdgpuadapterhandle.h"
+#include "structs.h"
+
+/* settings of adapter tried by the tuner, 0 means not set */
+struct TunePoint
+{
+    double coreClock;   // MHz
+    double memoryClock; // MHz
+    double voltage;     // V
+    double powerCap;    // W
+};
+
+/* current settings of adapter and limits of the tuned settings, 0 if unknown or not settable */
+struct TuneRanges
+{
+    TunePoint current;
+    double coreClockMin;
+    double coreClockMax;
+    double memoryClockMin;
+    double memoryClockMax;
+    double voltageMin;
+    double voltageMax;
+    double powerCapMin;
+    double powerCapMax;
+};
+
+/* adapters seen by the tuner: the AMDGPU driver or a simulation */
+class TuneBackend
+{
+
+public:
+
+    virtual ~TuneBackend()
+    {}
+
+    virtual int getAdaptersNum() const = 0;
+
+    virtual void getIdentity(int adapterIndex, AdapterIdentity& identity) const = 0;
+
+    virtual void getRanges(int adapterIndex, TuneRanges& ranges) = 0;
+
+    virtual void apply(int adapterIndex, const TunePoint& point) = 0;
+
+    // board power in W (negative if not available) and temperature in C, called from sampling thread
+    virtual void sample(int adapterIndex, double& power, double& temperature) = 0;
+
+};
+
+/* settings are applied through AmdGpuProOvc, like parameters of the command line */
+class AMDGPUTuneBackend: public TuneBackend
+{
+
+private:
+
+    AMDGPUAdapterHandle handle;
+
+public:
+
+    int getAdaptersNum() const;
+
+    void getIdentity(int adapterIndex, AdapterIdentity& identity) const;
+
+    void getRanges(int adapterIndex, TuneRanges& ranges);
+
+    void apply(int adapterIndex, const TunePoint& point);
+
+    void sample(int adapterIndex, double& power, double& temperature);
+
+};
+
+/* Simple model of adapters to test the search loop without hardware. Throughput grows with
+ * the core and memory clocks, power with the core clock and the square of the voltage.
+ * A core clock needs a minimal voltage (different for every adapter), otherwise the benchmark
+ * fails, and the power cap throttles the core clock. */
+class SimulatedTuneBackend: public TuneBackend
+{
+
+private:
+
+    struct Adapter
+    {
+        TunePoint point;
+        double voltageOffset;
+    };
+
+    mutable std::mutex mutex;
+
+    std::vector<Adapter> adapters;
+
+    double getEffectiveCoreClock(const Adapter& adapter) const;
+
+    double getPower(const Adapter& adapter, double coreClock) const;
+
+public:
+
+    explicit SimulatedTuneBackend(int adaptersNum);
+
+    int getAdaptersNum() const;
+
+    void getIdentity(int adapterIndex, AdapterIdentity& identity) const;
+
+    void getRanges(int adapterIndex, TuneRanges& ranges);
+
+    void apply(int adapterIndex, const TunePoint& point);
+
+    void sample(int adapterIndex, double& power, double& temperature);
+
+    // throughput of benchmark at current settings, false if adapter is unstable
+    bool getThroughput(int adapterIndex, double& throughput) const;
+
+};
+
+#endif /* TUNEBACKEND_H */
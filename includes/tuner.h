@@ -0,0 +1,67 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "outputbuffer.h"
+#include "tunebackend.h"
+
+struct TuneResult
+{
+    TunePoint point;
+    double metric;
+    double power;       // average board power in W, negative if not available
+    double temperature; // maximal temperature in C
+    bool stable;
+};
+
+/* Grid search of settings for the best performance per watt. For every adapter the core
+ * and memory clocks are swept around the current clocks together with the voltage (or
+ * the power cap if voltages are not settable). At every point the benchmark runs while
+ * a thread samples power and temperature. Settings of adapter are restored after tuning,
+ * or after the benchmark was killed by a stopping signal (Main exits then with 128 + signal). */
+class Tuner
+{
+
+private:
+
+    TuneBackend& backend;
+
+    Benchmark& benchmark;
+
+    unsigned int steps;
+
+    unsigned int sampleInterval;   // ms
+
+    bool verbose;
+
+    void measure(int adapterIndex, const TunePoint& point, TuneResult& result);
+
+    static void getValues(double current, double low, double high, double rangeMin, double rangeMax,
+                          unsigned int steps, double unit, std::vector<double>& values);
+
+    static void writeResult(OutputBuffer& out, const TuneResult& result);
+
+public:
+
+    Tuner(TuneBackend& _backend, Benchmark& _benchmark, unsigned int _steps, unsigned int _sampleInterval, bool _verbose);
+
+    static void GetGrid(const TuneRanges& ranges, unsigned int steps, std::vector<TunePoint>& points);
+
+    // stable results not beaten by another one in both metric and power, ordered by power
+    static void GetParetoFront(const std::vector<TuneResult>& results, std::vector<TuneResult>& front);
+
+    // result of front with the highest metric per watt (highest metric if power is unknown)
+    static const TuneResult& GetBest(const std::vector<TuneResult>& front);
+
+    // returns false if no setting was stable
+    bool Tune(int adapterIndex, std::vector<TuneResult>& front);
+
+    // amdcovc tune [OPTIONS]
+    static int Main(int argc, const char** argv);
+
+};
+
+#endif /* TUNER_H */
@@ -0,0 +1,158 @@
+#ifndef WATCHDOGBACKEND_H
+#define WATCHDOGBACKEND_H
+
+#include <cmath>
+#include <vector>
+
+#include "amdgpuadapterhandle.h"
+#include "deviceregistry.h"
+
+// temp1-temp3 of hwmon: edge, junction and memory
+const int WatchdogTemperaturesNum = 3;
+
+/* state of adapter read by the watchdog, NaN if not available */
+struct WatchdogSample
+{
+    double temperatures[WatchdogTemperaturesNum];   // C
+    double fanRPM;
+    double fanDuty;     // percent of PWM range
+};
+
+enum class WatchdogFault
+{
+    FAN_STALL,          // fan stops, temperature rises slowly
+    OVERHEAT,           // temperature jumps by 30 C
+    SENSOR_FAILURE,     // samples fail for 0.5 s
+    REVERT_FAILURE      // reverts fail for 0.5 s
+};
+
+/* adapters seen by the watchdog: the AMDGPU driver or a simulation */
+class WatchdogBackend
+{
+
+public:
+
+    virtual ~WatchdogBackend()
+    {}
+
+    // adapter ids, including adapters that were removed
+    virtual int getAdaptersNum() const = 0;
+
+    // critical temperatures of temp1-temp3 in C, NaN if not available
+    virtual void getCriticalTemperatures(int adapterIndex, double* temperatures) const = 0;
+
+    // throws if adapter can not be read (for example it is not present)
+    virtual void sample(int adapterIndex, WatchdogSample& sample) = 0;
+
+    // core and memory Overdrive to 0, fan to 100%, throws Error if some step failed
+    virtual void revert(int adapterIndex) = 0;
+
+    // time (s of steady clock) when injected fault started, NaN if none
+    virtual double getFaultTime(int adapterIndex) const
+    {
+        return NAN;
+    }
+
+    // waits up to timeout ms, appends adapters that appeared, were removed or reset
+    virtual void wait(unsigned int timeout, std::vector<DeviceEvent>& events);
+
+};
+
+/* reverts through setOverdriveCoreParam, setOverdriveMemoryParam and setFanSpeed
+ * of AMDGPUAdapterHandle, only attributes found when adapter appeared are written.
+ * Adapters are followed through DeviceRegistry, indices are its adapter ids. */
+class AMDGPUWatchdogBackend: public WatchdogBackend
+{
+
+private:
+
+    struct Adapter
+    {
+        bool coreOD;        // pp_sclk_od
+        bool memoryOD;      // pp_mclk_od
+        bool odTable;       // pp_od_clk_voltage
+        bool fan;           // pwm1
+        double minPWM;
+        double maxPWM;
+    };
+
+    AMDGPUAdapterHandle handle;
+
+    DeviceRegistry registry;
+
+    std::vector<Adapter> adapters;  // by adapter id
+
+    std::vector<double> values;     // reused by sample
+
+    // throws Error if adapter is not present
+    int getHandleIndex(int adapterId) const;
+
+    void probe(int adapterId);
+
+public:
+
+    AMDGPUWatchdogBackend();
+
+    int getAdaptersNum() const;
+
+    void getCriticalTemperatures(int adapterIndex, double* temperatures) const;
+
+    void sample(int adapterIndex, WatchdogSample& sample);
+
+    void revert(int adapterIndex);
+
+    void wait(unsigned int timeout, std::vector<DeviceEvent>& events);
+
+};
+
+/* Adapters running with aggressive Overdrive, approaching their target temperature
+ * exponentially. Faults injected at given times heat them up, a revert lowers the
+ * target by the Overdrive and the fan at 100% (if the fan is not stalled). Sensor
+ * and revert failures make sample and revert throw for a while. */
+class SimulatedWatchdogBackend: public WatchdogBackend
+{
+
+private:
+
+    struct Adapter
+    {
+        double temperature;
+        double coreOD;          // percent
+        double fanDuty;         // percent
+        double lastTime;
+        double stallTime;       // s since start, NaN if not injected
+        double overheatTime;
+        double sensorFailureTime;
+        double revertFailureTime;
+    };
+
+    double startTime;
+
+    std::vector<Adapter> adapters;
+
+    static double getTime();
+
+    bool isFailing(double failureTime, double time) const;
+
+    void update(Adapter& adapter, double time) const;
+
+public:
+
+    explicit SimulatedWatchdogBackend(int adaptersNum);
+
+    int getAdaptersNum() const;
+
+    void getCriticalTemperatures(int adapterIndex, double* temperatures) const;
+
+    void sample(int adapterIndex, WatchdogSample& sample);
+
+    void revert(int adapterIndex);
+
+    double getFaultTime(int adapterIndex) const;
+
+    // fault starts delay s after creation of backend
+    void injectFault(int adapterIndex, WatchdogFault fault, double delay);
+
+};
+
+#endif /* WATCHDOGBACKEND_H */
@@ -0,0 +1,408 @@
+#include "adladaptertable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "catalystcrimsonadapters.h"
+#include "error.h"
+#include "pciaccess.h"
+
+ADLAdapterTable::ADLAdapterTable(ADLMainControl& _mainControl) : mainControl(_mainControl)
+{
+    TimingTrace::Span span("startup", "ADL adapter table");
+
+    const int adaptersNum = mainControl.getAdaptersNum();
+
+    std::unique_ptr<AdapterInfo[]> adapterInfos(new AdapterInfo[adaptersNum]);
+    ::memset(adapterInfos.get(), 0, sizeof(AdapterInfo) * adaptersNum);
+    mainControl.getAdapterInfo(adaptersNum, adapterInfos.get());
+
+    for (int ai = 0; ai < adaptersNum; ai++)
+    {
+        const AdapterInfo& adapterInfo = adapterInfos[ai];
+        bool found = false;
+
+        // activity is checked only for the PCI locations without active adapter
+        for (const Adapter& adapter: adapters)
+        {
+            if (adapter.info.iBusNumber == adapterInfo.iBusNumber && adapter.info.iDeviceNumber == adapterInfo.iDeviceNumber &&
+                adapter.info.iFunctionNumber == adapterInfo.iFunctionNumber)
+            {
+                found = true;
+                break;
+            }
+        }
+
+        if (found || !mainControl.isAdapterActive(ai))
+        {
+            continue;
+        }
+
+        Adapter adapter;
+        adapter.adlIndex = ai;
+        adapter.info = adapterInfo;
+        adapter.odParametersRead = false;
+        adapter.odVersion = 0;
+
+        if (adapter.info.strAdapterName[0] == 0)
+        {
+            PCIAccess::GetFromPCI(adapter.info.iAdapterIndex, adapter.info);
+        }
+
+        adapters.push_back(adapter);
+    }
+
+    /* the driver numbers /dev/ati/cardN in the order it probes the GPUs, which is
+     * the order of PCI locations, not the order of the ADL adapter list */
+    for (const Adapter& adapter: adapters)
+    {
+        int card = 0;
+
+        for (const Adapter& other: adapters)
+        {
+            card += isBeforeInPCI(other.info, adapter.info) ? 1 : 0;
+        }
+
+        mainControl.setAdapterCard(adapter.adlIndex, card);
+    }
+}
+
+bool ADLAdapterTable::isBeforeInPCI(const AdapterInfo& info1, const AdapterInfo& info2)
+{
+    if (info1.iBusNumber != info2.iBusNumber)
+    {
+        return info1.iBusNumber < info2.iBusNumber;
+    }
+
+    if (info1.iDeviceNumber != info2.iDeviceNumber)
+    {
+        return info1.iDeviceNumber < info2.iDeviceNumber;
+    }
+
+    return info1.iFunctionNumber < info2.iFunctionNumber;
+}
+
+ADLAdapterTable::Adapter& ADLAdapterTable::getODAdapter(int index)
+{
+    Adapter& adapter = adapters[index];
+
+    if (!adapter.odParametersRead)
+    {
+        ::memset(&adapter.odParameters, 0, sizeof(adapter.odParameters));
+        adapter.powerControlSupported = false;
+        adapter.powerControlRange = ADLODParameterRange{ 0, 0, 0 };
+        adapter.defaultPowerControl = 0;
+        adapter.coreLevelsNum = adapter.memoryLevelsNum = 0;
+        adapter.odVersion = mainControl.getODVersion(adapter.adlIndex);
+
+        switch(adapter.odVersion)
+        {
+            case 5:
+
+                mainControl.getODParameters(adapter.adlIndex, adapter.odParameters);
+                break;
+
+            case 6:
+
+                readOD6Parameters(adapter);
+                break;
+
+            case 7:
+
+                readODNParameters(adapter);
+                break;
+
+            default:
+
+                break;
+        }
+
+        adapter.coreLevelsNum = std::min(adapter.coreLevelsNum, adapter.odParameters.iNumberOfPerformanceLevels);
+        adapter.memoryLevelsNum = std::min(adapter.memoryLevelsNum, adapter.odParameters.iNumberOfPerformanceLevels);
+
+        if (adapter.odVersion == 5)
+        {
+            adapter.coreLevelsNum = adapter.memoryLevelsNum = adapter.odParameters.iNumberOfPerformanceLevels;
+        }
+
+        adapter.odParametersRead = true;
+    }
+
+    return adapter;
+}
+
+void ADLAdapterTable::readOD6Parameters(Adapter& adapter)
+{
+    ADLOD6Capabilities caps;
+    ::memset(&caps, 0, sizeof(caps));
+    mainControl.getOD6Capabilities(adapter.adlIndex, caps);
+
+    ADLODParameters& odParams = adapter.odParameters;
+    odParams.iSize = sizeof(ADLODParameters);
+    odParams.iNumberOfPerformanceLevels = 2;
+    odParams.iActivityReportingSupported = (caps.iCapabilities & ADL_OD6_CAPABILITY_GPU_ACTIVITY_MONITOR) != 0;
+
+    if ((caps.iCapabilities & ADL_OD6_CAPABILITY_SCLK_CUSTOMIZATION) != 0)
+    {
+        odParams.sEngineClock = ADLODParameterRange{ caps.sEngineClockRange.iMin, caps.sEngineClockRange.iMax,
+            caps.sEngineClockRange.iStep };
+    }
+
+    if ((caps.iCapabilities & ADL_OD6_CAPABILITY_MCLK_CUSTOMIZATION) != 0)
+    {
+        odParams.sMemoryClock = ADLODParameterRange{ caps.sMemoryClockRange.iMin, caps.sMemoryClockRange.iMax,
+            caps.sMemoryClockRange.iStep };
+    }
+
+    adapter.coreLevelsNum = adapter.memoryLevelsNum = 2;
+
+    if ((caps.iCapabilities & ADL_OD6_CAPABILITY_POWER_CONTROL) != 0)
+    {
+        ADLOD6PowerControlInfo info;
+        ::memset(&info, 0, sizeof(info));
+        mainControl.getOD6PowerControlInfo(adapter.adlIndex, info);
+
+        adapter.powerControlSupported = true;
+        adapter.powerControlRange = ADLODParameterRange{ info.iMinValue, info.iMaxValue, info.iStepValue };
+        mainControl.getOD6PowerControl(adapter.adlIndex, adapter.defaultPowerControl);
+    }
+}
+
+void ADLAdapterTable::readODNParameters(Adapter& adapter)
+{
+    ADLODNCapabilities caps;
+    ::memset(&caps, 0, sizeof(caps));
+    mainControl.getODNCapabilities(adapter.adlIndex, caps);
+
+    // numbers of levels are known only after reading them
+    std::vector<ADLODNPerformanceLevel> levels;
+    mainControl.getODNPerformanceLevels(adapter.adlIndex, false, true, caps.iMaximumNumberOfPerformanceLevels, levels);
+    adapter.coreLevelsNum = levels.size();
+    mainControl.getODNPerformanceLevels(adapter.adlIndex, true, true, caps.iMaximumNumberOfPerformanceLevels, levels);
+    adapter.memoryLevelsNum = levels.size();
+
+    ADLODParameters& odParams = adapter.odParameters;
+    odParams.iSize = sizeof(ADLODParameters);
+    odParams.iNumberOfPerformanceLevels = std::max(adapter.coreLevelsNum, adapter.memoryLevelsNum);
+    odParams.iActivityReportingSupported = 1;
+    odParams.sEngineClock = ADLODParameterRange{ caps.sEngineClockRange.iMin, caps.sEngineClockRange.iMax,
+        caps.sEngineClockRange.iStep };
+    odParams.sMemoryClock = ADLODParameterRange{ caps.sMemoryClockRange.iMin, caps.sMemoryClockRange.iMax,
+        caps.sMemoryClockRange.iStep };
+    odParams.sVddc = ADLODParameterRange{ caps.svddcRange.iMin, caps.svddcRange.iMax, caps.svddcRange.iStep };
+
+    if (caps.power.iMax != 0)
+    {
+        adapter.powerControlSupported = true;
+        adapter.powerControlRange = ADLODParameterRange{ caps.power.iMin, caps.power.iMax, caps.power.iStep };
+        adapter.defaultPowerControl = caps.power.iDefault;
+    }
+}
+
+void ADLAdapterTable::readPerfLevels(const Adapter& adapter, bool isDefault, std::vector<ADLODPerformanceLevel>& perfLevels)
+{
+    const int levelsNum = adapter.odParameters.iNumberOfPerformanceLevels;
+
+    perfLevels.assign(levelsNum, ADLODPerformanceLevel{ 0, 0, 0 });
+
+    if (levelsNum == 0)
+    {
+        return;
+    }
+
+    switch(adapter.odVersion)
+    {
+        case 5:
+
+            mainControl.getODPerformanceLevels(adapter.adlIndex, isDefault, levelsNum, perfLevels.data());
+            break;
+
+        case 6:
+        {
+            ADLOD6PerformanceLevel od6Levels[2];
+            mainControl.getOD6PerformanceLevels(adapter.adlIndex, isDefault, od6Levels);
+
+            for (int j = 0; j < 2; j++)
+            {
+                perfLevels[j].iEngineClock = od6Levels[j].iEngineClock;
+                perfLevels[j].iMemoryClock = od6Levels[j].iMemoryClock;
+            }
+            break;
+        }
+
+        case 7:
+        {
+            std::vector<ADLODNPerformanceLevel> coreLevels, memoryLevels;
+            mainControl.getODNPerformanceLevels(adapter.adlIndex, false, isDefault, adapter.coreLevelsNum, coreLevels);
+            mainControl.getODNPerformanceLevels(adapter.adlIndex, true, isDefault, adapter.memoryLevelsNum, memoryLevels);
+
+            for (int j = 0; j < levelsNum; j++)
+            {
+                if (!coreLevels.empty())
+                {
+                    const ADLODNPerformanceLevel& level = coreLevels[std::min(j, int(coreLevels.size()) - 1)];
+                    perfLevels[j].iEngineClock = level.iClock;
+                    perfLevels[j].iVddc = level.iVddc;
+                }
+
+                if (!memoryLevels.empty())
+                {
+                    perfLevels[j].iMemoryClock = memoryLevels[std::min(j, int(memoryLevels.size()) - 1)].iClock;
+                }
+            }
+            break;
+        }
+
+        default:
+
+            break;
+    }
+}
+
+const ADLODParameters& ADLAdapterTable::getODParameters(int index)
+{
+    return getODAdapter(index).odParameters;
+}
+
+const std::vector<ADLODPerformanceLevel>& ADLAdapterTable::getDefaultPerfLevels(int index)
+{
+    Adapter& adapter = getODAdapter(index);
+
+    if (adapter.defaultPerfLevels.empty())
+    {
+        readPerfLevels(adapter, true, adapter.defaultPerfLevels);
+    }
+
+    return adapter.defaultPerfLevels;
+}
+
+void ADLAdapterTable::getPerfLevels(int index, std::vector<ADLODPerformanceLevel>& perfLevels)
+{
+    readPerfLevels(getODAdapter(index), false, perfLevels);
+}
+
+/* changes only domains which differ from the current levels */
+static bool mergeODNLevels(std::vector<ADLODNPerformanceLevel>& levels, const std::vector<ADLODPerformanceLevel>& perfLevels,
+                           bool memory)
+{
+    bool changed = false;
+
+    for (size_t j = 0; j < levels.size() && j < perfLevels.size(); j++)
+    {
+        ADLODNPerformanceLevel& level = levels[j];
+        const int clock = memory ? perfLevels[j].iMemoryClock : perfLevels[j].iEngineClock;
+
+        if (level.iClock != clock || (!memory && level.iVddc != perfLevels[j].iVddc))
+        {
+            level.iClock = clock;
+            level.iVddc = memory ? level.iVddc : perfLevels[j].iVddc;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+void ADLAdapterTable::setPerfLevels(int index, const std::vector<ADLODPerformanceLevel>& perfLevels)
+{
+    const Adapter& adapter = getODAdapter(index);
+
+    switch(adapter.odVersion)
+    {
+        case 5:
+
+            mainControl.setODPerformanceLevels(adapter.adlIndex, perfLevels.size(), const_cast<ADLODPerformanceLevel*>(perfLevels.data()));
+            break;
+
+        case 6:
+        {
+            ADLOD6PerformanceLevel od6Levels[2];
+
+            for (int j = 0; j < 2; j++)
+            {
+                od6Levels[j].iEngineClock = perfLevels[j].iEngineClock;
+                od6Levels[j].iMemoryClock = perfLevels[j].iMemoryClock;
+            }
+
+            mainControl.setOD6PerformanceLevels(adapter.adlIndex, od6Levels);
+            break;
+        }
+
+        case 7:
+        {
+            std::vector<ADLODNPerformanceLevel> levels;
+
+            mainControl.getODNPerformanceLevels(adapter.adlIndex, false, false, adapter.coreLevelsNum, levels);
+
+            if (mergeODNLevels(levels, perfLevels, false))
+            {
+                mainControl.setODNPerformanceLevels(adapter.adlIndex, false, levels);
+            }
+
+            mainControl.getODNPerformanceLevels(adapter.adlIndex, true, false, adapter.memoryLevelsNum, levels);
+
+            if (mergeODNLevels(levels, perfLevels, true))
+            {
+                mainControl.setODNPerformanceLevels(adapter.adlIndex, true, levels);
+            }
+            break;
+        }
+
+        default:
+
+            throw Error("Overdrive is not supported by adapter!");
+    }
+}
+
+int ADLAdapterTable::getPowerControl(int index)
+{
+    const Adapter& adapter = getODAdapter(index);
+
+    if (!adapter.powerControlSupported)
+    {
+        return 0;
+    }
+
+    if (adapter.odVersion == 6)
+    {
+        int defaultValue = 0;
+        return mainControl.getOD6PowerControl(adapter.adlIndex, defaultValue);
+    }
+
+    return mainControl.getODNPowerLimit(adapter.adlIndex);
+}
+
+void ADLAdapterTable::setPowerControl(int index, int value)
+{
+    const Adapter& adapter = getODAdapter(index);
+
+    if (!adapter.powerControlSupported)
+    {
+        throw Error("Power control is not supported by adapter!");
+    }
+
+    if (adapter.odVersion == 6)
+    {
+        mainControl.setOD6PowerControl(adapter.adlIndex, value);
+    }
+    else
+    {
+        mainControl.setODNPowerLimit(adapter.adlIndex, value);
+    }
+}
+
+void ADLAdapterTable::getIdentities(std::vector<AdapterIdentity>& identities) const
+{
+    identities.clear();
+
+    for (size_t i = 0; i < adapters.size(); i++)
+    {
+        const AdapterInfo& adapterInfo = adapters[i].info;
+
+        // ADL does not report PCI domains
+        identities.push_back(AdapterIdentity{ int(i), 0, (unsigned int)adapterInfo.iBusNumber,
+            (unsigned int)adapterInfo.iDeviceNumber, (unsigned int)adapterInfo.iFunctionNumber,
+            (unsigned int)CatalystCrimsonAdapters::ParseDeviceIdFromUDID(adapterInfo.strUDID) });
+    }
+}
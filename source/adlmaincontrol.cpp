@@ -1,5 +1,8 @@
 #include "adlmaincontrol.h"
 
+#include <algorithm>
+#include <cstring>
+
 // Memory allocation function
 void* __stdcall ADL_Main_Memory_Alloc (int iSize)
 {
@@ -17,10 +20,42 @@ void __stdcall ADL_Main_Memory_Free (void** lpBuffer)
     }
 }
 
+int ADLMainControl::openCard(int card)
+{
+    char devName[64];
+
+    snprintf(devName, 64, "/dev/ati/card%u", card);
+
+    errno = 0;
+    int fd = open(devName, O_RDWR);
+
+    if (fd == -1)
+    {
+        cl_uint platformsNum;
+
+        /// force initialization of devices
+        {
+            TimingTrace::Span clSpan("startup", "OpenCL platform init");
+            clGetPlatformIDs(0, nullptr, &platformsNum);
+        }
+        errno = 0;
+        fd = open(devName, O_RDWR);
+
+        if (fd == -1)
+        {
+            throw Error(errno, "Cannot open GPU device");
+        }
+    }
+
+    return fd;
+}
+
 ADLMainControl::ADLMainControl(const ATIADLHandle& _handle, int devId)
 
-try : handle(_handle), fd(-1), mainControlCreated(false), withX(true)
+try : handle(_handle), defaultCard(devId), currentCard(-1), mainControlCreated(false), withX(true)
 {
+    TimingTrace::Span span("startup", "ADL init");
+
     try
     {
         handle.Main_Control_Create(ADL_Main_Memory_Alloc, 0);
@@ -33,31 +68,16 @@ try : handle(_handle), fd(-1), mainControlCreated(false), withX(true)
         }
 
         withX = false;
-        char devName[64];
 
-        snprintf(devName, 64, "/dev/ati/card%u", devId);
-
-        errno = 0;
-        fd = open(devName, O_RDWR);
-
-        if (fd == -1)
-        {
-            cl_uint platformsNum;
-
-            /// force initialization of devices
-            clGetPlatformIDs(0, nullptr, &platformsNum);
-            errno = 0;
-            fd = open(devName, O_RDWR);
-
-            if (fd == -1)
-            {
-                throw Error(errno, "Cannot open GPU device");
-            }
-        }
+        const int fd = openCard(devId);
+        cardFds[devId] = fd;
 
         handle.ConsoleMode_FileDescriptor_Set(fd);
+        currentCard = devId;
         handle.Main_Control_Create(ADL_Main_Memory_Alloc, 0);
     }
+
+    mainControlCreated = true;
 }
 catch(...)
 {
@@ -66,9 +86,9 @@ catch(...)
         handle.Main_Control_Destroy();
     }
 
-    if (fd!=-1)
+    for (const auto& cardFd: cardFds)
     {
-        close(fd);
+        close(cardFd.second);
     }
 
     throw;
@@ -76,14 +96,74 @@ catch(...)
 
 ADLMainControl::~ADLMainControl()
 {
-    if (fd!=-1)
+    if (mainControlCreated)
+    {
+        try
+        {
+            handle.Main_Control_Destroy();
+        }
+        catch(const Error& error)
+        {
+            // nothing can be done while destroying
+        }
+    }
+
+    for (const auto& cardFd: cardFds)
+    {
+        close(cardFd.second);
+    }
+}
+
+ADLMainControl::CardLock::CardLock(const ADLMainControl& mainControl, int adapterIndex) : lock(mainControl.mutex)
+{
+    mainControl.selectCard(adapterIndex);
+}
+
+void ADLMainControl::selectCard(int adapterIndex) const
+{
+    if (withX)
+    {
+        return;
+    }
+
+    const auto adapterCard = adapterCards.find(adapterIndex);
+    const int card = (adapterCard != adapterCards.end()) ? adapterCard->second : defaultCard;
+
+    if (card == currentCard)
+    {
+        return;
+    }
+
+    auto cardFd = cardFds.find(card);
+
+    if (cardFd == cardFds.end())
     {
-        close(fd);
+        TimingTrace::Span span("startup", "ADL open card");
+        cardFd = cardFds.insert(std::make_pair(card, openCard(card))).first;
     }
+
+    handle.ConsoleMode_FileDescriptor_Set(cardFd->second);
+    currentCard = card;
+}
+
+void ADLMainControl::setAdapterCard(int adapterIndex, int card)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    adapterCards[adapterIndex] = card;
+}
+
+int ADLMainControl::getOpenedCardsNum() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return cardFds.size();
 }
 
 int ADLMainControl::getAdaptersNum() const
 {
+    const CardLock lock(*this, -1);
+
     int num = 0;
 
     handle.Adapter_NumberOfAdapters_Get(&num);
@@ -93,6 +173,8 @@ int ADLMainControl::getAdaptersNum() const
 
 bool ADLMainControl::isAdapterActive(int adapterIndex) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     if (!withX)
     {
         return true;
@@ -105,27 +187,30 @@ bool ADLMainControl::isAdapterActive(int adapterIndex) const
     return status == ADL_TRUE;
 }
 
-void ADLMainControl::getAdapterInfo(AdapterInfo* infos) const
+void ADLMainControl::getAdapterInfo(int adaptersNum, AdapterInfo* infos) const
 {
-    int num;
-    handle.Adapter_NumberOfAdapters_Get(&num);
+    const CardLock lock(*this, -1);
 
-    for (int i = 0; i < num; i++)
+    for (int i = 0; i < adaptersNum; i++)
     {
         infos[i].iSize = sizeof(AdapterInfo);
     }
 
-    handle.Adapter_Info_Get(infos, num*sizeof(AdapterInfo));
+    handle.Adapter_Info_Get(infos, adaptersNum*sizeof(AdapterInfo));
 }
 
 void ADLMainControl::getCurrentActivity(int adapterIndex, ADLPMActivity& activity) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     activity.iSize = sizeof(ADLPMActivity);
     handle.Overdrive5_CurrentActivity_Get(adapterIndex, &activity);
 }
 
 int ADLMainControl::getTemperature(int adapterIndex, int thermalCtrlIndex) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     ADLTemperature temp;
     temp.iSize = sizeof(ADLTemperature);
     handle.Overdrive5_Temperature_Get(adapterIndex, thermalCtrlIndex, &temp);
@@ -135,12 +220,16 @@ int ADLMainControl::getTemperature(int adapterIndex, int thermalCtrlIndex) const
 
 void ADLMainControl::getFanSpeedInfo(int adapterIndex, int thermalCtrlIndex, ADLFanSpeedInfo& info) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     info.iSize = sizeof(ADLFanSpeedInfo);
     handle.Overdrive5_FanSpeedInfo_Get(adapterIndex, thermalCtrlIndex, &info);
 }
 
 int ADLMainControl::getFanSpeed(int adapterIndex, int thermalCtrlIndex) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     ADLFanSpeedValue fanSpeedValue;
     fanSpeedValue.iSpeedType = ADL_DL_FANCTRL_SPEED_TYPE_PERCENT;
     fanSpeedValue.iFlags = 0;
@@ -153,12 +242,16 @@ int ADLMainControl::getFanSpeed(int adapterIndex, int thermalCtrlIndex) const
 
 void ADLMainControl::getODParameters(int adapterIndex, ADLODParameters& odParameters) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     odParameters.iSize = sizeof(ADLODParameters);
     handle.Overdrive5_ODParameters_Get(adapterIndex, &odParameters);
 }
 
 void ADLMainControl::getODPerformanceLevels(int adapterIndex, bool isDefault, int perfLevelsNum, ADLODPerformanceLevel* perfLevels) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     const size_t odPLBufSize = sizeof(ADLODPerformanceLevels) + sizeof(ADLODPerformanceLevel)*(perfLevelsNum - 1);
     std::unique_ptr<char[]> odPlBuf(new char[odPLBufSize]);
 
@@ -172,6 +265,8 @@ void ADLMainControl::getODPerformanceLevels(int adapterIndex, bool isDefault, in
 
 void ADLMainControl::setFanSpeed(int adapterIndex, int thermalCtrlIndex, int fanSpeed) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     ADLFanSpeedValue fanSpeedValue;
     fanSpeedValue.iSize = sizeof(ADLFanSpeedValue);
     fanSpeedValue.iSpeedType = ADL_DL_FANCTRL_SPEED_TYPE_PERCENT;
@@ -182,11 +277,15 @@ void ADLMainControl::setFanSpeed(int adapterIndex, int thermalCtrlIndex, int fan
 
 void ADLMainControl::setFanSpeedToDefault(int adapterIndex, int thermalCtrlIndex) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     handle.Overdrive5_FanSpeedToDefault_Set(adapterIndex, thermalCtrlIndex);
 }
 
 void ADLMainControl::setODPerformanceLevels(int adapterIndex, int perfLevelsNum, ADLODPerformanceLevel* perfLevels) const
 {
+    const CardLock lock(*this, adapterIndex);
+
     const size_t odPLBufSize = sizeof(ADLODPerformanceLevels) + sizeof(ADLODPerformanceLevel) * (perfLevelsNum - 1);
     std::unique_ptr<char[]> odPlBuf(new char[odPLBufSize]);
 
@@ -198,3 +297,193 @@ void ADLMainControl::setODPerformanceLevels(int adapterIndex, int perfLevelsNum,
 
     handle.Overdrive5_ODPerformanceLevels_Set(adapterIndex, odPLevels);
 }
+
+int ADLMainControl::getODVersion(int adapterIndex) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    if (!handle.hasOverdriveCaps())
+    {
+        return 5;
+    }
+
+    int supported = 0, enabled = 0, version = 0;
+    handle.Overdrive_Caps(adapterIndex, &supported, &enabled, &version);
+
+    if (supported == 0)
+    {
+        return 0;
+    }
+
+    switch(version)
+    {
+        case 5:
+
+            return 5;
+
+        case 6:
+
+            return handle.hasOverdrive6() ? 6 : 0;
+
+        case 7:
+
+            return handle.hasOverdriveN() ? 7 : 0;
+
+        default:
+
+            return 0;
+    }
+}
+
+void ADLMainControl::getOD6Capabilities(int adapterIndex, ADLOD6Capabilities& capabilities) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    handle.Overdrive6_Capabilities_Get(adapterIndex, &capabilities);
+}
+
+void ADLMainControl::getOD6PerformanceLevels(int adapterIndex, bool isDefault, ADLOD6PerformanceLevel* perfLevels) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    // state info with two levels
+    char stateBuf[sizeof(ADLOD6StateInfo) + sizeof(ADLOD6PerformanceLevel)];
+    ADLOD6StateInfo* stateInfo = (ADLOD6StateInfo*)stateBuf;
+
+    ::memset(stateBuf, 0, sizeof(stateBuf));
+    stateInfo->iNumberOfPerformanceLevels = 2;
+
+    handle.Overdrive6_StateInfo_Get(adapterIndex, isDefault ? ADL_OD6_GETSTATEINFO_DEFAULT_PERFORMANCE :
+                                    ADL_OD6_GETSTATEINFO_CUSTOM_PERFORMANCE, stateInfo);
+
+    std::copy(stateInfo->aLevels, stateInfo->aLevels + 2, perfLevels);
+}
+
+void ADLMainControl::setOD6PerformanceLevels(int adapterIndex, const ADLOD6PerformanceLevel* perfLevels) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    char stateBuf[sizeof(ADLOD6StateInfo) + sizeof(ADLOD6PerformanceLevel)];
+    ADLOD6StateInfo* stateInfo = (ADLOD6StateInfo*)stateBuf;
+
+    ::memset(stateBuf, 0, sizeof(stateBuf));
+    stateInfo->iNumberOfPerformanceLevels = 2;
+    std::copy(perfLevels, perfLevels + 2, stateInfo->aLevels);
+
+    handle.Overdrive6_State_Set(adapterIndex, ADL_OD6_SETSTATE_PERFORMANCE, stateInfo);
+}
+
+void ADLMainControl::getOD6PowerControlInfo(int adapterIndex, ADLOD6PowerControlInfo& info) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    handle.Overdrive6_PowerControlInfo_Get(adapterIndex, &info);
+}
+
+int ADLMainControl::getOD6PowerControl(int adapterIndex, int& defaultValue) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    int currentValue = 0;
+    handle.Overdrive6_PowerControl_Get(adapterIndex, &currentValue, &defaultValue);
+
+    return currentValue;
+}
+
+void ADLMainControl::setOD6PowerControl(int adapterIndex, int value) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    handle.Overdrive6_PowerControl_Set(adapterIndex, value);
+}
+
+void ADLMainControl::getODNCapabilities(int adapterIndex, ADLODNCapabilities& capabilities) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    handle.OverdriveN_Capabilities_Get(adapterIndex, &capabilities);
+}
+
+void ADLMainControl::getODNPerformanceLevels(int adapterIndex, bool memory, bool isDefault, int maxLevelsNum,
+                                             std::vector<ADLODNPerformanceLevel>& perfLevels) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    perfLevels.clear();
+
+    if (maxLevelsNum <= 0)
+    {
+        return;
+    }
+
+    const size_t odPLBufSize = sizeof(ADLODNPerformanceLevels) + sizeof(ADLODNPerformanceLevel) * (maxLevelsNum - 1);
+    std::unique_ptr<char[]> odPlBuf(new char[odPLBufSize]);
+
+    ADLODNPerformanceLevels* odPLevels = (ADLODNPerformanceLevels*)odPlBuf.get();
+    ::memset(odPLevels, 0, odPLBufSize);
+    odPLevels->iSize = odPLBufSize;
+    odPLevels->iMode = isDefault ? ODNControlType_Default : ODNControlType_Current;
+    odPLevels->iNumberOfPerformanceLevels = maxLevelsNum;
+
+    if (memory)
+    {
+        handle.OverdriveN_MemoryClocks_Get(adapterIndex, odPLevels);
+    }
+    else
+    {
+        handle.OverdriveN_SystemClocks_Get(adapterIndex, odPLevels);
+    }
+
+    const int levelsNum = std::min(std::max(odPLevels->iNumberOfPerformanceLevels, 0), maxLevelsNum);
+    perfLevels.assign(odPLevels->aLevels, odPLevels->aLevels + levelsNum);
+}
+
+void ADLMainControl::setODNPerformanceLevels(int adapterIndex, bool memory, const std::vector<ADLODNPerformanceLevel>& perfLevels) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    const size_t odPLBufSize = sizeof(ADLODNPerformanceLevels) + sizeof(ADLODNPerformanceLevel) * (perfLevels.size() - 1);
+    std::unique_ptr<char[]> odPlBuf(new char[odPLBufSize]);
+
+    ADLODNPerformanceLevels* odPLevels = (ADLODNPerformanceLevels*)odPlBuf.get();
+    odPLevels->iSize = odPLBufSize;
+    odPLevels->iMode = ODNControlType_Manual;
+    odPLevels->iNumberOfPerformanceLevels = perfLevels.size();
+
+    std::copy(perfLevels.begin(), perfLevels.end(), odPLevels->aLevels);
+
+    if (memory)
+    {
+        handle.OverdriveN_MemoryClocks_Set(adapterIndex, odPLevels);
+    }
+    else
+    {
+        handle.OverdriveN_SystemClocks_Set(adapterIndex, odPLevels);
+    }
+}
+
+int ADLMainControl::getODNPowerLimit(int adapterIndex) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    ADLODNPowerLimitSetting powerLimit;
+    ::memset(&powerLimit, 0, sizeof(powerLimit));
+    handle.OverdriveN_PowerLimit_Get(adapterIndex, &powerLimit);
+
+    return powerLimit.iTDPLimit;
+}
+
+void ADLMainControl::setODNPowerLimit(int adapterIndex, int value) const
+{
+    const CardLock lock(*this, adapterIndex);
+
+    // keeps the temperature limit
+    ADLODNPowerLimitSetting powerLimit;
+    ::memset(&powerLimit, 0, sizeof(powerLimit));
+    handle.OverdriveN_PowerLimit_Get(adapterIndex, &powerLimit);
+
+    powerLimit.iMode = ODNControlType_Manual;
+    powerLimit.iTDPLimit = value;
+
+    handle.OverdriveN_PowerLimit_Set(adapterIndex, &powerLimit);
+}
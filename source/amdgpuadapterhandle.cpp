@@ -3,6 +3,9 @@
 
 static void writeFileContentValue(const char* filename, unsigned int value)
 {
+    TimingTrace::Span span("write", "write", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::WRITE);
+
     std::ofstream ofs(filename, std::ios::binary);
 
     try
@@ -12,16 +15,44 @@ static void writeFileContentValue(const char* filename, unsigned int value)
     }
     catch(const std::exception& ex)
     {
+        stats.setFailed();
         throw Error( (std::string("Unable to write to file '") + filename + "'").c_str() );
     }
 }
 
+static void writeFileContentString(const char* filename, const std::string& value)
+{
+    TimingTrace::Span span("write", "write", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::WRITE);
+
+    std::ofstream ofs(filename, std::ios::binary);
+
+    try
+    {
+        ofs.exceptions(std::ios::failbit);
+        ofs << value << std::endl;
+    }
+    catch(const std::exception& ex)
+    {
+        stats.setFailed();
+        throw Error( (std::string("Unable to write '") + value + "' to file '" + filename + "'").c_str() );
+    }
+}
+
 static bool getFileContentValue(const char* filename, unsigned int& value)
 {
+    TimingTrace::Span span("read", "read", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::READ);
+
     value = 0;
 
     std::ifstream ifs(filename, std::ios::binary);
 
+    if (!ifs)
+    {
+        stats.setFailed();
+    }
+
     ifs.exceptions(std::ios::failbit);
 
     std::string line;
@@ -42,8 +73,99 @@ static bool getFileContentValue(const char* filename, unsigned int& value)
     return (p != p2);
 }
 
+/* first line of file, returns false if file is missing */
+static bool getFileContentString(const char* filename, std::string& value)
+{
+    TimingTrace::Span span("read", "read", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::READ);
+
+    value.clear();
+
+    std::ifstream ifs(filename, std::ios::binary);
+
+    if (!ifs)
+    {
+        stats.setFailed();
+        return false;
+    }
+
+    std::getline(ifs, value);
+
+    return true;
+}
+
+/* like getFileContentValue, but a missing file is not an error */
+static bool getOptionalFileContentValue(const char* filename, unsigned int& value)
+{
+    TimingTrace::Span span("read", "read", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::READ);
+
+    value = 0;
+
+    std::ifstream ifs(filename, std::ios::binary);
+
+    if (!ifs)
+    {
+        stats.setFailed();
+        return false;
+    }
+
+    std::string line;
+    std::getline(ifs, line);
+
+    char* p = (char*)line.c_str();
+    char* p2;
+
+    errno = 0;
+
+    value = strtoul(p, &p2, 0);
+
+    if (errno != 0)
+    {
+        throw Error("Unable to parse value from file");
+    }
+
+    return (p != p2);
+}
+
+/* like getOptionalFileContentValue, for values above 4 GB */
+static bool getOptionalFileContentValue(const char* filename, unsigned long long& value)
+{
+    TimingTrace::Span span("read", "read", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::READ);
+
+    value = 0;
+
+    std::ifstream ifs(filename, std::ios::binary);
+
+    if (!ifs)
+    {
+        stats.setFailed();
+        return false;
+    }
+
+    std::string line;
+    std::getline(ifs, line);
+
+    char* p = (char*)line.c_str();
+    char* p2;
+
+    errno = 0;
+
+    value = strtoull(p, &p2, 0);
+
+    if (errno != 0)
+    {
+        throw Error("Unable to parse value from file");
+    }
+
+    return (p != p2);
+}
+
 AMDGPUAdapterHandle::AMDGPUAdapterHandle() : totDeviceCount(0)
 {
+    TimingTrace::Span span("startup", "DRM scan");
+
     errno = 0;
     DIR* dirp = opendir("/sys/class/drm");
 
@@ -87,87 +209,150 @@ AMDGPUAdapterHandle::AMDGPUAdapterHandle() : totDeviceCount(0)
     closedir(dirp);
 
     // filter AMD GPU cards
-    char dbuf[120];
-
     for (unsigned int i = 0; i < totDeviceCount; i++)
     {
-        snprintf(dbuf, 120, "/sys/class/drm/card%u/device/vendor", i);
+        if (isAMDCard(i))
+        {
+            amdDevices.push_back(i);
+        }
+    }
+
+    for (unsigned int cardIndex: amdDevices)
+    {
+        attributePaths.push_back(AMDGPUAttributePaths(cardIndex, findHwmonIndex(cardIndex)));
+    }
+}
+
+bool AMDGPUAdapterHandle::isAMDCard(unsigned int cardIndex)
+{
+    const std::string path = "/sys/class/drm/card" + std::to_string(cardIndex) + "/device/vendor";
+    unsigned int vendorId = 0;
+
+    // card can disappear while it is probed
+    return getOptionalFileContentValue(path.c_str(), vendorId) && vendorId == 4098;
+}
+
+unsigned int AMDGPUAdapterHandle::findHwmonIndex(unsigned int cardIndex)
+{
+    const std::string path = "/sys/class/drm/card" + std::to_string(cardIndex) + "/device/hwmon";
+
+    // search hwmon
+    errno = 0;
+
+    DIR* dirp = opendir(path.c_str());
+
+    if (dirp == nullptr)
+    {
+        throw Error(errno, "Unable to open directory 'sys/class/drm/card?/device/hwmon'");
+    }
 
-        unsigned int vendorId = 0;
+    errno = 0;
+    struct dirent* dire;
+    unsigned int hwmonIndex = UINT_MAX;
 
-        if (!getFileContentValue(dbuf, vendorId))
+    while ( (dire = readdir(dirp)) != nullptr)
+    {
+        if (::strncmp(dire->d_name, "hwmon", 5) != 0)
         {
-            continue;
+            continue; // is not hwmon directory
         }
 
-        if (vendorId != 4098) // if not AMD
+        const char* p;
+        for (p = dire->d_name + 5; ::isdigit(*p); p++);
+
+        if (*p != 0)
         {
-            continue;
+            continue; // is not hwmon directory
         }
 
-        amdDevices.push_back(i);
+        errno = 0;
+        unsigned int v = ::strtoul(dire->d_name + 5, nullptr, 10);
+        hwmonIndex = std::min(hwmonIndex, v);
     }
 
-    /* hwmon indices */
-    for (unsigned int cardIndex: amdDevices)
+    if (errno != 0)
     {
-        // search hwmon
-        errno = 0;
+        closedir(dirp);
+        throw Error(errno, "Unable to open directory 'sys/class/drm/card?/hwmon'");
+    }
+
+    closedir(dirp);
 
-        snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon", cardIndex);
-        DIR* dirp = opendir(dbuf);
+    if (hwmonIndex == UINT_MAX)
+    {
+        throw Error("Unable to find hwmon directory.");
+    }
+
+    return hwmonIndex;
+}
 
-        if (dirp == nullptr)
+int AMDGPUAdapterHandle::findCard(unsigned int cardIndex) const
+{
+    for (size_t i = 0; i < amdDevices.size(); i++)
+    {
+        if (amdDevices[i] == cardIndex)
         {
-            throw Error(errno, "Unable to open directory 'sys/class/drm/card?/device/hwmon'");
+            return i;
         }
+    }
 
-        errno = 0;
-        struct dirent* dire;
-        unsigned int hwmonIndex = UINT_MAX;
+    return -1;
+}
 
-        while ( (dire = readdir(dirp)) != nullptr)
-        {
-            if (::strncmp(dire->d_name, "hwmon", 5) != 0)
-            {
-                continue; // is not hwmon directory
-            }
+/* only this card is probed, indices of the other adapters are kept */
+int AMDGPUAdapterHandle::addCard(unsigned int cardIndex)
+{
+    int index = findCard(cardIndex);
 
-            const char* p;
-            for (p = dire->d_name + 5; ::isdigit(*p); p++);
+    if (index >= 0)
+    {
+        // hwmon is registered again after reset of device
+        attributePaths[index] = AMDGPUAttributePaths(cardIndex, findHwmonIndex(cardIndex));
+        return index;
+    }
 
-            if (*p != 0)
-            {
-                continue; // is not hwmon directory
-            }
+    if (!isAMDCard(cardIndex))
+    {
+        return -1;
+    }
 
-            errno = 0;
-            unsigned int v = ::strtoul(dire->d_name + 5, nullptr, 10);
-            hwmonIndex = std::min(hwmonIndex, v);
-        }
+    const unsigned int hwmonIndex = findHwmonIndex(cardIndex);
 
-        if (errno != 0)
-        {
-            closedir(dirp);
-            throw Error(errno, "Unable to open directory 'sys/class/drm/card?/hwmon'");
-        }
+    amdDevices.push_back(cardIndex);
+    attributePaths.push_back(AMDGPUAttributePaths(cardIndex, hwmonIndex));
+    totDeviceCount = std::max(totDeviceCount, cardIndex + 1);
 
-        closedir(dirp);
+    return amdDevices.size() - 1;
+}
 
-        if (hwmonIndex == UINT_MAX)
-        {
-            throw Error("Unable to find hwmon directory.");
-        }
+bool AMDGPUAdapterHandle::removeCard(unsigned int cardIndex)
+{
+    const int index = findCard(cardIndex);
 
-        hwmonIndices.push_back(hwmonIndex);
+    if (index < 0)
+    {
+        return false;
     }
+
+    amdDevices.erase(amdDevices.begin() + index);
+    attributePaths.erase(attributePaths.begin() + index);
+
+    return true;
 }
 
 static std::vector<unsigned int> parseDPMFile(const char* filename, uint32_t& choosen)
 {
+    TimingTrace::Span span("read", "read", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::READ);
+
     std::vector<uint32_t> out;
     std::ifstream ifs(filename, std::ios::binary);
 
+    if (!ifs)
+    {
+        stats.setFailed();
+    }
+
     choosen = UINT32_MAX;
 
     while (ifs)
@@ -227,43 +412,93 @@ static std::vector<unsigned int> parseDPMFile(const char* filename, uint32_t& ch
     return out;
 }
 
-static void parseDPMPCIEFile(const char* filename, unsigned int& pcieMB, unsigned int& lanes)
+static unsigned int countDPMStates(const char* filename)
 {
+    TimingTrace::Span span("read", "read", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::READ);
+
     std::ifstream ifs(filename, std::ios::binary);
 
-    unsigned int ilanes = 0, ipcieMB = 0;
+    if (!ifs)
+    {
+        stats.setFailed();
+        return 0;
+    }
 
-    while (ifs)
+    unsigned int statesNum = 0;
+    std::string line;
+
+    while (std::getline(ifs, line))
     {
-        std::string line;
-        std::getline(ifs, line);
+        const char* p = line.c_str();
 
-        if (line.empty())
+        while (::isdigit(*p))
         {
-            break;
+            p++;
+        }
+
+        if (p != line.c_str() && *p == ':')
+        {
+            statesNum++;
         }
+    }
+
+    return statesNum;
+}
+
+static AMDGPUAttribute getDPMAttribute(DPMDomain domain)
+{
+    switch(domain)
+    {
+        case DPMDomain::CORE:
+
+            return AMDGPUAttribute::PP_DPM_SCLK;
+
+        case DPMDomain::MEMORY:
+
+            return AMDGPUAttribute::PP_DPM_MCLK;
+
+        default:
+
+            return AMDGPUAttribute::PP_DPM_PCIE;
+    }
+}
+
+/* lines like '1: 8.0GT/s, x16 *', the active state is marked by '*' */
+static void parseDPMPCIEFile(const char* filename, unsigned int& pcieMB, unsigned int& lanes)
+{
+    TimingTrace::Span span("read", "read", filename);
+    IOStats::Scope stats(filename, IOStats::Operation::READ);
+
+    std::ifstream ifs(filename, std::ios::binary);
+
+    pcieMB = lanes = 0;
+
+    if (!ifs)
+    {
+        stats.setFailed();
+        return;
+    }
+
+    std::string line;
 
+    while (std::getline(ifs, line))
+    {
         char* p = (char*)line.c_str();
-        char* p2 = (char*)line.c_str();
+        char* p2;
 
         errno = 0;
 
         strtoul(p, &p2, 10);
 
-        if (errno!=0 || p==p2)
+        if (errno != 0 || p == p2 || *p2 != ':')
         {
             throw Error(errno, "Unable to parse index.");
         }
 
-        p = p2;
-
-        if (*p != ':' || p[1] != ' ')
-        {
-            throw Error(errno, "Unable to parse the next part of the line");
-        }
+        p = p2 + 1;
 
-        p += 2;
-        double bandwidth = strtod(p, &p2);
+        const double bandwidth = strtod(p, &p2);
 
         if (errno != 0 || p == p2)
         {
@@ -272,67 +507,61 @@ static void parseDPMPCIEFile(const char* filename, unsigned int& pcieMB, unsigne
 
         p = p2;
 
-        if (*p == 'G' && p2[1] == 'B')
+        unsigned int ipcieMB;
+
+        // transfer rate (GT/s) of newer kernels is given like bandwidth
+        if (::strncmp(p, "GT/s", 4) == 0 || ::strncmp(p, "GB/s", 4) == 0)
         {
             ipcieMB = bandwidth * 1000;
         }
-        else if (*p == 'M' && p2[1] == 'B')
+        else if (::strncmp(p, "MT/s", 4) == 0 || ::strncmp(p, "MB/s", 4) == 0)
         {
             ipcieMB = bandwidth;
         }
-        else if (*p == 'M' && p2[1] == 'B')
-        {
-            ipcieMB = bandwidth / 1000;
-        }
         else
         {
-            throw Error(errno, "Invalid bandwidth specified.");
+            throw Error("Invalid bandwidth specified.");
         }
 
-        p += 2;
+        p += 4;
 
         if (::strncmp(p, ", x", 3) != 0)
         {
-            throw Error(errno, "Unable to parse the next part of the line.");
+            throw Error("Unable to parse the next part of the line.");
         }
 
-        errno = 0;
-        ilanes = strtoul(p, &p2, 10);
+        p += 3;
+
+        const unsigned int ilanes = strtoul(p, &p2, 10);
 
         if (errno != 0 || p == p2)
         {
             throw Error(errno, "Unable to parse lanes.");
         }
 
-        if (*p == ' ' && p[1] == '*')
+        if (::strchr(p2, '*') != nullptr)
         {
             lanes = ilanes;
             pcieMB = ipcieMB;
             break;
         }
-
     }
 }
 
 void AMDGPUAdapterHandle::getPerformanceClocks(int adapterIndex, unsigned int& coreClock, unsigned int& memoryClock) const
 {
-    char dbuf[120];
-    unsigned int cardIndex = amdDevices[adapterIndex];
+    const AMDGPUAttributePaths& paths = attributePaths[adapterIndex];
 
     unsigned int coreOD = 0;
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_sclk_od", cardIndex);
 
-    getFileContentValue(dbuf, coreOD);
+    getFileContentValue(paths.get(AMDGPUAttribute::PP_SCLK_OD), coreOD);
 
     unsigned int memoryOD = 0;
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_mclk_od", cardIndex);
 
-    getFileContentValue(dbuf, memoryOD);
-
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_dpm_sclk", cardIndex);
+    getFileContentValue(paths.get(AMDGPUAttribute::PP_MCLK_OD), memoryOD);
 
     unsigned int activeClockIndex;
-    std::vector<unsigned int> clocks = parseDPMFile(dbuf, activeClockIndex);
+    std::vector<unsigned int> clocks = parseDPMFile(paths.get(AMDGPUAttribute::PP_DPM_SCLK), activeClockIndex);
     coreClock = 0;
 
     if (!clocks.empty())
@@ -340,8 +569,7 @@ void AMDGPUAdapterHandle::getPerformanceClocks(int adapterIndex, unsigned int& c
         coreClock = int(ceil(double(clocks.back()) / (1.0 + coreOD * 0.01)));
     }
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_dpm_mclk", cardIndex);
-    clocks = parseDPMFile(dbuf, activeClockIndex);
+    clocks = parseDPMFile(paths.get(AMDGPUAttribute::PP_DPM_MCLK), activeClockIndex);
     memoryClock = 0;
 
     if (!clocks.empty())
@@ -352,24 +580,32 @@ void AMDGPUAdapterHandle::getPerformanceClocks(int adapterIndex, unsigned int& c
 
 AMDGPUAdapterInfo AMDGPUAdapterHandle::parseAdapterInfo(int index)
 {
-    AMDGPUAdapterInfo adapterInfo;
-    unsigned int cardIndex = amdDevices[index];
-    char dbuf[120];
-    char rlink[120];
+    TimingTrace::Span span("command", "parse adapter info");
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device", cardIndex);
+    // plain values, read in this order
+    static const struct
+    {
+        AMDGPUAttribute attribute;
+        unsigned int AMDGPUAdapterInfo::*value;
+    } values[] =
+    {
+        { AMDGPUAttribute::PP_SCLK_OD, &AMDGPUAdapterInfo::coreOD },
+        { AMDGPUAttribute::PP_MCLK_OD, &AMDGPUAdapterInfo::memoryOD },
+        { AMDGPUAttribute::PWM1_MIN, &AMDGPUAdapterInfo::minFanSpeed },
+        { AMDGPUAttribute::PWM1_MAX, &AMDGPUAdapterInfo::maxFanSpeed },
+        { AMDGPUAttribute::PWM1, &AMDGPUAdapterInfo::fanSpeed },
+        { AMDGPUAttribute::TEMP1_INPUT, &AMDGPUAdapterInfo::temperature },
+        { AMDGPUAttribute::TEMP1_CRIT, &AMDGPUAdapterInfo::tempCritical }
+    };
 
-    // currently throws a warning at compile time
-    ::readlink(dbuf, rlink, 120);
-    rlink[119] = 0;
+    AMDGPUAdapterInfo adapterInfo;
+    const AMDGPUAttributePaths& paths = attributePaths[index];
 
-    PCIAccess::GetFromPCI_AMDGPU(rlink, adapterInfo);
+    PCIAccess::GetFromPCI_AMDGPU(getSlotName(index), adapterInfo);
 
     // parse pp_dpm_sclk
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_dpm_sclk", cardIndex);
-
     unsigned int activeCoreClockIndex;
-    adapterInfo.coreClocks = parseDPMFile(dbuf, activeCoreClockIndex);
+    adapterInfo.coreClocks = parseDPMFile(paths.get(AMDGPUAttribute::PP_DPM_SCLK), activeCoreClockIndex);
 
     if (activeCoreClockIndex!=UINT_MAX)
     {
@@ -381,10 +617,8 @@ AMDGPUAdapterInfo AMDGPUAdapterHandle::parseAdapterInfo(int index)
     }
 
     // parse pp_dpm_mclk
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_dpm_mclk", cardIndex);
-
     unsigned int activeMemoryClockIndex;
-    adapterInfo.memoryClocks = parseDPMFile(dbuf, activeMemoryClockIndex);
+    adapterInfo.memoryClocks = parseDPMFile(paths.get(AMDGPUAttribute::PP_DPM_MCLK), activeMemoryClockIndex);
 
     if (activeMemoryClockIndex!=UINT_MAX)
     {
@@ -395,132 +629,713 @@ AMDGPUAdapterInfo AMDGPUAdapterHandle::parseAdapterInfo(int index)
       adapterInfo.memoryClock = 0;
     }
 
-    unsigned int hwmonIndex = hwmonIndices[index];
-
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_sclk_od", cardIndex);
+    for (const auto& value: values)
+    {
+        getFileContentValue(paths.get(value.attribute), adapterInfo.*value.value);
+    }
 
-    getFileContentValue(dbuf, adapterInfo.coreOD);
+    unsigned int pwmEnable = 0;
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_mclk_od", cardIndex);
+    getFileContentValue(paths.get(AMDGPUAttribute::PWM1_ENABLE), pwmEnable);
 
-    getFileContentValue(dbuf, adapterInfo.memoryOD);
+    adapterInfo.defaultFanSpeed = pwmEnable==2;
 
-    // get fanspeed
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1_min", cardIndex, hwmonIndex);
+    adapterInfo.power = getPower(index);
 
-    getFileContentValue(dbuf, adapterInfo.minFanSpeed);
+    adapterInfo.powerCapAvailable = getOptionalFileContentValue(paths.get(AMDGPUAttribute::POWER1_CAP), adapterInfo.powerCap);
+    adapterInfo.powerCapMin = adapterInfo.powerCapMax = 0;
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1_max", cardIndex, hwmonIndex);
+    if (adapterInfo.powerCapAvailable)
+    {
+        getPowerCapRange(index, adapterInfo.powerCapMin, adapterInfo.powerCapMax);
+    }
 
-    getFileContentValue(dbuf, adapterInfo.maxFanSpeed);
+    getMemoryUsage(index, adapterInfo.memoryUsage);
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1", cardIndex, hwmonIndex);
+    getSensors(index, adapterInfo.sensors);
 
-    getFileContentValue(dbuf, adapterInfo.fanSpeed);
+    adapterInfo.gpuLoad = getGPULoad(index);
+    adapterInfo.memoryLoad = getMemoryLoad(index);
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1_enable", cardIndex, hwmonIndex);
+    // debugfs is slow and needs root, it is only a fallback for older kernels
+    if (adapterInfo.gpuLoad < 0 && getPMInfo(index, adapterInfo.pmInfo))
+    {
+        adapterInfo.gpuLoad = adapterInfo.pmInfo.gpuLoad;
 
-    unsigned int pwmEnable = 0;
+        if (adapterInfo.memoryLoad < 0)
+        {
+            adapterInfo.memoryLoad = adapterInfo.pmInfo.memoryLoad;
+        }
+    }
 
-    getFileContentValue(dbuf, pwmEnable);
+    try
+    {
+        getODClockVoltage(index, adapterInfo.odTable);
+    }
+    catch(const Error& error)
+    {
+        // unknown format of pp_od_clk_voltage should not hide other informations
+        adapterInfo.odTable = AMDGPUODTable();
+    }
 
-    adapterInfo.defaultFanSpeed = pwmEnable==2;
+    getPerformanceLevel(index, adapterInfo.performanceLevel);
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/temp1_input", cardIndex, hwmonIndex);
+    try
+    {
+        getPowerProfiles(index, adapterInfo.powerProfiles);
+    }
+    catch(const Error& error)
+    {
+        adapterInfo.powerProfiles = AMDGPUPowerProfileTable();
+    }
 
-    getFileContentValue(dbuf, adapterInfo.temperature);
+    try
+    {
+        parseDPMPCIEFile(paths.get(AMDGPUAttribute::PP_DPM_PCIE), adapterInfo.busSpeed, adapterInfo.busLanes);
+    }
+    catch(const Error& error)
+    {
+        adapterInfo.busSpeed = adapterInfo.busLanes = 0;
+    }
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/temp1_crit", cardIndex, hwmonIndex);
+    return adapterInfo;
+}
 
-    getFileContentValue(dbuf, adapterInfo.tempCritical);
+double AMDGPUAdapterHandle::getAttribute(int index, AMDGPUAttribute attribute) const
+{
+    const AMDGPUAttributeDescriptor& descriptor = AMDGPUAttributePaths::GetDescriptor(attribute);
+    unsigned long long value;
 
-    // parse GPU load
-    snprintf(dbuf, 120, "/sys/kernel/debug/dri/%u/amdgpu_pm_info", cardIndex);
+    if (descriptor.format != AMDGPUAttributeFormat::VALUE ||
+        !getOptionalFileContentValue(attributePaths[index].get(attribute), value))
     {
-        adapterInfo.gpuLoad = -1;
+        return NAN;
+    }
 
-        std::ifstream ifs(dbuf, std::ios::binary);
+    return value * descriptor.scale;
+}
 
-        while (ifs)
-        {
-            std::string line;
-            std::getline(ifs, line);
+void AMDGPUAdapterHandle::getAttributes(int index, const std::vector<AMDGPUAttribute>& attributes, std::vector<double>& values) const
+{
+    values.resize(attributes.size());
 
-            if (line.compare(0, 10, "GPU load: ") == 0 || line.compare(0, 10, "GPU Load: ") == 0)
-            {
-                errno = 0;
-                char* endp;
-                adapterInfo.gpuLoad = strtoul(line.c_str() + 10, &endp, 10);
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        values[i] = getAttribute(index, attributes[i]);
+    }
+}
 
-                if (errno != 0 || endp == line.c_str()+10)
+void AMDGPUAdapterHandle::writeAttribute(int index, const std::string& name, const std::string& value) const
+{
+    const char* path = attributePaths[index].findPath(name);
+
+    if (path == nullptr)
+    {
+        throw Error(("Adapter does not have attribute '" + name + "'").c_str());
+    }
+
+    writeFileContentString(path, value);
+}
+
+void AMDGPUAdapterHandle::setFanSpeed(int index, unsigned int controllerIndex, int fanSpeed) const
+{
+    const AMDGPUAttributePaths& paths = attributePaths[index];
+
+    writeFileContentValue(paths.getChannel(AMDGPUChannelAttribute::PWM_ENABLE, controllerIndex), 1);
+
+    unsigned int minFanSpeed, maxFanSpeed;
+
+    getFileContentValue(paths.getChannel(AMDGPUChannelAttribute::PWM_MIN, controllerIndex), minFanSpeed);
+
+    getFileContentValue(paths.getChannel(AMDGPUChannelAttribute::PWM_MAX, controllerIndex), maxFanSpeed);
+
+    writeFileContentValue(paths.getChannel(AMDGPUChannelAttribute::PWM, controllerIndex),
+                          int( round( fanSpeed / 100.0 * (maxFanSpeed-minFanSpeed) + minFanSpeed) ) );
+}
+
+void AMDGPUAdapterHandle::setFanSpeedToDefault(int index, unsigned int controllerIndex) const
+{
+    writeFileContentValue(attributePaths[index].getChannel(AMDGPUChannelAttribute::PWM_ENABLE, controllerIndex), 2);
+}
+
+unsigned int AMDGPUAdapterHandle::getFanControllersNum(int index) const
+{
+    return attributePaths[index].getChannelsNum();
+}
+
+void AMDGPUAdapterHandle::getFanRPMControl(int index, unsigned int controllerIndex, AMDGPUFanRPMControl& control) const
+{
+    const AMDGPUAttributePaths& paths = attributePaths[index];
+    unsigned int value;
+
+    control.available = getOptionalFileContentValue(paths.getChannel(AMDGPUChannelAttribute::FAN_INPUT, controllerIndex), value);
+
+    // fanN_target exists on drivers without RPM control too, but reading it fails there
+    control.hasTarget = control.available &&
+        getOptionalFileContentValue(paths.getChannel(AMDGPUChannelAttribute::FAN_TARGET, controllerIndex), value);
+
+    getOptionalFileContentValue(paths.getChannel(AMDGPUChannelAttribute::FAN_MIN, controllerIndex), control.min);
+
+    getOptionalFileContentValue(paths.getChannel(AMDGPUChannelAttribute::FAN_MAX, controllerIndex), control.max);
+}
+
+unsigned int AMDGPUAdapterHandle::getFanRPM(int index, unsigned int controllerIndex) const
+{
+    unsigned int rpm;
+
+    getFileContentValue(attributePaths[index].getChannel(AMDGPUChannelAttribute::FAN_INPUT, controllerIndex), rpm);
+
+    return rpm;
+}
+
+/* the driver accepts fanN_target only in manual mode */
+void AMDGPUAdapterHandle::setFanRPMTarget(int index, unsigned int controllerIndex, unsigned int rpm) const
+{
+    const AMDGPUAttributePaths& paths = attributePaths[index];
+    const char* fanEnable = paths.getChannel(AMDGPUChannelAttribute::FAN_ENABLE, controllerIndex);
+
+    if (::access(fanEnable, F_OK) == 0)
+    {
+        writeFileContentValue(fanEnable, 1);
+    }
+    else
+    {
+        writeFileContentValue(paths.getChannel(AMDGPUChannelAttribute::PWM_ENABLE, controllerIndex), 1);
+    }
+
+    writeFileContentValue(paths.getChannel(AMDGPUChannelAttribute::FAN_TARGET, controllerIndex), rpm);
+}
+
+void AMDGPUAdapterHandle::setFanRPMToDefault(int index, unsigned int controllerIndex) const
+{
+    const char* fanEnable = attributePaths[index].getChannel(AMDGPUChannelAttribute::FAN_ENABLE, controllerIndex);
+
+    if (::access(fanEnable, F_OK) == 0)
+    {
+        writeFileContentValue(fanEnable, 0);
+    }
+
+    setFanSpeedToDefault(index, controllerIndex);
+}
+
+/* sensors of hwmon: name prefix, scale of raw values and the suffix of the value */
+static const struct
+{
+    const char* type;
+    double scale;
+    const char* inputs[2];
+} sensorTypes[] = {
+    { "temp", 0.001, { "_input", nullptr } },
+    { "fan", 1.0, { "_input", nullptr } },
+    { "in", 0.001, { "_input", nullptr } },
+    { "power", 0.000001, { "_average", "_input" } }     // like getPower
+};
+
+static double getSensorLimit(const char* filename, double scale)
+{
+    unsigned int value;
+
+    return getOptionalFileContentValue(filename, value) ? value * scale : NAN;
+}
+
+void AMDGPUAdapterHandle::getSensors(int index, std::vector<AMDGPUSensor>& sensors) const
+{
+    const std::string& hwmonPath = attributePaths[index].getHwmonPath();
+
+    sensors.clear();
+
+    DIR* dirp = ::opendir(hwmonPath.c_str());
+
+    if (dirp == nullptr)
+    {
+        return;
+    }
+
+    // channels of every type, found by names like temp2_input
+    std::vector<std::vector<unsigned int> > channels(sizeof(sensorTypes) / sizeof(sensorTypes[0]));
+    struct dirent* dire;
+
+    while ((dire = ::readdir(dirp)) != nullptr)
+    {
+        for (size_t t = 0; t < channels.size(); t++)
+        {
+            const size_t typeLength = ::strlen(sensorTypes[t].type);
+
+            if (::strncmp(dire->d_name, sensorTypes[t].type, typeLength) != 0 || !::isdigit(dire->d_name[typeLength]))
+            {
+                continue;
+            }
+
+            char* end;
+            const unsigned int channel = ::strtoul(dire->d_name + typeLength, &end, 10);
+
+            if (*end == '_' && std::find(channels[t].begin(), channels[t].end(), channel) == channels[t].end())
+            {
+                channels[t].push_back(channel);
+            }
+        }
+    }
+
+    ::closedir(dirp);
+
+    for (size_t t = 0; t < channels.size(); t++)
+    {
+        std::sort(channels[t].begin(), channels[t].end());
+
+        for (unsigned int channel: channels[t])
+        {
+            const std::string prefix = hwmonPath + "/" + sensorTypes[t].type + std::to_string(channel);
+            unsigned int value;
+            bool found = false;
+
+            for (const char* input: sensorTypes[t].inputs)
+            {
+                if (input != nullptr && !found)
                 {
-                    throw Error("Unable to parse GPU load.");
+                    found = getOptionalFileContentValue((prefix + input).c_str(), value);
                 }
+            }
+
+            // channel without a value, like temp1_crit alone
+            if (!found)
+            {
+                continue;
+            }
+
+            AMDGPUSensor sensor;
+            sensor.type = sensorTypes[t].type;
+            sensor.channel = channel;
+            sensor.value = value * sensorTypes[t].scale;
+            sensor.critical = sensor.emergency = NAN;
+
+            if (!getFileContentString((prefix + "_label").c_str(), sensor.label) || sensor.label.empty())
+            {
+                sensor.label = sensor.type + std::to_string(channel);
+            }
 
-                break;
+            if (sensor.type == "temp")
+            {
+                sensor.critical = getSensorLimit((prefix + "_crit").c_str(), sensorTypes[t].scale);
+                sensor.emergency = getSensorLimit((prefix + "_emergency").c_str(), sensorTypes[t].scale);
             }
+
+            sensors.push_back(sensor);
         }
     }
+}
+
+void AMDGPUAdapterHandle::setOverdriveCoreParam(int index, unsigned int coreOD) const
+{
+    writeFileContentValue(attributePaths[index].get(AMDGPUAttribute::PP_SCLK_OD), coreOD);
+}
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/pp_dpm_pcie", cardIndex);
+void AMDGPUAdapterHandle::setOverdriveMemoryParam(int index, unsigned int memoryOD) const
+{
+    writeFileContentValue(attributePaths[index].get(AMDGPUAttribute::PP_MCLK_OD), memoryOD);
+}
 
-    parseDPMPCIEFile(dbuf, adapterInfo.busLanes, adapterInfo.busSpeed);
+std::string AMDGPUAdapterHandle::getSlotName(int index) const
+{
+    char rlink[PATH_MAX];
 
-    return adapterInfo;
+    ssize_t rlinkLen = ::readlink(attributePaths[index].getDevicePath().c_str(), rlink, sizeof(rlink) - 1);
+
+    if (rlinkLen < 0)
+    {
+        throw Error(errno, "Unable to read link 'sys/class/drm/card?/device'");
+    }
+
+    rlink[rlinkLen] = 0;
+
+    const char* slotName = ::strrchr(rlink, '/');
+
+    return (slotName != nullptr) ? slotName + 1 : rlink;
 }
 
-void AMDGPUAdapterHandle::setFanSpeed(int index, int fanSpeed) const
+void AMDGPUAdapterHandle::getIdentity(int index, AdapterIdentity& identity) const
 {
-    char dbuf[120];
-    unsigned int cardIndex = amdDevices[index];
-    unsigned int hwmonIndex = hwmonIndices[index];
+    const std::string slotName = getSlotName(index);
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1_enable", cardIndex, hwmonIndex);
+    identity.index = index;
 
-    writeFileContentValue(dbuf, 1);
+    if (::sscanf(slotName.c_str(), "%x:%x:%x.%x", &identity.domain, &identity.busNo, &identity.deviceNo, &identity.funcNo) != 4)
+    {
+        throw Error("Unable to parse PCI location");
+    }
 
-    unsigned int minFanSpeed, maxFanSpeed;
+    if (!getFileContentValue(attributePaths[index].get(AMDGPUAttribute::DEVICE_ID), identity.deviceId))
+    {
+        throw Error("Unable to parse device ID");
+    }
+}
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1_min", cardIndex, hwmonIndex);
+bool AMDGPUAdapterHandle::getODClockVoltage(int index, AMDGPUODTable& table) const
+{
+    const char* path = attributePaths[index].get(AMDGPUAttribute::PP_OD_CLK_VOLTAGE);
 
-    getFileContentValue(dbuf, minFanSpeed);
+    TimingTrace::Span span("read", "read", path);
+    IOStats::Scope stats(path, IOStats::Operation::READ);
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1_max", cardIndex, hwmonIndex);
+    std::ifstream ifs(path, std::ios::binary);
 
-    getFileContentValue(dbuf, maxFanSpeed);
+    if (!ifs)
+    {
+        stats.setFailed();
+        table = AMDGPUODTable();
+        return false;
+    }
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1", cardIndex, hwmonIndex);
+    AMDGPUODTable::Parse(ifs, table);
 
-    writeFileContentValue(dbuf, int( round( fanSpeed / 100.0 * (maxFanSpeed-minFanSpeed) + minFanSpeed) ) );
+    return table.isAvailable();
 }
 
-void AMDGPUAdapterHandle::setFanSpeedToDefault(int index) const
+/* every command needs its own write, the driver parses one command per write */
+void AMDGPUAdapterHandle::setODClockVoltage(int index, const AMDGPUODTable& table) const
 {
-    char dbuf[120];
-    unsigned int cardIndex = amdDevices[index];
-    unsigned int hwmonIndex = hwmonIndices[index];
+    const char* path = attributePaths[index].get(AMDGPUAttribute::PP_OD_CLK_VOLTAGE);
+
+    std::vector<std::string> commands;
+    table.getCommands(commands);
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/hwmon/hwmon%u/pwm1_enable", cardIndex, hwmonIndex);
+    if (commands.empty())
+    {
+        return;
+    }
 
-    writeFileContentValue(dbuf, 2);
+    for (const std::string& command: commands)
+    {
+        writeFileContentString(path, command);
+    }
+
+    writeFileContentString(path, "c");
 }
 
-void AMDGPUAdapterHandle::setOverdriveCoreParam(int index, unsigned int coreOD) const
+void AMDGPUAdapterHandle::resetODClockVoltage(int index) const
 {
-    char dbuf[120];
-    unsigned int cardIndex = amdDevices[index];
+    const char* path = attributePaths[index].get(AMDGPUAttribute::PP_OD_CLK_VOLTAGE);
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_sclk_od", cardIndex);
+    writeFileContentString(path, "r");
+    writeFileContentString(path, "c");
+}
+
+unsigned int AMDGPUAdapterHandle::getCriticalTemperature(int index) const
+{
+    unsigned int temperature;
 
-    writeFileContentValue(dbuf, coreOD);
+    getFileContentValue(attributePaths[index].get(AMDGPUAttribute::TEMP1_CRIT), temperature);
+
+    return temperature;
 }
 
-void AMDGPUAdapterHandle::setOverdriveMemoryParam(int index, unsigned int memoryOD) const
+bool AMDGPUAdapterHandle::getPowerCap(int index, unsigned int& powerCap) const
 {
-    char dbuf[120];
-    unsigned int cardIndex = amdDevices[index];
+    return getOptionalFileContentValue(attributePaths[index].get(AMDGPUAttribute::POWER1_CAP), powerCap);
+}
+
+bool AMDGPUAdapterHandle::getPowerCapRange(int index, unsigned int& powerCapMin, unsigned int& powerCapMax) const
+{
+    const AMDGPUAttributePaths& paths = attributePaths[index];
+    unsigned int powerCap;
+
+    powerCapMin = powerCapMax = 0;
 
-    snprintf(dbuf, 120, "/sys/class/drm/card%u/device/pp_mclk_od", cardIndex);
+    if (!getOptionalFileContentValue(paths.get(AMDGPUAttribute::POWER1_CAP), powerCap))
+    {
+        return false;
+    }
+
+    getOptionalFileContentValue(paths.get(AMDGPUAttribute::POWER1_CAP_MIN), powerCapMin);
+
+    getOptionalFileContentValue(paths.get(AMDGPUAttribute::POWER1_CAP_MAX), powerCapMax);
+
+    return true;
+}
+
+void AMDGPUAdapterHandle::setPowerCap(int index, unsigned int powerCap) const
+{
+    writeFileContentValue(attributePaths[index].get(AMDGPUAttribute::POWER1_CAP), powerCap);
+}
+
+/* the driver restores the default power limit when 0 is written */
+void AMDGPUAdapterHandle::setPowerCapToDefault(int index) const
+{
+    setPowerCap(index, 0);
+}
+
+bool AMDGPUAdapterHandle::getMemoryUsage(int index, AMDGPUMemoryUsage& usage) const
+{
+    static const struct
+    {
+        AMDGPUAttribute attribute;
+        unsigned long long AMDGPUMemoryUsage::*value;
+    } attributes[] =
+    {
+        { AMDGPUAttribute::MEM_INFO_VRAM_TOTAL, &AMDGPUMemoryUsage::vramTotal },
+        { AMDGPUAttribute::MEM_INFO_VRAM_USED, &AMDGPUMemoryUsage::vramUsed },
+        { AMDGPUAttribute::MEM_INFO_VIS_VRAM_TOTAL, &AMDGPUMemoryUsage::visibleVramTotal },
+        { AMDGPUAttribute::MEM_INFO_VIS_VRAM_USED, &AMDGPUMemoryUsage::visibleVramUsed },
+        { AMDGPUAttribute::MEM_INFO_GTT_TOTAL, &AMDGPUMemoryUsage::gttTotal },
+        { AMDGPUAttribute::MEM_INFO_GTT_USED, &AMDGPUMemoryUsage::gttUsed }
+    };
+
+    usage.available = false;
+
+    for (const auto& attribute: attributes)
+    {
+        if (getOptionalFileContentValue(attributePaths[index].get(attribute.attribute), usage.*attribute.value))
+        {
+            usage.available = true;
+        }
+    }
+
+    return usage.available;
+}
+
+int AMDGPUAdapterHandle::getGPULoad(int index) const
+{
+    unsigned int load;
+
+    return getOptionalFileContentValue(attributePaths[index].get(AMDGPUAttribute::GPU_BUSY_PERCENT), load) ? int(load) : -1;
+}
+
+int AMDGPUAdapterHandle::getMemoryLoad(int index) const
+{
+    unsigned int load;
+
+    return getOptionalFileContentValue(attributePaths[index].get(AMDGPUAttribute::MEM_BUSY_PERCENT), load) ? int(load) : -1;
+}
+
+bool AMDGPUAdapterHandle::getPMInfo(int index, AMDGPUPMInfo& pmInfo) const
+{
+    const char* path = attributePaths[index].getPMInfo();
+
+    TimingTrace::Span span("read", "read", path);
+    IOStats::Scope stats(path, IOStats::Operation::READ);
+
+    std::ifstream ifs(path, std::ios::binary);
+
+    if (!ifs)
+    {
+        stats.setFailed();
+        pmInfo = AMDGPUPMInfo();
+        return false;
+    }
+
+    AMDGPUPMInfo::Parse(ifs, pmInfo);
+
+    return pmInfo.isAvailable();
+}
+
+bool AMDGPUAdapterHandle::getPowerProfiles(int index, AMDGPUPowerProfileTable& table) const
+{
+    const char* path = attributePaths[index].get(AMDGPUAttribute::PP_POWER_PROFILE_MODE);
+
+    TimingTrace::Span span("read", "read", path);
+    IOStats::Scope stats(path, IOStats::Operation::READ);
+
+    std::ifstream ifs(path, std::ios::binary);
+
+    if (!ifs)
+    {
+        stats.setFailed();
+        table = AMDGPUPowerProfileTable();
+        return false;
+    }
+
+    AMDGPUPowerProfileTable::Parse(ifs, table);
+
+    return table.isAvailable();
+}
+
+void AMDGPUAdapterHandle::setPowerProfile(int index, const std::string& command) const
+{
+    writeFileContentString(attributePaths[index].get(AMDGPUAttribute::PP_POWER_PROFILE_MODE), command);
+}
+
+bool AMDGPUAdapterHandle::getPerformanceLevel(int index, std::string& level) const
+{
+    return getFileContentString(attributePaths[index].get(AMDGPUAttribute::PERFORMANCE_LEVEL), level);
+}
+
+void AMDGPUAdapterHandle::setPerformanceLevel(int index, const std::string& level) const
+{
+    writeFileContentString(attributePaths[index].get(AMDGPUAttribute::PERFORMANCE_LEVEL), level);
+}
+
+unsigned int AMDGPUAdapterHandle::getDPMStatesNum(int index, DPMDomain domain) const
+{
+    return countDPMStates(attributePaths[index].get(getDPMAttribute(domain)));
+}
+
+void AMDGPUAdapterHandle::setDPMStatesMask(int index, DPMDomain domain, const std::vector<int>& states) const
+{
+    std::string mask;
+
+    for (int state: states)
+    {
+        mask += (mask.empty() ? "" : " ") + std::to_string(state);
+    }
+
+    writeFileContentString(attributePaths[index].get(getDPMAttribute(domain)), mask);
+}
+
+/* board power, power1_average on older kernels and power1_input on newer ones */
+int AMDGPUAdapterHandle::getPower(int index) const
+{
+    const AMDGPUAttributePaths& paths = attributePaths[index];
+    unsigned int power;
+
+    if (getOptionalFileContentValue(paths.get(AMDGPUAttribute::POWER1_AVERAGE), power))
+    {
+        return int(power);
+    }
+
+    if (getOptionalFileContentValue(paths.get(AMDGPUAttribute::POWER1_INPUT), power))
+    {
+        return int(power);
+    }
+
+    return -1;
+}
+
+unsigned int AMDGPUAdapterHandle::getTemperature(int index) const
+{
+    unsigned int temperature;
+
+    getFileContentValue(attributePaths[index].get(AMDGPUAttribute::TEMP1_INPUT), temperature);
+
+    return temperature;
+}
+
+void AMDGPUAdapterHandle::getCurrentClocks(int index, unsigned int& coreClock, unsigned int& memoryClock) const
+{
+    unsigned int highestClock;
+
+    getDPMClock(index, DPMDomain::CORE, coreClock, highestClock);
+    getDPMClock(index, DPMDomain::MEMORY, memoryClock, highestClock);
+}
+
+void AMDGPUAdapterHandle::getDPMClock(int index, DPMDomain domain, unsigned int& activeClock, unsigned int& highestClock) const
+{
+    unsigned int activeClockIndex;
+
+    const std::vector<unsigned int> clocks = parseDPMFile(attributePaths[index].get(getDPMAttribute(domain)), activeClockIndex);
+
+    activeClock = (activeClockIndex != UINT_MAX) ? clocks[activeClockIndex] : 0;
+    highestClock = clocks.empty() ? 0 : *std::max_element(clocks.begin(), clocks.end());
+}
+
+/* fanN_enable (manual RPM control of fanrpm) is written before the PWM mode, a target
+ * in manual RPM mode after it, since writing pwmN would override the target */
+void AMDGPUAdapterHandle::getFanRestoreWrites(const AMDGPUAttributePaths& paths, unsigned int controllerIndex,
+                                              std::vector<AMDGPUSysfsWrite>& writes)
+{
+    const char* fanEnablePath = paths.getChannel(AMDGPUChannelAttribute::FAN_ENABLE, controllerIndex);
+    const char* fanTargetPath = paths.getChannel(AMDGPUChannelAttribute::FAN_TARGET, controllerIndex);
+    const char* pwmEnablePath = paths.getChannel(AMDGPUChannelAttribute::PWM_ENABLE, controllerIndex);
+    unsigned int fanEnable, fanTarget, pwmEnable, pwm;
+
+    const bool hasFanEnable = getOptionalFileContentValue(fanEnablePath, fanEnable);
+    const bool rpmMode = hasFanEnable && fanEnable == 1 && getOptionalFileContentValue(fanTargetPath, fanTarget);
+
+    if (hasFanEnable && !rpmMode)
+    {
+        writes.push_back(AMDGPUSysfsWrite{ fanEnablePath, std::to_string(fanEnable) });
+    }
+
+    if (getOptionalFileContentValue(pwmEnablePath, pwmEnable))
+    {
+        writes.push_back(AMDGPUSysfsWrite{ pwmEnablePath, std::to_string(pwmEnable) });
+
+        // fan speed is kept only in manual mode
+        if (pwmEnable == 1 && !rpmMode &&
+            getOptionalFileContentValue(paths.getChannel(AMDGPUChannelAttribute::PWM, controllerIndex), pwm))
+        {
+            writes.push_back(AMDGPUSysfsWrite{ paths.getChannel(AMDGPUChannelAttribute::PWM, controllerIndex), std::to_string(pwm) });
+        }
+    }
+
+    if (rpmMode)
+    {
+        writes.push_back(AMDGPUSysfsWrite{ fanEnablePath, "1" });
+        writes.push_back(AMDGPUSysfsWrite{ fanTargetPath, std::to_string(fanTarget) });
+    }
+}
+
+/* The masks of DPM states can not be read back, so a manual performance level is
+ * restored through 'auto', which enables all states again. */
+void AMDGPUAdapterHandle::getRestoreWrites(int index, std::vector<AMDGPUSysfsWrite>& writes) const
+{
+    const AMDGPUAttributePaths& paths = attributePaths[index];
+    unsigned int value;
+
+    writes.clear();
+
+    AMDGPUODTable table;
+
+    if (getODClockVoltage(index, table))
+    {
+        for (std::vector<AMDGPUODLevel>* levels: { &table.coreLevels, &table.memoryLevels, &table.voltageCurve })
+        {
+            for (AMDGPUODLevel& level: *levels)
+            {
+                level.changed = true;
+            }
+        }
+
+        std::vector<std::string> commands;
+        table.getCommands(commands);
+        commands.push_back("c");
+
+        for (const std::string& command: commands)
+        {
+            writes.push_back(AMDGPUSysfsWrite{ paths.get(AMDGPUAttribute::PP_OD_CLK_VOLTAGE), command });
+        }
+    }
+
+    for (AMDGPUAttribute attribute: { AMDGPUAttribute::PP_SCLK_OD, AMDGPUAttribute::PP_MCLK_OD, AMDGPUAttribute::POWER1_CAP })
+    {
+        if (getOptionalFileContentValue(paths.get(attribute), value))
+        {
+            writes.push_back(AMDGPUSysfsWrite{ paths.get(attribute), std::to_string(value) });
+        }
+    }
+
+    for (unsigned int i = 0; i < paths.getChannelsNum(); i++)
+    {
+        getFanRestoreWrites(paths, i, writes);
+    }
+
+    std::string perfLevel;
+
+    if (!getPerformanceLevel(index, perfLevel))
+    {
+        return;
+    }
+
+    const std::string perfLevelPath = paths.get(AMDGPUAttribute::PERFORMANCE_LEVEL);
+    AMDGPUPowerProfileTable profiles;
+    const AMDGPUPowerProfile* activeProfile = getPowerProfiles(index, profiles) ? profiles.getActive() : nullptr;
+
+    if (activeProfile != nullptr)
+    {
+        std::vector<std::string> commands;
+        activeProfile->getCommands(commands);
+
+        // power profile is written only in manual performance level
+        writes.push_back(AMDGPUSysfsWrite{ perfLevelPath, "manual" });
+
+        for (const std::string& command: commands)
+        {
+            writes.push_back(AMDGPUSysfsWrite{ paths.get(AMDGPUAttribute::PP_POWER_PROFILE_MODE), command });
+        }
+    }
+
+    if (perfLevel == "manual")
+    {
+        writes.push_back(AMDGPUSysfsWrite{ perfLevelPath, "auto" });
+    }
 
-    writeFileContentValue(dbuf, memoryOD);
+    writes.push_back(AMDGPUSysfsWrite{ perfLevelPath, perfLevel });
 }
@@ -0,0 +1,191 @@
+#include "amdgpuattributes.h"
+
+#include <cstring>
+#include <unistd.h>
+
+#include "error.h"
+
+/* adding an attribute needs only its enum value and its entry here */
+static const AMDGPUAttributeDescriptor descriptors[] =
+{
+    { AMDGPUAttribute::VENDOR, AMDGPUAttributeBase::DEVICE, "vendor", AMDGPUAttributeFormat::VALUE, "", 1.0 },
+    { AMDGPUAttribute::DEVICE_ID, AMDGPUAttributeBase::DEVICE, "device", AMDGPUAttributeFormat::VALUE, "", 1.0 },
+    { AMDGPUAttribute::PP_SCLK_OD, AMDGPUAttributeBase::DEVICE, "pp_sclk_od", AMDGPUAttributeFormat::VALUE, "%", 1.0 },
+    { AMDGPUAttribute::PP_MCLK_OD, AMDGPUAttributeBase::DEVICE, "pp_mclk_od", AMDGPUAttributeFormat::VALUE, "%", 1.0 },
+    { AMDGPUAttribute::PP_DPM_SCLK, AMDGPUAttributeBase::DEVICE, "pp_dpm_sclk", AMDGPUAttributeFormat::TABLE, "MHz", 1.0 },
+    { AMDGPUAttribute::PP_DPM_MCLK, AMDGPUAttributeBase::DEVICE, "pp_dpm_mclk", AMDGPUAttributeFormat::TABLE, "MHz", 1.0 },
+    { AMDGPUAttribute::PP_DPM_PCIE, AMDGPUAttributeBase::DEVICE, "pp_dpm_pcie", AMDGPUAttributeFormat::TABLE, "", 1.0 },
+    { AMDGPUAttribute::PP_OD_CLK_VOLTAGE, AMDGPUAttributeBase::DEVICE, "pp_od_clk_voltage", AMDGPUAttributeFormat::TABLE, "", 1.0 },
+    { AMDGPUAttribute::PP_POWER_PROFILE_MODE, AMDGPUAttributeBase::DEVICE, "pp_power_profile_mode", AMDGPUAttributeFormat::TABLE,
+      "", 1.0 },
+    { AMDGPUAttribute::PERFORMANCE_LEVEL, AMDGPUAttributeBase::DEVICE, "power_dpm_force_performance_level",
+      AMDGPUAttributeFormat::STRING, "", 1.0 },
+    { AMDGPUAttribute::GPU_BUSY_PERCENT, AMDGPUAttributeBase::DEVICE, "gpu_busy_percent", AMDGPUAttributeFormat::VALUE, "%", 1.0 },
+    { AMDGPUAttribute::MEM_BUSY_PERCENT, AMDGPUAttributeBase::DEVICE, "mem_busy_percent", AMDGPUAttributeFormat::VALUE, "%", 1.0 },
+    { AMDGPUAttribute::MEM_INFO_VRAM_TOTAL, AMDGPUAttributeBase::DEVICE, "mem_info_vram_total", AMDGPUAttributeFormat::VALUE,
+      "MiB", 1.0 / 1048576.0 },
+    { AMDGPUAttribute::MEM_INFO_VRAM_USED, AMDGPUAttributeBase::DEVICE, "mem_info_vram_used", AMDGPUAttributeFormat::VALUE,
+      "MiB", 1.0 / 1048576.0 },
+    { AMDGPUAttribute::MEM_INFO_VIS_VRAM_TOTAL, AMDGPUAttributeBase::DEVICE, "mem_info_vis_vram_total", AMDGPUAttributeFormat::VALUE,
+      "MiB", 1.0 / 1048576.0 },
+    { AMDGPUAttribute::MEM_INFO_VIS_VRAM_USED, AMDGPUAttributeBase::DEVICE, "mem_info_vis_vram_used", AMDGPUAttributeFormat::VALUE,
+      "MiB", 1.0 / 1048576.0 },
+    { AMDGPUAttribute::MEM_INFO_GTT_TOTAL, AMDGPUAttributeBase::DEVICE, "mem_info_gtt_total", AMDGPUAttributeFormat::VALUE,
+      "MiB", 1.0 / 1048576.0 },
+    { AMDGPUAttribute::MEM_INFO_GTT_USED, AMDGPUAttributeBase::DEVICE, "mem_info_gtt_used", AMDGPUAttributeFormat::VALUE,
+      "MiB", 1.0 / 1048576.0 },
+    { AMDGPUAttribute::TEMP1_INPUT, AMDGPUAttributeBase::HWMON, "temp1_input", AMDGPUAttributeFormat::VALUE, "C", 0.001 },
+    { AMDGPUAttribute::TEMP1_CRIT, AMDGPUAttributeBase::HWMON, "temp1_crit", AMDGPUAttributeFormat::VALUE, "C", 0.001 },
+    { AMDGPUAttribute::TEMP2_INPUT, AMDGPUAttributeBase::HWMON, "temp2_input", AMDGPUAttributeFormat::VALUE, "C", 0.001 },
+    { AMDGPUAttribute::TEMP2_CRIT, AMDGPUAttributeBase::HWMON, "temp2_crit", AMDGPUAttributeFormat::VALUE, "C", 0.001 },
+    { AMDGPUAttribute::TEMP3_INPUT, AMDGPUAttributeBase::HWMON, "temp3_input", AMDGPUAttributeFormat::VALUE, "C", 0.001 },
+    { AMDGPUAttribute::TEMP3_CRIT, AMDGPUAttributeBase::HWMON, "temp3_crit", AMDGPUAttributeFormat::VALUE, "C", 0.001 },
+    { AMDGPUAttribute::POWER1_AVERAGE, AMDGPUAttributeBase::HWMON, "power1_average", AMDGPUAttributeFormat::VALUE, "W", 0.000001 },
+    { AMDGPUAttribute::POWER1_INPUT, AMDGPUAttributeBase::HWMON, "power1_input", AMDGPUAttributeFormat::VALUE, "W", 0.000001 },
+    { AMDGPUAttribute::POWER1_CAP, AMDGPUAttributeBase::HWMON, "power1_cap", AMDGPUAttributeFormat::VALUE, "W", 0.000001 },
+    { AMDGPUAttribute::POWER1_CAP_MIN, AMDGPUAttributeBase::HWMON, "power1_cap_min", AMDGPUAttributeFormat::VALUE, "W", 0.000001 },
+    { AMDGPUAttribute::POWER1_CAP_MAX, AMDGPUAttributeBase::HWMON, "power1_cap_max", AMDGPUAttributeFormat::VALUE, "W", 0.000001 },
+    { AMDGPUAttribute::PWM1, AMDGPUAttributeBase::HWMON, "pwm1", AMDGPUAttributeFormat::VALUE, "", 1.0 },
+    { AMDGPUAttribute::PWM1_ENABLE, AMDGPUAttributeBase::HWMON, "pwm1_enable", AMDGPUAttributeFormat::VALUE, "", 1.0 },
+    { AMDGPUAttribute::PWM1_MIN, AMDGPUAttributeBase::HWMON, "pwm1_min", AMDGPUAttributeFormat::VALUE, "", 1.0 },
+    { AMDGPUAttribute::PWM1_MAX, AMDGPUAttributeBase::HWMON, "pwm1_max", AMDGPUAttributeFormat::VALUE, "", 1.0 },
+    { AMDGPUAttribute::FAN1_ENABLE, AMDGPUAttributeBase::HWMON, "fan1_enable", AMDGPUAttributeFormat::VALUE, "", 1.0 },
+    { AMDGPUAttribute::FAN1_INPUT, AMDGPUAttributeBase::HWMON, "fan1_input", AMDGPUAttributeFormat::VALUE, "RPM", 1.0 }
+};
+
+static_assert(sizeof(descriptors) / sizeof(descriptors[0]) == size_t(AMDGPUAttribute::COUNT),
+              "every attribute needs a descriptor");
+
+static const AMDGPUChannelAttributeDescriptor channelDescriptors[] =
+{
+    { AMDGPUChannelAttribute::PWM, "pwm", "" },
+    { AMDGPUChannelAttribute::PWM_ENABLE, "pwm", "_enable" },
+    { AMDGPUChannelAttribute::PWM_MIN, "pwm", "_min" },
+    { AMDGPUChannelAttribute::PWM_MAX, "pwm", "_max" },
+    { AMDGPUChannelAttribute::FAN_INPUT, "fan", "_input" },
+    { AMDGPUChannelAttribute::FAN_TARGET, "fan", "_target" },
+    { AMDGPUChannelAttribute::FAN_ENABLE, "fan", "_enable" },
+    { AMDGPUChannelAttribute::FAN_MIN, "fan", "_min" },
+    { AMDGPUChannelAttribute::FAN_MAX, "fan", "_max" }
+};
+
+static_assert(sizeof(channelDescriptors) / sizeof(channelDescriptors[0]) == size_t(AMDGPUChannelAttribute::COUNT),
+              "every channel attribute needs a descriptor");
+
+AMDGPUAttributePaths::AMDGPUAttributePaths(unsigned int cardIndex, unsigned int hwmonIndex) :
+    devicePath("/sys/class/drm/card" + std::to_string(cardIndex) + "/device"),
+    hwmonPath(devicePath + "/hwmon/hwmon" + std::to_string(hwmonIndex)),
+    pmInfoPath("/sys/kernel/debug/dri/" + std::to_string(cardIndex) + "/amdgpu_pm_info")
+{
+    paths.reserve(size_t(AMDGPUAttribute::COUNT));
+
+    for (const AMDGPUAttributeDescriptor& descriptor: descriptors)
+    {
+        const std::string& base = (descriptor.base == AMDGPUAttributeBase::HWMON) ? hwmonPath : devicePath;
+
+        paths.push_back(base + "/" + descriptor.name);
+    }
+
+    // controllers are numbered from pwm1 without gaps
+    for (unsigned int channel = 1; ::access((hwmonPath + "/pwm" + std::to_string(channel)).c_str(), F_OK) == 0; channel++)
+    {
+        for (const AMDGPUChannelAttributeDescriptor& descriptor: channelDescriptors)
+        {
+            channelPaths.push_back(hwmonPath + "/" + descriptor.type + std::to_string(channel) + descriptor.suffix);
+        }
+    }
+}
+
+const char* AMDGPUAttributePaths::getChannel(AMDGPUChannelAttribute attribute, unsigned int controllerIndex) const
+{
+    if (controllerIndex >= getChannelsNum())
+    {
+        throw Error(("Thermal controller " + std::to_string(controllerIndex) + " is not present").c_str());
+    }
+
+    return channelPaths[controllerIndex * size_t(AMDGPUChannelAttribute::COUNT) + size_t(attribute)].c_str();
+}
+
+/* attributes are files of the device or hwmon directory, so the name is the file name */
+bool AMDGPUAttributePaths::findName(const std::string& path, std::string& name) const
+{
+    for (const std::vector<std::string>* table: { &paths, &channelPaths })
+    {
+        for (const std::string& tablePath: *table)
+        {
+            if (tablePath == path)
+            {
+                name = path.substr(path.rfind('/') + 1);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+const char* AMDGPUAttributePaths::findPath(const std::string& name) const
+{
+    for (const std::vector<std::string>* table: { &paths, &channelPaths })
+    {
+        for (const std::string& path: *table)
+        {
+            if (path.size() > name.size() && path.compare(path.size() - name.size(), name.size(), name) == 0 &&
+                path[path.size() - name.size() - 1] == '/')
+            {
+                return path.c_str();
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+const AMDGPUAttributeDescriptor& AMDGPUAttributePaths::GetDescriptor(AMDGPUAttribute attribute)
+{
+    return descriptors[int(attribute)];
+}
+
+bool AMDGPUAttributePaths::IsName(const std::string& name)
+{
+    AMDGPUAttribute attribute;
+
+    if (FindName(name, attribute))
+    {
+        return true;
+    }
+
+    // type, channel from 1 without leading zeros, suffix
+    for (const AMDGPUChannelAttributeDescriptor& descriptor: channelDescriptors)
+    {
+        const size_t typeLength = ::strlen(descriptor.type);
+        const size_t suffixLength = ::strlen(descriptor.suffix);
+
+        if (name.size() > typeLength + suffixLength && name.compare(0, typeLength, descriptor.type) == 0 &&
+            name.compare(name.size() - suffixLength, suffixLength, descriptor.suffix) == 0)
+        {
+            const std::string channel = name.substr(typeLength, name.size() - typeLength - suffixLength);
+
+            if (channel[0] != '0' && channel.find_first_not_of("0123456789") == std::string::npos)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool AMDGPUAttributePaths::FindName(const std::string& name, AMDGPUAttribute& attribute)
+{
+    for (const AMDGPUAttributeDescriptor& descriptor: descriptors)
+    {
+        if (name == descriptor.name)
+        {
+            attribute = descriptor.attribute;
+            return true;
+        }
+    }
+
+    return false;
+}
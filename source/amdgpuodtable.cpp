@@ -0,0 +1,232 @@
+#include "amdgpuodtable.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "error.h"
+#include "structs.h"
+
+AMDGPUODTable::AMDGPUODTable()
+{
+    coreClockRange = memoryClockRange = voltageRange = AMDGPUODRange{ 0, 0, false };
+}
+
+static void appendLevelCommands(std::vector<std::string>& commands, const char* command, const std::vector<AMDGPUODLevel>& levels,
+                                bool withVoltage)
+{
+    for (const AMDGPUODLevel& level: levels)
+    {
+        if (!level.changed)
+        {
+            continue;
+        }
+
+        std::string text = std::string(command) + " " + std::to_string(level.index) + " " + std::to_string(level.clock);
+
+        if (withVoltage && level.voltage != 0)
+        {
+            text += " " + std::to_string(level.voltage);
+        }
+
+        commands.push_back(text);
+    }
+}
+
+void AMDGPUODTable::getCommands(std::vector<std::string>& commands) const
+{
+    // voltages of Vega20/Navi are given only by the curve
+    const bool levelVoltages = voltageCurve.empty();
+
+    appendLevelCommands(commands, "s", coreLevels, levelVoltages);
+    appendLevelCommands(commands, "m", memoryLevels, levelVoltages);
+    appendLevelCommands(commands, "vc", voltageCurve, true);
+}
+
+AMDGPUODLevel* AMDGPUODTable::FindLevel(std::vector<AMDGPUODLevel>& levels, int partId)
+{
+    return const_cast<AMDGPUODLevel*>(FindLevel(static_cast<const std::vector<AMDGPUODLevel>&>(levels), partId));
+}
+
+const AMDGPUODLevel* AMDGPUODTable::FindLevel(const std::vector<AMDGPUODLevel>& levels, int partId)
+{
+    if (levels.empty())
+    {
+        return nullptr;
+    }
+
+    if (partId == LAST_PERFLEVEL)
+    {
+        return &levels.back();
+    }
+
+    for (const AMDGPUODLevel& level: levels)
+    {
+        if (int(level.index) == partId)
+        {
+            return &level;
+        }
+    }
+
+    return nullptr;
+}
+
+/* parses number with unit ('300MHz', '300Mhz', '800mV'), returns false if no number */
+static bool parseValue(const char*& p, unsigned int& value)
+{
+    while (*p == ' ' || *p == '\t')
+    {
+        p++;
+    }
+
+    char* end;
+    errno = 0;
+    value = ::strtoul(p, &end, 10);
+
+    if (errno != 0 || end == p)
+    {
+        return false;
+    }
+
+    p = end;
+
+    while (::isalpha(*p))
+    {
+        p++;
+    }
+
+    return true;
+}
+
+void AMDGPUODTable::Parse(std::istream& is, AMDGPUODTable& table)
+{
+    enum class Section
+    {
+        NONE,
+        CORE,
+        MEMORY,
+        VOLTAGE_CURVE,
+        RANGE
+    };
+
+    Section section = Section::NONE;
+    std::string line;
+
+    table = AMDGPUODTable();
+
+    while (std::getline(is, line))
+    {
+        const char* p = line.c_str();
+
+        if (::strncmp(p, "OD_", 3) == 0)
+        {
+            if (::strncmp(p, "OD_SCLK:", 8) == 0)
+            {
+                section = Section::CORE;
+            }
+            else if (::strncmp(p, "OD_MCLK:", 8) == 0)
+            {
+                section = Section::MEMORY;
+            }
+            else if (::strncmp(p, "OD_VDDC_CURVE:", 14) == 0)
+            {
+                section = Section::VOLTAGE_CURVE;
+            }
+            else if (::strncmp(p, "OD_RANGE:", 9) == 0)
+            {
+                section = Section::RANGE;
+            }
+            else
+            {
+                section = Section::NONE; // not supported, for example OD_VDDGFX_OFFSET
+            }
+
+            continue;
+        }
+
+        if (section == Section::NONE || line.empty())
+        {
+            continue;
+        }
+
+        if (section == Section::RANGE)
+        {
+            const char* colon = ::strchr(p, ':');
+            AMDGPUODRange range{ 0, 0, true };
+
+            if (colon == nullptr)
+            {
+                throw Error("Unable to parse OD_RANGE in pp_od_clk_voltage.");
+            }
+
+            std::string name(p, colon);
+            p = colon + 1;
+
+            if (!parseValue(p, range.min) || !parseValue(p, range.max))
+            {
+                throw Error("Unable to parse OD_RANGE in pp_od_clk_voltage.");
+            }
+
+            if (name == "SCLK")
+            {
+                table.coreClockRange = range;
+            }
+            else if (name == "MCLK")
+            {
+                table.memoryClockRange = range;
+            }
+            else if (name == "VDDC" || name.compare(0, 16, "VDDC_CURVE_VOLT[") == 0)
+            {
+                // one range for all points of the voltage curve
+                if (table.voltageRange.isSet)
+                {
+                    range.min = std::min(range.min, table.voltageRange.min);
+                    range.max = std::max(range.max, table.voltageRange.max);
+                }
+
+                table.voltageRange = range;
+            }
+
+            continue;
+        }
+
+        AMDGPUODLevel level{ 0, 0, 0, false };
+        char* end;
+        errno = 0;
+        level.index = ::strtoul(p, &end, 10);
+
+        if (errno != 0 || end == p || *end != ':')
+        {
+            throw Error("Unable to parse level index in pp_od_clk_voltage.");
+        }
+
+        p = end + 1;
+
+        if (!parseValue(p, level.clock))
+        {
+            throw Error("Unable to parse clock in pp_od_clk_voltage.");
+        }
+
+        parseValue(p, level.voltage);
+
+        switch(section)
+        {
+            case Section::CORE:
+
+                table.coreLevels.push_back(level);
+                break;
+
+            case Section::MEMORY:
+
+                table.memoryLevels.push_back(level);
+                break;
+
+            default:
+
+                table.voltageCurve.push_back(level);
+                break;
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "amdgpupminfo.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+AMDGPUPMInfo::AMDGPUPMInfo() : coreClock(-1), memoryClock(-1), vddgfx(-1), gfxPower(-1.0), temperature(-1), gpuLoad(-1),
+    memoryLoad(-1)
+{}
+
+static bool startsWithNoCase(const char* p, const char* end, const char* prefix)
+{
+    const size_t length = ::strlen(prefix);
+
+    return size_t(end - p) >= length && ::strncasecmp(p, prefix, length) == 0;
+}
+
+/* '<value> <unit> (<name>)' */
+static void parseValueLine(const char* p, const char* end, AMDGPUPMInfo& info)
+{
+    char* valueEnd;
+    errno = 0;
+    const double value = ::strtod(p, &valueEnd);
+
+    if (errno != 0 || valueEnd == p)
+    {
+        return;
+    }
+
+    p = valueEnd;
+
+    while (p < end && *p == ' ')
+    {
+        p++;
+    }
+
+    const char* unit = p;
+
+    while (p < end && *p != ' ' && *p != '(')
+    {
+        p++;
+    }
+
+    const std::string unitName(unit, p);
+
+    while (p < end && *p == ' ')
+    {
+        p++;
+    }
+
+    if (p == end || *p != '(')
+    {
+        return;
+    }
+
+    const char* nameEnd = static_cast<const char*>(::memchr(p, ')', end - p));
+
+    if (nameEnd == nullptr)
+    {
+        return;
+    }
+
+    const std::string name(p + 1, nameEnd);
+
+    if (name == "SCLK")
+    {
+        info.coreClock = int(value);
+    }
+    else if (name == "MCLK")
+    {
+        info.memoryClock = int(value);
+    }
+    else if (name == "VDDGFX")
+    {
+        info.vddgfx = int((unitName == "V") ? value * 1000.0 + 0.5 : value);
+    }
+    else if (name == "average GPU")
+    {
+        info.gfxPower = value;
+    }
+}
+
+/* '<key>: <value>' */
+static void parseKeyLine(const char* p, const char* end, AMDGPUPMInfo& info)
+{
+    static const struct
+    {
+        const char* key;
+        int AMDGPUPMInfo::*field;
+    } keys[] =
+    {
+        { "GPU Load:", &AMDGPUPMInfo::gpuLoad },
+        { "MEM Load:", &AMDGPUPMInfo::memoryLoad },
+        { "GPU Temperature:", &AMDGPUPMInfo::temperature }
+    };
+
+    for (const auto& key: keys)
+    {
+        if (startsWithNoCase(p, end, key.key))
+        {
+            char* valueEnd;
+            const char* value = p + ::strlen(key.key);
+            errno = 0;
+            const long parsed = ::strtol(value, &valueEnd, 10);
+
+            if (errno == 0 && valueEnd != value)
+            {
+                info.*key.field = int(parsed);
+            }
+
+            return;
+        }
+    }
+}
+
+void AMDGPUPMInfo::Parse(std::istream& is, AMDGPUPMInfo& info)
+{
+    info = AMDGPUPMInfo();
+
+    const std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    const char* p = text.c_str();
+    const char* const textEnd = p + text.size();
+
+    while (p < textEnd)
+    {
+        const char* end = static_cast<const char*>(::memchr(p, '\n', textEnd - p));
+        end = (end != nullptr) ? end : textEnd;
+
+        while (p < end && (*p == ' ' || *p == '\t'))
+        {
+            p++;
+        }
+
+        if (p < end && (*p >= '0' && *p <= '9'))
+        {
+            parseValueLine(p, end, info);
+        }
+        else if (p < end)
+        {
+            parseKeyLine(p, end, info);
+        }
+
+        p = end + 1;
+    }
+}
@@ -0,0 +1,199 @@
+#include "amdgpupowerprofiletable.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+#include <strings.h>
+
+#include "error.h"
+
+static void tokenize(const std::string& text, std::vector<std::string>& tokens)
+{
+    std::istringstream iss(text);
+    std::string token;
+
+    tokens.clear();
+
+    while (iss >> token)
+    {
+        tokens.push_back(token);
+    }
+}
+
+/* Rows of clock domains start with the domain index and name ('0 GFXCLK 0 5 ...'), they are
+ * written as 'PROFILE DOMAIN VALUES'. A single row is written as 'PROFILE VALUES', unless
+ * some heuristic is not set ('-'), as the driver needs all of them */
+void AMDGPUPowerProfile::getCommands(std::vector<std::string>& commands) const
+{
+    const std::string indexText = std::to_string(index);
+
+    commands.clear();
+
+    if (name != "CUSTOM" || rows.empty())
+    {
+        commands.push_back(indexText);
+        return;
+    }
+
+    for (const std::vector<std::string>& row: rows)
+    {
+        const bool domainRow = row.size() >= 2 && ::isalpha(row[1][0]);
+        std::string command = indexText;
+
+        for (size_t i = 0; i < row.size(); i++)
+        {
+            if (row[i] == "-")
+            {
+                commands.assign(1, indexText);
+                return;
+            }
+
+            if (!domainRow || i != 1)
+            {
+                command += " " + row[i];
+            }
+        }
+
+        commands.push_back(command);
+    }
+}
+
+const AMDGPUPowerProfile* AMDGPUPowerProfileTable::getActive() const
+{
+    for (const AMDGPUPowerProfile& profile: profiles)
+    {
+        if (profile.active)
+        {
+            return &profile;
+        }
+    }
+
+    return nullptr;
+}
+
+const AMDGPUPowerProfile* AMDGPUPowerProfileTable::find(const std::string& nameOrIndex) const
+{
+    char* end;
+    errno = 0;
+    unsigned long index = ::strtoul(nameOrIndex.c_str(), &end, 10);
+    const bool isIndex = errno == 0 && end != nameOrIndex.c_str() && *end == 0;
+
+    for (const AMDGPUPowerProfile& profile: profiles)
+    {
+        if (isIndex ? profile.index == index : ::strcasecmp(profile.name.c_str(), nameOrIndex.c_str()) == 0)
+        {
+            return &profile;
+        }
+    }
+
+    return nullptr;
+}
+
+void AMDGPUPowerProfileTable::Parse(std::istream& is, AMDGPUPowerProfileTable& table)
+{
+    std::string line;
+    std::vector<std::string> tokens;
+
+    table = AMDGPUPowerProfileTable();
+
+    while (std::getline(is, line))
+    {
+        size_t pos = line.find_first_not_of(" \t");
+
+        if (pos == std::string::npos)
+        {
+            continue;
+        }
+
+        if (line.compare(pos, 3, "NUM") == 0)
+        {
+            tokenize(line, tokens);
+
+            // columns after MODE_NAME
+            for (size_t i = 0; i < tokens.size(); i++)
+            {
+                if (tokens[i] == "MODE_NAME")
+                {
+                    table.columns.assign(tokens.begin() + i + 1, tokens.end());
+                    break;
+                }
+            }
+
+            continue;
+        }
+
+        if (!::isdigit(line[pos]))
+        {
+            continue;
+        }
+
+        char* end;
+        errno = 0;
+        unsigned int index = ::strtoul(line.c_str() + pos, &end, 10);
+
+        if (errno != 0)
+        {
+            throw Error("Unable to parse index in pp_power_profile_mode.");
+        }
+
+        pos = end - line.c_str();
+
+        if (line[pos] == '(')
+        {
+            // heuristics of clock domain of previous profile: 'N(  GFXCLK)  values...'
+            if (table.profiles.empty())
+            {
+                throw Error("Unable to parse pp_power_profile_mode.");
+            }
+
+            std::string row = std::to_string(index) + " " + line.substr(pos);
+
+            for (char& c: row)
+            {
+                c = (c == '(' || c == ')') ? ' ' : c;
+            }
+
+            tokenize(row, tokens);
+            table.profiles.back().rows.push_back(tokens);
+            continue;
+        }
+
+        AMDGPUPowerProfile profile;
+        profile.index = index;
+
+        const size_t colon = line.find(':', pos);
+        std::string name = line.substr(pos, colon == std::string::npos ? std::string::npos : colon - pos);
+
+        profile.active = name.find('*') != std::string::npos;
+        tokenize(name, tokens);
+
+        for (const std::string& token: tokens)
+        {
+            profile.name += token;
+        }
+
+        // active mark: 'NAME*' or 'NAME *'
+        if (!profile.name.empty() && profile.name.back() == '*')
+        {
+            profile.name.pop_back();
+        }
+
+        if (profile.name.empty())
+        {
+            throw Error("Unable to parse profile name in pp_power_profile_mode.");
+        }
+
+        if (colon != std::string::npos)
+        {
+            tokenize(line.substr(colon + 1), tokens);
+
+            if (!tokens.empty())
+            {
+                profile.rows.push_back(tokens);
+            }
+        }
+
+        table.profiles.push_back(profile);
+    }
+}
@@ -2,6 +2,7 @@
 
 void AmdGpuProAdapters::PrintInfo(AMDGPUAdapterHandle& handle, const std::vector<int>& choosenAdapters, bool useChoosen)
 {
+    OutputBuffer out;
     int adaptersNum = handle.getAdaptersNum();
     auto choosenIter = choosenAdapters.begin();
     int i = 0;
@@ -16,15 +17,21 @@ void AmdGpuProAdapters::PrintInfo(AMDGPUAdapterHandle& handle, const std::vector
 
         const AMDGPUAdapterInfo adapterInfo = handle.parseAdapterInfo(ai);
 
-        printAdapterSummary(adapterInfo, i);
+        printAdapterSummary(out, adapterInfo, i);
 
-        printGpuLoad(adapterInfo);
+        printGpuLoad(out, adapterInfo);
 
-        printTemperature(adapterInfo);
+        printPower(out, adapterInfo);
 
-        printCoreClocks(adapterInfo);
+        printTemperature(out, adapterInfo);
 
-        printMemoryClocks(adapterInfo);
+        printMemoryUsage(out, adapterInfo.memoryUsage);
+
+        printSensors(out, adapterInfo.sensors, false);
+
+        printCoreClocks(out, adapterInfo);
+
+        printMemoryClocks(out, adapterInfo);
 
         if (useChoosen)
         {
@@ -35,60 +42,295 @@ void AmdGpuProAdapters::PrintInfo(AMDGPUAdapterHandle& handle, const std::vector
     }
 }
 
-void AmdGpuProAdapters::printAdapterSummary(const AMDGPUAdapterInfo adapterInfo, int i)
+void AmdGpuProAdapters::printAdapterSummary(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo, int i)
 {
-    std::cout << "Adapter " << i << ": " << adapterInfo.name << "\n  Core: " << adapterInfo.coreClock << " MHz, Mem: " <<
+    out << "Adapter " << i << ": " << adapterInfo.name << "\n  Core: " << adapterInfo.coreClock << " MHz, Mem: " <<
         adapterInfo.memoryClock << " MHz, CoreOD: " << adapterInfo.coreOD << ", MemOD: " << adapterInfo.memoryOD << ", ";
 
 }
 
-void AmdGpuProAdapters::printGpuLoad(const AMDGPUAdapterInfo adapterInfo)
+void AmdGpuProAdapters::printGpuLoad(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo)
 {
     if (adapterInfo.gpuLoad>=0)
     {
-        std::cout << "Load: " << adapterInfo.gpuLoad << "%, ";
+        out << "Load: " << adapterInfo.gpuLoad << "%, ";
+    }
+}
+
+void AmdGpuProAdapters::printPower(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo)
+{
+    if (adapterInfo.power>=0)
+    {
+        out << "Power: " << adapterInfo.power / 1000000.0 << " W, ";
     }
 }
 
-void AmdGpuProAdapters::printTemperature(const AMDGPUAdapterInfo adapterInfo)
+void AmdGpuProAdapters::printTemperature(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo)
 {
-    std::cout << "Temp: " << adapterInfo.temperature/1000.0 << " C, Fan: " <<
+    out << "Temp: " << adapterInfo.temperature/1000.0 << " C, Fan: " <<
         double(adapterInfo.fanSpeed-adapterInfo.minFanSpeed) / double(adapterInfo.maxFanSpeed - adapterInfo.minFanSpeed) * 100.0 <<
-        "%" << std::endl;
+        "%" << '\n';
+}
+
+static unsigned long toMiB(unsigned long long bytes)
+{
+    return bytes >> 20;
+}
+
+void AmdGpuProAdapters::printMemoryUsage(OutputBuffer& out, const AMDGPUMemoryUsage& usage)
+{
+    if (usage.available)
+    {
+        out << "  VRAM: " << toMiB(usage.vramUsed) << " / " << toMiB(usage.vramTotal) << " MiB, GTT: " << toMiB(usage.gttUsed) <<
+            " / " << toMiB(usage.gttTotal) << " MiB\n";
+    }
+}
+
+static const char* getSensorUnit(const AMDGPUSensor& sensor)
+{
+    if (sensor.type == "temp")
+    {
+        return " C";
+    }
+
+    if (sensor.type == "fan")
+    {
+        return " RPM";
+    }
+
+    return (sensor.type == "in") ? " V" : " W";
+}
+
+/* the short view lists sensors only if hwmon has more than the edge temperature */
+void AmdGpuProAdapters::printSensors(OutputBuffer& out, const std::vector<AMDGPUSensor>& sensors, bool verbose)
+{
+    if (verbose)
+    {
+        for (const AMDGPUSensor& sensor: sensors)
+        {
+            out << "  Sensor " << sensor.label << " (" << sensor.type << sensor.channel << "): " << sensor.value << getSensorUnit(sensor);
+
+            if (!std::isnan(sensor.critical))
+            {
+                out << ", critical " << sensor.critical << " C";
+            }
+
+            if (!std::isnan(sensor.emergency))
+            {
+                out << ", emergency " << sensor.emergency << " C";
+            }
+
+            out << '\n';
+        }
+
+        return;
+    }
+
+    std::string text;
+    unsigned int shownNum = 0;
+
+    for (const AMDGPUSensor& sensor: sensors)
+    {
+        if (sensor.type == "temp" || sensor.type == "fan")
+        {
+            text += (shownNum++ == 0) ? "  Sensors: " : ", ";
+            text += sensor.label + ' ';
+            OutputBuffer::AppendDouble(text, sensor.value);
+            text += getSensorUnit(sensor);
+        }
+    }
+
+    if (shownNum > 1)
+    {
+        out << text << '\n';
+    }
 }
 
-void AmdGpuProAdapters::printCoreClocks(const AMDGPUAdapterInfo adapterInfo)
+void AmdGpuProAdapters::printCoreClocks(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo)
 {
     if (!adapterInfo.coreClocks.empty())
     {
-        std::cout << "  Core clocks: ";
+        out << "  Core clocks: ";
 
         for (uint32_t v: adapterInfo.coreClocks)
         {
-            std::cout << " " << v;
+            out << " " << v;
         }
 
-        std::cout << std::endl;
+        out << '\n';
     }
 }
 
-void AmdGpuProAdapters::printMemoryClocks(const AMDGPUAdapterInfo adapterInfo)
+void AmdGpuProAdapters::printMemoryClocks(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo)
 {
     if (!adapterInfo.memoryClocks.empty())
     {
-        std::cout << "  Memory Clocks: ";
+        out << "  Memory Clocks: ";
 
         for (uint32_t v: adapterInfo.memoryClocks)
         {
-            std::cout << " " << v;
+            out << " " << v;
+        }
+
+        out << '\n';
+    }
+}
+
+void AmdGpuProAdapters::printODLevels(OutputBuffer& out, const char* name, const std::vector<AMDGPUODLevel>& levels)
+{
+    if (levels.empty())
+    {
+        return;
+    }
+
+    out << "  " << name << ":";
+
+    for (const AMDGPUODLevel& level: levels)
+    {
+        out << " " << level.index << ": " << level.clock << " MHz";
+
+        if (level.voltage != 0)
+        {
+            out << " " << level.voltage / 1000.0 << " V";
         }
 
-        std::cout << std::endl;
+        out << (&level != &levels.back() ? "," : "");
+    }
+
+    out << '\n';
+}
+
+void AmdGpuProAdapters::printODRange(OutputBuffer& out, const char* name, const AMDGPUODRange& range, const char* unit)
+{
+    if (range.isSet)
+    {
+        out << "  " << name << ": " << range.min << " - " << range.max << unit << '\n';
+    }
+}
+
+void AmdGpuProAdapters::printODTable(OutputBuffer& out, const AMDGPUAdapterInfo& adapterInfo)
+{
+    const AMDGPUODTable& table = adapterInfo.odTable;
+
+    if (!table.isAvailable())
+    {
+        return;
+    }
+
+    printODLevels(out, "OD Core levels", table.coreLevels);
+    printODLevels(out, "OD Memory levels", table.memoryLevels);
+    printODLevels(out, "OD Voltage curve", table.voltageCurve);
+    printODRange(out, "OD Core clock range", table.coreClockRange, " MHz");
+    printODRange(out, "OD Memory clock range", table.memoryClockRange, " MHz");
+    printODRange(out, "OD Voltage range", table.voltageRange, " mV");
+}
+
+/* only fields given by amdgpu_pm_info */
+void AmdGpuProAdapters::printPMInfo(OutputBuffer& out, const AMDGPUPMInfo& pmInfo)
+{
+    if (!pmInfo.isAvailable())
+    {
+        return;
+    }
+
+    const char* separator = " ";
+
+    out << "  PM info:";
+
+    if (pmInfo.coreClock >= 0)
+    {
+        out << separator << "SCLK: " << pmInfo.coreClock << " MHz";
+        separator = ", ";
+    }
+
+    if (pmInfo.memoryClock >= 0)
+    {
+        out << separator << "MCLK: " << pmInfo.memoryClock << " MHz";
+        separator = ", ";
+    }
+
+    if (pmInfo.vddgfx >= 0)
+    {
+        out << separator << "VDDGFX: " << pmInfo.vddgfx / 1000.0 << " V";
+        separator = ", ";
+    }
+
+    if (pmInfo.gfxPower >= 0.0)
+    {
+        out << separator << "GFX power: " << pmInfo.gfxPower << " W";
+        separator = ", ";
+    }
+
+    if (pmInfo.temperature >= 0)
+    {
+        out << separator << "Temp: " << pmInfo.temperature << " C";
+        separator = ", ";
+    }
+
+    if (pmInfo.gpuLoad >= 0)
+    {
+        out << separator << "GPU load: " << pmInfo.gpuLoad << "%";
+        separator = ", ";
+    }
+
+    if (pmInfo.memoryLoad >= 0)
+    {
+        out << separator << "MEM load: " << pmInfo.memoryLoad << "%";
+    }
+
+    out << '\n';
+}
+
+static void appendRows(std::string& text, const std::vector<std::vector<std::string> >& rows)
+{
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        text += (i != 0) ? "; " : "";
+
+        for (size_t j = 0; j < rows[i].size(); j++)
+        {
+            text += (j != 0) ? " " : "";
+            text += rows[i][j];
+        }
+    }
+}
+
+/* one line per profile, the active profile is marked with '*' */
+void AmdGpuProAdapters::printPowerProfiles(OutputBuffer& out, const AMDGPUPowerProfileTable& table)
+{
+    if (!table.isAvailable())
+    {
+        return;
+    }
+
+    out << "  Power profiles:";
+
+    for (const std::string& column: table.columns)
+    {
+        out << " " << column;
+    }
+
+    out << '\n';
+
+    for (const AMDGPUPowerProfile& profile: table.profiles)
+    {
+        std::string heuristics;
+        appendRows(heuristics, profile.rows);
+
+        out << "   " << (profile.active ? '*' : ' ') << " " << profile.index << ": " << profile.name;
+
+        if (!heuristics.empty())
+        {
+            out << ": " << heuristics;
+        }
+
+        out << '\n';
     }
 }
 
 void AmdGpuProAdapters::PrintInfoVerbose(AMDGPUAdapterHandle& handle, const std::vector<int>& choosenAdapters, bool useChoosen)
 {
+    OutputBuffer out;
     int adaptersNum = handle.getAdaptersNum();
     auto choosenIter = choosenAdapters.begin();
     int i = 0;
@@ -103,7 +345,7 @@ void AmdGpuProAdapters::PrintInfoVerbose(AMDGPUAdapterHandle& handle, const std:
 
         const AMDGPUAdapterInfo adapterInfo = handle.parseAdapterInfo(ai);
 
-        std::cout << "Adapter " << i << ": " << adapterInfo.name << "\n"
+        out << "Adapter " << i << ": " << adapterInfo.name << "\n"
             "  Device Topology: " << adapterInfo.busNo << ':' << adapterInfo.deviceNo << ":" << adapterInfo.funcNo << "\n"
             "  Vendor ID: " << adapterInfo.vendorId << "\n"
             "  Device ID: " << adapterInfo.deviceId << "\n"
@@ -112,9 +354,33 @@ void AmdGpuProAdapters::PrintInfoVerbose(AMDGPUAdapterHandle& handle, const std:
             "  Core Overdrive: " << adapterInfo.coreOD << "\n"
             "  Memory Overdrive: " << adapterInfo.memoryOD << "\n";
 
-        printGpuLoad(adapterInfo);
+        if (adapterInfo.gpuLoad >= 0)
+        {
+            out << "  GPU Load: " << adapterInfo.gpuLoad << "%\n";
+        }
+
+        if (adapterInfo.memoryLoad >= 0)
+        {
+            out << "  Memory Load: " << adapterInfo.memoryLoad << "%\n";
+        }
+
+        if (!adapterInfo.performanceLevel.empty())
+        {
+            out << "  Performance Level: " << adapterInfo.performanceLevel << "\n";
+        }
+
+        if (adapterInfo.power >= 0)
+        {
+            out << "  Power: " << adapterInfo.power / 1000000.0 << " W\n";
+        }
 
-        std::cout << "  Current BusSpeed: " << adapterInfo.busSpeed << "\n"
+        if (adapterInfo.powerCapAvailable)
+        {
+            out << "  Power Cap: " << adapterInfo.powerCap / 1000000.0 << " W (" << adapterInfo.powerCapMin / 1000000.0 << " - " <<
+                adapterInfo.powerCapMax / 1000000.0 << " W)\n";
+        }
+
+        out << "  Current BusSpeed: " << adapterInfo.busSpeed << "\n"
             "  Current BusLanes: " << adapterInfo.busLanes << "\n"
             "  Temperature: " << adapterInfo.temperature / 1000.0 << " C\n"
             "  Critical temperature: " << adapterInfo.tempCritical / 1000.0 << " C\n"
@@ -124,9 +390,26 @@ void AmdGpuProAdapters::PrintInfoVerbose(AMDGPUAdapterHandle& handle, const std:
                 (double(adapterInfo.fanSpeed-adapterInfo.minFanSpeed) / double(adapterInfo.maxFanSpeed-adapterInfo.minFanSpeed)*100.0) << "%\n"
             "  Controlled FanSpeed: " << ( adapterInfo.defaultFanSpeed ? "yes" : "no" ) << "\n";
 
-        printCoreClocks(adapterInfo);
+        if (adapterInfo.memoryUsage.available)
+        {
+            const AMDGPUMemoryUsage& usage = adapterInfo.memoryUsage;
+
+            out << "  VRAM Used: " << toMiB(usage.vramUsed) << " / " << toMiB(usage.vramTotal) << " MiB\n"
+                "  Visible VRAM Used: " << toMiB(usage.visibleVramUsed) << " / " << toMiB(usage.visibleVramTotal) << " MiB\n"
+                "  GTT Used: " << toMiB(usage.gttUsed) << " / " << toMiB(usage.gttTotal) << " MiB\n";
+        }
+
+        printSensors(out, adapterInfo.sensors, true);
+
+        printCoreClocks(out, adapterInfo);
+
+        printMemoryClocks(out, adapterInfo);
 
-        printMemoryClocks(adapterInfo);
+        printODTable(out, adapterInfo);
+
+        printPowerProfiles(out, adapterInfo.powerProfiles);
+
+        printPMInfo(out, adapterInfo.pmInfo);
 
         if (useChoosen)
         {
@@ -134,6 +417,199 @@ void AmdGpuProAdapters::PrintInfoVerbose(AMDGPUAdapterHandle& handle, const std:
         }
 
         i++;
-        std::cout << std::endl;
+        out << '\n';
     }
 }
+
+void AmdGpuProAdapters::PrintInfoStructured(AMDGPUAdapterHandle& handle, const std::vector<int>& choosenAdapters, bool useChoosen, OutputWriter& writer)
+{
+    int adaptersNum = handle.getAdaptersNum();
+    auto choosenIter = choosenAdapters.begin();
+
+    writer.BeginDocument();
+
+    for (int ai = 0; ai < adaptersNum; ai++)
+    {
+        if (useChoosen && (choosenIter == choosenAdapters.end() || *choosenIter != ai))
+        {
+            continue;
+        }
+
+        const AMDGPUAdapterInfo adapterInfo = handle.parseAdapterInfo(ai);
+
+        writer.BeginRecord();
+        writer.Field("index", ai);
+        writer.Field("backend", "amdgpu");
+        writer.Field("name", adapterInfo.name);
+        writer.Field("busNo", adapterInfo.busNo);
+        writer.Field("deviceNo", adapterInfo.deviceNo);
+        writer.Field("funcNo", adapterInfo.funcNo);
+        writer.Field("vendorId", adapterInfo.vendorId);
+        writer.Field("deviceId", adapterInfo.deviceId);
+        writer.Field("coreClock", adapterInfo.coreClock);
+        writer.Field("memoryClock", adapterInfo.memoryClock);
+        writer.Field("coreOD", adapterInfo.coreOD);
+        writer.Field("memoryOD", adapterInfo.memoryOD);
+        writer.Field("gpuLoad", adapterInfo.gpuLoad);
+        writer.Field("memoryLoad", adapterInfo.memoryLoad);
+        writer.Field("busLanes", adapterInfo.busLanes);
+        writer.Field("busSpeed", adapterInfo.busSpeed);
+        writer.Field("temperature", adapterInfo.temperature / 1000.0);
+        writer.Field("tempCritical", adapterInfo.tempCritical / 1000.0);
+        writer.Field("performanceLevel", adapterInfo.performanceLevel);
+        writer.Field("power", adapterInfo.power >= 0 ? adapterInfo.power / 1000000.0 : NAN);
+
+        writer.BeginObject("powerCap");
+        writer.Field("value", adapterInfo.powerCapAvailable ? adapterInfo.powerCap / 1000000.0 : NAN);
+        writer.Field("min", adapterInfo.powerCapAvailable ? adapterInfo.powerCapMin / 1000000.0 : NAN);
+        writer.Field("max", adapterInfo.powerCapAvailable ? adapterInfo.powerCapMax / 1000000.0 : NAN);
+        writer.EndObject();
+
+        writer.BeginObject("fan");
+        writer.Field("min", adapterInfo.minFanSpeed);
+        writer.Field("max", adapterInfo.maxFanSpeed);
+        writer.Field("value", adapterInfo.fanSpeed);
+        writer.Field("percent",
+            double(adapterInfo.fanSpeed - adapterInfo.minFanSpeed) / double(adapterInfo.maxFanSpeed - adapterInfo.minFanSpeed) * 100.0);
+        writer.Field("default", adapterInfo.defaultFanSpeed);
+        writer.EndObject();
+
+        writer.Field("coreClocks", adapterInfo.coreClocks);
+        writer.Field("memoryClocks", adapterInfo.memoryClocks);
+        writeODTable(writer, adapterInfo.odTable);
+        writePowerProfiles(writer, adapterInfo.powerProfiles);
+        writeMemoryUsage(writer, adapterInfo.memoryUsage);
+        writeSensors(writer, adapterInfo.sensors);
+        writePMInfo(writer, adapterInfo.pmInfo);
+        writer.EndRecord();
+
+        if (useChoosen)
+        {
+            ++choosenIter;
+        }
+    }
+
+    writer.EndDocument();
+}
+
+void AmdGpuProAdapters::writeODLevels(OutputWriter& writer, const char* name, const std::vector<AMDGPUODLevel>& levels)
+{
+    writer.BeginArray(name);
+
+    for (const AMDGPUODLevel& level: levels)
+    {
+        writer.BeginObject(nullptr);
+        writer.Field("index", level.index);
+        writer.Field("clock", level.clock);
+        writer.Field("voltage", level.voltage / 1000.0);
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+}
+
+void AmdGpuProAdapters::writeODRange(OutputWriter& writer, const char* name, const AMDGPUODRange& range, double divider)
+{
+    writer.BeginObject(name);
+    writer.Field("min", range.min / divider);
+    writer.Field("max", range.max / divider);
+    writer.EndObject();
+}
+
+/* written also when pp_od_clk_voltage is not available, to keep the same fields in all records */
+void AmdGpuProAdapters::writeODTable(OutputWriter& writer, const AMDGPUODTable& table)
+{
+    writer.BeginObject("od");
+    writer.Field("available", table.isAvailable());
+    writeODLevels(writer, "coreLevels", table.coreLevels);
+    writeODLevels(writer, "memoryLevels", table.memoryLevels);
+    writeODLevels(writer, "voltageCurve", table.voltageCurve);
+    writeODRange(writer, "coreClockRange", table.coreClockRange, 1.0);
+    writeODRange(writer, "memoryClockRange", table.memoryClockRange, 1.0);
+    writeODRange(writer, "voltageRange", table.voltageRange, 1000.0);
+    writer.EndObject();
+}
+
+void AmdGpuProAdapters::writePowerProfiles(OutputWriter& writer, const AMDGPUPowerProfileTable& table)
+{
+    const AMDGPUPowerProfile* active = table.getActive();
+
+    writer.Field("powerProfile", active != nullptr ? active->name : std::string());
+    writer.BeginArray("powerProfiles");
+
+    for (const AMDGPUPowerProfile& profile: table.profiles)
+    {
+        std::string heuristics;
+        appendRows(heuristics, profile.rows);
+
+        writer.BeginObject(nullptr);
+        writer.Field("index", profile.index);
+        writer.Field("name", profile.name);
+        writer.Field("active", profile.active);
+        writer.Field("heuristics", heuristics);
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+}
+
+/* written also when amdgpu_pm_info was not read, missing values are -1 (NaN for power) */
+void AmdGpuProAdapters::writePMInfo(OutputWriter& writer, const AMDGPUPMInfo& pmInfo)
+{
+    writer.BeginObject("pmInfo");
+    writer.Field("available", pmInfo.isAvailable());
+    writer.Field("coreClock", pmInfo.coreClock);
+    writer.Field("memoryClock", pmInfo.memoryClock);
+    writer.Field("vddgfx", pmInfo.vddgfx >= 0 ? pmInfo.vddgfx / 1000.0 : NAN);
+    writer.Field("gfxPower", pmInfo.gfxPower >= 0.0 ? pmInfo.gfxPower : NAN);
+    writer.Field("temperature", pmInfo.temperature);
+    writer.Field("gpuLoad", pmInfo.gpuLoad);
+    writer.Field("memoryLoad", pmInfo.memoryLoad);
+    writer.EndObject();
+}
+
+/* in MiB, null if the kernel does not have mem_info_* */
+void AmdGpuProAdapters::writeMemoryUsage(OutputWriter& writer, const AMDGPUMemoryUsage& usage)
+{
+    static const struct
+    {
+        const char* name;
+        unsigned long long AMDGPUMemoryUsage::*value;
+    } fields[] =
+    {
+        { "vramTotal", &AMDGPUMemoryUsage::vramTotal },
+        { "vramUsed", &AMDGPUMemoryUsage::vramUsed },
+        { "visibleVramTotal", &AMDGPUMemoryUsage::visibleVramTotal },
+        { "visibleVramUsed", &AMDGPUMemoryUsage::visibleVramUsed },
+        { "gttTotal", &AMDGPUMemoryUsage::gttTotal },
+        { "gttUsed", &AMDGPUMemoryUsage::gttUsed }
+    };
+
+    writer.BeginObject("memory");
+
+    for (const auto& field: fields)
+    {
+        writer.Field(field.name, usage.available ? double(toMiB(usage.*field.value)) : NAN);
+    }
+
+    writer.EndObject();
+}
+
+/* objects named by labels, like sensors.junction.value */
+void AmdGpuProAdapters::writeSensors(OutputWriter& writer, const std::vector<AMDGPUSensor>& sensors)
+{
+    writer.BeginObject("sensors");
+
+    for (const AMDGPUSensor& sensor: sensors)
+    {
+        writer.BeginObject(sensor.label.c_str());
+        writer.Field("type", sensor.type);
+        writer.Field("channel", sensor.channel);
+        writer.Field("value", sensor.value);
+        writer.Field("critical", sensor.critical);
+        writer.Field("emergency", sensor.emergency);
+        writer.EndObject();
+    }
+
+    writer.EndObject();
+}
@@ -1,370 +1,1082 @@
 #include "amdgpuproovc.h"
 
-void AmdGpuProOvc::Set(AMDGPUAdapterHandle& Handle_, const std::vector<OVCParameter>& OvcParams, const std::vector<PerfClocks>& PerfClocksList)
+#include <algorithm>
+
+void AmdGpuProOvc::Set(AMDGPUAdapterHandle& Handle_, const std::vector<OVCParameter>& OvcParams, bool Report, std::ostream& Errors)
 {
-    std::cout << ConstStrings::OverdriveWarning << std::endl;
+    if (Report)
+    {
+        std::cout << ConstStrings::OverdriveWarning << std::endl;
+    }
 
     bool failed = false;
-    int adaptersNum = Handle_.getAdaptersNum();
-
-    checkAdapterIndicies(OvcParams, adaptersNum, failed);
 
-    checkFanSpeeds(OvcParams, failed);
+    const OVCPlan plan(OvcParams, Handle_.getAdaptersNum(), Errors, failed);
 
-    checkParameters(OvcParams, adaptersNum, PerfClocksList, failed);
+    std::vector<AMDGPUOvcState> states(plan.getAdaptersNum());
 
-    throwErrorOnFailed(failed);
-
-    printFanSpeedChanges(OvcParams, adaptersNum);
-
-    printParameterChanges(OvcParams, adaptersNum);
+    for (int i = 0; i < plan.getAdaptersNum(); i++)
+    {
+        getState(Handle_, plan, i, states[i]);
+    }
 
-    std::vector<FanSpeedSetup> fanSpeedSetups(adaptersNum);
+    checkParameters(plan, states, Errors, failed);
 
-    setFanSpeedSetup(fanSpeedSetups, OvcParams, adaptersNum);
+    throwErrorOnFailed(Errors, failed);
 
-    setParameters(Handle_, OvcParams, adaptersNum, PerfClocksList);
+    if (Report)
+    {
+        printChanges(plan, states);
+    }
 
-    setFanSpeeds(adaptersNum, fanSpeedSetups, Handle_);
+    setParameters(Handle_, plan, states);
 }
 
-void AmdGpuProOvc::setFanSpeeds(int adaptersNum, std::vector<FanSpeedSetup> fanSpeedSetups, AMDGPUAdapterHandle& Handle_)
+/* reads only what the actions of adapter need, nothing for adapters without actions */
+void AmdGpuProOvc::getState(const AMDGPUAdapterHandle& handle_, const OVCPlan& plan, int adapterIndex, AMDGPUOvcState& state)
 {
-    for (int i = 0; i < adaptersNum; i++)
+    bool odTableRead = false;
+    bool perfClocksRead = false;
+    bool perfLevelRead = false;
+    bool fanControllersRead = false;
+
+    for (int action = plan.getActionsBegin(adapterIndex); action < plan.getActionsEnd(adapterIndex); action++)
     {
-        if (fanSpeedSetups[i].isSet)
+        const OVCParamType type = plan.getType(action);
+
+        if (isODType(type) && !odTableRead)
         {
-            if (!fanSpeedSetups[i].useDefault)
+            odTableRead = true;
+
+            try
             {
-                Handle_.setFanSpeed( i, int( round( fanSpeedSetups[i].value ) ) );
+                handle_.getODClockVoltage(adapterIndex, state.odTable);
             }
-            else
+            catch(const Error& error)
             {
-                Handle_.setFanSpeedToDefault(i);
+                state.odTable = AMDGPUODTable();
+                state.odTableError = error.what();
             }
         }
+
+        // clocks are set by Overdrive percents without pp_od_clk_voltage
+        if ((type == OVCParamType::CORE_CLOCK || type == OVCParamType::MEMORY_CLOCK) && !perfClocksRead &&
+            !state.odTable.isAvailable() && state.odTableError.empty())
+        {
+            perfClocksRead = true;
+            handle_.getPerformanceClocks(adapterIndex, state.perfClocks.coreClock, state.perfClocks.memoryClock);
+        }
+
+        if ((type == OVCParamType::FAN_SPEED || type == OVCParamType::FAN_RPM) && !fanControllersRead)
+        {
+            fanControllersRead = true;
+            state.fanControllersNum = handle_.getFanControllersNum(adapterIndex);
+            state.fanRPMControls.resize(state.fanControllersNum);
+        }
+
+        switch(type)
+        {
+            case OVCParamType::FAN_RPM:
+
+                if (plan.getPartId(action) >= 0 && plan.getPartId(action) < int(state.fanControllersNum))
+                {
+                    handle_.getFanRPMControl(adapterIndex, plan.getPartId(action), state.fanRPMControls[plan.getPartId(action)]);
+                }
+                break;
+
+            case OVCParamType::POWER_CAP:
+
+                state.powerCapRange.isAvailable = handle_.getPowerCapRange(adapterIndex, state.powerCapRange.min, state.powerCapRange.max);
+                break;
+
+            case OVCParamType::POWER_PROFILE:
+
+                handle_.getPowerProfiles(adapterIndex, state.powerProfiles);
+
+                // the profile may need the manual performance level
+                if (!perfLevelRead)
+                {
+                    perfLevelRead = true;
+                    handle_.getPerformanceLevel(adapterIndex, state.performanceLevel);
+                }
+                break;
+
+            case OVCParamType::CORE_CLOCK_MASK:
+            case OVCParamType::MEMORY_CLOCK_MASK:
+            case OVCParamType::PCIE_MASK:
+            {
+                const DPMDomain domain = getDPMDomain(type);
+                const unsigned int statesNum = handle_.getDPMStatesNum(adapterIndex, domain);
+
+                switch(domain)
+                {
+                    case DPMDomain::CORE:
+
+                        state.coreStatesNum = statesNum;
+                        break;
+
+                    case DPMDomain::MEMORY:
+
+                        state.memoryStatesNum = statesNum;
+                        break;
+
+                    default:
+
+                        state.pcieStatesNum = statesNum;
+                        break;
+                }
+            }
+            // fall through, masks need the performance level too
+
+            case OVCParamType::PERFORMANCE_LEVEL:
+
+                if (!perfLevelRead)
+                {
+                    perfLevelRead = true;
+                    handle_.getPerformanceLevel(adapterIndex, state.performanceLevel);
+                }
+                break;
+
+            default:
+
+                break;
+        }
+    }
+}
+
+bool AmdGpuProOvc::isODType(OVCParamType type)
+{
+    return type == OVCParamType::CORE_CLOCK || type == OVCParamType::MEMORY_CLOCK || type == OVCParamType::VDDC_VOLTAGE;
+}
+
+/* levels of pp_od_clk_voltage changed by parameter type, nullptr if not set per level */
+const std::vector<AMDGPUODLevel>* AmdGpuProOvc::getODLevels(const AMDGPUODTable& table, OVCParamType type)
+{
+    if (!table.isAvailable())
+    {
+        return nullptr;
+    }
+
+    switch(type)
+    {
+        case OVCParamType::CORE_CLOCK:
+
+            return &table.coreLevels;
+
+        case OVCParamType::MEMORY_CLOCK:
+
+            return &table.memoryLevels;
+
+        case OVCParamType::VDDC_VOLTAGE:
+
+            return &table.getVoltageLevels();
+
+        default:
+
+            return nullptr;
     }
 }
 
-void AmdGpuProOvc::checkFanSpeeds(const std::vector<OVCParameter>& ovcParams, bool& failed)
+void AmdGpuProOvc::checkODParameter(const OVCPlan& plan, int action, const AMDGPUODTable& table, std::ostream& errors, bool& failed)
 {
-    for (OVCParameter param: ovcParams)
+    const std::vector<AMDGPUODLevel>* levels = getODLevels(table, plan.getType(action));
+
+    if (AMDGPUODTable::FindLevel(*levels, plan.getPartId(action)) == nullptr)
     {
-        if (param.type == OVCParamType::FAN_SPEED)
-        {
-            if(param.partId != 0)
+        errors << "Performance level out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+        return;
+    }
+
+    if (plan.isDefault(action))
+    {
+        return;
+    }
+
+    const double value = plan.getValue(action);
+
+    switch(plan.getType(action))
+    {
+        case OVCParamType::CORE_CLOCK:
+
+            if (table.coreClockRange.isSet && (value < table.coreClockRange.min || value > table.coreClockRange.max))
             {
-                std::cerr << "Thermal Control Index is not 0 in '" << param.argText << "'!" << std::endl;
+                errors << "Core clock out of range in '" << plan.getArgText(action) << "'!" << std::endl;
                 failed = true;
             }
-            if( !param.useDefault && (param.value < 0.0 || param.value > 100.0) )
+            break;
+
+        case OVCParamType::MEMORY_CLOCK:
+
+            if (table.memoryClockRange.isSet && (value < table.memoryClockRange.min || value > table.memoryClockRange.max))
             {
-                std::cerr << "FanSpeed value out of range in '" << param.argText << "'!" << std::endl;
+                errors << "Memory clock out of range in '" << plan.getArgText(action) << "'!" << std::endl;
                 failed = true;
             }
+            break;
+
+        default:
+
+            if (table.voltageRange.isSet && (value < table.voltageRange.min / 1000.0 || value > table.voltageRange.max / 1000.0))
+            {
+                errors << "Voltage out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                failed = true;
+            }
+            break;
+    }
+}
+
+void AmdGpuProOvc::checkFanRPM(const OVCPlan& plan, int action, const AMDGPUOvcState& state, std::ostream& errors, bool& failed)
+{
+    const int controllerIndex = plan.getPartId(action);
+
+    if (controllerIndex < 0 || controllerIndex >= int(state.fanControllersNum))
+    {
+        errors << "Thermal Control Index out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+        return;
+    }
+
+    const AMDGPUFanRPMControl& control = state.fanRPMControls[controllerIndex];
+
+    if (!control.available)
+    {
+        errors << "Fan RPM is not available in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+        return;
+    }
+
+    // without fanN_target the speed could be only approximated once by PWM and would not follow load
+    if (!plan.isDefault(action) && !control.hasTarget)
+    {
+        errors << "Fan RPM target is not supported by driver in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+        return;
+    }
+
+    const double value = plan.getValue(action);
+
+    if (!plan.isDefault(action) && (value < 0.0 || (control.min != 0 && value < control.min) ||
+                                    (control.max != 0 && value > control.max)))
+    {
+        errors << "Fan RPM value out of range " << control.min << " - " << control.max << " in '"
+               << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+}
+
+void AmdGpuProOvc::checkPowerCap(const OVCPlan& plan, int action, const PowerCapRange& powerCapRange, std::ostream& errors, bool& failed)
+{
+    const double value = plan.getValue(action);
+
+    if (plan.getPartId(action) != 0)
+    {
+        errors << "Power cap does not have levels in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+    else if (!powerCapRange.isAvailable)
+    {
+        errors << "Power cap is not available in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+    else if (!plan.isDefault(action) && (value <= 0.0 ||
+             (powerCapRange.max != 0 && (value * 1000000.0 < powerCapRange.min || value * 1000000.0 > powerCapRange.max))))
+    {
+        errors << "Power cap out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+}
+
+/* command for pp_power_profile_mode: profile index and values of custom profile separated by spaces;
+ * 'default' selects BOOTUP_DEFAULT. Returns false if profile is not found */
+bool AmdGpuProOvc::getPowerProfileCommand(const OVCPlan& plan, int action, const AMDGPUPowerProfileTable& powerProfiles,
+                                          std::string& command, std::string& profileName)
+{
+    const std::string& text = plan.getText(action);
+    const size_t colon = text.find(':');
+    const AMDGPUPowerProfile* profile = plan.isDefault(action) ? powerProfiles.find("0") : powerProfiles.find(text.substr(0, colon));
+
+    if (profile == nullptr)
+    {
+        return false;
+    }
+
+    profileName = profile->name;
+    command = std::to_string(profile->index);
+
+    if (!plan.isDefault(action) && colon != std::string::npos)
+    {
+        std::string values = text.substr(colon + 1);
+
+        for (char& c: values)
+        {
+            c = (c == ',') ? ' ' : c;
         }
+
+        command += " " + values;
     }
+
+    return true;
 }
 
-void AmdGpuProOvc::checkAdapterIndicies(const std::vector<OVCParameter>& ovcParams, int adaptersNum, bool& failed)
+void AmdGpuProOvc::checkPowerProfile(const OVCPlan& plan, int action, const AMDGPUPowerProfileTable& powerProfiles, std::ostream& errors,
+                                     bool& failed)
 {
-    for (OVCParameter param: ovcParams)
+    std::string command, profileName;
+
+    if (plan.getPartId(action) != 0)
     {
-        if (!param.allAdapters)
+        errors << "Power profile does not have levels in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+        return;
+    }
+
+    if (!powerProfiles.isAvailable())
+    {
+        errors << "Power profile is not available in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+        return;
+    }
+
+    if (!getPowerProfileCommand(plan, action, powerProfiles, command, profileName))
+    {
+        errors << "Unknown power profile in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+        return;
+    }
+
+    const size_t colon = plan.isDefault(action) ? std::string::npos : plan.getText(action).find(':');
+
+    if (colon == std::string::npos)
+    {
+        return;
+    }
+
+    if (profileName != "CUSTOM")
+    {
+        errors << "Only CUSTOM power profile can have values in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+        return;
+    }
+
+    const std::string values = plan.getText(action).substr(colon + 1);
+    const char* p = values.c_str();
+
+    // comma-separated list of integers
+    while (true)
+    {
+        char* end;
+        errno = 0;
+        ::strtol(p, &end, 10);
+
+        if (errno != 0 || end == p || (*end != ',' && *end != 0))
         {
-            bool listFailed = false;
-            for (int adapterIndex: param.adapters)
-            {
-                if ( !listFailed && (adapterIndex >= adaptersNum || adapterIndex < 0) )
-                {
-                    std::cerr << "Some adapter indices out of range in '" << param.argText << "'!" << std::endl;
-                    listFailed = failed = true;
-                }
-            }
+            errors << "Unable to parse power profile values in '" << plan.getArgText(action) << "'!" << std::endl;
+            failed = true;
+            return;
+        }
+
+        if (*end == 0)
+        {
+            break;
         }
+
+        p = end + 1;
     }
 }
 
-void AmdGpuProOvc::checkParameters(const std::vector<OVCParameter>& ovcParams, int adaptersNum, const std::vector<PerfClocks>& perfClocksList, bool& failed)
+/* last action of type for adapter, -1 if none */
+int AmdGpuProOvc::findAction(const OVCPlan& plan, int adapterIndex, OVCParamType type)
 {
-    for (OVCParameter param: ovcParams)
+    int found = -1;
+
+    for (int action = plan.getActionsBegin(adapterIndex); action < plan.getActionsEnd(adapterIndex); action++)
     {
-        if (param.type != OVCParamType::FAN_SPEED)
+        if (plan.getType(action) == type)
         {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, adaptersNum); ait; ++ait)
-            {
-                int i = *ait;
+            found = action;
+        }
+    }
 
-                if (i>=adaptersNum)
-                {
-                    continue;
-                }
+    return found;
+}
 
-                int partId = (param.partId != LAST_PERFLEVEL) ? param.partId : 0;
+std::string AmdGpuProOvc::getPerformanceLevel(const OVCPlan& plan, int action)
+{
+    return plan.isDefault(action) ? std::string("auto") : plan.getText(action);
+}
+
+/* older kernels change the power profile only in the manual performance level, so
+ * the automatic level is switched to manual unless the level is given explicitly;
+ * the default profile is what the automatic level uses, so it keeps that level */
+bool AmdGpuProOvc::switchesToManualLevel(const OVCPlan& plan, int adapterIndex, const AMDGPUOvcState& state)
+{
+    const int action = findAction(plan, adapterIndex, OVCParamType::POWER_PROFILE);
+
+    return action >= 0 && !plan.isDefault(action) &&
+        findAction(plan, adapterIndex, OVCParamType::PERFORMANCE_LEVEL) < 0 && state.performanceLevel == "auto";
+}
+
+void AmdGpuProOvc::checkPerformanceLevel(const OVCPlan& plan, int action, const AMDGPUOvcState& state, std::ostream& errors, bool& failed)
+{
+    static const char* levels[] = { "auto", "low", "high", "manual", "profile_standard", "profile_min_sclk",
+                                    "profile_min_mclk", "profile_peak", "profile_exit" };
+
+    const std::string level = getPerformanceLevel(plan, action);
+
+    if (plan.getPartId(action) != 0)
+    {
+        errors << "Performance level does not have levels in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+    else if (state.performanceLevel.empty())
+    {
+        errors << "Performance level is not available in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+    else if (std::find(std::begin(levels), std::end(levels), level) == std::end(levels))
+    {
+        errors << "Unknown performance level in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+}
+
+DPMDomain AmdGpuProOvc::getDPMDomain(OVCParamType type)
+{
+    switch(type)
+    {
+        case OVCParamType::CORE_CLOCK_MASK:
+
+            return DPMDomain::CORE;
 
-                if (partId != 0)
+        case OVCParamType::MEMORY_CLOCK_MASK:
+
+            return DPMDomain::MEMORY;
+
+        default:
+
+            return DPMDomain::PCIE;
+    }
+}
+
+unsigned int AmdGpuProOvc::getDPMStatesNum(const AMDGPUOvcState& state, DPMDomain domain)
+{
+    switch(domain)
+    {
+        case DPMDomain::CORE:
+
+            return state.coreStatesNum;
+
+        case DPMDomain::MEMORY:
+
+            return state.memoryStatesNum;
+
+        default:
+
+            return state.pcieStatesNum;
+    }
+}
+
+/* states of mask in adapter list syntax ('1,2', '0-2', 'all'), 'default' allows all states.
+ * Returns false if list can not be parsed */
+bool AmdGpuProOvc::getDPMStates(const OVCPlan& plan, int action, unsigned int statesNum, std::vector<int>& states)
+{
+    bool allStates = plan.isDefault(action);
+
+    if (!allStates)
+    {
+        try
+        {
+            AdaptersList::Parse(plan.getText(action).c_str(), states, allStates);
+        }
+        catch(const Error& error)
+        {
+            return false;
+        }
+    }
+
+    if (allStates)
+    {
+        states.clear();
+
+        for (unsigned int i = 0; i < statesNum; i++)
+        {
+            states.push_back(i);
+        }
+    }
+
+    return true;
+}
+
+void AmdGpuProOvc::checkDPMStatesMask(const OVCPlan& plan, int adapterIndex, int action, const AMDGPUOvcState& state, std::ostream& errors,
+                                      bool& failed)
+{
+    const unsigned int statesNum = getDPMStatesNum(state, getDPMDomain(plan.getType(action)));
+    const int perfLevelAction = findAction(plan, adapterIndex, OVCParamType::PERFORMANCE_LEVEL);
+    std::vector<int> states;
+
+    if (plan.getPartId(action) != 0)
+    {
+        errors << "DPM state mask does not have levels in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+    else if (statesNum == 0)
+    {
+        errors << "DPM state mask is not available in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+    else if (!getDPMStates(plan, action, statesNum, states))
+    {
+        errors << "Unable to parse DPM states in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+    else if (states.empty() || states.back() >= int(statesNum))
+    {
+        errors << "DPM state out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+    else if (perfLevelAction >= 0 && getPerformanceLevel(plan, perfLevelAction) != "manual")
+    {
+        errors << "DPM state mask needs manual performance level in '" << plan.getArgText(action) << "'!" << std::endl;
+        failed = true;
+    }
+}
+
+void AmdGpuProOvc::checkParameters(const OVCPlan& plan, const std::vector<AMDGPUOvcState>& states, std::ostream& errors, bool& failed)
+{
+    for (int i = 0; i < plan.getAdaptersNum(); i++)
+    {
+        const PerfClocks& perfClks = states[i].perfClocks;
+
+        for (int action = plan.getActionsBegin(i); action < plan.getActionsEnd(i); action++)
+        {
+            const bool useDefault = plan.isDefault(action);
+            const double value = plan.getValue(action);
+
+            if (plan.getType(action) == OVCParamType::FAN_SPEED)
+            {
+                if (plan.getPartId(action) < 0 || plan.getPartId(action) >= int(states[i].fanControllersNum))
                 {
-                    std::cerr << "Performance level out of range in '" << param.argText << "'!" << std::endl;
+                    errors << "Thermal Control Index out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                    failed = true;
+                }
+                if (!useDefault && (value < 0.0 || value > 100.0))
+                {
+                    errors << "FanSpeed value out of range in '" << plan.getArgText(action) << "'!" << std::endl;
                     failed = true;
-                    continue;
                 }
+                continue;
+            }
 
-                const PerfClocks& perfClks = perfClocksList[i];
+            if (plan.getType(action) == OVCParamType::FAN_RPM)
+            {
+                checkFanRPM(plan, action, states[i], errors, failed);
+                continue;
+            }
 
-                switch(param.type)
-                {
-                    case OVCParamType::CORE_CLOCK:
+            if (plan.getType(action) == OVCParamType::POWER_CAP)
+            {
+                checkPowerCap(plan, action, states[i].powerCapRange, errors, failed);
+                continue;
+            }
 
-                        if (!param.useDefault && (param.value < perfClks.coreClock || param.value > perfClks.coreClock * 1.20))
-                        {
-                            std::cerr << "Core clock out of range in '" << param.argText << "'!" << std::endl;
-                            failed = true;
-                        }
-                        break;
+            if (plan.getType(action) == OVCParamType::POWER_CONTROL)
+            {
+                continue;
+            }
 
-                    case OVCParamType::MEMORY_CLOCK:
+            if (plan.getType(action) == OVCParamType::POWER_PROFILE)
+            {
+                checkPowerProfile(plan, action, states[i].powerProfiles, errors, failed);
+                continue;
+            }
 
-                        if (!param.useDefault && (param.value < perfClks.memoryClock || param.value > perfClks.memoryClock * 1.20))
-                        {
-                            std::cerr << "Memory clock out of range in '" << param.argText << "'!" << std::endl;
-                            failed = true;
-                        }
-                        break;
+            if (plan.getType(action) == OVCParamType::PERFORMANCE_LEVEL)
+            {
+                checkPerformanceLevel(plan, action, states[i], errors, failed);
+                continue;
+            }
 
-                    case OVCParamType::CORE_OD:
+            if (plan.getType(action) == OVCParamType::CORE_CLOCK_MASK || plan.getType(action) == OVCParamType::MEMORY_CLOCK_MASK ||
+                plan.getType(action) == OVCParamType::PCIE_MASK)
+            {
+                checkDPMStatesMask(plan, i, action, states[i], errors, failed);
+                continue;
+            }
 
-                        if (!param.useDefault && (param.value < 0.0 || param.value > 20.0))
-                        {
-                            std::cerr << "Core Overdrive out of range in '" << param.argText << "'!" << std::endl;
-                            failed = true;
-                        }
-                        break;
+            if (isODType(plan.getType(action)) && !states[i].odTableError.empty())
+            {
+                errors << states[i].odTableError << " Overdrive table is not usable in '" << plan.getArgText(action) << "'!" << std::endl;
+                failed = true;
+                continue;
+            }
 
-                    case OVCParamType::MEMORY_OD:
+            if (getODLevels(states[i].odTable, plan.getType(action)) != nullptr)
+            {
+                checkODParameter(plan, action, states[i].odTable, errors, failed);
+                continue;
+            }
 
-                        if (!param.useDefault && (param.value < 0.0 || param.value > 20.0))
-                        {
-                            std::cerr << "Memory Overdrive out of range in '" << param.argText << "'!" << std::endl;
-                            failed = true;
-                        }
-                        break;
+            int partId = (plan.getPartId(action) != LAST_PERFLEVEL) ? plan.getPartId(action) : 0;
 
-                    default:
+            if (partId != 0)
+            {
+                errors << "Performance level out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                failed = true;
+                continue;
+            }
 
-                        break;
-                }
+            switch(plan.getType(action))
+            {
+                case OVCParamType::CORE_CLOCK:
+
+                    if (!useDefault && (value < perfClks.coreClock || value > perfClks.coreClock * 1.20))
+                    {
+                        errors << "Core clock out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    break;
+
+                case OVCParamType::MEMORY_CLOCK:
+
+                    if (!useDefault && (value < perfClks.memoryClock || value > perfClks.memoryClock * 1.20))
+                    {
+                        errors << "Memory clock out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    break;
+
+                case OVCParamType::CORE_OD:
+
+                    if (!useDefault && (value < 0.0 || value > 20.0))
+                    {
+                        errors << "Core Overdrive out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    break;
+
+                case OVCParamType::MEMORY_OD:
+
+                    if (!useDefault && (value < 0.0 || value > 20.0))
+                    {
+                        errors << "Memory Overdrive out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    break;
+
+                default:
+
+                    break;
             }
         }
     }
 }
 
-void AmdGpuProOvc::throwErrorOnFailed(bool failed)
+void AmdGpuProOvc::throwErrorOnFailed(std::ostream& errors, bool failed)
 {
     if (failed)
     {
-        std::cerr << "Error in parameters. No settings have been applied." << std::endl;
+        errors << "Error in parameters. No settings have been applied." << std::endl;
         throw Error("Invalid parameters.");
     }
 }
 
-void AmdGpuProOvc::printFanSpeedChanges(const std::vector<OVCParameter>& ovcParams, int adaptersNum)
+void AmdGpuProOvc::printChanges(const OVCPlan& plan, const std::vector<AMDGPUOvcState>& states)
 {
-    for (OVCParameter param: ovcParams)
+    OutputBuffer out;
+
+    for (int i = 0; i < plan.getAdaptersNum(); i++)
     {
-        if (param.type == OVCParamType::FAN_SPEED)
+        for (int action = plan.getActionsBegin(i); action < plan.getActionsEnd(i); action++)
         {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, adaptersNum); ait; ++ait)
+            const std::vector<AMDGPUODLevel>* levels = getODLevels(states[i].odTable, plan.getType(action));
+            const char* unit = "";
+
+            switch(plan.getType(action))
             {
-                std::cout << "Setting fan speed to ";
+                case OVCParamType::FAN_SPEED:
+
+                    out << "Setting fan speed to ";
+                    unit = "%";
+                    break;
+
+                case OVCParamType::FAN_RPM:
+
+                    out << "Setting fan speed to ";
+                    unit = " RPM";
+                    break;
+
+                case OVCParamType::CORE_CLOCK:
+
+                    out << "Setting core clock to ";
+                    unit = " MHz";
+                    break;
 
-                if (param.useDefault)
+                case OVCParamType::MEMORY_CLOCK:
+
+                    out << "Setting memory clock to ";
+                    unit = " MHz";
+                    break;
+
+                case OVCParamType::CORE_OD:
+
+                    out << "Setting core overdrive to ";
+                    break;
+
+                case OVCParamType::POWER_CAP:
+
+                    out << "Setting power cap to ";
+                    unit = " W";
+                    break;
+
+                case OVCParamType::POWER_CONTROL:
+
+                    out << "Power control available only for AMD Catalyst/Crimson drivers.\n";
+                    continue;
+
+                case OVCParamType::PERFORMANCE_LEVEL:
+
+                    out << "Setting performance level to " << getPerformanceLevel(plan, action) << " for adapter " << i << '\n';
+                    continue;
+
+                case OVCParamType::CORE_CLOCK_MASK:
+                case OVCParamType::MEMORY_CLOCK_MASK:
+                case OVCParamType::PCIE_MASK:
                 {
-                    std::cout << "default";
+                    static const char* domainNames[] = { "core clock", "memory clock", "PCIe" };
+                    const DPMDomain domain = getDPMDomain(plan.getType(action));
+                    std::vector<int> dpmStates;
+                    getDPMStates(plan, action, getDPMStatesNum(states[i], domain), dpmStates);
+
+                    out << "Allowing " << domainNames[int(domain)] << " states";
+
+                    for (int state: dpmStates)
+                    {
+                        out << " " << state;
+                    }
+
+                    out << " for adapter " << i << '\n';
+                    continue;
                 }
-                else
+
+                case OVCParamType::POWER_PROFILE:
                 {
-                    std::cout << param.value << "%";
+                    std::string command, profileName;
+                    getPowerProfileCommand(plan, action, states[i].powerProfiles, command, profileName);
+
+                    out << "Setting power profile to " << profileName << " (" << command << ") for adapter " << i << '\n';
+
+                    if (switchesToManualLevel(plan, i, states[i]))
+                    {
+                        out << "Switching performance level from auto to manual for power profile of adapter " << i << '\n';
+                    }
+                    continue;
                 }
 
-                std::cout << " for adapter " << *ait << " at thermal controller " << param.partId << std::endl;
+                case OVCParamType::MEMORY_OD:
+
+                    out << "Setting memory overdrive to ";
+                    break;
+
+                case OVCParamType::VDDC_VOLTAGE:
+
+                    if (levels == nullptr)
+                    {
+                        out << "VDDC voltage available only for AMD Catalyst/Crimson drivers or with pp_od_clk_voltage.\n";
+                        continue;
+                    }
+
+                    out << "Setting Vddc to ";
+                    unit = " V";
+                    break;
+
+                default:
+
+                    continue;
+            }
+
+            if (plan.isDefault(action))
+            {
+                out << "default";
+            }
+            else
+            {
+                out << plan.getValue(action) << unit;
+            }
+
+            if (plan.getType(action) == OVCParamType::FAN_SPEED || plan.getType(action) == OVCParamType::FAN_RPM)
+            {
+                out << " for adapter " << i << " at thermal controller " << plan.getPartId(action) << '\n';
+            }
+            else if (plan.getType(action) == OVCParamType::POWER_CAP)
+            {
+                out << " for adapter " << i << '\n';
+            }
+            else if (levels != nullptr)
+            {
+                out << " for adapter " << i << " at performance level " <<
+                    AMDGPUODTable::FindLevel(*levels, plan.getPartId(action))->index << '\n';
+            }
+            else
+            {
+                out << " for adapter " << i << " at performance level " << 0 << '\n';
             }
         }
     }
 }
 
-void AmdGpuProOvc::printParameterChanges(const std::vector<OVCParameter>& ovcParams, int adaptersNum)
+/* 'default' restores the whole table, so the reset is done before the other changes
+ * of the adapter, which are written together and committed once */
+void AmdGpuProOvc::setODParameters(AMDGPUAdapterHandle& handle_, const OVCPlan& plan, int adapterIndex, const AMDGPUODTable& odTable)
 {
-  for (OVCParameter param: ovcParams)
-  {
-      if (param.type != OVCParamType::FAN_SPEED)
-      {
-          for (AdapterIterator ait(param.adapters, param.allAdapters, adaptersNum); ait; ++ait)
-          {
-              int i = *ait;
-              int partId = (param.partId != LAST_PERFLEVEL) ? param.partId : 0;
-
-              switch(param.type)
-              {
-                  case OVCParamType::CORE_CLOCK:
-
-                      std::cout << "Setting core clock to ";
-
-                      if (param.useDefault)
-                      {
-                          std::cout << "default";
-                      }
-                      else
-                      {
-                          std::cout << param.value << " MHz";
-                      }
-                      std::cout << " for adapter " << i << " at performance level " << partId << std::endl;
-                      break;
-
-                  case OVCParamType::MEMORY_CLOCK:
-
-                      std::cout << "Setting memory clock to ";
-
-                      if (param.useDefault)
-                      {
-                          std::cout << "default";
-                      }
-                      else
-                      {
-                          std::cout << param.value << " MHz";
-                      }
-                      std::cout << " for adapter " << i << " at performance level " << partId << std::endl;
-                      break;
-
-                  case OVCParamType::CORE_OD:
-
-                      std::cout << "Setting core overdrive to ";
-
-                      if (param.useDefault)
-                      {
-                          std::cout << "default";
-                      }
-                      else
-                      {
-                          std::cout << param.value;
-                      }
-
-                      std::cout << " for adapter " << i << " at performance level " << partId << std::endl;
-                      break;
-
-                  case OVCParamType::MEMORY_OD:
-
-                      std::cout << "Setting memory overdrive to ";
-
-                      if (param.useDefault)
-                      {
-                          std::cout << "default";
-                      }
-                      else
-                      {
-                          std::cout << param.value;
-                      }
-
-                      std::cout << " for adapter " << i << " at performance level " << partId << std::endl;
-                      break;
-
-                  case OVCParamType::VDDC_VOLTAGE:
-
-                      std::cout << "VDDC voltage available only for AMD Catalyst/Crimson drivers." << std::endl;
-                      break;
-
-                  default:
-
-                      break;
-              }
-          }
-      }
-  }
+    AMDGPUODTable table = odTable;
+    bool reset = false;
+    bool changed = false;
+
+    for (int action = plan.getActionsBegin(adapterIndex); action < plan.getActionsEnd(adapterIndex); action++)
+    {
+        if (plan.isDefault(action) && getODLevels(table, plan.getType(action)) != nullptr)
+        {
+            reset = true;
+        }
+    }
+
+    if (reset)
+    {
+        handle_.resetODClockVoltage(adapterIndex);
+        handle_.getODClockVoltage(adapterIndex, table);
+    }
+
+    for (int action = plan.getActionsBegin(adapterIndex); action < plan.getActionsEnd(adapterIndex); action++)
+    {
+        if (plan.isDefault(action) || getODLevels(table, plan.getType(action)) == nullptr)
+        {
+            continue;
+        }
+
+        const double value = plan.getValue(action);
+        AMDGPUODLevel* level;
+
+        if (plan.getType(action) == OVCParamType::VDDC_VOLTAGE)
+        {
+            level = AMDGPUODTable::FindLevel(table.getVoltageLevels(), plan.getPartId(action));
+        }
+        else
+        {
+            level = AMDGPUODTable::FindLevel(plan.getType(action) == OVCParamType::CORE_CLOCK ? table.coreLevels : table.memoryLevels,
+                                             plan.getPartId(action));
+        }
+
+        if (level == nullptr)
+        {
+            // levels can be changed by reset
+            throw Error((std::string("Performance level out of range after reset in '") + plan.getArgText(action) + "'").c_str());
+        }
+
+        if (plan.getType(action) == OVCParamType::VDDC_VOLTAGE)
+        {
+            level->voltage = (unsigned int)round(value * 1000.0);
+        }
+        else
+        {
+            level->clock = (unsigned int)round(value);
+        }
+
+        level->changed = changed = true;
+    }
+
+    if (changed)
+    {
+        handle_.setODClockVoltage(adapterIndex, table);
+    }
 }
 
-void AmdGpuProOvc::setFanSpeedSetup(std::vector<FanSpeedSetup>& fanSpeedSetups, const std::vector<OVCParameter>& ovcParams, int adaptersNum)
+/* masks need the manual performance level, so it is set before them if not given */
+void AmdGpuProOvc::setPerformanceLevelAndMasks(AMDGPUAdapterHandle& handle_, const OVCPlan& plan, int adapterIndex,
+                                               const AMDGPUOvcState& state)
 {
-    std::fill(fanSpeedSetups.begin(), fanSpeedSetups.end(), FanSpeedSetup{ 0.0, false, false });
+    static const OVCParamType maskTypes[] = { OVCParamType::CORE_CLOCK_MASK, OVCParamType::MEMORY_CLOCK_MASK, OVCParamType::PCIE_MASK };
+
+    const int perfLevelAction = findAction(plan, adapterIndex, OVCParamType::PERFORMANCE_LEVEL);
+    int maskActions[3];
+    bool hasMasks = false;
+
+    for (int j = 0; j < 3; j++)
+    {
+        maskActions[j] = findAction(plan, adapterIndex, maskTypes[j]);
+        hasMasks |= maskActions[j] >= 0;
+    }
+
+    if (perfLevelAction >= 0)
+    {
+        handle_.setPerformanceLevel(adapterIndex, getPerformanceLevel(plan, perfLevelAction));
+    }
+    else if (hasMasks && state.performanceLevel != "manual")
+    {
+        handle_.setPerformanceLevel(adapterIndex, "manual");
+    }
 
-    for (OVCParameter param: ovcParams)
+    for (int j = 0; j < 3; j++)
     {
-        if (param.type == OVCParamType::FAN_SPEED)
+        if (maskActions[j] < 0)
         {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, adaptersNum); ait; ++ait)
-            {
-                fanSpeedSetups[*ait].value = param.value;
-                fanSpeedSetups[*ait].useDefault = param.useDefault;
-                fanSpeedSetups[*ait].isSet = true;
-            }
+            continue;
         }
+
+        const DPMDomain domain = getDPMDomain(maskTypes[j]);
+        std::vector<int> dpmStates;
+        getDPMStates(plan, maskActions[j], getDPMStatesNum(state, domain), dpmStates);
+
+        handle_.setDPMStatesMask(adapterIndex, domain, dpmStates);
     }
 }
 
-void AmdGpuProOvc::setParameters(AMDGPUAdapterHandle& handle_, const std::vector<OVCParameter>& ovcParams, int adaptersNum, const std::vector<PerfClocks>& perfClocksList)
+void AmdGpuProOvc::setFanRPM(AMDGPUAdapterHandle& handle_, const OVCPlan& plan, int adapterIndex, int action)
 {
-    for (OVCParameter param: ovcParams)
+    const unsigned int controllerIndex = plan.getPartId(action);
+
+    if (plan.isDefault(action))
+    {
+        handle_.setFanRPMToDefault(adapterIndex, controllerIndex);
+    }
+    else
     {
-        if (param.type != OVCParamType::FAN_SPEED)
+        handle_.setFanRPMTarget(adapterIndex, controllerIndex, (unsigned int)round(plan.getValue(action)));
+    }
+}
+
+/* every parameter of adapter is resolved to the final value of its sysfs attribute,
+ * so each attribute is written at most once */
+void AmdGpuProOvc::setParameters(AMDGPUAdapterHandle& handle_, const OVCPlan& plan, const std::vector<AMDGPUOvcState>& states)
+{
+    for (int i = 0; i < plan.getAdaptersNum(); i++)
+    {
+        const PerfClocks& perfClks = states[i].perfClocks;
+        const bool useODTable = states[i].odTable.isAvailable();
+
+        setPerformanceLevelAndMasks(handle_, plan, i, states[i]);
+
+        int coreOD = -1;
+        int memoryOD = -1;
+        std::vector<int> fanActions;   // FAN_SPEED and FAN_RPM in order of parameters
+        int powerCapAction = -1;
+        int powerProfileAction = -1;
+
+        for (int action = plan.getActionsBegin(i); action < plan.getActionsEnd(i); action++)
         {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, adaptersNum); ait; ++ait)
-            {
-                int i = *ait;
+            const bool useDefault = plan.isDefault(action);
+            const double value = plan.getValue(action);
 
-                const PerfClocks& perfClks = perfClocksList[i];
+            switch(plan.getType(action))
+            {
+                case OVCParamType::CORE_CLOCK:
 
-                switch(param.type)
-                {
-                    case OVCParamType::CORE_CLOCK:
-
-                        if (param.useDefault)
-                        {
-                            handle_.setOverdriveCoreParam(i, 0);
-                        }
-                        else
-                        {
-                            handle_.setOverdriveCoreParam(i, int( round( ( double( param.value - perfClks.coreClock ) / perfClks.coreClock ) * 100.0 ) ) );
-                        }
+                    if (useODTable)
+                    {
                         break;
+                    }
+
+                    coreOD = useDefault ? 0 : int( round( ( double( value - perfClks.coreClock ) / perfClks.coreClock ) * 100.0 ) );
+                    break;
 
-                    case OVCParamType::MEMORY_CLOCK:
+                case OVCParamType::MEMORY_CLOCK:
 
-                        if (param.useDefault)
-                        {
-                            handle_.setOverdriveMemoryParam(i, 0);
-                        }
-                        else
-                        {
-                            handle_.setOverdriveMemoryParam( i, int( round( ( double( param.value - perfClks.memoryClock) / perfClks.memoryClock) * 100.0 ) ) );
-                        }
+                    if (useODTable)
+                    {
                         break;
+                    }
 
-                    case OVCParamType::CORE_OD:
+                    memoryOD = useDefault ? 0 : int( round( ( double( value - perfClks.memoryClock ) / perfClks.memoryClock ) * 100.0 ) );
+                    break;
 
-                        if (param.useDefault)
-                        {
-                            handle_.setOverdriveCoreParam(i, 0);
-                        }
-                        else
-                        {
-                            handle_.setOverdriveCoreParam( i, int( round( param.value ) ) );
-                        }
-                        break;
+                case OVCParamType::CORE_OD:
 
-                    case OVCParamType::MEMORY_OD:
+                    coreOD = useDefault ? 0 : int( round( value ) );
+                    break;
 
-                        if (param.useDefault)
-                        {
-                            handle_.setOverdriveMemoryParam(i, 0);
-                        }
-                        else
-                        {
-                            handle_.setOverdriveMemoryParam( i, int( round( param.value ) ) );
-                        }
-                        break;
+                case OVCParamType::MEMORY_OD:
 
-                    default:
-                        break;
-                }
+                    memoryOD = useDefault ? 0 : int( round( value ) );
+                    break;
+
+                case OVCParamType::FAN_SPEED:
+                case OVCParamType::FAN_RPM:
+
+                    fanActions.push_back(action);
+                    break;
+
+                case OVCParamType::POWER_CAP:
+
+                    powerCapAction = action;
+                    break;
+
+                case OVCParamType::POWER_PROFILE:
+
+                    powerProfileAction = action;
+                    break;
+
+                default:
+
+                    break;
+            }
+        }
+
+        if (useODTable)
+        {
+            setODParameters(handle_, plan, i, states[i].odTable);
+        }
+
+        if (coreOD >= 0)
+        {
+            handle_.setOverdriveCoreParam(i, coreOD);
+        }
+
+        if (memoryOD >= 0)
+        {
+            handle_.setOverdriveMemoryParam(i, memoryOD);
+        }
+
+        for (int fanAction: fanActions)
+        {
+            const unsigned int controllerIndex = plan.getPartId(fanAction);
+
+            if (plan.getType(fanAction) == OVCParamType::FAN_RPM)
+            {
+                setFanRPM(handle_, plan, i, fanAction);
             }
+            else if (!plan.isDefault(fanAction))
+            {
+                handle_.setFanSpeed(i, controllerIndex, int( round( plan.getValue(fanAction) ) ) );
+            }
+            else
+            {
+                handle_.setFanSpeedToDefault(i, controllerIndex);
+            }
+        }
+
+        if (powerCapAction >= 0)
+        {
+            if (!plan.isDefault(powerCapAction))
+            {
+                handle_.setPowerCap(i, (unsigned int)round(plan.getValue(powerCapAction) * 1000000.0));
+            }
+            else
+            {
+                handle_.setPowerCapToDefault(i);
+            }
+        }
+
+        if (powerProfileAction >= 0)
+        {
+            std::string command, profileName;
+            getPowerProfileCommand(plan, powerProfileAction, states[i].powerProfiles, command, profileName);
+
+            if (switchesToManualLevel(plan, i, states[i]))
+            {
+                handle_.setPerformanceLevel(i, "manual");
+            }
+
+            handle_.setPowerProfile(i, command);
         }
     }
 }
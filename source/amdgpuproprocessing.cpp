@@ -1,38 +1,44 @@
 #include "amdgpuproprocessing.h"
 
 void AmdGpuProProcessing::Process(std::vector<OVCParameter> OvcParameters, bool UseAdaptersList, std::vector<int> ChosenAdapters, bool ChooseAllAdapters,
-                                  bool PrintVerbose)
+                                  bool PrintVerbose, OutputFormat Format, const Profile& Profile_)
 {
+    if (Profile_.IsLoaded())
+    {
+        compileProfile(Profile_, OvcParameters);
+    }
+
     if (!OvcParameters.empty())
     {
-        this->setOvcParameters(OvcParameters);
+        TimingTrace::Span span("command", "set parameters");
+        SetOvcParameters(handle, OvcParameters, true, std::cerr);
     }
     else
     {
+        TimingTrace::Span span("command", "print adapter info");
         this->validateAdapterList(UseAdaptersList, ChosenAdapters);
-        this->printAdapterInfo(PrintVerbose, ChosenAdapters, UseAdaptersList, ChooseAllAdapters);
+        this->printAdapterInfo(PrintVerbose, ChosenAdapters, UseAdaptersList, ChooseAllAdapters, Format);
     }
 }
 
-void AmdGpuProProcessing::setOvcParameters(std::vector<OVCParameter> ovcParameters)
+void AmdGpuProProcessing::SetOvcParameters(AMDGPUAdapterHandle& Handle_, const std::vector<OVCParameter>& OvcParameters, bool Report,
+                                           std::ostream& Errors)
 {
-    std::vector<PerfClocks> perfClocks;
-
-    for (unsigned int i = 0; i < handle.getAdaptersNum(); i++)
-    {
-        unsigned int coreClock, memoryClock;
-        handle.getPerformanceClocks(i, coreClock, memoryClock);
-        perfClocks.push_back(PerfClocks{ coreClock, memoryClock });
-    }
-
-    AmdGpuProOvc::Set(handle, ovcParameters, perfClocks);
+    AmdGpuProOvc::Set(Handle_, OvcParameters, Report, Errors);
 }
 
-void AmdGpuProProcessing::printAdapterInfo(bool printVerbose, std::vector<int> chosenAdapters, bool useAdaptersList, bool chooseAllAdapters)
+void AmdGpuProProcessing::printAdapterInfo(bool printVerbose, std::vector<int> chosenAdapters, bool useAdaptersList, bool chooseAllAdapters,
+                                           OutputFormat format)
 {
     bool useChosen = useAdaptersList && !chooseAllAdapters;
 
-    if (printVerbose)
+    if (format != OutputFormat::TEXT)
+    {
+        OutputBuffer out;
+        std::unique_ptr<OutputWriter> writer = OutputWriter::Create(format, out);
+        AmdGpuProAdapters::PrintInfoStructured(handle, chosenAdapters, useChosen, *writer);
+    }
+    else if (printVerbose)
     {
         AmdGpuProAdapters::PrintInfoVerbose(handle, chosenAdapters, useChosen);
     }
@@ -42,6 +48,22 @@ void AmdGpuProProcessing::printAdapterInfo(bool printVerbose, std::vector<int> c
     }
 }
 
+/* profile settings go first, so parameters given in command line override them */
+void AmdGpuProProcessing::compileProfile(const Profile& profile, std::vector<OVCParameter>& ovcParameters)
+{
+    std::vector<AdapterIdentity> identities(handle.getAdaptersNum());
+
+    for (unsigned int i = 0; i < handle.getAdaptersNum(); i++)
+    {
+        handle.getIdentity(i, identities[i]);
+    }
+
+    std::vector<OVCParameter> profileParameters;
+    profile.Compile(identities, profileParameters);
+
+    ovcParameters.insert(ovcParameters.begin(), profileParameters.begin(), profileParameters.end());
+}
+
 void AmdGpuProProcessing::validateAdapterList(bool useAdaptersList, std::vector<int> chosenAdapters)
 {
     if (useAdaptersList)
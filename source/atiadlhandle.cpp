@@ -1,11 +1,38 @@
 #include "atiadlhandle.h"
 
+/* one ADL call, measured by the timing trace and the statistics under its entry point name */
+class ADLCallScope
+{
+
+private:
+
+    TimingTrace::Span span;
+
+    IOStats::Scope stats;
+
+public:
+
+    explicit ADLCallScope(const char* name) : span("adl", name), stats("ADL", name, IOStats::Operation::CALL)
+    {}
+
+    void setFailed()
+    {
+        stats.setFailed();
+    }
+
+};
+
 ATIADLHandle::ATIADLHandle() : handle(nullptr),
     pADL_Main_Control_Create(nullptr), pADL_Main_Control_Destroy(nullptr), pADL_ConsoleMode_FileDescriptor_Set(nullptr),
     pADL_Adapter_NumberOfAdapters_Get(nullptr), pADL_Adapter_Active_Get(nullptr), pADL_Adapter_AdapterInfo_Get(nullptr),
     pADL_Overdrive5_CurrentActivity_Get(nullptr), pADL_Overdrive5_Temperature_Get(nullptr), pADL_Overdrive5_FanSpeedInfo_Get(nullptr),
     pADL_Overdrive5_FanSpeed_Get(nullptr), pADL_Overdrive5_ODParameters_Get(nullptr), pADL_Overdrive5_ODPerformanceLevels_Get(nullptr),
-    pADL_Overdrive5_FanSpeed_Set(nullptr), pADL_Overdrive5_FanSpeedToDefault_Set(nullptr), pADL_Overdrive5_ODPerformanceLevels_Set(nullptr)
+    pADL_Overdrive5_FanSpeed_Set(nullptr), pADL_Overdrive5_FanSpeedToDefault_Set(nullptr), pADL_Overdrive5_ODPerformanceLevels_Set(nullptr),
+    pADL_Overdrive_Caps(nullptr), pADL_Overdrive6_Capabilities_Get(nullptr), pADL_Overdrive6_StateInfo_Get(nullptr),
+    pADL_Overdrive6_State_Set(nullptr), pADL_Overdrive6_PowerControlInfo_Get(nullptr), pADL_Overdrive6_PowerControl_Get(nullptr),
+    pADL_Overdrive6_PowerControl_Set(nullptr), pADL_OverdriveN_Capabilities_Get(nullptr), pADL_OverdriveN_SystemClocks_Get(nullptr),
+    pADL_OverdriveN_SystemClocks_Set(nullptr), pADL_OverdriveN_MemoryClocks_Get(nullptr), pADL_OverdriveN_MemoryClocks_Set(nullptr),
+    pADL_OverdriveN_PowerLimit_Get(nullptr), pADL_OverdriveN_PowerLimit_Set(nullptr)
 {
 
 }
@@ -14,13 +41,19 @@ bool ATIADLHandle::open()
 try
 {
     dlerror(); // clear old errors
-    handle = dlopen("libatiadlxx.so", RTLD_LAZY | RTLD_GLOBAL);
+
+    {
+        TimingTrace::Span span("startup", "dlopen libatiadlxx.so");
+        handle = dlopen("libatiadlxx.so", RTLD_LAZY | RTLD_GLOBAL);
+    }
 
     if (handle == nullptr)
     {
         return false;
     }
 
+    TimingTrace::Span span("startup", "resolve ADL symbols");
+
     pADL_Main_Control_Create = (ADL_Main_Control_Create_T) getSym("ADL_Main_Control_Create");
     pADL_Main_Control_Destroy = (ADL_Main_Control_Destroy_T) getSym("ADL_Main_Control_Destroy");
     pADL_ConsoleMode_FileDescriptor_Set = (ADL_ConsoleMode_FileDescriptor_Set_T) getSym("ADL_ConsoleMode_FileDescriptor_Set");
@@ -37,6 +70,21 @@ try
     pADL_Overdrive5_FanSpeedToDefault_Set = (ADL_Overdrive5_FanSpeedToDefault_Set_T) getSym("ADL_Overdrive5_FanSpeedToDefault_Set");
     pADL_Overdrive5_ODPerformanceLevels_Set = (ADL_Overdrive5_ODPerformanceLevels_Set_T) getSym("ADL_Overdrive5_ODPerformanceLevels_Set");
 
+    pADL_Overdrive_Caps = (ADL_Overdrive_Caps_T) getOptionalSym("ADL_Overdrive_Caps");
+    pADL_Overdrive6_Capabilities_Get = (ADL_Overdrive6_Capabilities_Get_T) getOptionalSym("ADL_Overdrive6_Capabilities_Get");
+    pADL_Overdrive6_StateInfo_Get = (ADL_Overdrive6_StateInfo_Get_T) getOptionalSym("ADL_Overdrive6_StateInfo_Get");
+    pADL_Overdrive6_State_Set = (ADL_Overdrive6_State_Set_T) getOptionalSym("ADL_Overdrive6_State_Set");
+    pADL_Overdrive6_PowerControlInfo_Get = (ADL_Overdrive6_PowerControlInfo_Get_T) getOptionalSym("ADL_Overdrive6_PowerControlInfo_Get");
+    pADL_Overdrive6_PowerControl_Get = (ADL_Overdrive6_PowerControl_Get_T) getOptionalSym("ADL_Overdrive6_PowerControl_Get");
+    pADL_Overdrive6_PowerControl_Set = (ADL_Overdrive6_PowerControl_Set_T) getOptionalSym("ADL_Overdrive6_PowerControl_Set");
+    pADL_OverdriveN_Capabilities_Get = (ADL_OverdriveN_Capabilities_Get_T) getOptionalSym("ADL_OverdriveN_Capabilities_Get");
+    pADL_OverdriveN_SystemClocks_Get = (ADL_OverdriveN_Clocks_T) getOptionalSym("ADL_OverdriveN_SystemClocks_Get");
+    pADL_OverdriveN_SystemClocks_Set = (ADL_OverdriveN_Clocks_T) getOptionalSym("ADL_OverdriveN_SystemClocks_Set");
+    pADL_OverdriveN_MemoryClocks_Get = (ADL_OverdriveN_Clocks_T) getOptionalSym("ADL_OverdriveN_MemoryClocks_Get");
+    pADL_OverdriveN_MemoryClocks_Set = (ADL_OverdriveN_Clocks_T) getOptionalSym("ADL_OverdriveN_MemoryClocks_Set");
+    pADL_OverdriveN_PowerLimit_Get = (ADL_OverdriveN_PowerLimit_T) getOptionalSym("ADL_OverdriveN_PowerLimit_Get");
+    pADL_OverdriveN_PowerLimit_Set = (ADL_OverdriveN_PowerLimit_T) getOptionalSym("ADL_OverdriveN_PowerLimit_Set");
+
     return true;
 }
 catch(...)
@@ -86,152 +134,403 @@ void* ATIADLHandle::getSym(const char* symbolName)
     return symbol;
 }
 
+void* ATIADLHandle::getOptionalSym(const char* symbolName)
+{
+    dlerror(); // clear old errors
+    void* symbol = dlsym(handle, symbolName);
+    dlerror();
+
+    return symbol;
+}
+
+bool ATIADLHandle::hasOverdrive6() const
+{
+    return pADL_Overdrive6_Capabilities_Get != nullptr && pADL_Overdrive6_StateInfo_Get != nullptr &&
+        pADL_Overdrive6_State_Set != nullptr && pADL_Overdrive6_PowerControlInfo_Get != nullptr &&
+        pADL_Overdrive6_PowerControl_Get != nullptr && pADL_Overdrive6_PowerControl_Set != nullptr;
+}
+
+bool ATIADLHandle::hasOverdriveN() const
+{
+    return pADL_OverdriveN_Capabilities_Get != nullptr && pADL_OverdriveN_SystemClocks_Get != nullptr &&
+        pADL_OverdriveN_SystemClocks_Set != nullptr && pADL_OverdriveN_MemoryClocks_Get != nullptr &&
+        pADL_OverdriveN_MemoryClocks_Set != nullptr && pADL_OverdriveN_PowerLimit_Get != nullptr &&
+        pADL_OverdriveN_PowerLimit_Set != nullptr;
+}
+
 void ATIADLHandle::Main_Control_Create(ADL_MAIN_MALLOC_CALLBACK callback, int iEnumConnectedAdapters) const
 {
+    ADLCallScope call("ADL_Main_Control_Create");
+
     int error = pADL_Main_Control_Create(callback, iEnumConnectedAdapters);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Main_Control_Create error.");
     }
 }
 
 void ATIADLHandle::Main_Control_Destroy() const
 {
+    ADLCallScope call("ADL_Main_Control_Destroy");
+
     int error = pADL_Main_Control_Destroy();
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Main_Control_Destroy error.");
     }
 }
 
 void ATIADLHandle::ConsoleMode_FileDescriptor_Set(int fileDescriptor) const
 {
+    ADLCallScope call("ADL_ConsoleMode_FileDescriptor_Set");
+
     int error = pADL_ConsoleMode_FileDescriptor_Set(fileDescriptor);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_ConsoleMode_FileDescriptor_Set error.");
     }
 }
 
 void ATIADLHandle::Adapter_NumberOfAdapters_Get(int* number) const
 {
+    ADLCallScope call("ADL_Adapter_NumberOfAdapters_Get");
+
     int error = pADL_Adapter_NumberOfAdapters_Get(number);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Adapter_NumberOfAdapters_Get error.");
     }
 }
 
 void ATIADLHandle::Adapter_Active_Get(int adapterIndex, int* status) const
 {
+    ADLCallScope call("ADL_Adapter_Active_Get");
+
     int error = pADL_Adapter_Active_Get(adapterIndex, status);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Adapter_Active_Get error.");
     }
 }
 
 void ATIADLHandle::Adapter_Info_Get(LPAdapterInfo info, int inputSize) const
 {
+    ADLCallScope call("ADL_Adapter_AdapterInfo_Get");
+
     int error = pADL_Adapter_AdapterInfo_Get(info, inputSize);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_AdapterInfo_Get error.");
     }
 }
 
 void ATIADLHandle::Overdrive5_CurrentActivity_Get(int adapterIndex, ADLPMActivity* activity) const
 {
+    ADLCallScope call("ADL_Overdrive5_CurrentActivity_Get");
+
     int error = pADL_Overdrive5_CurrentActivity_Get(adapterIndex, activity);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_CurrentActivity_Get error.");
     }
 }
 
 void ATIADLHandle::Overdrive5_Temperature_Get(int adapterIndex, int thermalCtrlIndex, ADLTemperature *temperature) const
 {
+    ADLCallScope call("ADL_Overdrive5_Temperature_Get");
+
     int error = pADL_Overdrive5_Temperature_Get(adapterIndex, thermalCtrlIndex, temperature);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_Temperature_Get error.");
     }
 }
 
 void ATIADLHandle::Overdrive5_FanSpeedInfo_Get(int adapterIndex, int thermalCtrlIndex, ADLFanSpeedInfo* fanSpeedInfo) const
 {
+    ADLCallScope call("ADL_Overdrive5_FanSpeedInfo_Get");
+
     int error = pADL_Overdrive5_FanSpeedInfo_Get(adapterIndex, thermalCtrlIndex, fanSpeedInfo);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_FanSpeedInfo_Get error.");
     }
 }
 
 void ATIADLHandle::Overdrive5_FanSpeed_Get(int adapterIndex, int thermalCtrlIndex, ADLFanSpeedValue* fanSpeedValue) const
 {
+    ADLCallScope call("ADL_Overdrive5_FanSpeed_Get");
+
     int error = pADL_Overdrive5_FanSpeed_Get(adapterIndex, thermalCtrlIndex, fanSpeedValue);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_FanSpeed_Get error");
     }
 }
 
 void ATIADLHandle::Overdrive5_ODParameters_Get(int adapterIndex, ADLODParameters* odParameters) const
 {
+    ADLCallScope call("ADL_Overdrive5_ODParameters_Get");
+
     int error = pADL_Overdrive5_ODParameters_Get(adapterIndex, odParameters);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_ODParameters_Get error");
     }
 }
 
 void ATIADLHandle::Overdrive5_ODPerformanceLevels_Get(int adapterIndex, int idefault, ADLODPerformanceLevels* odPerformanceLevels) const
 {
+    ADLCallScope call("ADL_Overdrive5_ODPerformanceLevels_Get");
+
     int error = pADL_Overdrive5_ODPerformanceLevels_Get(adapterIndex, idefault, odPerformanceLevels);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_ODPerformanceLevels_Get error");
     }
 }
 
 void ATIADLHandle::Overdrive5_FanSpeed_Set(int adapterIndex, int thermalCtrlIndex, ADLFanSpeedValue* fanSpeedValue) const
 {
+    ADLCallScope call("ADL_Overdrive5_FanSpeed_Set");
+
     int error = pADL_Overdrive5_FanSpeed_Set(adapterIndex, thermalCtrlIndex, fanSpeedValue);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_FanSpeed_Set error");
     }
 }
 
 void ATIADLHandle::Overdrive5_FanSpeedToDefault_Set(int adapterIndex, int thermalCtrlIndex) const
 {
+    ADLCallScope call("ADL_Overdrive5_FanSpeedToDefault_Set");
+
     int error = pADL_Overdrive5_FanSpeedToDefault_Set(adapterIndex, thermalCtrlIndex);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_FanSpeedToDefault_Set error");
     }
 }
 
 void ATIADLHandle::Overdrive5_ODPerformanceLevels_Set(int adapterIndex, ADLODPerformanceLevels* odPerformanceLevels) const
 {
+    ADLCallScope call("ADL_Overdrive5_ODPerformanceLevels_Set");
+
     int error = pADL_Overdrive5_ODPerformanceLevels_Set(adapterIndex, odPerformanceLevels);
 
     if (error != ADL_OK)
     {
+        call.setFailed();
         throw Error(error, "ADL_Overdrive5_ODPerformanceLevels_Set error");
     }
 }
+
+void ATIADLHandle::Overdrive_Caps(int adapterIndex, int* supported, int* enabled, int* version) const
+{
+    ADLCallScope call("ADL_Overdrive_Caps");
+
+    int error = pADL_Overdrive_Caps(adapterIndex, supported, enabled, version);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_Overdrive_Caps error");
+    }
+}
+
+void ATIADLHandle::Overdrive6_Capabilities_Get(int adapterIndex, ADLOD6Capabilities* capabilities) const
+{
+    ADLCallScope call("ADL_Overdrive6_Capabilities_Get");
+
+    int error = pADL_Overdrive6_Capabilities_Get(adapterIndex, capabilities);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_Overdrive6_Capabilities_Get error");
+    }
+}
+
+void ATIADLHandle::Overdrive6_StateInfo_Get(int adapterIndex, int stateType, ADLOD6StateInfo* stateInfo) const
+{
+    ADLCallScope call("ADL_Overdrive6_StateInfo_Get");
+
+    int error = pADL_Overdrive6_StateInfo_Get(adapterIndex, stateType, stateInfo);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_Overdrive6_StateInfo_Get error");
+    }
+}
+
+void ATIADLHandle::Overdrive6_State_Set(int adapterIndex, int stateType, ADLOD6StateInfo* stateInfo) const
+{
+    ADLCallScope call("ADL_Overdrive6_State_Set");
+
+    int error = pADL_Overdrive6_State_Set(adapterIndex, stateType, stateInfo);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_Overdrive6_State_Set error");
+    }
+}
+
+void ATIADLHandle::Overdrive6_PowerControlInfo_Get(int adapterIndex, ADLOD6PowerControlInfo* powerControlInfo) const
+{
+    ADLCallScope call("ADL_Overdrive6_PowerControlInfo_Get");
+
+    int error = pADL_Overdrive6_PowerControlInfo_Get(adapterIndex, powerControlInfo);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_Overdrive6_PowerControlInfo_Get error");
+    }
+}
+
+void ATIADLHandle::Overdrive6_PowerControl_Get(int adapterIndex, int* currentValue, int* defaultValue) const
+{
+    ADLCallScope call("ADL_Overdrive6_PowerControl_Get");
+
+    int error = pADL_Overdrive6_PowerControl_Get(adapterIndex, currentValue, defaultValue);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_Overdrive6_PowerControl_Get error");
+    }
+}
+
+void ATIADLHandle::Overdrive6_PowerControl_Set(int adapterIndex, int value) const
+{
+    ADLCallScope call("ADL_Overdrive6_PowerControl_Set");
+
+    int error = pADL_Overdrive6_PowerControl_Set(adapterIndex, value);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_Overdrive6_PowerControl_Set error");
+    }
+}
+
+void ATIADLHandle::OverdriveN_Capabilities_Get(int adapterIndex, ADLODNCapabilities* capabilities) const
+{
+    ADLCallScope call("ADL_OverdriveN_Capabilities_Get");
+
+    int error = pADL_OverdriveN_Capabilities_Get(adapterIndex, capabilities);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_OverdriveN_Capabilities_Get error");
+    }
+}
+
+void ATIADLHandle::OverdriveN_SystemClocks_Get(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels) const
+{
+    ADLCallScope call("ADL_OverdriveN_SystemClocks_Get");
+
+    int error = pADL_OverdriveN_SystemClocks_Get(adapterIndex, odPerformanceLevels);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_OverdriveN_SystemClocks_Get error");
+    }
+}
+
+void ATIADLHandle::OverdriveN_SystemClocks_Set(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels) const
+{
+    ADLCallScope call("ADL_OverdriveN_SystemClocks_Set");
+
+    int error = pADL_OverdriveN_SystemClocks_Set(adapterIndex, odPerformanceLevels);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_OverdriveN_SystemClocks_Set error");
+    }
+}
+
+void ATIADLHandle::OverdriveN_MemoryClocks_Get(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels) const
+{
+    ADLCallScope call("ADL_OverdriveN_MemoryClocks_Get");
+
+    int error = pADL_OverdriveN_MemoryClocks_Get(adapterIndex, odPerformanceLevels);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_OverdriveN_MemoryClocks_Get error");
+    }
+}
+
+void ATIADLHandle::OverdriveN_MemoryClocks_Set(int adapterIndex, ADLODNPerformanceLevels* odPerformanceLevels) const
+{
+    ADLCallScope call("ADL_OverdriveN_MemoryClocks_Set");
+
+    int error = pADL_OverdriveN_MemoryClocks_Set(adapterIndex, odPerformanceLevels);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_OverdriveN_MemoryClocks_Set error");
+    }
+}
+
+void ATIADLHandle::OverdriveN_PowerLimit_Get(int adapterIndex, ADLODNPowerLimitSetting* powerLimit) const
+{
+    ADLCallScope call("ADL_OverdriveN_PowerLimit_Get");
+
+    int error = pADL_OverdriveN_PowerLimit_Get(adapterIndex, powerLimit);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_OverdriveN_PowerLimit_Get error");
+    }
+}
+
+void ATIADLHandle::OverdriveN_PowerLimit_Set(int adapterIndex, ADLODNPowerLimitSetting* powerLimit) const
+{
+    ADLCallScope call("ADL_OverdriveN_PowerLimit_Set");
+
+    int error = pADL_OverdriveN_PowerLimit_Set(adapterIndex, powerLimit);
+
+    if (error != ADL_OK)
+    {
+        call.setFailed();
+        throw Error(error, "ADL_OverdriveN_PowerLimit_Set error");
+    }
+}
@@ -0,0 +1,199 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "error.h"
+
+extern char** environ;
+
+CommandBenchmark::CommandBenchmark(const std::string& _command, const std::string& metricPattern, unsigned int _timeout) :
+    command(_command), timeout(_timeout), processGroup(0)
+{
+    try
+    {
+        metricRegex = std::regex(metricPattern);
+    }
+    catch(const std::regex_error& error)
+    {
+        throw Error((std::string("Invalid metric regular expression '") + metricPattern + "'").c_str());
+    }
+}
+
+/* the command runs in its own process group, so the kill after timeout reaches
+ * processes started by the shell too. The environment is prepared before fork,
+ * as the child of a threaded process may call only async-signal-safe functions. */
+bool CommandBenchmark::runCommand(int adapterIndex, std::string& output)
+{
+    const std::string adapterVariable = "AMDCOVC_ADAPTER=" + std::to_string(adapterIndex);
+    std::vector<char*> environment;
+
+    for (char** variable = environ; *variable != nullptr; variable++)
+    {
+        if (::strncmp(*variable, "AMDCOVC_ADAPTER=", 16) != 0)
+        {
+            environment.push_back(*variable);
+        }
+    }
+
+    environment.push_back(const_cast<char*>(adapterVariable.c_str()));
+    environment.push_back(nullptr);
+
+    int fds[2];
+
+    if (::pipe(fds) != 0)
+    {
+        throw Error(errno, (std::string("Unable to run benchmark '") + command + "'").c_str());
+    }
+
+    const pid_t pid = ::fork();
+
+    if (pid < 0)
+    {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        throw Error(errno, (std::string("Unable to run benchmark '") + command + "'").c_str());
+    }
+
+    if (pid == 0)
+    {
+        ::setpgid(0, 0);
+        ::dup2(fds[1], STDOUT_FILENO);
+        ::close(fds[0]);
+        ::close(fds[1]);
+        ::execle("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr), environment.data());
+        ::_exit(127);
+    }
+
+    ::close(fds[1]);
+    processGroup = pid;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+    bool timedOut = false;
+    char buffer[4096];
+
+    while (true)
+    {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        struct pollfd pollFd = { fds[0], POLLIN, 0 };
+
+        if (remaining.count() <= 0)
+        {
+            timedOut = true;
+            break;
+        }
+
+        const int ready = ::poll(&pollFd, 1, int(std::min<long long>(remaining.count(), INT_MAX)));
+
+        // deadline is checked again after a signal or an expired poll
+        if (ready == 0 || (ready < 0 && errno == EINTR))
+        {
+            continue;
+        }
+
+        const ssize_t readSize = (ready > 0) ? ::read(fds[0], buffer, sizeof(buffer)) : -1;
+
+        if (readSize < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (readSize <= 0)
+        {
+            break;      // end of output or error
+        }
+
+        output.append(buffer, readSize);
+    }
+
+    ::close(fds[0]);
+
+    // the command can close its output and still run, so the deadline holds for the wait too
+    int status;
+
+    while (true)
+    {
+        if (timedOut)
+        {
+            ::kill(-pid, SIGKILL);
+        }
+
+        const pid_t waited = ::waitpid(pid, &status, timedOut ? 0 : WNOHANG);
+
+        if (waited == pid)
+        {
+            break;
+        }
+
+        if (waited < 0 && errno != EINTR)
+        {
+            processGroup = 0;
+            return false;
+        }
+
+        if (waited == 0)
+        {
+            timedOut = std::chrono::steady_clock::now() >= deadline;
+
+            if (!timedOut)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+    }
+
+    processGroup = 0;
+
+    return !timedOut && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/* only async-signal-safe calls */
+void CommandBenchmark::interrupt()
+{
+    const pid_t group = processGroup;
+
+    if (group > 0)
+    {
+        ::kill(-group, SIGKILL);
+    }
+}
+
+bool CommandBenchmark::run(int adapterIndex, double& metric)
+{
+    std::string output;
+
+    if (!runCommand(adapterIndex, output))
+    {
+        return false;
+    }
+
+    bool found = false;
+
+    for (std::sregex_iterator it(output.begin(), output.end(), metricRegex), end; it != end; ++it)
+    {
+        const std::smatch& match = *it;
+        const std::string text = (match.size() > 1 && match[1].matched) ? match[1].str() : match[0].str();
+        char* endPtr;
+
+        errno = 0;
+        const double value = ::strtod(text.c_str(), &endPtr);
+
+        if (errno == 0 && endPtr != text.c_str())
+        {
+            metric = value;
+            found = true;
+        }
+    }
+
+    return found;
+}
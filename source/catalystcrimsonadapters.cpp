@@ -1,111 +1,86 @@
 #include "catalystcrimsonadapters.h"
 
-void CatalystCrimsonAdapters::PrintInfo(ADLMainControl& mainControl, int adaptersNum, const std::vector<int>& activeAdapters,
-                                        const std::vector<int>& choosenAdapters, bool useChoosen)
+void CatalystCrimsonAdapters::PrintInfo(ADLMainControl& mainControl, ADLAdapterTable& adapterTable, const std::vector<int>& choosenAdapters,
+                                        bool useChoosen)
 {
-    std::unique_ptr<AdapterInfo[]> adapterInfos(new AdapterInfo[adaptersNum]);
-    ::memset(adapterInfos.get(), 0, sizeof(AdapterInfo)*adaptersNum);
-    mainControl.getAdapterInfo(adapterInfos.get());
-
-    int i = 0;
+    OutputBuffer out;
     auto choosenIter = choosenAdapters.begin();
 
-    for (int ai = 0; ai < adaptersNum; ai++)
+    for (int i = 0; i < adapterTable.getAdaptersNum(); i++)
     {
-        if (!mainControl.isAdapterActive(ai))
-        {
-            continue;
-        }
-
         if (useChoosen && (choosenIter==choosenAdapters.end() || *choosenIter!=i))
         {
-            i++;
             continue;
         }
 
-        if (adapterInfos[ai].strAdapterName[0] == 0)
-        {
-            PCIAccess::GetFromPCI(adapterInfos[ai].iAdapterIndex, adapterInfos[ai]);
-        }
+        const int ai = adapterTable.getADLIndex(i);
+        const AdapterInfo& adapterInfo = adapterTable.getAdapterInfo(i);
 
         ADLPMActivity activity;
         mainControl.getCurrentActivity(ai, activity);
 
-        std::cout << "Adapter " << i << ": " << adapterInfos[ai].strAdapterName << "\n"
+        out << "Adapter " << i << ": " << adapterInfo.strAdapterName << "\n"
                 "  Core: " << activity.iEngineClock/100.0 << " MHz, "
                 "Mem: " << activity.iMemoryClock/100.0 << " MHz, "
                 "Vddc: " << activity.iVddc/1000.0 << " V, "
                 "Load: " << activity.iActivityPercent << "%, "
                 "Temp: " << mainControl.getTemperature(ai, 0)/1000.0 << " C, "
-                "Fan: " << mainControl.getFanSpeed(ai, 0) << "%" << std::endl;
+                "Fan: " << mainControl.getFanSpeed(ai, 0) << "%" << '\n';
 
-        ADLODParameters odParams;
-        mainControl.getODParameters(ai, odParams);
+        const ADLODParameters& odParams = adapterTable.getODParameters(i);
 
-        std::cout << "  Max Ranges: Core: " << odParams.sEngineClock.iMin/100.0 << " - " << odParams.sEngineClock.iMax/100.0 << " MHz, "
+        out << "  Max Ranges: Core: " << odParams.sEngineClock.iMin/100.0 << " - " << odParams.sEngineClock.iMax/100.0 << " MHz, "
             "Mem: " << odParams.sMemoryClock.iMin/100.0 << " - " << odParams.sMemoryClock.iMax/100.0 << " MHz, " <<
             "Vddc: " <<  odParams.sVddc.iMin/1000.0 << " - " << odParams.sVddc.iMax/1000.0 << " V\n";
 
-        int levelsNum = odParams.iNumberOfPerformanceLevels;
+        const int levelsNum = odParams.iNumberOfPerformanceLevels;
+        std::vector<ADLODPerformanceLevel> odPLevels;
 
-        std::unique_ptr<ADLODPerformanceLevel[]> odPLevels(new ADLODPerformanceLevel[levelsNum]);
+        adapterTable.getPerfLevels(i, odPLevels);
 
-        mainControl.getODPerformanceLevels(ai, false, levelsNum, odPLevels.get());
-
-        std::cout << "  PerfLevels: Core: " << odPLevels[0].iEngineClock/100.0 << " - " << odPLevels[levelsNum-1].iEngineClock/100.0 << " MHz, "
-            "Mem: " << odPLevels[0].iMemoryClock/100.0 << " - " << odPLevels[levelsNum-1].iMemoryClock/100.0 << " MHz, "
-            "Vddc: " << odPLevels[0].iVddc/1000.0 << " - " << odPLevels[levelsNum-1].iVddc/1000.0 << " V\n";
+        if (levelsNum > 0)
+        {
+            out << "  PerfLevels: Core: " << odPLevels[0].iEngineClock/100.0 << " - " << odPLevels[levelsNum-1].iEngineClock/100.0 << " MHz, "
+                "Mem: " << odPLevels[0].iMemoryClock/100.0 << " - " << odPLevels[levelsNum-1].iMemoryClock/100.0 << " MHz, "
+                "Vddc: " << odPLevels[0].iVddc/1000.0 << " - " << odPLevels[levelsNum-1].iVddc/1000.0 << " V\n";
+        }
 
         if (useChoosen)
         {
             ++choosenIter;
         }
 
-        i++;
-        std::cout << std::endl;
+        out << '\n';
     }
 }
 
-void CatalystCrimsonAdapters::PrintInfoVerbose(ADLMainControl& mainControl, int adaptersNum, const std::vector<int>& activeAdapters,
-                                         const std::vector<int>& choosenAdapters, bool useChoosen)
+void CatalystCrimsonAdapters::PrintInfoVerbose(ADLMainControl& mainControl, ADLAdapterTable& adapterTable,
+                                               const std::vector<int>& choosenAdapters, bool useChoosen)
 {
-    std::unique_ptr<AdapterInfo[]> adapterInfos(new AdapterInfo[adaptersNum]);
-    ::memset(adapterInfos.get(), 0, sizeof(AdapterInfo)*adaptersNum);
-
-    mainControl.getAdapterInfo(adapterInfos.get());
-
-    int i = 0;
+    OutputBuffer out;
     auto choosenIter = choosenAdapters.begin();
 
-    for (int ai = 0; ai < adaptersNum; ai++)
+    for (int i = 0; i < adapterTable.getAdaptersNum(); i++)
     {
-        if (!mainControl.isAdapterActive(ai))
-        {
-            continue;
-        }
-
         if (useChoosen && (choosenIter==choosenAdapters.end() || *choosenIter!=i))
         {
-            i++;
             continue;
         }
 
-        if (adapterInfos[ai].strAdapterName[0] == 0)
-        {
-            PCIAccess::GetFromPCI(adapterInfos[ai].iAdapterIndex, adapterInfos[ai]);
-        }
+        const int ai = adapterTable.getADLIndex(i);
+        const AdapterInfo& adapterInfo = adapterTable.getAdapterInfo(i);
 
-        std::cout <<
-            "Adapter " << i << ": " << adapterInfos[ai].strAdapterName << "\n"
-            "  Device Topology: " << adapterInfos[ai].iBusNumber << ':' << adapterInfos[ai].iDeviceNumber << ":" << adapterInfos[ai].iFunctionNumber << "\n"
-            "  Vendor ID: " << adapterInfos[ai].iVendorID << std::endl;
+        out <<
+            "Adapter " << i << ": " << adapterInfo.strAdapterName << "\n"
+            "  Device Topology: " << adapterInfo.iBusNumber << ':' << adapterInfo.iDeviceNumber << ":" << adapterInfo.iFunctionNumber << "\n"
+            "  Vendor ID: " << adapterInfo.iVendorID << '\n';
 
         ADLFanSpeedInfo fsInfo;
         ADLPMActivity activity;
 
         mainControl.getCurrentActivity(ai, activity);
 
-        std::cout << "  Current CoreClock: " << activity.iEngineClock / 100.0 << " MHz\n"
+        out << "  Current CoreClock: " << activity.iEngineClock / 100.0 << " MHz\n"
             "  Current MemoryClock: " << activity.iMemoryClock / 100.0 << " MHz\n"
             "  Current Voltage: " << activity.iVddc / 1000.0 << " V\n"
             "  GPU Load: " << activity.iActivityPercent << "%\n"
@@ -115,21 +90,30 @@ void CatalystCrimsonAdapters::PrintInfoVerbose(ADLMainControl& mainControl, int
 
         int temperature = mainControl.getTemperature(ai, 0);
 
-        std::cout << "  Temperature: " << temperature / 1000.0 << " C\n";
+        out << "  Temperature: " << temperature / 1000.0 << " C\n";
 
         mainControl.getFanSpeedInfo(ai, 0, fsInfo);
 
-        std::cout << "  FanSpeed Min: " << fsInfo.iMinPercent << "%\n"
+        out << "  FanSpeed Min: " << fsInfo.iMinPercent << "%\n"
             "  FanSpeed Max: " << fsInfo.iMaxPercent << "%\n"
             "  FanSpeed MinRPM: " << fsInfo.iMinRPM << " RPM\n"
             "  FanSpeed MaxRPM: " << fsInfo.iMaxRPM << " RPM" << "\n";
 
-        std::cout << "  Current FanSpeed: " << mainControl.getFanSpeed(ai, 0) << "%\n";
+        out << "  Current FanSpeed: " << mainControl.getFanSpeed(ai, 0) << "%\n";
 
-        ADLODParameters odParams;
-        mainControl.getODParameters(ai, odParams);
+        const ADLODParameters& odParams = adapterTable.getODParameters(i);
 
-        std::cout <<
+        out << "  Overdrive version: " << adapterTable.getODVersion(i) << '\n';
+
+        if (adapterTable.hasPowerControl(i))
+        {
+            const ADLODParameterRange& range = adapterTable.getPowerControlRange(i);
+
+            out << "  Power control: " << adapterTable.getPowerControl(i) << "%, range: " << range.iMin << " - " << range.iMax <<
+                "%, default: " << adapterTable.getDefaultPowerControl(i) << "%\n";
+        }
+
+        out <<
             "  CoreClock: " << odParams.sEngineClock.iMin / 100.0 << " - " << odParams.sEngineClock.iMax / 100.0 <<
             " MHz, step: " << odParams.sEngineClock.iStep / 100.0 << " MHz\n"
             "  MemClock: " << odParams.sMemoryClock.iMin / 100.0 << " - " << odParams.sMemoryClock.iMax / 100.0 <<
@@ -137,55 +121,175 @@ void CatalystCrimsonAdapters::PrintInfoVerbose(ADLMainControl& mainControl, int
             "  Voltage: " << odParams.sVddc.iMin / 1000.0 << " - " << odParams.sVddc.iMax / 1000.0 <<
             " V, step: " << odParams.sVddc.iStep / 1000.0 << " V\n";
 
-        std::unique_ptr<ADLODPerformanceLevel[]> odPLevels(new ADLODPerformanceLevel[odParams.iNumberOfPerformanceLevels]);
+        std::vector<ADLODPerformanceLevel> odPLevels;
 
-        mainControl.getODPerformanceLevels(ai, false, odParams.iNumberOfPerformanceLevels, odPLevels.get());
+        adapterTable.getPerfLevels(i, odPLevels);
 
-        std::cout << "  Performance levels: " << odParams.iNumberOfPerformanceLevels << "\n";
+        out << "  Performance levels: " << odParams.iNumberOfPerformanceLevels << "\n";
 
         for (int j = 0; j < odParams.iNumberOfPerformanceLevels; j++)
         {
-            std::cout <<
+            out <<
                 "    Performance Level: " << j << "\n"
                 "      CoreClock: " << odPLevels[j].iEngineClock / 100.0 << " MHz\n"
                 "      MemClock: " << odPLevels[j].iMemoryClock / 100.0 << " MHz\n"
                 "      Voltage: " << odPLevels[j].iVddc / 1000.0 << " V\n";
         }
 
-        mainControl.getODPerformanceLevels(ai, true, odParams.iNumberOfPerformanceLevels, odPLevels.get());
+        const std::vector<ADLODPerformanceLevel>& defaultPLevels = adapterTable.getDefaultPerfLevels(i);
 
-        std::cout << "  Default Performance levels: " << odParams.iNumberOfPerformanceLevels << "\n";
+        out << "  Default Performance levels: " << odParams.iNumberOfPerformanceLevels << "\n";
 
         for (int j = 0; j < odParams.iNumberOfPerformanceLevels; j++)
         {
-            std::cout <<
+            out <<
                 "    Performance Level: " << j << "\n"
-                "      CoreClock: " << odPLevels[j].iEngineClock / 100.0 << " MHz\n"
-                "      MemClock: " << odPLevels[j].iMemoryClock / 100.0 << " MHz\n"
-                "      Voltage: " << odPLevels[j].iVddc / 1000.0 << " V\n";
+                "      CoreClock: " << defaultPLevels[j].iEngineClock / 100.0 << " MHz\n"
+                "      MemClock: " << defaultPLevels[j].iMemoryClock / 100.0 << " MHz\n"
+                "      Voltage: " << defaultPLevels[j].iVddc / 1000.0 << " V\n";
         }
 
-        std::cout.flush();
-
         if (useChoosen)
         {
             ++choosenIter;
         }
 
-        i++;
-        std::cout << std::endl;
+        out << '\n';
     }
 }
 
-void CatalystCrimsonAdapters::GetActiveAdaptersIndices(ADLMainControl& mainControl, int adaptersNum, std::vector<int>& activeAdapters)
+void CatalystCrimsonAdapters::PrintInfoStructured(ADLMainControl& mainControl, ADLAdapterTable& adapterTable,
+                                                  const std::vector<int>& choosenAdapters, bool useChoosen, OutputWriter& writer)
 {
-    activeAdapters.clear();
+    auto choosenIter = choosenAdapters.begin();
+
+    writer.BeginDocument();
 
-    for (int i = 0; i < adaptersNum; i++)
+    for (int i = 0; i < adapterTable.getAdaptersNum(); i++)
     {
-        if (mainControl.isAdapterActive(i))
+        if (useChoosen && (choosenIter==choosenAdapters.end() || *choosenIter!=i))
         {
-            activeAdapters.push_back(i);
+            continue;
+        }
+
+        const int ai = adapterTable.getADLIndex(i);
+        const AdapterInfo& adapterInfo = adapterTable.getAdapterInfo(i);
+
+        writer.BeginRecord();
+        writer.Field("index", i);
+        writer.Field("backend", "adl");
+        writer.Field("name", adapterInfo.strAdapterName);
+        writer.Field("adlIndex", adapterInfo.iAdapterIndex);
+        writer.Field("busNo", adapterInfo.iBusNumber);
+        writer.Field("deviceNo", adapterInfo.iDeviceNumber);
+        writer.Field("funcNo", adapterInfo.iFunctionNumber);
+        writer.Field("vendorId", adapterInfo.iVendorID);
+        writer.Field("udid", adapterInfo.strUDID);
+
+        ADLPMActivity activity;
+        mainControl.getCurrentActivity(ai, activity);
+
+        writer.BeginObject("activity");
+        writer.Field("engineClock", activity.iEngineClock / 100.0);
+        writer.Field("memoryClock", activity.iMemoryClock / 100.0);
+        writer.Field("vddc", activity.iVddc / 1000.0);
+        writer.Field("activityPercent", activity.iActivityPercent);
+        writer.Field("currentPerformanceLevel", activity.iCurrentPerformanceLevel);
+        writer.Field("currentBusSpeed", activity.iCurrentBusSpeed);
+        writer.Field("currentBusLanes", activity.iCurrentBusLanes);
+        writer.Field("maximumBusLanes", activity.iMaximumBusLanes);
+        writer.EndObject();
+
+        writer.Field("temperature", mainControl.getTemperature(ai, 0) / 1000.0);
+
+        ADLFanSpeedInfo fsInfo;
+        mainControl.getFanSpeedInfo(ai, 0, fsInfo);
+
+        writer.BeginObject("fan");
+        writer.Field("flags", fsInfo.iFlags);
+        writer.Field("minPercent", fsInfo.iMinPercent);
+        writer.Field("maxPercent", fsInfo.iMaxPercent);
+        writer.Field("minRPM", fsInfo.iMinRPM);
+        writer.Field("maxRPM", fsInfo.iMaxRPM);
+        writer.Field("percent", mainControl.getFanSpeed(ai, 0));
+        writer.EndObject();
+
+        const ADLODParameters& odParams = adapterTable.getODParameters(i);
+
+        writer.BeginObject("odParameters");
+        writer.Field("numberOfPerformanceLevels", odParams.iNumberOfPerformanceLevels);
+        writer.Field("activityReportingSupported", odParams.iActivityReportingSupported != 0);
+        writer.Field("discretePerformanceLevels", odParams.iDiscretePerformanceLevels != 0);
+        writeODParameterRange(writer, "engineClock", odParams.sEngineClock, 100.0);
+        writeODParameterRange(writer, "memoryClock", odParams.sMemoryClock, 100.0);
+        writeODParameterRange(writer, "vddc", odParams.sVddc, 1000.0);
+        writer.EndObject();
+
+        writer.Field("odVersion", adapterTable.getODVersion(i));
+
+        if (adapterTable.hasPowerControl(i))
+        {
+            writer.BeginObject("powerControl");
+            writer.Field("value", adapterTable.getPowerControl(i));
+            writer.Field("default", adapterTable.getDefaultPowerControl(i));
+            writeODParameterRange(writer, "range", adapterTable.getPowerControlRange(i), 1.0);
+            writer.EndObject();
+        }
+
+        std::vector<ADLODPerformanceLevel> odPLevels;
+        adapterTable.getPerfLevels(i, odPLevels);
+
+        writePerformanceLevels(writer, "perfLevels", odPLevels);
+        writePerformanceLevels(writer, "defaultPerfLevels", adapterTable.getDefaultPerfLevels(i));
+
+        writer.EndRecord();
+
+        if (useChoosen)
+        {
+            ++choosenIter;
         }
     }
+
+    writer.EndDocument();
+}
+
+void CatalystCrimsonAdapters::writeODParameterRange(OutputWriter& writer, const char* name, const ADLODParameterRange& range, double divider)
+{
+    writer.BeginObject(name);
+    writer.Field("min", range.iMin / divider);
+    writer.Field("max", range.iMax / divider);
+    writer.Field("step", range.iStep / divider);
+    writer.EndObject();
+}
+
+void CatalystCrimsonAdapters::writePerformanceLevels(OutputWriter& writer, const char* name,
+                                                     const std::vector<ADLODPerformanceLevel>& perfLevels)
+{
+    writer.BeginArray(name);
+
+    for (const ADLODPerformanceLevel& perfLevel: perfLevels)
+    {
+        writer.BeginObject(nullptr);
+        writer.Field("engineClock", perfLevel.iEngineClock / 100.0);
+        writer.Field("memoryClock", perfLevel.iMemoryClock / 100.0);
+        writer.Field("vddc", perfLevel.iVddc / 1000.0);
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+}
+
+int CatalystCrimsonAdapters::ParseDeviceIdFromUDID(const char* udid)
+{
+    const char* dev = ::strstr(udid, "DEV_");
+
+    if (dev == nullptr)
+    {
+        return -1;
+    }
+
+    char* end;
+    int deviceId = ::strtol(dev + 4, &end, 16);
+
+    return (end != dev + 4) ? deviceId : -1;
 }
@@ -1,334 +1,400 @@
 #include "catalystcrimsonovc.h"
 
-void CatalystCrimsonOvc::Set(ADLMainControl& MainControl, const std::vector<int>& ActiveAdapters, const std::vector<OVCParameter>& OvcParams)
+void CatalystCrimsonOvc::Set(ADLMainControl& MainControl, ADLAdapterTable& AdapterTable, const std::vector<OVCParameter>& OvcParams,
+                             bool Report, std::ostream& Errors)
 {
-    std::cout << ConstStrings::OverdriveWarning << std::endl;
+    if (Report)
+    {
+        std::cout << ConstStrings::OverdriveWarning << std::endl;
+    }
+
+    const int realAdaptersNum = AdapterTable.getAdaptersNum();
+
+    bool failed = false;
 
-    const int realAdaptersNum = ActiveAdapters.size();
+    const OVCPlan plan(OvcParams, realAdaptersNum, Errors, failed);
 
-    std::vector<ADLODParameters> odParams(realAdaptersNum);
     std::vector<std::vector<ADLODPerformanceLevel> > perfLevels(realAdaptersNum);
-    std::vector<std::vector<ADLODPerformanceLevel> > defaultPerfLevels(realAdaptersNum);
-    std::vector<bool> changedDevices(realAdaptersNum);
-    std::fill(changedDevices.begin(), changedDevices.end(), false);
 
-    bool failed = false;
+    // only adapters with actions are queried, Overdrive parameters come from the table
+    for (int ai = 0; ai < realAdaptersNum; ai++)
+    {
+        if (!plan.hasActions(ai))
+        {
+            continue;
+        }
 
-    for (OVCParameter param: OvcParams)
+        AdapterTable.getPerfLevels(ai, perfLevels[ai]);
+    }
+
+    checkParameters(plan, AdapterTable, Errors, failed);
+
+    if (failed)
     {
-        if (!param.allAdapters)
+        Errors << "No settings applied. Error in parameters!" << std::endl;
+        throw Error("Wrong parameters!");
+    }
+
+    if (Report)
+    {
+        printChanges(plan, AdapterTable);
+    }
+
+    for (int i = 0; i < realAdaptersNum; i++)
+    {
+        bool changedDevice = false;
+        int fanSpeedAction = -1;
+        int powerControlAction = -1;
+
+        for (int action = plan.getActionsBegin(i); action < plan.getActionsEnd(i); action++)
         {
-            bool listFailed = false;
+            if (plan.getType(action) == OVCParamType::FAN_SPEED)
+            {
+                fanSpeedAction = action;
+                continue;
+            }
 
-            for (int adapterIndex: param.adapters)
+            if (plan.getType(action) == OVCParamType::POWER_CONTROL)
             {
-                if (!listFailed && (adapterIndex >= realAdaptersNum || adapterIndex <0 ))
-                {
-                    std::cerr << "Some adapter indices are out of range in '" << param.argText << "'!" << std::endl;
-                    listFailed = failed = true;
-                }
+                powerControlAction = action;
+                continue;
+            }
+
+            if (isAMDGPUOnly(plan.getType(action)))
+            {
+                continue;
             }
+
+            const bool useDefault = plan.isDefault(action);
+            const double value = plan.getValue(action);
+            int partId = getPerfLevel(plan, action, AdapterTable, i);
+            ADLODPerformanceLevel& perfLevel = perfLevels[i][partId];
+            // default levels are read only if needed
+            const ADLODPerformanceLevel* defaultPerfLevel = useDefault ? &AdapterTable.getDefaultPerfLevels(i)[partId] : nullptr;
+
+            switch(plan.getType(action))
+            {
+                case OVCParamType::CORE_CLOCK:
+
+                    perfLevel.iEngineClock = useDefault ? defaultPerfLevel->iEngineClock : int(round(value * 100.0));
+                    break;
+
+                case OVCParamType::MEMORY_CLOCK:
+
+                    perfLevel.iMemoryClock = useDefault ? defaultPerfLevel->iMemoryClock : int(round(value * 100.0));
+                    break;
+
+                case OVCParamType::VDDC_VOLTAGE:
+
+                    if (useDefault)
+                    {
+                        perfLevel.iVddc = defaultPerfLevel->iVddc;
+                    }
+                    else if (perfLevel.iVddc == 0)
+                    {
+                        Errors << "Voltage for adapter " << i << " is not set!" << std::endl;
+                    }
+                    else
+                    {
+                        perfLevel.iVddc = int(round(value * 1000.0));
+                    }
+                    break;
+
+                default:
+
+                    break;
+            }
+
+            changedDevice = true;
         }
-    }
 
-    // check fanspeed
-    for (OVCParameter param: OvcParams)
-    {
-        if (param.type == OVCParamType::FAN_SPEED)
+        if (fanSpeedAction >= 0)
         {
-            if(param.partId != 0)
+            if (!plan.isDefault(fanSpeedAction))
             {
-                std::cerr << "Thermal Control Index is not 0 in '" << param.argText << "'!" << std::endl;
-                failed = true;
+                MainControl.setFanSpeed(AdapterTable.getADLIndex(i), 0 /* must be zero */, int(round(plan.getValue(fanSpeedAction))));
             }
-            if(!param.useDefault && (param.value < 0.0 || param.value > 100.0))
+            else
             {
-                std::cerr << "FanSpeed value out of range in '" << param.argText << "'!" << std::endl;
-                failed = true;
+                MainControl.setFanSpeedToDefault(AdapterTable.getADLIndex(i), 0);
             }
         }
+
+        if (powerControlAction >= 0)
+        {
+            AdapterTable.setPowerControl(i, plan.isDefault(powerControlAction) ? AdapterTable.getDefaultPowerControl(i) :
+                                         int(round(plan.getValue(powerControlAction))));
+        }
+
+        if (changedDevice)
+        {
+            AdapterTable.setPerfLevels(i, perfLevels[i]);
+        }
     }
+}
 
-    for (int ai = 0; ai < realAdaptersNum; ai++)
+/* parameters without ADL counterpart, ignored when applying */
+bool CatalystCrimsonOvc::isAMDGPUOnly(OVCParamType type)
+{
+    switch(type)
     {
-        int i = ActiveAdapters[ai];
+        case OVCParamType::CORE_OD:
+        case OVCParamType::MEMORY_OD:
+        case OVCParamType::POWER_CAP:
+        case OVCParamType::POWER_PROFILE:
+        case OVCParamType::PERFORMANCE_LEVEL:
+        case OVCParamType::CORE_CLOCK_MASK:
+        case OVCParamType::MEMORY_CLOCK_MASK:
+        case OVCParamType::PCIE_MASK:
+        case OVCParamType::FAN_RPM:
 
-        MainControl.getODParameters(i, odParams[ai]);
+            return true;
 
-        perfLevels[ai].resize(odParams[ai].iNumberOfPerformanceLevels);
-        defaultPerfLevels[ai].resize(odParams[ai].iNumberOfPerformanceLevels);
+        default:
 
-        MainControl.getODPerformanceLevels(i, 0, odParams[ai].iNumberOfPerformanceLevels, perfLevels[ai].data());
-        MainControl.getODPerformanceLevels(i, 1, odParams[ai].iNumberOfPerformanceLevels, defaultPerfLevels[ai].data());
+            return false;
     }
+}
 
-    // check other params
-    for (OVCParameter param: OvcParams)
+int CatalystCrimsonOvc::getPerfLevel(const OVCPlan& plan, int action, ADLAdapterTable& adapterTable, int adapterIndex)
+{
+    if (plan.getPartId(action) != LAST_PERFLEVEL)
+    {
+        return plan.getPartId(action);
+    }
+
+    return ((plan.getType(action) == OVCParamType::MEMORY_CLOCK) ? adapterTable.getMemoryLevelsNum(adapterIndex) :
+            adapterTable.getCoreLevelsNum(adapterIndex)) - 1;
+}
+
+void CatalystCrimsonOvc::checkParameters(const OVCPlan& plan, ADLAdapterTable& adapterTable, std::ostream& errors, bool& failed)
+{
+    for (int i = 0; i < plan.getAdaptersNum(); i++)
     {
-        if (param.type!=OVCParamType::FAN_SPEED)
+        if (!plan.hasActions(i))
         {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, realAdaptersNum); ait; ++ait)
-            {
-                int i = *ait;
+            continue;
+        }
 
-                if (i >= realAdaptersNum)
-                {
-                    continue;
-                }
+        const ADLODParameters& odParams = adapterTable.getODParameters(i);
 
-                int partId = (param.partId != LAST_PERFLEVEL) ? param.partId : odParams[i].iNumberOfPerformanceLevels - 1;
+        for (int action = plan.getActionsBegin(i); action < plan.getActionsEnd(i); action++)
+        {
+            const bool useDefault = plan.isDefault(action);
+            const double value = plan.getValue(action);
 
-                if (partId >= odParams[i].iNumberOfPerformanceLevels || partId < 0)
+            if (plan.getType(action) == OVCParamType::FAN_SPEED)
+            {
+                if (plan.getPartId(action) != 0)
                 {
-                    std::cerr << "Performance level out of range in '" << param.argText << "'!" << std::endl;
+                    errors << "Thermal Control Index is not 0 in '" << plan.getArgText(action) << "'!" << std::endl;
                     failed = true;
-                    continue;
                 }
-                switch(param.type)
+                if (!useDefault && (value < 0.0 || value > 100.0))
                 {
-                    case OVCParamType::CORE_CLOCK:
-
-                        if (!param.useDefault && (param.value < odParams[i].sEngineClock.iMin/100.0 || param.value > odParams[i].sEngineClock.iMax/100.0))
-                        {
-                            std::cerr << "Core clock out of range in '" << param.argText << "'!" << std::endl;
-                            failed = true;
-                        }
-                        break;
-
-                    case OVCParamType::MEMORY_CLOCK:
-
-                        if (!param.useDefault && (param.value < odParams[i].sMemoryClock.iMin/100.0 || param.value > odParams[i].sMemoryClock.iMax/100.0))
-                        {
-                            std::cerr << "Memory clock out of range in '" << param.argText << "'!" << std::endl;
-                            failed = true;
-                        }
-                        break;
-
-                    case OVCParamType::VDDC_VOLTAGE:
-
-                        if (!param.useDefault && (param.value < odParams[i].sVddc.iMin/1000.0 || param.value > odParams[i].sVddc.iMax/1000.0))
-                        {
-                            std::cerr << "Voltage out of range in '" << param.argText << "'!" << std::endl;
-                            failed = true;
-                        }
-                        break;
-
-                    default:
-                        break;
+                    errors << "FanSpeed value out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                    failed = true;
                 }
+                continue;
             }
-        }
-    }
 
-    if (failed)
-    {
-        std::cerr << "No settings applied. Error in parameters!" << std::endl;
-        throw Error("Wrong parameters!");
-    }
-
-    // print what has been changed
-    for (OVCParameter param: OvcParams)
-    {
-        if (param.type==OVCParamType::FAN_SPEED)
-        {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, realAdaptersNum); ait; ++ait)
+            if (plan.getType(action) == OVCParamType::POWER_CONTROL)
             {
-                std::cout << "Setting fanspeed to ";
+                const ADLODParameterRange& range = adapterTable.getPowerControlRange(i);
 
-                if (param.useDefault)
+                if (!adapterTable.hasPowerControl(i))
                 {
-                    std::cout << "default";
+                    errors << "Power control is not supported in '" << plan.getArgText(action) << "'!" << std::endl;
+                    failed = true;
                 }
-                else
+                else if (!useDefault && (value < range.iMin || value > range.iMax))
                 {
-                    std::cout << param.value << "%";
+                    errors << "Power control out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                    failed = true;
                 }
+                continue;
+            }
+
+            if (isAMDGPUOnly(plan.getType(action)))
+            {
+                continue;
+            }
+
+            if (adapterTable.getODVersion(i) == 0)
+            {
+                errors << "Overdrive is not supported by adapter in '" << plan.getArgText(action) << "'!" << std::endl;
+                failed = true;
+                continue;
+            }
+
+            int partId = getPerfLevel(plan, action, adapterTable, i);
+            const int levelsNum = (plan.getType(action) == OVCParamType::MEMORY_CLOCK) ? adapterTable.getMemoryLevelsNum(i) :
+                adapterTable.getCoreLevelsNum(i);
 
-                std::cout << " for adapter " << *ait << " at thermal controller " << param.partId << std::endl;
+            if (partId >= levelsNum || partId < 0)
+            {
+                errors << "Performance level out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                failed = true;
+                continue;
+            }
+
+            switch(plan.getType(action))
+            {
+                case OVCParamType::CORE_CLOCK:
+
+                    if (odParams.sEngineClock.iMax == 0)
+                    {
+                        errors << "Core clock is not settable in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    else if (!useDefault && (value < odParams.sEngineClock.iMin/100.0 || value > odParams.sEngineClock.iMax/100.0))
+                    {
+                        errors << "Core clock out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    break;
+
+                case OVCParamType::MEMORY_CLOCK:
+
+                    if (odParams.sMemoryClock.iMax == 0)
+                    {
+                        errors << "Memory clock is not settable in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    else if (!useDefault && (value < odParams.sMemoryClock.iMin/100.0 || value > odParams.sMemoryClock.iMax/100.0))
+                    {
+                        errors << "Memory clock out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    break;
+
+                case OVCParamType::VDDC_VOLTAGE:
+
+                    if (odParams.sVddc.iMax == 0)
+                    {
+                        errors << "Voltage control is not supported in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    else if (!useDefault && (value < odParams.sVddc.iMin/1000.0 || value > odParams.sVddc.iMax/1000.0))
+                    {
+                        errors << "Voltage out of range in '" << plan.getArgText(action) << "'!" << std::endl;
+                        failed = true;
+                    }
+                    break;
+
+                default:
+
+                    break;
             }
         }
     }
+}
+
+void CatalystCrimsonOvc::printChanges(const OVCPlan& plan, ADLAdapterTable& adapterTable)
+{
+    OutputBuffer out;
 
-    for (OVCParameter param: OvcParams)
+    for (int i = 0; i < plan.getAdaptersNum(); i++)
     {
-        if (param.type != OVCParamType::FAN_SPEED)
+        for (int action = plan.getActionsBegin(i); action < plan.getActionsEnd(i); action++)
         {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, realAdaptersNum); ait; ++ait)
+            const char* unit = "";
+
+            switch(plan.getType(action))
             {
-                int i = *ait;
-                int partId = (param.partId != LAST_PERFLEVEL) ? param.partId: odParams[i].iNumberOfPerformanceLevels - 1;
+                case OVCParamType::FAN_SPEED:
 
-                switch(param.type)
-                {
-                    case OVCParamType::CORE_CLOCK:
+                    out << "Setting fanspeed to ";
+                    unit = "%";
+                    break;
 
-                        std::cout << "Setting core clock to ";
+                case OVCParamType::CORE_CLOCK:
 
-                        if (param.useDefault)
-                        {
-                            std::cout << "default";
-                        }
-                        else
-                        {
-                            std::cout << param.value << " MHz";
-                        }
+                    out << "Setting core clock to ";
+                    unit = " MHz";
+                    break;
 
-                        std::cout << " for adapter " << i << " at performance level " << partId << std::endl;
-                        break;
+                case OVCParamType::MEMORY_CLOCK:
 
-                    case OVCParamType::MEMORY_CLOCK:
+                    out << "Setting memory clock to ";
+                    unit = " MHz";
+                    break;
 
-                        std::cout << "Setting memory clock to ";
+                case OVCParamType::VDDC_VOLTAGE:
 
-                        if (param.useDefault)
-                        {
-                            std::cout << "default";
-                        }
-                        else
-                        {
-                            std::cout << param.value << " MHz";
-                        }
+                    out << "Setting Vddc voltage to ";
+                    unit = " V";
+                    break;
 
-                        std::cout << " for adapter " << i << " at performance level " << partId << std::endl;
-                        break;
+                case OVCParamType::POWER_CONTROL:
 
-                    case OVCParamType::CORE_OD:
+                    out << "Setting power control to ";
+                    unit = "%";
+                    break;
 
-                        std::cout << "Core OD available only for AMDGPU-(PRO) drivers." << std::endl;
-                        break;
+                case OVCParamType::CORE_OD:
 
-                    case OVCParamType::MEMORY_OD:
+                    out << "Core OD available only for AMDGPU-(PRO) drivers.\n";
+                    continue;
 
-                        std::cout << "Memory OD available only for AMDGPU-(PRO) drivers." << std::endl;
-                        break;
+                case OVCParamType::MEMORY_OD:
 
-                    case OVCParamType::VDDC_VOLTAGE:
+                    out << "Memory OD available only for AMDGPU-(PRO) drivers.\n";
+                    continue;
 
-                        std::cout << "Setting Vddc voltage to ";
+                case OVCParamType::POWER_CAP:
 
-                        if (param.useDefault)
-                        {
-                            std::cout << "default";
-                        }
-                        else
-                        {
-                            std::cout << param.value << " V";
-                        }
+                    out << "Power cap available only for AMDGPU-(PRO) drivers.\n";
+                    continue;
 
-                        std::cout << " for adapter " << i << " at performance level " << partId << std::endl;
-                        break;
+                case OVCParamType::POWER_PROFILE:
 
-                    default:
+                    out << "Power profile available only for AMDGPU-(PRO) drivers.\n";
+                    continue;
 
-                        break;
-                }
-            }
-        }
-    }
+                case OVCParamType::PERFORMANCE_LEVEL:
 
-    std::vector<FanSpeedSetup> fanSpeedSetups(realAdaptersNum);
-    std::fill(fanSpeedSetups.begin(), fanSpeedSetups.end(), FanSpeedSetup{ 0.0, false, false });
+                    out << "Performance level available only for AMDGPU-(PRO) drivers.\n";
+                    continue;
 
-    for (OVCParameter param: OvcParams)
-    {
-        if (param.type==OVCParamType::FAN_SPEED)
-        {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, realAdaptersNum); ait; ++ait)
-            {
-                fanSpeedSetups[*ait].value = param.value;
-                fanSpeedSetups[*ait].useDefault = param.useDefault;
-                fanSpeedSetups[*ait].isSet = true;
-            }
-        }
-    }
+                case OVCParamType::CORE_CLOCK_MASK:
+                case OVCParamType::MEMORY_CLOCK_MASK:
+                case OVCParamType::PCIE_MASK:
 
-    for (OVCParameter param: OvcParams)
-    {
-        if (param.type!=OVCParamType::FAN_SPEED)
-        {
-            for (AdapterIterator ait(param.adapters, param.allAdapters, realAdaptersNum); ait; ++ait)
-            {
-                int i = *ait;
-                int partId = (param.partId != LAST_PERFLEVEL) ? param.partId : odParams[i].iNumberOfPerformanceLevels - 1;
-                ADLODPerformanceLevel& perfLevel = perfLevels[i][partId];
-                const ADLODPerformanceLevel& defaultPerfLevel = defaultPerfLevels[i][partId];
+                    out << "DPM state masks available only for AMDGPU-(PRO) drivers.\n";
+                    continue;
 
-                switch(param.type)
-                {
-                    case OVCParamType::CORE_CLOCK:
-
-                        if (param.useDefault)
-                        {
-                            perfLevel.iEngineClock = defaultPerfLevel.iEngineClock;
-                        }
-                        else
-                        {
-                            perfLevel.iEngineClock = int(round(param.value * 100.0));
-                        }
-
-                        break;
-
-                    case OVCParamType::MEMORY_CLOCK:
-
-                        if (param.useDefault)
-                        {
-                            perfLevel.iMemoryClock = defaultPerfLevel.iMemoryClock;
-                        }
-                        else
-                        {
-                            perfLevel.iMemoryClock = int(round(param.value * 100.0));
-                        }
-
-                        break;
-
-                    case OVCParamType::VDDC_VOLTAGE:
-
-                        if (param.useDefault)
-                        {
-                            perfLevel.iVddc = defaultPerfLevel.iVddc;
-                        }
-                        else if (perfLevel.iVddc == 0)
-                        {
-                            std::cout << "Voltage for adapter " << i << " is not set!" << std::endl;
-                        }
-                        else
-                        {
-                            perfLevel.iVddc = int(round(param.value * 1000.0));
-                        }
-                        break;
-
-                    default:
-
-                        break;
-                }
+                case OVCParamType::FAN_RPM:
+
+                    out << "Fan RPM available only for AMDGPU-(PRO) drivers.\n";
+                    continue;
+
+                default:
 
-                changedDevices[i] = true;
+                    continue;
             }
-        }
-    }
 
-    /// set fan speeds
-    for (int i = 0; i < realAdaptersNum; i++)
-    {
-        if (fanSpeedSetups[i].isSet)
-        {
-            if (!fanSpeedSetups[i].useDefault)
+            if (plan.isDefault(action))
             {
-                MainControl.setFanSpeed(ActiveAdapters[i], 0 /* must be zero */, int(round(fanSpeedSetups[i].value)));
+                out << "default";
             }
             else
             {
-                MainControl.setFanSpeedToDefault(ActiveAdapters[i], 0);
+                out << plan.getValue(action) << unit;
             }
-        }
-    }
 
-    // set od perflevels
-    for (int i = 0; i < realAdaptersNum; i++)
-    {
-        if (changedDevices[i])
-        {
-            MainControl.setODPerformanceLevels(ActiveAdapters[i], odParams[i].iNumberOfPerformanceLevels, perfLevels[i].data());
+            if (plan.getType(action) == OVCParamType::FAN_SPEED)
+            {
+                out << " for adapter " << i << " at thermal controller " << plan.getPartId(action) << '\n';
+            }
+            else if (plan.getType(action) == OVCParamType::POWER_CONTROL)
+            {
+                out << " for adapter " << i << '\n';
+            }
+            else
+            {
+                out << " for adapter " << i << " at performance level " << getPerfLevel(plan, action, adapterTable, i) << '\n';
+            }
         }
     }
 }
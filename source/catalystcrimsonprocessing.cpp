@@ -1,40 +1,60 @@
 #include "catalystcrimsonprocessing.h"
 
-void CatalystCrimsonProcessing::Process(ATIADLHandle Handle_, bool UseAdaptersList, std::vector<int> ChosenAdapters,
-                                        std::vector<OVCParameter> OvcParameters, bool ChooseAllAdapters, bool PrintVerbose)
+void CatalystCrimsonProcessing::Process(const ATIADLHandle& Handle_, bool UseAdaptersList, std::vector<int> ChosenAdapters,
+                                        std::vector<OVCParameter> OvcParameters, bool ChooseAllAdapters, bool PrintVerbose,
+                                        OutputFormat Format, const Profile& Profile_)
 {
     ADLMainControl mainControl(Handle_, 0);
-    int adaptersNum = mainControl.getAdaptersNum();
+    ADLAdapterTable adapterTable(mainControl);
 
-    std::vector<int> activeAdapters;
-    CatalystCrimsonAdapters::GetActiveAdaptersIndices(mainControl, adaptersNum, activeAdapters);
-
-    checkAdapterList(UseAdaptersList, ChosenAdapters, activeAdapters);
+    checkAdapterList(UseAdaptersList, ChosenAdapters, adapterTable.getAdaptersNum());
 
     bool useChosen = UseAdaptersList && !ChooseAllAdapters;
 
+    if (Profile_.IsLoaded())
+    {
+        // profile settings go first, so parameters given in command line override them
+        std::vector<AdapterIdentity> identities;
+        std::vector<OVCParameter> profileParameters;
+
+        adapterTable.getIdentities(identities);
+        Profile_.Compile(identities, profileParameters);
+        OvcParameters.insert(OvcParameters.begin(), profileParameters.begin(), profileParameters.end());
+    }
+
     if (!OvcParameters.empty())
     {
-        CatalystCrimsonOvc::Set(mainControl, activeAdapters, OvcParameters);
+        TimingTrace::Span span("command", "set parameters");
+        CatalystCrimsonOvc::Set(mainControl, adapterTable, OvcParameters, true, std::cerr);
+        return;
+    }
+
+    TimingTrace::Span span("command", "print adapter info");
+
+    if (Format != OutputFormat::TEXT)
+    {
+        OutputBuffer out;
+        std::unique_ptr<OutputWriter> writer = OutputWriter::Create(Format, out);
+        CatalystCrimsonAdapters::PrintInfoStructured(mainControl, adapterTable, ChosenAdapters, useChosen, *writer);
         return;
     }
 
     if (PrintVerbose)
     {
-        CatalystCrimsonAdapters::PrintInfoVerbose(mainControl, adaptersNum, activeAdapters, ChosenAdapters, useChosen);
+        CatalystCrimsonAdapters::PrintInfoVerbose(mainControl, adapterTable, ChosenAdapters, useChosen);
         return;
     }
 
-    CatalystCrimsonAdapters::PrintInfo(mainControl, adaptersNum, activeAdapters, ChosenAdapters, useChosen);
+    CatalystCrimsonAdapters::PrintInfo(mainControl, adapterTable, ChosenAdapters, useChosen);
 }
 
-void CatalystCrimsonProcessing::checkAdapterList(bool useAdaptersList, std::vector<int> chosenAdapters, std::vector<int> activeAdapters)
+void CatalystCrimsonProcessing::checkAdapterList(bool useAdaptersList, std::vector<int> chosenAdapters, int adaptersNum)
 {
     if (useAdaptersList)
     {
         for (int adapterIndex: chosenAdapters)
         {
-            if (adapterIndex >= int(activeAdapters.size()) || adapterIndex < 0)
+            if (adapterIndex >= adaptersNum || adapterIndex < 0)
             {
                 throw Error("Some adapter indices are out of range");
             }
@@ -59,18 +59,25 @@ void CliParameters::CheckFailed(bool failed)
 
 void CliParameters::ProcessParameters(bool UseAdaptersList, bool PrintVerbose)
 {
+    if (fieldsSelected && outputFormat == OutputFormat::TEXT)
+    {
+        throw Error("Field selection needs json, csv or kv output.");
+    }
+
     ATIADLHandle handle;
 
     if (handle.open())
     {
         CatalystCrimsonProcessing *processor = new CatalystCrimsonProcessing();
-        processor->Process(handle, UseAdaptersList, chosenAdapters, ovcParameters, chooseAllAdapters, PrintVerbose);
+        processor->Process(handle, UseAdaptersList, chosenAdapters, ovcParameters, chooseAllAdapters, PrintVerbose, outputFormat,
+                           profile);
         delete processor;
     }
     else
     {
         AmdGpuProProcessing *processor = new AmdGpuProProcessing();
-        processor->Process(ovcParameters, UseAdaptersList, chosenAdapters, chooseAllAdapters, PrintVerbose);
+        processor->Process(ovcParameters, UseAdaptersList, chosenAdapters, chooseAllAdapters, PrintVerbose, outputFormat,
+                           profile);
         delete processor;
     }
 }
@@ -104,7 +111,7 @@ bool CliParameters::SetUseAdaptersListEquals(const char* Argvi)
     return false;
 }
 
-bool CliParameters::SetUseAdaptersList(const char** Argv, int Argc, int I)
+bool CliParameters::SetUseAdaptersList(const char** Argv, int Argc, int& I)
 {
   if (::strcmp(Argv[I], "--adapters") == 0)
   {
@@ -126,7 +133,7 @@ bool CliParameters::ParseParametersOrFail(const char* Argvi)
 {
     OVCParameter param;
 
-    if (this->parseOVCParameter(Argvi, param))
+    if (ParseOVCParameter(Argvi, param, std::cerr))
     {
         ovcParameters.push_back(param);
     }
@@ -138,7 +145,7 @@ bool CliParameters::ParseParametersOrFail(const char* Argvi)
     return false;
 }
 
-bool CliParameters::ParseAdaptersList(const char** Argv, int Argc, int I)
+bool CliParameters::ParseAdaptersList(const char** Argv, int Argc, int& I)
 {
     if (::strncmp(Argv[I], "-a", 2) == 0)
     {
@@ -161,20 +168,131 @@ bool CliParameters::ParseAdaptersList(const char** Argv, int Argc, int I)
     return false;
 }
 
-bool CliParameters::parseOVCParameter(const char* string, OVCParameter& param)
+bool CliParameters::SetTraceTiming(const char* Argvi)
 {
-    const char* afterName = strchr(string, ':');
+    if (::strcmp(Argvi, "--trace-timing") == 0)
+    {
+        TimingTrace::Enable(nullptr);
+        return true;
+    }
 
-    if (afterName==nullptr)
+    if (::strncmp(Argvi, "--trace-timing=", 15) == 0)
     {
-        afterName = strchr(string, '=');
+        if (Argvi[15] == 0)
+        {
+            throw Error("Trace file not supplied.");
+        }
+
+        TimingTrace::Enable(Argvi + 15);
+        return true;
+    }
+
+    return false;
+}
 
-        if (afterName==nullptr)
+bool CliParameters::SetPrintStats(const char* Argvi)
+{
+    if (::strcmp(Argvi, "--stats") == 0)
+    {
+        IOStats::Enable();
+        return true;
+    }
+
+    return false;
+}
+
+bool CliParameters::SetOutputFormat(const char* Argvi)
+{
+    if (::strncmp(Argvi, "--output=", 9) == 0)
+    {
+        if (!OutputWriter::ParseFormat(Argvi + 9, outputFormat))
         {
-            std::cerr << "Invalid parameter specified: '" << string << "'!" << std::endl;
+            throw Error("Unknown output format. Use text, json, csv or kv.");
+        }
 
-            return false;
+        return true;
+    }
+
+    return false;
+}
+
+bool CliParameters::SetOutputFields(const char* Argvi)
+{
+    if (::strncmp(Argvi, "--fields=", 9) == 0)
+    {
+        OutputWriter::SelectFields(Argvi + 9);
+        fieldsSelected = true;
+        return true;
+    }
+
+    return false;
+}
+
+bool CliParameters::SetProfile(const char** Argv, int Argc, int& I)
+{
+    const char* filename = nullptr;
+
+    if (::strncmp(Argv[I], "--profile=", 10) == 0)
+    {
+        filename = Argv[I] + 10;
+    }
+    else if (::strcmp(Argv[I], "--profile") == 0)
+    {
+        if (I + 1 >= Argc)
+        {
+            throw Error("Profile file not supplied.");
         }
+
+        filename = Argv[++I];
+    }
+    else
+    {
+        return false;
+    }
+
+    if (*filename == 0)
+    {
+        throw Error("Profile file not supplied.");
+    }
+
+    if (profile.IsLoaded())
+    {
+        throw Error("Only one profile can be given.");
+    }
+
+    profile.Load(filename);
+
+    return true;
+}
+
+static bool isTextParameter(OVCParamType type)
+{
+    switch(type)
+    {
+        case OVCParamType::POWER_PROFILE:
+        case OVCParamType::PERFORMANCE_LEVEL:
+        case OVCParamType::CORE_CLOCK_MASK:
+        case OVCParamType::MEMORY_CLOCK_MASK:
+        case OVCParamType::PCIE_MASK:
+
+            return true;
+
+        default:
+
+            return false;
+    }
+}
+
+bool CliParameters::ParseOVCParameter(const char* string, OVCParameter& param, std::ostream& errors)
+{
+    // value can contain ':' (powerprofile=CUSTOM:...), so name ends at the first ':' or '='
+    const char* afterName = strpbrk(string, ":=");
+
+    if (afterName==nullptr)
+    {
+        errors << "Invalid parameter specified: '" << string << "'!" << std::endl;
+
+        return false;
     }
 
     std::string name(string, afterName);
@@ -216,6 +334,46 @@ bool CliParameters::parseOVCParameter(const char* string, OVCParameter& param)
         param.type = OVCParamType::FAN_SPEED;
         partIdSet = false;
     }
+    else if (name=="fanrpm")
+    {
+        param.type = OVCParamType::FAN_RPM;
+        partIdSet = false;
+    }
+    else if (name=="powercap")
+    {
+        param.type = OVCParamType::POWER_CAP;
+        partIdSet = false;
+    }
+    else if (name=="powercontrol")
+    {
+        param.type = OVCParamType::POWER_CONTROL;
+        partIdSet = false;
+    }
+    else if (name=="powerprofile")
+    {
+        param.type = OVCParamType::POWER_PROFILE;
+        partIdSet = false;
+    }
+    else if (name=="perflevel")
+    {
+        param.type = OVCParamType::PERFORMANCE_LEVEL;
+        partIdSet = false;
+    }
+    else if (name=="sclkmask")
+    {
+        param.type = OVCParamType::CORE_CLOCK_MASK;
+        partIdSet = false;
+    }
+    else if (name=="mclkmask")
+    {
+        param.type = OVCParamType::MEMORY_CLOCK_MASK;
+        partIdSet = false;
+    }
+    else if (name=="pciemask")
+    {
+        param.type = OVCParamType::PCIE_MASK;
+        partIdSet = false;
+    }
     else if (name=="icoreclk")
     {
         param.type = OVCParamType::CORE_CLOCK;
@@ -233,7 +391,7 @@ bool CliParameters::parseOVCParameter(const char* string, OVCParameter& param)
     }
     else
     {
-        std::cout << "Wrong parameter name in '" << string << "'!" << std::endl;
+        errors << "Wrong parameter name in '" << string << "'!" << std::endl;
         return false;
     }
 
@@ -245,12 +403,7 @@ bool CliParameters::parseOVCParameter(const char* string, OVCParameter& param)
 
         try
         {
-            const char* afterList = ::strchr(afterName, ':');
-
-            if (afterList==nullptr)
-            {
-                afterList = ::strchr(afterName, '=');
-            }
+            const char* afterList = ::strpbrk(afterName, ":=");
 
             if (afterList==nullptr)
             {
@@ -266,13 +419,13 @@ bool CliParameters::parseOVCParameter(const char* string, OVCParameter& param)
         }
         catch(const Error& error)
         {
-            std::cerr << "Unable to parse adapter list for '" << string << "': " << error.what() << std::endl;
+            errors << "Unable to parse adapter list for '" << string << "': " << error.what() << std::endl;
             return false;
         }
     }
     else if (*afterName==0)
     {
-        std::cerr << "Unterminated parameter '" << string << "'!" << std::endl;
+        errors << "Unterminated parameter '" << string << "'!" << std::endl;
         return false;
     }
 
@@ -284,7 +437,7 @@ bool CliParameters::parseOVCParameter(const char* string, OVCParameter& param)
 
         if (errno!=0)
         {
-            std::cerr << "Unable to parse partId in '" << string << "'!" << std::endl;
+            errors << "Unable to parse partId in '" << string << "'!" << std::endl;
             return false;
         }
 
@@ -297,7 +450,7 @@ bool CliParameters::parseOVCParameter(const char* string, OVCParameter& param)
     }
     else if (*afterName==0)
     {
-        std::cerr << "Unterminated parameter '" << string << "'!" << std::endl;
+        errors << "Unterminated parameter '" << string << "'!" << std::endl;
         return false;
     }
 
@@ -311,31 +464,45 @@ bool CliParameters::parseOVCParameter(const char* string, OVCParameter& param)
             param.useDefault = true;
             afterName += 7;
         }
+        else if (isTextParameter(param.type))
+        {
+            // checked against adapter: powerprofile=NAME|INDEX[:VALUE,...], perflevel=LEVEL, *mask=STATES
+            param.text = afterName;
+            param.value = 0.0;
+
+            if (param.text.empty())
+            {
+                errors << "Unable to parse value in '" << string << "'!" << std::endl;
+                return false;
+            }
+
+            afterName += param.text.size();
+        }
         else
         {
             param.value = strtod(afterName, &next);
 
             if (errno!=0 || afterName==next)
             {
-                std::cerr << "Unable to parse value in '" << string << "'!" << std::endl;
+                errors << "Unable to parse value in '" << string << "'!" << std::endl;
                 return false;
             }
             if (std::isinf(param.value) || std::isnan(param.value))
             {
-                std::cerr << "Value of '" << string << "' is not finite!" << std::endl;
+                errors << "Value of '" << string << "' is not finite!" << std::endl;
                 return false;
             }
             afterName = next;
         }
         if (*afterName!=0)
         {
-            std::cerr << "Invalid data in '" << string << "'!" << std::endl;
+            errors << "Invalid data in '" << string << "'!" << std::endl;
             return false;
         }
     }
     else
     {
-        std::cerr << "Unterminated parameter '" << string << "'!" << std::endl;
+        errors << "Unterminated parameter '" << string << "'!" << std::endl;
         return false;
     }
 
@@ -5,16 +5,73 @@ const char* ConstStrings::HelpAndUsage =
     "This program is distributed under terms of the GPLv2.\n"
     "and is available at https://github.com/matszpk/amdcovc.\n"
     "\n"
-    "Usage: amdcovc [--help|-?] [--verbose|-v] [-a LIST|--adapters=LIST] [PARAM ...]\n"
+    "Usage: amdcovc [--help|-?] [--verbose|-v] [-a LIST|--adapters=LIST] [--trace-timing[=FILE]] [--stats]\n"
+    "               [--output=FORMAT] [--fields=LIST] [--profile FILE] [PARAM ...]\n"
+    "       amdcovc [TRACE] tune --run CMD --metric REGEX [OPTION ...]\n"
+    "       amdcovc [TRACE] exec [OPTION ...] [PARAM ...] -- COMMAND [ARG ...]\n"
+    "       amdcovc [TRACE] throttle [OPTION ...]\n"
+    "       amdcovc [TRACE] watchdog [OPTION ...]\n"
+    "       amdcovc [TRACE] save [--adapters LIST] FILE\n"
+    "       amdcovc [TRACE] restore [--wait S] [-v] FILE\n"
+    "TRACE is --trace-timing[=FILE] and --stats, given before the subcommand.\n"
     "Prints AMD Overdrive information if no parameters are given.\n"
     "Sets AMD Overdrive parameters (clocks, fanspeeds,...) if any parameters are given.\n"
     "\n"
     "List of options:\n"
     "  -a, --adapters=LIST       print informations only for these adapters\n"
     "  -v, --verbose             print verbose informations\n"
+    "      --trace-timing[=FILE] print timing summary of all phases and backend calls,\n"
+    "                            write Chrome trace-event JSON to FILE if given\n"
+    "      --stats               print per-attribute I/O and ADL call statistics\n"
+    "      --output=FORMAT       print adapter informations as text, json, csv or kv\n"
+    "      --fields=LIST         write only these fields (json, csv or kv output)\n"
+    "      --profile=FILE        apply Overdrive settings from profile FILE\n"
     "      --version             print version\n"
     "  -?, --help                print help\n"
     "\n"
+    "Options of tune (search settings with the best performance per watt, AMDGPU):\n"
+    "      --run CMD             benchmark command, AMDCOVC_ADAPTER holds adapter index\n"
+    "      --metric REGEX        regular expression of throughput in benchmark output\n"
+    "      --adapters LIST       tune only these adapters\n"
+    "      --steps N             number of values of every setting (default 4)\n"
+    "      --sample-interval MS  interval of power and temperature samples (default 100)\n"
+    "      --timeout S           kill benchmark after S seconds, as unstable (default 600)\n"
+    "      --save FILE           write best settings as profile FILE\n"
+    "      --simulate[=N]        tune N simulated adapters\n"
+    "  -v, --verbose             print result of every point\n"
+    "\n"
+    "Options of exec (run COMMAND with settings, restore them at the end, AMDGPU):\n"
+    "      --profile FILE        apply settings from profile FILE\n"
+    "      --adapters LIST       adapters used by COMMAND\n"
+    "      --sample-interval MS  interval of power, temperature and clock samples (default 100)\n"
+    "      --journal-dir DIR     directory of journals of settings (default /run/amdcovc)\n"
+    "\n"
+    "Options of throttle (report throttled clocks with reasons, AMDGPU):\n"
+    "      --adapters LIST       watch only these adapters\n"
+    "      --interval MS         interval of samples (default 500)\n"
+    "      --duration S          stop after S seconds\n"
+    "      --load PERCENT        minimal GPU load of busy adapter (default 90)\n"
+    "      --temp-margin C       thermal throttling below critical temperature (default 5)\n"
+    "      --power-margin PERCENT  power throttling below power cap (default 5)\n"
+    "\n"
+    "Options of watchdog (revert Overdrive and set fan to 100% at overheat or fan stall, AMDGPU):\n"
+    "      --adapters LIST       watch only these adapters\n"
+    "      --interval MS         interval of samples (default 20)\n"
+    "      --duration S          stop after S seconds\n"
+    "      --temp-margin C       limit below critical temperatures (default 5)\n"
+    "      --temp-limit C        limit of all temperatures instead of critical ones\n"
+    "      --stall-rpm RPM       fan speed of stalled fan (default 200)\n"
+    "      --stall-duty PERCENT  minimal PWM duty of stalled fan (default 30)\n"
+    "      --stall-time MS       time of stall before revert (default 500)\n"
+    "      --simulate[=N]        watch N simulated adapters\n"
+    "      --inject LIST         faults of simulated adapters\n"
+    "                            (stall|overheat|sensor|revert:ADAPTER@MS,...)\n"
+    "\n"
+    "Options of save and restore (settings of adapters by PCI slot in FILE, AMDGPU):\n"
+    "      --adapters LIST       save only these adapters\n"
+    "      --wait S              restore: wait up to S seconds for all saved adapters\n"
+    "  -v, --verbose             restore: print written settings\n"
+    "\n"
     "List of parameters:\n"
     "  coreclk[:[ADAPTERS][:LEVEL]]=CLOCK    set core clock in MHz\n"
     "  memclk[:[ADAPTERS][:LEVEL]]=CLOCK     set memory clock in MHz\n"
@@ -25,13 +82,30 @@ const char* ConstStrings::HelpAndUsage =
     "  imemclk[:ADAPTERS]=CLOCK              set memory clock in MHz for idle level\n"
     "  ivcore[:ADAPTERS]=VOLTAGE             set Vddc voltage in Volts for idle level\n"
     "  fanspeed[:[ADAPTERS][:THID]]=PERCENT  set fanspeed by percentage\n"
+    "  fanrpm[:[ADAPTERS][:THID]]=RPM        set fan speed in RPM by fanN_target (AMDGPU),\n"
+    "                                        rejected if the driver does not support it\n"
+    "  powercap[:ADAPTERS]=POWER             set power limit in Watts (AMDGPU)\n"
+    "  powercontrol[:ADAPTERS]=PERCENT       set power control (power limit) in percent\n"
+    "                                        (AMD Catalyst/Crimson with Overdrive6 or OverdriveN)\n"
+    "  powerprofile[:ADAPTERS]=PROFILE[:VALUES]\n"
+    "                                        select power profile by name or index,\n"
+    "                                        with comma-separated values for CUSTOM (AMDGPU)\n"
+    "  perflevel[:ADAPTERS]=LEVEL            force performance level: auto, low, high, manual,\n"
+    "                                        profile_standard, profile_min_sclk,\n"
+    "                                        profile_min_mclk, profile_peak, profile_exit (AMDGPU)\n"
+    "  sclkmask[:ADAPTERS]=STATES            allow only given core clock states (AMDGPU)\n"
+    "  mclkmask[:ADAPTERS]=STATES            allow only given memory clock states (AMDGPU)\n"
+    "  pciemask[:ADAPTERS]=STATES            allow only given PCIe states (AMDGPU)\n"
     "\n"
     "Extra specifiers in parameters:\n"
     "  ADAPTERS                  adapter (devices) index list (default is 0)\n"
     "  LEVEL                     performance level (typically 0 or 1, default is last)\n"
-    "  THID                      thermal controller index (must be 0)\n"
+    "  THID                      thermal controller index (0, AMDGPU: pwmTHID+1 of hwmon)\n"
+    "  STATES                    DPM state index list in adapter list syntax\n"
     "You can use 'default' in place of a value to set default value.\n"
-    "For fanspeed the 'default' value forces automatic speed setup.\n"
+    "For fanspeed and fanrpm the 'default' value forces automatic speed setup.\n"
+    "On AMDGPU adapters with pp_od_clk_voltage, coreclk, memclk and vcore change\n"
+    "the DPM state given by LEVEL, 'default' restores the whole table.\n"
     "\n"
     "Adapter list specified in the parameters and '--adapter' options are a comma-separated list\n"
     "with ranges 'first-last' or 'all'. e.g. 'all', '0-2', '0,1,3-5'\n"
@@ -52,6 +126,10 @@ const char* ConstStrings::HelpAndUsage =
     "amdcovc fanspeed=75 fanspeed:2=60 fanspeed:1=default\n"
     "    set fanspeed to 75% for adapter 0 and set fanspeed to 60% for adapter 2\n"
     "    set fanspeed to default for adapter 1\n\n"
+    "amdcovc mclkmask:all=1\n"
+    "    allow only memory clock state 1 for all adapters (sets manual performance level)\n\n"
+    "amdcovc powerprofile:0-3=COMPUTE\n"
+    "    select COMPUTE power profile for adapters 0 to 3\n\n"
     "amdcovc vcore=1.111 vcore::0=0.81\n"
     "    set Vddc voltage to 1.111 V for adapter 0\n"
     "    set Vddc voltage to 0.81 for adapter 0 for performance level 0\n\n";
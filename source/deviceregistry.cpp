@@ -0,0 +1,364 @@
+#include "deviceregistry.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "error.h"
+
+DeviceRegistry::DeviceRegistry(AMDGPUAdapterHandle& _handle) : handle(_handle), socketFd(-1)
+{
+    // socket is opened first, so no card is missed between the scan and listening
+    socketFd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+
+    if (socketFd >= 0)
+    {
+        struct sockaddr_nl address;
+        ::memset(&address, 0, sizeof(address));
+        address.nl_family = AF_NETLINK;
+        address.nl_groups = 1;  // kernel uevents, not these resent by udev
+
+        if (::bind(socketFd, (struct sockaddr*)&address, sizeof(address)) != 0)
+        {
+            ::close(socketFd);
+            socketFd = -1;
+        }
+    }
+
+    for (unsigned int i = 0; i < handle.getAdaptersNum(); i++)
+    {
+        entries.push_back(Entry{ handle.getSlotName(i), handle.getCardIndex(i), int(i) });
+    }
+}
+
+DeviceRegistry::~DeviceRegistry()
+{
+    if (socketFd >= 0)
+    {
+        ::close(socketFd);
+    }
+}
+
+int DeviceRegistry::findEntry(unsigned int cardIndex) const
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].handleIndex >= 0 && entries[i].cardIndex == cardIndex)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void DeviceRegistry::updateHandleIndices()
+{
+    for (Entry& entry: entries)
+    {
+        if (entry.handleIndex >= 0)
+        {
+            entry.handleIndex = handle.findCard(entry.cardIndex);
+        }
+    }
+}
+
+int DeviceRegistry::GetHandleIndex(int adapterId) const
+{
+    if (adapterId < 0 || adapterId >= int(entries.size()))
+    {
+        return -1;
+    }
+
+    return entries[adapterId].handleIndex;
+}
+
+/* cardN itself, not its connectors like cardN-DP-1 */
+bool DeviceRegistry::parseCardIndex(const std::string& devPath, unsigned int& cardIndex)
+{
+    const size_t slash = devPath.rfind('/');
+    const std::string name = devPath.substr(slash != std::string::npos ? slash + 1 : 0);
+
+    if (name.compare(0, 4, "card") != 0 || name.size() == 4 || name.find_first_not_of("0123456789", 4) != std::string::npos)
+    {
+        return false;
+    }
+
+    cardIndex = ::strtoul(name.c_str() + 4, nullptr, 10);
+
+    return true;
+}
+
+void DeviceRegistry::processUevent(const char* data, size_t size, std::vector<DeviceEvent>& events)
+{
+    std::string action, devPath, subsystem;
+    bool hotplug = false;
+
+    // the first string is ACTION@DEVPATH, then KEY=VALUE pairs
+    for (size_t pos = ::strnlen(data, size) + 1; pos < size; )
+    {
+        const std::string pair(data + pos, ::strnlen(data + pos, size - pos));
+        const size_t equal = pair.find('=');
+
+        pos += pair.size() + 1;
+
+        if (equal == std::string::npos)
+        {
+            continue;
+        }
+
+        const std::string key = pair.substr(0, equal);
+
+        if (key == "ACTION")
+        {
+            action = pair.substr(equal + 1);
+        }
+        else if (key == "DEVPATH")
+        {
+            devPath = pair.substr(equal + 1);
+        }
+        else if (key == "SUBSYSTEM")
+        {
+            subsystem = pair.substr(equal + 1);
+        }
+        else if (key == "HOTPLUG")
+        {
+            hotplug = true;
+        }
+    }
+
+    unsigned int cardIndex;
+
+    if (subsystem != "drm" || !parseCardIndex(devPath, cardIndex))
+    {
+        return;
+    }
+
+    const int entryIndex = findEntry(cardIndex);
+
+    if (action == "remove" || action == "unbind")
+    {
+        if (entryIndex >= 0)
+        {
+            removeEntry(entryIndex, events);
+        }
+        return;
+    }
+
+    // change events of connectors come with HOTPLUG=1
+    if (action == "change" && !hotplug && entryIndex >= 0)
+    {
+        try
+        {
+            handle.addCard(cardIndex);
+            events.push_back(DeviceEvent{ DeviceEventType::CHANGED, entryIndex });
+        }
+        catch(const std::exception& error)
+        {
+            // hwmon is gone, the remove event follows
+        }
+        return;
+    }
+
+    if ((action == "add" || action == "bind") && entryIndex < 0)
+    {
+        addCard(cardIndex, events);
+    }
+}
+
+void DeviceRegistry::removeEntry(int entryIndex, std::vector<DeviceEvent>& events)
+{
+    handle.removeCard(entries[entryIndex].cardIndex);
+    entries[entryIndex].handleIndex = -1;
+    updateHandleIndices();
+    events.push_back(DeviceEvent{ DeviceEventType::REMOVED, entryIndex });
+}
+
+void DeviceRegistry::addCard(unsigned int cardIndex, std::vector<DeviceEvent>& events)
+{
+    int handleIndex;
+    std::string slotName;
+
+    try
+    {
+        handleIndex = handle.addCard(cardIndex);
+
+        if (handleIndex < 0)
+        {
+            return;    // not an AMD card
+        }
+
+        slotName = handle.getSlotName(handleIndex);
+    }
+    catch(const std::exception& error)
+    {
+        // driver has not finished probing, bind or change event comes later
+        handle.removeCard(cardIndex);
+        return;
+    }
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].handleIndex < 0 && entries[i].slotName == slotName)
+        {
+            entries[i].cardIndex = cardIndex;
+            entries[i].handleIndex = handleIndex;
+            events.push_back(DeviceEvent{ DeviceEventType::ADDED, int(i) });
+            return;
+        }
+    }
+
+    entries.push_back(Entry{ slotName, cardIndex, handleIndex });
+    events.push_back(DeviceEvent{ DeviceEventType::ADDED, int(entries.size() - 1) });
+}
+
+/* events were dropped: present adapters are checked and cards not known by handle
+ * are probed, only names of /sys/class/drm are read for the latter */
+void DeviceRegistry::resynchronize(std::vector<DeviceEvent>& events)
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].handleIndex < 0)
+        {
+            continue;
+        }
+
+        bool present;
+
+        try
+        {
+            present = handle.getSlotName(entries[i].handleIndex) == entries[i].slotName;
+        }
+        catch(const std::exception& error)
+        {
+            present = false;
+        }
+
+        if (!present)
+        {
+            removeEntry(i, events);
+        }
+    }
+
+    DIR* dirp = ::opendir("/sys/class/drm");
+
+    if (dirp == nullptr)
+    {
+        return;
+    }
+
+    struct dirent* dire;
+    std::vector<unsigned int> cardIndices;
+
+    while ((dire = ::readdir(dirp)) != nullptr)
+    {
+        unsigned int cardIndex;
+
+        if (parseCardIndex(dire->d_name, cardIndex) && handle.findCard(cardIndex) < 0)
+        {
+            cardIndices.push_back(cardIndex);
+        }
+    }
+
+    ::closedir(dirp);
+
+    for (unsigned int cardIndex: cardIndices)
+    {
+        addCard(cardIndex, events);
+    }
+}
+
+void DeviceRegistry::receiveUevents(std::vector<DeviceEvent>& events)
+{
+    char buffer[8192];
+
+    while (true)
+    {
+        struct sockaddr_nl sender;
+        struct iovec iov = { buffer, sizeof(buffer) };
+        struct msghdr message;
+
+        ::memset(&message, 0, sizeof(message));
+        message.msg_name = &sender;
+        message.msg_namelen = sizeof(sender);
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+
+        const ssize_t size = ::recvmsg(socketFd, &message, 0);
+
+        if (size < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return;
+            }
+
+            if (errno == ENOBUFS)
+            {
+                resynchronize(events);
+                continue;
+            }
+
+            throw Error(errno, "Unable to receive uevents");
+        }
+
+        // only the kernel sends to this group
+        if (sender.nl_pid != 0 || (message.msg_flags & MSG_TRUNC) != 0)
+        {
+            continue;
+        }
+
+        processUevent(buffer, size, events);
+    }
+}
+
+void DeviceRegistry::Poll(unsigned int timeout, std::vector<DeviceEvent>& events)
+{
+    if (socketFd < 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+        return;
+    }
+
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    while (true)
+    {
+        const long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now()).count();
+        struct pollfd pollFd = { socketFd, POLLIN, 0 };
+
+        const int result = ::poll(&pollFd, 1, std::max(remaining, 0L));
+
+        if (result < 0 && errno != EINTR)
+        {
+            throw Error(errno, "Unable to wait for uevents");
+        }
+
+        if (result > 0)
+        {
+            receiveUevents(events);
+        }
+
+        if (remaining <= 0 || result < 0)
+        {
+            return;
+        }
+    }
+}
+
+void DeviceRegistry::InjectUevent(const std::string& message, std::vector<DeviceEvent>& events)
+{
+    processUevent(message.data(), message.size(), events);
+}
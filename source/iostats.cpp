@@ -0,0 +1,220 @@
+#include "iostats.h"
+
+#include <cstring>
+#include <cctype>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+bool IOStats::enabled = false;
+
+std::map<std::pair<std::string, std::string>, IOStats::Entry> IOStats::entries;
+
+std::mutex IOStats::entriesMutex;
+
+IOStats::Scope::~Scope()
+{
+    if (!active)
+    {
+        return;
+    }
+
+    uint64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (group != nullptr)
+    {
+        record(group, name, operation, failed, durationNs);
+        return;
+    }
+
+    std::string adapter, attribute;
+    classifySysfsPath(name, adapter, attribute);
+    record(adapter, attribute, operation, failed, durationNs);
+}
+
+void IOStats::Enable()
+{
+    enabled = true;
+}
+
+/* splits '/sys/class/drm/card0/device/hwmon/hwmon2/pwm1' into 'card0' and 'hwmon/pwm1',
+ * '/sys/kernel/debug/dri/0/amdgpu_pm_info' into 'card0' and 'debugfs/amdgpu_pm_info' */
+void IOStats::classifySysfsPath(const char* path, std::string& adapter, std::string& attribute)
+{
+    const char* p = ::strstr(path, "/card");
+    const char* rest = nullptr;
+
+    if (p != nullptr && ::isdigit(p[5]))
+    {
+        const char* end = p + 5;
+
+        for (; ::isdigit(*end); end++);
+
+        adapter.assign(p + 1, end);
+        rest = (*end == '/') ? end + 1 : end;
+
+        if (::strncmp(rest, "device/", 7) == 0)
+        {
+            rest += 7;
+        }
+    }
+    else if ((p = ::strstr(path, "/debug/dri/")) != nullptr && ::isdigit(p[11]))
+    {
+        const char* end = p + 11;
+
+        for (; ::isdigit(*end); end++);
+
+        adapter = "card";
+        adapter.append(p + 11, end);
+        attribute = "debugfs/";
+        rest = (*end == '/') ? end + 1 : end;
+    }
+
+    if (rest == nullptr)
+    {
+        adapter = "-";
+        attribute = path;
+        return;
+    }
+
+    if (::strncmp(rest, "hwmon/hwmon", 11) == 0)
+    {
+        const char* afterHwmon = ::strchr(rest + 11, '/');
+
+        if (afterHwmon != nullptr)
+        {
+            attribute = "hwmon/";
+            rest = afterHwmon + 1;
+        }
+    }
+
+    attribute += rest;
+}
+
+void IOStats::record(const std::string& adapter, const std::string& attribute, Operation operation, bool failed, uint64_t durationNs)
+{
+    int bucket = 0;
+
+    for (uint64_t us = durationNs / 1000; us != 0 && bucket < BUCKETS_NUM - 1; us >>= 1)
+    {
+        bucket++;
+    }
+
+    std::lock_guard<std::mutex> lock(entriesMutex);
+
+    auto it = entries.find(std::make_pair(adapter, attribute));
+
+    if (it == entries.end())
+    {
+        Entry empty;
+        ::memset(&empty, 0, sizeof(Entry));
+        it = entries.insert(std::make_pair(std::make_pair(adapter, attribute), empty)).first;
+    }
+
+    Entry& entry = it->second;
+
+    switch(operation)
+    {
+        case Operation::READ:
+
+            entry.opens++;
+            entry.reads++;
+            break;
+
+        case Operation::WRITE:
+
+            entry.opens++;
+            entry.writes++;
+            break;
+
+        case Operation::CALL:
+
+            entry.calls++;
+            break;
+    }
+
+    if (failed)
+    {
+        entry.errors++;
+    }
+
+    entry.totalNs += durationNs;
+    entry.maxNs = std::max(entry.maxNs, durationNs);
+    entry.buckets[bucket]++;
+}
+
+uint64_t IOStats::getBucketUpperBound(int bucket)
+{
+    return uint64_t(1) << bucket;
+}
+
+uint64_t IOStats::getPercentile(const Entry& entry, double percentile)
+{
+    uint64_t count = 0;
+
+    for (int i = 0; i < BUCKETS_NUM; i++)
+    {
+        count += entry.buckets[i];
+    }
+
+    uint64_t threshold = uint64_t(count * percentile + 0.999999);
+    uint64_t sum = 0;
+
+    for (int i = 0; i < BUCKETS_NUM; i++)
+    {
+        sum += entry.buckets[i];
+
+        if (sum >= threshold && entry.buckets[i] != 0)
+        {
+            return getBucketUpperBound(i);
+        }
+    }
+
+    return getBucketUpperBound(BUCKETS_NUM - 1);
+}
+
+void IOStats::Print(std::ostream& os)
+{
+    std::lock_guard<std::mutex> lock(entriesMutex);
+
+    os << "I/O statistics (latencies in us, percentiles are bucket upper bounds):\n" << std::left <<
+        std::setw(8) << "Adapter" << std::setw(40) << "Attribute" << std::right <<
+        std::setw(8) << "Opens" << std::setw(8) << "Reads" << std::setw(8) << "Writes" << std::setw(8) << "Calls" <<
+        std::setw(8) << "Errors" << std::setw(10) << "Avg" << std::setw(8) << "P50" << std::setw(8) << "P99" <<
+        std::setw(10) << "Max" << "  Histogram\n";
+
+    std::ostringstream histogram;
+
+    for (const auto& item: entries)
+    {
+        const Entry& entry = item.second;
+        uint64_t count = entry.reads + entry.writes + entry.calls;
+
+        histogram.str("");
+
+        for (int i = 0; i < BUCKETS_NUM; i++)
+        {
+            if (entry.buckets[i] != 0)
+            {
+                histogram << " <" << getBucketUpperBound(i) << ":" << entry.buckets[i];
+            }
+        }
+
+        os << std::left << std::setw(8) << item.first.first << std::setw(40) << item.first.second << std::right <<
+            std::setw(8) << entry.opens << std::setw(8) << entry.reads << std::setw(8) << entry.writes <<
+            std::setw(8) << entry.calls << std::setw(8) << entry.errors << std::fixed << std::setprecision(1) <<
+            std::setw(10) << (count != 0 ? entry.totalNs / 1000.0 / count : 0.0) <<
+            std::setw(8) << getPercentile(entry, 0.5) << std::setw(8) << getPercentile(entry, 0.99) <<
+            std::setw(10) << entry.maxNs / 1000.0 << " " << histogram.str() << "\n";
+    }
+
+    os.flush();
+}
+
+void IOStats::Finish()
+{
+    if (enabled)
+    {
+        Print(std::cerr);
+    }
+}
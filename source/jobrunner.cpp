@@ -0,0 +1,376 @@
+#include "jobrunner.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "amdgpuproprocessing.h"
+#include "cliparameters.h"
+#include "error.h"
+#include "profile.h"
+#include "settingsjournal.h"
+#include "subcommandoptions.h"
+
+/* state shared with signal handlers */
+static SettingsJournal* activeJournal = nullptr;
+static volatile sig_atomic_t jobPid = 0;
+static volatile sig_atomic_t pendingSignal = 0;
+
+/* terminating signals are passed to the job, the settings are restored when it ends */
+static void handleTerminateSignal(int signal)
+{
+    pendingSignal = signal;
+
+    if (jobPid > 0)
+    {
+        ::kill(jobPid, signal);
+    }
+}
+
+/* the wrapper crashed: restore settings and die by the same signal */
+static void handleCrashSignal(int signal)
+{
+    if (activeJournal != nullptr)
+    {
+        activeJournal->RestoreFromSignal();
+    }
+
+    ::signal(signal, SIG_DFL);
+    ::raise(signal);
+}
+
+static void setSignalHandlers(bool install)
+{
+    static const int terminateSignals[] = { SIGINT, SIGTERM, SIGHUP, SIGQUIT };
+    static const int crashSignals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+
+    struct sigaction action;
+    ::memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+
+    action.sa_handler = install ? handleTerminateSignal : SIG_DFL;
+    action.sa_flags = SA_RESTART;
+
+    for (int signal: terminateSignals)
+    {
+        ::sigaction(signal, &action, nullptr);
+    }
+
+    action.sa_handler = install ? handleCrashSignal : SIG_DFL;
+    action.sa_flags = 0;
+
+    for (int signal: crashSignals)
+    {
+        ::sigaction(signal, &action, nullptr);
+    }
+}
+
+JobRunner::JobRunner(AMDGPUAdapterHandle& _handle, const std::vector<int>& _adapters, unsigned int _sampleInterval) :
+    handle(_handle), registry(_handle), adapters(_adapters), sampleInterval(_sampleInterval)
+{}
+
+/* board power is integrated by the trapezoidal rule over the interval from the previous sample */
+void JobRunner::sample(std::vector<JobStats>& stats, double interval)
+{
+    for (JobStats& adapterStats: stats)
+    {
+        const int handleIndex = registry.GetHandleIndex(adapterStats.adapterIndex);
+        int microWatts;
+        double temperature;
+        unsigned int coreClock, memoryClock;
+
+        if (handleIndex < 0)
+        {
+            continue;
+        }
+
+        try
+        {
+            microWatts = handle.getPower(handleIndex);
+            temperature = handle.getTemperature(handleIndex) / 1000.0;
+            handle.getCurrentClocks(handleIndex, coreClock, memoryClock);
+        }
+        catch(const std::exception& error)
+        {
+            continue;   // adapter is being removed
+        }
+
+        if (microWatts < 0)
+        {
+            adapterStats.energy = -1.0;
+        }
+        else
+        {
+            const double power = microWatts / 1000000.0;
+
+            if (adapterStats.samples != 0 && adapterStats.energy >= 0.0)
+            {
+                adapterStats.energy += (adapterStats.lastPower + power) * 0.5 * interval;
+            }
+
+            adapterStats.lastPower = power;
+        }
+
+        if (adapterStats.samples == 0)
+        {
+            adapterStats.temperatureMin = adapterStats.temperatureMax = temperature;
+        }
+
+        adapterStats.temperatureMin = std::min(adapterStats.temperatureMin, temperature);
+        adapterStats.temperatureMax = std::max(adapterStats.temperatureMax, temperature);
+        adapterStats.temperatureSum += temperature;
+        adapterStats.coreClockSum += coreClock;
+        adapterStats.coreClockMax = std::max(adapterStats.coreClockMax, double(coreClock));
+        adapterStats.memoryClockSum += memoryClock;
+        adapterStats.memoryClockMax = std::max(adapterStats.memoryClockMax, double(memoryClock));
+        adapterStats.samples++;
+    }
+}
+
+int JobRunner::Run(const std::vector<std::string>& command, std::vector<JobStats>& stats, double& duration)
+{
+    std::vector<char*> args;
+
+    for (const std::string& arg: command)
+    {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+
+    args.push_back(nullptr);
+
+    stats.clear();
+
+    for (int adapterIndex: adapters)
+    {
+        stats.push_back(JobStats{ adapterIndex, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 });
+    }
+
+    std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+    const std::chrono::steady_clock::time_point start = last;
+
+    sample(stats, 0.0);
+
+    const pid_t pid = ::fork();
+
+    if (pid < 0)
+    {
+        throw Error(errno, "Unable to start job");
+    }
+
+    if (pid == 0)
+    {
+        ::execvp(args[0], args.data());
+        std::cerr << "Unable to run '" << args[0] << "': " << ::strerror(errno) << std::endl;
+        ::_exit(127);
+    }
+
+    jobPid = pid;
+
+    // signal came before the job was started
+    if (pendingSignal != 0)
+    {
+        ::kill(pid, pendingSignal);
+    }
+
+    int status = 0;
+
+    while (true)
+    {
+        const pid_t result = ::waitpid(pid, &status, WNOHANG);
+
+        if (result == pid)
+        {
+            break;
+        }
+
+        if (result < 0 && errno != EINTR)
+        {
+            jobPid = 0;
+            throw Error(errno, "Unable to wait for job");
+        }
+
+        std::vector<DeviceEvent> deviceEvents;
+        registry.Poll(sampleInterval, deviceEvents);
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        sample(stats, std::chrono::duration<double>(now - last).count());
+        last = now;
+    }
+
+    jobPid = 0;
+    duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+void JobRunner::writeStats(OutputBuffer& out, const JobStats& stats, double duration)
+{
+    const double samples = std::max(stats.samples, 1U);
+
+    out << "Adapter " << stats.adapterIndex << ": ";
+
+    if (stats.energy >= 0.0)
+    {
+        out << "energy " << stats.energy << " J (average power " << stats.energy / std::max(duration, 0.001) << " W), ";
+    }
+    else
+    {
+        out << "energy not available, ";
+    }
+
+    out << "temperature " << stats.temperatureMin << " - " << stats.temperatureMax << " C (average "
+        << stats.temperatureSum / samples << " C), core clock average " << stats.coreClockSum / samples
+        << " MHz (max " << stats.coreClockMax << " MHz), memory clock average " << stats.memoryClockSum / samples
+        << " MHz (max " << stats.memoryClockMax << " MHz)\n";
+}
+
+int JobRunner::Main(int argc, const char** argv)
+{
+    std::string profileFile, adaptersText, sampleInterval = "100", journalDirectory = "/run/amdcovc";
+    std::vector<OVCParameter> parameters;
+    std::vector<std::string> command;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (::strcmp(argv[i], "--") == 0)
+        {
+            command.assign(argv + i + 1, argv + argc);
+            break;
+        }
+
+        if (SubcommandOptions::Get(argv, argc, i, "--profile", profileFile) ||
+            SubcommandOptions::Get(argv, argc, i, "--adapters", adaptersText) ||
+            SubcommandOptions::Get(argv, argc, i, "--sample-interval", sampleInterval) ||
+            SubcommandOptions::Get(argv, argc, i, "--journal-dir", journalDirectory))
+        {
+            continue;
+        }
+
+        if (argv[i][0] == '-')
+        {
+            throw Error((std::string("Unknown option of exec '") + argv[i] + "'").c_str());
+        }
+
+        OVCParameter param;
+
+        if (!CliParameters::ParseOVCParameter(argv[i], param, std::cerr))
+        {
+            throw Error("Unable to parse parameters");
+        }
+
+        parameters.push_back(param);
+    }
+
+    if (command.empty())
+    {
+        throw Error("Command of exec is missing after '--'");
+    }
+
+    AMDGPUAdapterHandle handle;
+    std::vector<int> adapters;
+
+    SubcommandOptions::GetAdapters(adaptersText, handle.getAdaptersNum(), adapters);
+
+    // settings of other adapters would not be restored
+    for (OVCParameter& param: parameters)
+    {
+        if (param.allAdapters)
+        {
+            param.adapters = adapters;
+            param.allAdapters = false;
+        }
+
+        for (int adapterIndex: param.adapters)
+        {
+            if (std::find(adapters.begin(), adapters.end(), adapterIndex) == adapters.end())
+            {
+                std::cerr << "Adapter " << adapterIndex << " is not chosen by exec in '" << param.argText << "'!" << std::endl;
+                throw Error("Unable to parse parameters");
+            }
+        }
+    }
+
+    if (!profileFile.empty())
+    {
+        Profile profile;
+        profile.Load(profileFile.c_str());
+
+        std::vector<AdapterIdentity> identities(handle.getAdaptersNum());
+
+        for (unsigned int i = 0; i < handle.getAdaptersNum(); i++)
+        {
+            handle.getIdentity(i, identities[i]);
+        }
+
+        std::vector<OVCParameter> profileParameters;
+        profile.Compile(identities, profileParameters);
+
+        // profile settings go first, so parameters override them
+        std::vector<OVCParameter> chosenParameters;
+
+        for (const OVCParameter& param: profileParameters)
+        {
+            if (std::find(adapters.begin(), adapters.end(), param.adapters.front()) != adapters.end())
+            {
+                chosenParameters.push_back(param);
+            }
+        }
+
+        parameters.insert(parameters.begin(), chosenParameters.begin(), chosenParameters.end());
+    }
+
+    JobRunner runner(handle, adapters, SubcommandOptions::ParseUnsigned(sampleInterval, "--sample-interval"));
+    SettingsJournal journal(journalDirectory);
+
+    for (int adapterIndex: adapters)
+    {
+        journal.Begin(handle, adapterIndex);
+    }
+
+    activeJournal = &journal;
+    setSignalHandlers(true);
+
+    std::vector<JobStats> stats;
+    double duration = 0.0;
+    int status;
+
+    try
+    {
+        AmdGpuProProcessing::SetOvcParameters(handle, parameters, false, std::cerr);
+
+        status = (pendingSignal == 0) ? runner.Run(command, stats, duration) : 128 + pendingSignal;
+    }
+    catch(...)
+    {
+        journal.Restore();
+        setSignalHandlers(false);
+        activeJournal = nullptr;
+        throw;
+    }
+
+    const bool restored = journal.Restore();
+
+    setSignalHandlers(false);
+    activeJournal = nullptr;
+
+    OutputBuffer out(STDERR_FILENO);
+
+    out << "Job exited with status " << status << " after " << duration << " s\n";
+
+    for (const JobStats& adapterStats: stats)
+    {
+        writeStats(out, adapterStats, duration);
+    }
+
+    if (!restored)
+    {
+        out << "Some settings were not restored, the journal in " << journalDirectory << " is kept\n";
+    }
+
+    return status;
+}
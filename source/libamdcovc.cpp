@@ -0,0 +1,334 @@
+#include "libamdcovc.h"
+#include "cliparameters.h"
+
+#include <mutex>
+#include <sstream>
+
+/* ADL state and console-mode card devices belong to the process, so all contexts share
+ * one ADL instance, created by the first context and destroyed with the last one.
+ * Calls through it are serialized by the mutex. */
+struct ADLInstance
+{
+    std::mutex mutex;
+    std::unique_ptr<ATIADLHandle> handle;
+    std::unique_ptr<ADLMainControl> mainControl;
+    std::unique_ptr<ADLAdapterTable> adapterTable;
+    int contextsNum;
+};
+
+static ADLInstance adlInstance;
+
+struct amdcovc_context
+{
+    ADLInstance* adl;   // nullptr if AMDGPU backend is used
+    std::unique_ptr<AMDGPUAdapterHandle> amdgpuHandle;
+    std::string lastError;
+};
+
+/* returns false if ADL is not available, instance mutex must be locked */
+static bool acquireADL()
+{
+    if (adlInstance.contextsNum == 0)
+    {
+        std::unique_ptr<ATIADLHandle> handle(new ATIADLHandle);
+
+        if (!handle->open())
+        {
+            return false;
+        }
+
+        std::unique_ptr<ADLMainControl> mainControl(new ADLMainControl(*handle, 0));
+        adlInstance.adapterTable.reset(new ADLAdapterTable(*mainControl));
+        adlInstance.mainControl = std::move(mainControl);
+        adlInstance.handle = std::move(handle);
+    }
+
+    adlInstance.contextsNum++;
+    return true;
+}
+
+static int setError(amdcovc_context* context, int error, const char* message)
+{
+    context->lastError = message;
+    return error;
+}
+
+/* messages written by parameter checks, one per line, replace the generic message of exception */
+static int setError(amdcovc_context* context, int error, const std::ostringstream& messages, const char* message)
+{
+    const std::string text = messages.str();
+
+    if (text.empty())
+    {
+        return setError(context, error, message);
+    }
+
+    context->lastError = text.substr(0, text.find_last_not_of('\n') + 1);
+    return error;
+}
+
+static void copyName(char* dest, size_t destSize, const char* src)
+{
+    size_t length = std::min(::strlen(src), destSize - 1);
+    ::memcpy(dest, src, length);
+    dest[length] = 0;
+}
+
+static void getADLAdapterInfo(amdcovc_context* context, int adapterIndex, amdcovc_adapter_info& info)
+{
+    const ADLMainControl& mainControl = *context->adl->mainControl;
+    const int ai = context->adl->adapterTable->getADLIndex(adapterIndex);
+    const AdapterInfo& adapterInfo = context->adl->adapterTable->getAdapterInfo(adapterIndex);
+
+    info.backend = AMDCOVC_BACKEND_ADL;
+    info.busNo = adapterInfo.iBusNumber;
+    info.deviceNo = adapterInfo.iDeviceNumber;
+    info.funcNo = adapterInfo.iFunctionNumber;
+    info.vendorId = adapterInfo.iVendorID;
+    info.deviceId = CatalystCrimsonAdapters::ParseDeviceIdFromUDID(adapterInfo.strUDID);
+    copyName(info.name, sizeof(info.name), adapterInfo.strAdapterName);
+
+    ADLPMActivity activity;
+    mainControl.getCurrentActivity(ai, activity);
+
+    info.coreClock = activity.iEngineClock / 100.0;
+    info.memoryClock = activity.iMemoryClock / 100.0;
+    info.vddc = activity.iVddc / 1000.0;
+    info.gpuLoad = activity.iActivityPercent;
+    info.busLanes = activity.iCurrentBusLanes;
+    info.busSpeed = activity.iCurrentBusSpeed;
+    info.perfLevel = activity.iCurrentPerformanceLevel;
+    info.temperature = mainControl.getTemperature(ai, 0) / 1000.0;
+    info.fanSpeed = mainControl.getFanSpeed(ai, 0);
+}
+
+static void getAMDGPUAdapterInfo(amdcovc_context* context, int adapterIndex, amdcovc_adapter_info& info)
+{
+    const AMDGPUAdapterInfo adapterInfo = context->amdgpuHandle->parseAdapterInfo(adapterIndex);
+
+    info.backend = AMDCOVC_BACKEND_AMDGPU;
+    info.busNo = adapterInfo.busNo;
+    info.deviceNo = adapterInfo.deviceNo;
+    info.funcNo = adapterInfo.funcNo;
+    info.vendorId = adapterInfo.vendorId;
+    info.deviceId = adapterInfo.deviceId;
+    copyName(info.name, sizeof(info.name), adapterInfo.name.c_str());
+    info.coreClock = adapterInfo.coreClock;
+    info.memoryClock = adapterInfo.memoryClock;
+    info.coreOD = adapterInfo.coreOD;
+    info.memoryOD = adapterInfo.memoryOD;
+    info.gpuLoad = adapterInfo.gpuLoad;
+    info.temperature = adapterInfo.temperature / 1000.0;
+    info.tempCritical = adapterInfo.tempCritical / 1000.0;
+
+    if (adapterInfo.maxFanSpeed > adapterInfo.minFanSpeed)
+    {
+        info.fanSpeed = double(adapterInfo.fanSpeed - adapterInfo.minFanSpeed) /
+            double(adapterInfo.maxFanSpeed - adapterInfo.minFanSpeed) * 100.0;
+    }
+
+    info.defaultFanSpeed = adapterInfo.defaultFanSpeed;
+    info.busLanes = adapterInfo.busLanes;
+    info.busSpeed = adapterInfo.busSpeed;
+
+    if (adapterInfo.power >= 0)
+    {
+        info.power = adapterInfo.power / 1000000.0;
+    }
+
+    if (adapterInfo.powerCapAvailable)
+    {
+        info.powerCap = adapterInfo.powerCap / 1000000.0;
+    }
+}
+
+extern "C"
+{
+
+int amdcovc_get_api_version(void)
+{
+    return AMDCOVC_API_VERSION;
+}
+
+int amdcovc_create(amdcovc_context** context, char* error, size_t errorSize)
+{
+    if (context == nullptr || (error == nullptr && errorSize != 0))
+    {
+        return AMDCOVC_INVALID_ARGUMENT;
+    }
+
+    *context = nullptr;
+
+    if (errorSize != 0)
+    {
+        error[0] = 0;
+    }
+
+    try
+    {
+        std::unique_ptr<amdcovc_context> newContext(new amdcovc_context);
+        newContext->adl = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(adlInstance.mutex);
+
+            if (acquireADL())
+            {
+                newContext->adl = &adlInstance;
+            }
+        }
+
+        if (newContext->adl == nullptr)
+        {
+            newContext->amdgpuHandle.reset(new AMDGPUAdapterHandle);
+        }
+
+        *context = newContext.release();
+    }
+    catch(const std::exception& ex)
+    {
+        if (errorSize != 0)
+        {
+            copyName(error, errorSize, ex.what());
+        }
+
+        return AMDCOVC_ERROR;
+    }
+
+    return AMDCOVC_OK;
+}
+
+void amdcovc_destroy(amdcovc_context* context)
+{
+    if (context != nullptr && context->adl != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(adlInstance.mutex);
+
+        // main control is destroyed before the library is closed
+        if (--adlInstance.contextsNum == 0)
+        {
+            adlInstance.adapterTable.reset();
+            adlInstance.mainControl.reset();
+            adlInstance.handle.reset();
+        }
+    }
+
+    delete context;
+}
+
+int amdcovc_get_backend(const amdcovc_context* context)
+{
+    if (context == nullptr)
+    {
+        return AMDCOVC_INVALID_ARGUMENT;
+    }
+
+    return (context->adl != nullptr) ? AMDCOVC_BACKEND_ADL : AMDCOVC_BACKEND_AMDGPU;
+}
+
+int amdcovc_get_adapters_num(amdcovc_context* context, int* adaptersNum)
+{
+    if (context == nullptr || adaptersNum == nullptr)
+    {
+        return AMDCOVC_INVALID_ARGUMENT;
+    }
+
+    *adaptersNum = (context->adl != nullptr) ? context->adl->adapterTable->getAdaptersNum() : context->amdgpuHandle->getAdaptersNum();
+
+    return AMDCOVC_OK;
+}
+
+int amdcovc_get_adapter_info(amdcovc_context* context, int adapterIndex, amdcovc_adapter_info* info)
+{
+    if (context == nullptr || info == nullptr || info->size < sizeof(unsigned int))
+    {
+        return AMDCOVC_INVALID_ARGUMENT;
+    }
+
+    int adaptersNum = 0;
+    amdcovc_get_adapters_num(context, &adaptersNum);
+
+    if (adapterIndex < 0 || adapterIndex >= adaptersNum)
+    {
+        return setError(context, AMDCOVC_INVALID_ARGUMENT, "Adapter index out of range");
+    }
+
+    amdcovc_adapter_info fullInfo;
+    ::memset(&fullInfo, 0, sizeof(fullInfo));
+    fullInfo.size = sizeof(fullInfo);
+    fullInfo.busNo = fullInfo.deviceNo = fullInfo.funcNo = fullInfo.vendorId = fullInfo.deviceId = -1;
+    fullInfo.coreClock = fullInfo.memoryClock = fullInfo.vddc = -1.0;
+    fullInfo.coreOD = fullInfo.memoryOD = fullInfo.gpuLoad = -1;
+    fullInfo.temperature = fullInfo.tempCritical = fullInfo.fanSpeed = -1.0;
+    fullInfo.defaultFanSpeed = fullInfo.busLanes = fullInfo.busSpeed = fullInfo.perfLevel = -1;
+    fullInfo.power = fullInfo.powerCap = -1.0;
+
+    try
+    {
+        if (context->adl != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(context->adl->mutex);
+            getADLAdapterInfo(context, adapterIndex, fullInfo);
+        }
+        else
+        {
+            getAMDGPUAdapterInfo(context, adapterIndex, fullInfo);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        return setError(context, AMDCOVC_ERROR, ex.what());
+    }
+
+    // copy only as much as the caller knows about
+    const unsigned int callerSize = info->size;
+    ::memcpy(info, &fullInfo, std::min<size_t>(callerSize, sizeof(fullInfo)));
+    info->size = callerSize;
+
+    return AMDCOVC_OK;
+}
+
+int amdcovc_apply(amdcovc_context* context, const char* const* parameters, int parametersNum)
+{
+    if (context == nullptr || (parameters == nullptr && parametersNum != 0) || parametersNum < 0)
+    {
+        return AMDCOVC_INVALID_ARGUMENT;
+    }
+
+    std::vector<OVCParameter> ovcParameters(parametersNum);
+    std::ostringstream messages;
+
+    for (int i = 0; i < parametersNum; i++)
+    {
+        if (parameters[i] == nullptr || !CliParameters::ParseOVCParameter(parameters[i], ovcParameters[i], messages))
+        {
+            return setError(context, AMDCOVC_INVALID_PARAMETERS, messages, "Unable to parse parameters");
+        }
+    }
+
+    try
+    {
+        if (context->adl != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(context->adl->mutex);
+            CatalystCrimsonOvc::Set(*context->adl->mainControl, *context->adl->adapterTable, ovcParameters, false, messages);
+        }
+        else
+        {
+            AmdGpuProProcessing::SetOvcParameters(*context->amdgpuHandle, ovcParameters, false, messages);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        return setError(context, AMDCOVC_ERROR, messages, ex.what());
+    }
+
+    return AMDCOVC_OK;
+}
+
+const char* amdcovc_get_last_error(const amdcovc_context* context)
+{
+    return (context != nullptr) ? context->lastError.c_str() : "";
+}
+
+}
@@ -22,6 +22,11 @@
 #endif
 
 #include "cliparameters.h"
+#include "jobrunner.h"
+#include "settingssnapshot.h"
+#include "thermalwatchdog.h"
+#include "throttledetector.h"
+#include "tuner.h"
 
 CliParameters *cli = new CliParameters();
 
@@ -34,16 +39,58 @@ try
     bool useAdaptersList = false;
     bool failed = false;
 
-    for (int i = 1; i < argc; i++)
+    static const struct
     {
-        printHelp |= cli->SetPrintHelp(argv[i]);
-        printVersion |= cli->SetPrintVersion(argv[i]);
-        printVerbose |= cli->SetPrintVerbose(argv[i]);
-        useAdaptersList |= cli->SetUseAdaptersListEquals(argv[i]);
-        useAdaptersList |= cli->SetUseAdaptersList(argv, argc, i);
-        useAdaptersList |= cli->ParseAdaptersList(argv, argc, i);
-
-        if( !( printVersion | printHelp | printVerbose | useAdaptersList ) )
+        const char* name;
+        int (*main)(int argc, const char** argv);
+    } subcommands[] = {
+        { "tune", Tuner::Main },
+        { "exec", JobRunner::Main },
+        { "throttle", ThrottleDetector::Main },
+        { "watchdog", ThermalWatchdog::Main },
+        { "save", SettingsSnapshot::SaveMain },
+        { "restore", SettingsSnapshot::RestoreMain }
+    };
+
+    // --trace-timing and --stats can be given before a subcommand too
+    int first = 1;
+
+    while (first < argc && (cli->SetTraceTiming(argv[first]) || cli->SetPrintStats(argv[first])))
+    {
+        first++;
+    }
+
+    for (const auto& subcommand: subcommands)
+    {
+        if (first < argc && ::strcmp(argv[first], subcommand.name) == 0)
+        {
+            const int status = subcommand.main(argc - first, argv + first);
+
+            TimingTrace::Finish();
+            IOStats::Finish();
+
+            return status;
+        }
+    }
+
+    for (int i = first; i < argc; i++)
+    {
+        bool help = cli->SetPrintHelp(argv[i]);
+        bool version = cli->SetPrintVersion(argv[i]);
+        bool verbose = cli->SetPrintVerbose(argv[i]);
+        bool traceTiming = cli->SetTraceTiming(argv[i]);
+        bool stats = cli->SetPrintStats(argv[i]);
+        bool output = cli->SetOutputFormat(argv[i]) || cli->SetOutputFields(argv[i]);
+        bool profile = cli->SetProfile(argv, argc, i);
+        bool adaptersList = cli->SetUseAdaptersListEquals(argv[i]) || cli->SetUseAdaptersList(argv, argc, i) ||
+            cli->ParseAdaptersList(argv, argc, i);
+
+        printHelp |= help;
+        printVersion |= version;
+        printVerbose |= verbose;
+        useAdaptersList |= adaptersList;
+
+        if( !( help | version | verbose | traceTiming | stats | output | profile | adaptersList ) )
         {
             failed |= cli->ParseParametersOrFail(argv[i]);
         }
@@ -58,9 +105,16 @@ try
         return 0;
     }
 
-    cli->ProcessParameters(useAdaptersList, printVerbose);
+    {
+        TimingTrace::Span span("command", "process parameters");
+        cli->ProcessParameters(useAdaptersList, printVerbose);
+    }
+
     cli->CleanupPciAccess();
 
+    TimingTrace::Finish();
+    IOStats::Finish();
+
     return 0;
 }
 catch(const std::exception& ex)
@@ -69,5 +123,15 @@ catch(const std::exception& ex)
 
     std::cerr << ex.what() << std::endl;
 
+    try
+    {
+        TimingTrace::Finish();
+        IOStats::Finish();
+    }
+    catch(const std::exception& traceEx)
+    {
+        std::cerr << traceEx.what() << std::endl;
+    }
+
     return 1;
 }
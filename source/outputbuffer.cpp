@@ -0,0 +1,258 @@
+#include "outputbuffer.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+static const int DOUBLE_PRECISION = 6;
+
+OutputBuffer::OutputBuffer(int _fd, size_t capacity) : fd(_fd)
+{
+    buffer.reserve(capacity);
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    // output collected before an exception is still printed, before the error message
+    Flush();
+}
+
+OutputBuffer& OutputBuffer::operator<<(const char* value)
+{
+    buffer += value;
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(const std::string& value)
+{
+    buffer += value;
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(char value)
+{
+    buffer += value;
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(int value)
+{
+    AppendInteger(buffer, value);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(unsigned int value)
+{
+    AppendUnsigned(buffer, value);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(long value)
+{
+    AppendInteger(buffer, value);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(unsigned long value)
+{
+    AppendUnsigned(buffer, value);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(double value)
+{
+    AppendDouble(buffer, value);
+    return *this;
+}
+
+void OutputBuffer::Flush()
+{
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+
+    while (remaining != 0)
+    {
+        ssize_t written = ::write(fd, data, remaining);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        data += written;
+        remaining -= written;
+    }
+
+    buffer.clear();
+}
+
+void OutputBuffer::AppendUnsigned(std::string& out, unsigned long value)
+{
+    char digits[24];
+    char* p = digits + sizeof(digits);
+
+    do
+    {
+        *--p = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    out.append(p, digits + sizeof(digits));
+}
+
+void OutputBuffer::AppendInteger(std::string& out, long value)
+{
+    if (value < 0)
+    {
+        out += '-';
+        AppendUnsigned(out, 0UL - (unsigned long)value);
+        return;
+    }
+
+    AppendUnsigned(out, value);
+}
+
+/* scales value to DOUBLE_PRECISION significant digits for decimal exponent.
+ * returns false if rounding of the scaled value is not certain (near half) */
+static bool getSignificantDigits(double value, int exponent, uint64_t& significant)
+{
+    int shift = DOUBLE_PRECISION - 1 - exponent;
+    double scaled = (shift >= 0) ? value * std::pow(10.0, shift) : value / std::pow(10.0, -shift);
+    double fraction = scaled - std::floor(scaled);
+
+    significant = uint64_t(std::llround(scaled));
+
+    return std::fabs(fraction - 0.5) > 1e-6;
+}
+
+/* exact but slower path: let snprintf round and take only digits and exponent,
+ * so decimal point of the C locale does not matter */
+static void getSignificantDigitsExact(double value, int& exponent, uint64_t& significant)
+{
+    char text[32];
+    ::snprintf(text, sizeof(text), "%.*e", DOUBLE_PRECISION - 1, value);
+
+    const char* p = text;
+    significant = 0;
+
+    for (; *p != 'e'; p++)
+    {
+        if (*p >= '0' && *p <= '9')
+        {
+            significant = significant * 10 + (*p - '0');
+        }
+    }
+
+    exponent = ::atoi(p + 1);
+}
+
+void OutputBuffer::AppendDouble(std::string& out, double value)
+{
+    if (std::isnan(value))
+    {
+        out += "nan";
+        return;
+    }
+
+    if (std::signbit(value))
+    {
+        out += '-';
+        value = -value;
+    }
+
+    if (std::isinf(value))
+    {
+        out += "inf";
+        return;
+    }
+
+    if (value == 0.0)
+    {
+        out += '0';
+        return;
+    }
+
+    const uint64_t lowerBound = 100000; // 10^(DOUBLE_PRECISION-1)
+    const uint64_t upperBound = 1000000; // 10^DOUBLE_PRECISION
+
+    int exponent = int(std::floor(std::log10(value)));
+    uint64_t significant = 0;
+    bool certain = value > 1e-300 && value < 1e300 && getSignificantDigits(value, exponent, significant);
+
+    // correct inexact log10 and rounding up to the next power of ten (9.999999 -> 10)
+    if (certain && significant >= upperBound)
+    {
+        exponent++;
+        certain = getSignificantDigits(value, exponent, significant);
+    }
+    else if (certain && significant < lowerBound)
+    {
+        exponent--;
+        certain = getSignificantDigits(value, exponent, significant);
+    }
+
+    if (!certain || significant < lowerBound || significant >= upperBound)
+    {
+        getSignificantDigitsExact(value, exponent, significant);
+    }
+
+    char digits[DOUBLE_PRECISION];
+
+    for (int i = DOUBLE_PRECISION - 1; i >= 0; i--)
+    {
+        digits[i] = '0' + (significant % 10);
+        significant /= 10;
+    }
+
+    int digitsNum = DOUBLE_PRECISION;
+
+    while (digitsNum > 1 && digits[digitsNum - 1] == '0')
+    {
+        digitsNum--;
+    }
+
+    if (exponent < -4 || exponent >= DOUBLE_PRECISION)
+    {
+        out += digits[0];
+
+        if (digitsNum > 1)
+        {
+            out += '.';
+            out.append(digits + 1, digitsNum - 1);
+        }
+
+        out += 'e';
+        out += (exponent < 0) ? '-' : '+';
+
+        if (std::abs(exponent) < 10)
+        {
+            out += '0';
+        }
+
+        AppendUnsigned(out, std::abs(exponent));
+    }
+    else if (exponent < 0)
+    {
+        out += "0.";
+        out.append(-exponent - 1, '0');
+        out.append(digits, digitsNum);
+    }
+    else
+    {
+        int integerDigits = exponent + 1;
+        out.append(digits, integerDigits);
+
+        if (digitsNum > integerDigits)
+        {
+            out += '.';
+            out.append(digits + integerDigits, digitsNum - integerDigits);
+        }
+    }
+}
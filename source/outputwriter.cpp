@@ -0,0 +1,665 @@
+#include "outputwriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "error.h"
+
+bool OutputWriter::ParseFormat(const char* string, OutputFormat& format)
+{
+    if (::strcmp(string, "text") == 0)
+    {
+        format = OutputFormat::TEXT;
+    }
+    else if (::strcmp(string, "json") == 0)
+    {
+        format = OutputFormat::JSON;
+    }
+    else if (::strcmp(string, "csv") == 0)
+    {
+        format = OutputFormat::CSV;
+    }
+    else if (::strcmp(string, "kv") == 0)
+    {
+        format = OutputFormat::KV;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<std::string> OutputWriter::selectedFields;
+
+std::unique_ptr<OutputWriter> OutputWriter::Create(OutputFormat format, OutputBuffer& out)
+{
+    std::unique_ptr<OutputWriter> writer;
+
+    switch(format)
+    {
+        case OutputFormat::JSON:
+
+            writer.reset(new JsonOutputWriter(out));
+            break;
+
+        case OutputFormat::CSV:
+
+            writer.reset(new CsvOutputWriter(out));
+            break;
+
+        case OutputFormat::KV:
+
+            writer.reset(new KvOutputWriter(out));
+            break;
+
+        default:
+
+            throw Error("Output writer is not available for text format");
+    }
+
+    if (!selectedFields.empty())
+    {
+        writer.reset(new FilteredOutputWriter(std::move(writer), out, selectedFields));
+    }
+
+    return writer;
+}
+
+void OutputWriter::SelectFields(const char* list)
+{
+    selectedFields.clear();
+
+    const char* p = list;
+
+    while (true)
+    {
+        const char* end = ::strchr(p, ',');
+        end = (end != nullptr) ? end : p + ::strlen(p);
+
+        if (end == p)
+        {
+            throw Error("Empty field name in field list.");
+        }
+
+        selectedFields.push_back(std::string(p, end));
+
+        if (*end == 0)
+        {
+            break;
+        }
+
+        p = end + 1;
+    }
+}
+
+void OutputWriter::Field(const char* name, const std::string& value)
+{
+    writeValue(name, value, true);
+}
+
+void OutputWriter::Field(const char* name, const char* value)
+{
+    writeValue(name, value, true);
+}
+
+void OutputWriter::Field(const char* name, int value)
+{
+    std::string text;
+    OutputBuffer::AppendInteger(text, value);
+    writeValue(name, text, false);
+}
+
+void OutputWriter::Field(const char* name, unsigned int value)
+{
+    std::string text;
+    OutputBuffer::AppendUnsigned(text, value);
+    writeValue(name, text, false);
+}
+
+void OutputWriter::Field(const char* name, double value)
+{
+    if (!std::isfinite(value))
+    {
+        writeValue(name, "null", false);
+        return;
+    }
+
+    std::string text;
+    OutputBuffer::AppendDouble(text, value);
+    writeValue(name, text, false);
+}
+
+void OutputWriter::Field(const char* name, bool value)
+{
+    writeValue(name, value ? "true" : "false", false);
+}
+
+/*
+ * JSON
+ */
+
+void JsonOutputWriter::writeSeparator()
+{
+    if (!firstInLevel.back())
+    {
+        out << ',';
+    }
+
+    firstInLevel.back() = false;
+}
+
+void JsonOutputWriter::writeKey(const char* name)
+{
+    writeSeparator();
+
+    if (name != nullptr)
+    {
+        writeString(name);
+        out << ':';
+    }
+}
+
+void JsonOutputWriter::writeString(const std::string& string)
+{
+    static const char* hexDigits = "0123456789abcdef";
+
+    out << '"';
+
+    for (char c: string)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out << '\\' << c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            out << "\\u00" << hexDigits[(c >> 4) & 15] << hexDigits[c & 15];
+        }
+        else
+        {
+            out << c;
+        }
+    }
+
+    out << '"';
+}
+
+void JsonOutputWriter::writeValue(const char* name, const std::string& text, bool isString)
+{
+    writeKey(name);
+
+    if (isString)
+    {
+        writeString(text);
+    }
+    else
+    {
+        out << text;
+    }
+}
+
+void JsonOutputWriter::BeginDocument()
+{
+    firstInLevel.assign(1, true);
+    out << "{\"schemaVersion\":" << SCHEMA_VERSION << ",\"adapters\":[";
+}
+
+void JsonOutputWriter::EndDocument()
+{
+    out << "\n]}\n";
+    out.Flush();
+}
+
+void JsonOutputWriter::BeginRecord()
+{
+    writeSeparator();
+    out << '\n' << '{';
+    firstInLevel.push_back(true);
+}
+
+void JsonOutputWriter::EndRecord()
+{
+    out << '}';
+    firstInLevel.pop_back();
+}
+
+void JsonOutputWriter::BeginObject(const char* name)
+{
+    writeKey(name);
+    out << '{';
+    firstInLevel.push_back(true);
+}
+
+void JsonOutputWriter::EndObject()
+{
+    out << '}';
+    firstInLevel.pop_back();
+}
+
+void JsonOutputWriter::BeginArray(const char* name)
+{
+    writeKey(name);
+    out << '[';
+    firstInLevel.push_back(true);
+}
+
+void JsonOutputWriter::EndArray()
+{
+    out << ']';
+    firstInLevel.pop_back();
+}
+
+void JsonOutputWriter::Field(const char* name, const std::vector<unsigned int>& values)
+{
+    writeKey(name);
+    out << '[';
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (i != 0)
+        {
+            out << ',';
+        }
+
+        out << values[i];
+    }
+
+    out << ']';
+}
+
+/*
+ * CSV - rows are written at the end of the document, the header has the columns of all records.
+ * Values of array elements are joined with ';' into one column.
+ */
+
+std::string CsvOutputWriter::getFullName(const char* name) const
+{
+    std::string fullName;
+
+    for (const std::string& level: path)
+    {
+        if (!level.empty())
+        {
+            fullName += level;
+            fullName += '.';
+        }
+    }
+
+    fullName += name;
+
+    return fullName;
+}
+
+void CsvOutputWriter::writeCell(const std::string& text)
+{
+    if (text.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        out << text;
+        return;
+    }
+
+    out << '"';
+
+    for (char c: text)
+    {
+        if (c == '"')
+        {
+            out << '"';
+        }
+
+        out << c;
+    }
+
+    out << '"';
+}
+
+void CsvOutputWriter::writeValue(const char* name, const std::string& text, bool isString)
+{
+    const std::string fullName = getFullName(name);
+    Row& row = rows.back();
+
+    for (std::pair<std::string, std::string>& cell: row)
+    {
+        if (cell.first == fullName)
+        {
+            cell.second += ';';
+            cell.second += text;
+            return;
+        }
+    }
+
+    row.push_back(std::make_pair(fullName, text));
+}
+
+void CsvOutputWriter::BeginDocument()
+{
+    header.clear();
+    rows.clear();
+}
+
+void CsvOutputWriter::EndDocument()
+{
+    if (!rows.empty())
+    {
+        for (size_t i = 0; i < header.size(); i++)
+        {
+            if (i != 0)
+            {
+                out << ',';
+            }
+
+            writeCell(header[i]);
+        }
+
+        out << '\n';
+    }
+
+    // columns are written in the order of the header, so every row has the same schema
+    for (const Row& row: rows)
+    {
+        for (size_t i = 0; i < header.size(); i++)
+        {
+            if (i != 0)
+            {
+                out << ',';
+            }
+
+            for (const std::pair<std::string, std::string>& cell: row)
+            {
+                if (cell.first == header[i])
+                {
+                    writeCell(cell.second);
+                    break;
+                }
+            }
+        }
+
+        out << '\n';
+    }
+
+    rows.clear();
+    out.Flush();
+}
+
+void CsvOutputWriter::BeginRecord()
+{
+    rows.push_back(Row());
+    path.clear();
+}
+
+/* columns first seen in this record are appended to the header */
+void CsvOutputWriter::EndRecord()
+{
+    for (const std::pair<std::string, std::string>& cell: rows.back())
+    {
+        if (std::find(header.begin(), header.end(), cell.first) == header.end())
+        {
+            header.push_back(cell.first);
+        }
+    }
+}
+
+void CsvOutputWriter::BeginObject(const char* name)
+{
+    // array elements do not add a name level
+    path.push_back((name != nullptr) ? name : "");
+}
+
+void CsvOutputWriter::EndObject()
+{
+    path.pop_back();
+}
+
+void CsvOutputWriter::BeginArray(const char* name)
+{
+    path.push_back(name);
+}
+
+void CsvOutputWriter::EndArray()
+{
+    path.pop_back();
+}
+
+void CsvOutputWriter::Field(const char* name, const std::vector<unsigned int>& values)
+{
+    std::string text;
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (i != 0)
+        {
+            text += ';';
+        }
+
+        OutputBuffer::AppendUnsigned(text, values[i]);
+    }
+
+    writeValue(name, text, false);
+}
+
+/*
+ * KV - one 'name=value' line per field, records separated by empty line
+ */
+
+std::string KvOutputWriter::getFullName(const char* name) const
+{
+    std::string fullName;
+
+    for (const Level& level: path)
+    {
+        fullName += level.name;
+        fullName += '.';
+    }
+
+    fullName += name;
+
+    return fullName;
+}
+
+void KvOutputWriter::writeValue(const char* name, const std::string& text, bool isString)
+{
+    out << getFullName(name) << '=';
+
+    for (char c: text)
+    {
+        out << ((c == '\n' || c == '\r') ? ' ' : c);
+    }
+
+    out << '\n';
+}
+
+void KvOutputWriter::BeginDocument()
+{
+    out << "schemaVersion=" << SCHEMA_VERSION << '\n';
+}
+
+void KvOutputWriter::EndDocument()
+{
+    out.Flush();
+}
+
+void KvOutputWriter::BeginRecord()
+{
+    out << '\n';
+    path.clear();
+}
+
+void KvOutputWriter::EndRecord()
+{
+}
+
+void KvOutputWriter::BeginObject(const char* name)
+{
+    if (!path.empty() && path.back().isArray)
+    {
+        Level& array = path.back();
+        path.push_back(Level{ std::to_string(array.index++), false, 0 });
+        return;
+    }
+
+    path.push_back(Level{ name, false, 0 });
+}
+
+void KvOutputWriter::EndObject()
+{
+    path.pop_back();
+}
+
+void KvOutputWriter::BeginArray(const char* name)
+{
+    path.push_back(Level{ name, true, 0 });
+}
+
+void KvOutputWriter::EndArray()
+{
+    path.pop_back();
+}
+
+void KvOutputWriter::Field(const char* name, const std::vector<unsigned int>& values)
+{
+    std::string text;
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (i != 0)
+        {
+            text += ',';
+        }
+
+        OutputBuffer::AppendUnsigned(text, values[i]);
+    }
+
+    writeValue(name, text, false);
+}
+
+/*
+ * Filter of fields - levels are written when the first selected field inside them is written
+ */
+
+FilteredOutputWriter::FilteredOutputWriter(std::unique_ptr<OutputWriter> _writer, OutputBuffer& out,
+                                           const std::vector<std::string>& _fields)
+    : OutputWriter(out), writer(std::move(_writer)), fields(_fields)
+{
+}
+
+bool FilteredOutputWriter::isSelected(const char* name) const
+{
+    std::string fullName;
+
+    for (const Level& level: path)
+    {
+        if (!level.isElement)
+        {
+            fullName += level.name;
+            fullName += '.';
+        }
+    }
+
+    fullName += (name != nullptr) ? name : "";
+
+    for (const std::string& field: fields)
+    {
+        if (fullName.compare(0, field.size(), field) == 0 && (fullName.size() == field.size() || fullName[field.size()] == '.'))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void FilteredOutputWriter::writeLevels()
+{
+    for (Level& level: path)
+    {
+        if (level.written)
+        {
+            continue;
+        }
+
+        if (level.isArray)
+        {
+            writer->BeginArray(level.name.c_str());
+        }
+        else
+        {
+            writer->BeginObject(level.isElement ? nullptr : level.name.c_str());
+        }
+
+        level.written = true;
+    }
+}
+
+void FilteredOutputWriter::writeValue(const char* name, const std::string& text, bool isString)
+{
+    if (isSelected(name))
+    {
+        writeLevels();
+        writer->writeValue(name, text, isString);
+    }
+}
+
+void FilteredOutputWriter::BeginDocument()
+{
+    writer->BeginDocument();
+}
+
+void FilteredOutputWriter::EndDocument()
+{
+    writer->EndDocument();
+}
+
+void FilteredOutputWriter::BeginRecord()
+{
+    path.clear();
+    writer->BeginRecord();
+}
+
+void FilteredOutputWriter::EndRecord()
+{
+    writer->EndRecord();
+}
+
+void FilteredOutputWriter::BeginObject(const char* name)
+{
+    const bool isElement = !path.empty() && path.back().isArray;
+
+    path.push_back(Level{ (!isElement && name != nullptr) ? name : "", false, isElement, false });
+}
+
+void FilteredOutputWriter::EndObject()
+{
+    if (path.back().written)
+    {
+        writer->EndObject();
+    }
+
+    path.pop_back();
+}
+
+void FilteredOutputWriter::BeginArray(const char* name)
+{
+    path.push_back(Level{ name, true, false, false });
+}
+
+void FilteredOutputWriter::EndArray()
+{
+    if (path.back().written)
+    {
+        writer->EndArray();
+    }
+
+    path.pop_back();
+}
+
+void FilteredOutputWriter::Field(const char* name, const std::vector<unsigned int>& values)
+{
+    if (isSelected(name))
+    {
+        writeLevels();
+        writer->Field(name, values);
+    }
+}
@@ -0,0 +1,129 @@
+#include "ovcplan.h"
+
+#include <unordered_set>
+
+OVCPlan::OVCPlan(const std::vector<OVCParameter>& params, int adaptersNum, std::ostream& errors, bool& failed)
+{
+    adapterOffsets.assign(adaptersNum + 1, 0);
+
+    // count actions of every adapter
+    for (const OVCParameter& param: params)
+    {
+        if (!param.allAdapters)
+        {
+            bool listFailed = false;
+
+            for (int adapterIndex: param.adapters)
+            {
+                if (adapterIndex >= adaptersNum || adapterIndex < 0)
+                {
+                    if (!listFailed)
+                    {
+                        errors << "Some adapter indices are out of range in '" << param.argText << "'!" << std::endl;
+                        listFailed = failed = true;
+                    }
+
+                    continue;
+                }
+
+                adapterOffsets[adapterIndex + 1]++;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < adaptersNum; i++)
+            {
+                adapterOffsets[i + 1]++;
+            }
+        }
+    }
+
+    for (int i = 0; i < adaptersNum; i++)
+    {
+        adapterOffsets[i + 1] += adapterOffsets[i];
+    }
+
+    const int actionsNum = adapterOffsets[adaptersNum];
+
+    types.resize(actionsNum);
+    partIds.resize(actionsNum);
+    values.resize(actionsNum);
+    useDefaults.resize(actionsNum);
+    sources.resize(actionsNum);
+
+    std::vector<int> positions(adapterOffsets.begin(), adapterOffsets.end() - 1);
+
+    for (const OVCParameter& param: params)
+    {
+        for (AdapterIterator ait(param.adapters, param.allAdapters, adaptersNum); ait; ++ait)
+        {
+            int i = *ait;
+
+            if (i >= adaptersNum || i < 0)
+            {
+                continue;
+            }
+
+            int action = positions[i]++;
+
+            types[action] = param.type;
+            partIds[action] = param.partId;
+            values[action] = param.value;
+            useDefaults[action] = param.useDefault;
+            sources[action] = &param;
+        }
+    }
+
+    removeOverridden(adaptersNum);
+}
+
+/* keeps the last action for every (type, level) of adapter, in place */
+void OVCPlan::removeOverridden(int adaptersNum)
+{
+    std::unordered_set<long long> seen;
+    int out = 0;
+
+    for (int i = 0; i < adaptersNum; i++)
+    {
+        const int begin = adapterOffsets[i];
+        const int end = adapterOffsets[i + 1];
+
+        seen.clear();
+
+        // mark overridden actions walking from the end
+        for (int action = end - 1; action >= begin; action--)
+        {
+            long long key = ((long long)(int)types[action] << 32) | (unsigned int)partIds[action];
+
+            if (!seen.insert(key).second)
+            {
+                sources[action] = nullptr;
+            }
+        }
+
+        adapterOffsets[i] = out;
+
+        for (int action = begin; action < end; action++)
+        {
+            if (sources[action] == nullptr)
+            {
+                continue;
+            }
+
+            types[out] = types[action];
+            partIds[out] = partIds[action];
+            values[out] = values[action];
+            useDefaults[out] = useDefaults[action];
+            sources[out] = sources[action];
+            out++;
+        }
+    }
+
+    adapterOffsets[adaptersNum] = out;
+
+    types.resize(out);
+    partIds.resize(out);
+    values.resize(out);
+    useDefaults.resize(out);
+    sources.resize(out);
+}
@@ -17,6 +17,8 @@ void PciAccessError(char* msg, ...)
 
 void PCIAccess::InitializePCIAccess()
 {
+    TimingTrace::Span span("startup", "PCI scan");
+
     pciAccess = pci_alloc();
 
     if (pciAccess == nullptr)
@@ -31,61 +33,19 @@ void PCIAccess::InitializePCIAccess()
     pci_scan_bus(pciAccess);
 }
 
-void PCIAccess::GetFromPCI_AMDGPU(const char* rlink, AMDGPUAdapterInfo& adapterInfo)
+/* slot name as in /sys/bus/pci/devices, like 0000:0a:00.0 */
+void PCIAccess::GetFromPCI_AMDGPU(const std::string& slotName, AMDGPUAdapterInfo& adapterInfo)
 {
     if (pciAccess==nullptr)
     {
         InitializePCIAccess();
     }
 
-    unsigned int busNum, devNum, funcNum;
-    size_t rlinkLen = strlen(rlink);
-
-    if (rlinkLen < 18 || ::strncmp(rlink, "../../../", 9) != 0)
-    {
-        throw Error("Invalid PCI Bus string");
-    }
-
-    char* pciStrPtr = (char*)rlink+9;
-    char* pciStrPtrNew;
-
-    while (isdigit(*pciStrPtr))
-    {
-        pciStrPtr++;
-    }
-
-    if (*pciStrPtr != ':')
-    {
-        throw Error(errno, "Unable to parse PCI location");
-    }
-
-    pciStrPtr++;
-    errno = 0;
-
-    busNum = strtoul(pciStrPtr, &pciStrPtrNew, 10);
-
-    if (errno != 0 || pciStrPtr == pciStrPtrNew)
-    {
-        throw Error(errno, "Unable to parse BusID");
-    }
-
-    pciStrPtr = pciStrPtrNew + 1;
-    errno  = 0;
-    devNum = strtoul(pciStrPtr, &pciStrPtr, 10);
+    unsigned int domain, busNum, devNum, funcNum;
 
-    if (errno !=0 || pciStrPtr == pciStrPtrNew)
+    if (::sscanf(slotName.c_str(), "%x:%x:%x.%x", &domain, &busNum, &devNum, &funcNum) != 4)
     {
-        throw Error(errno, "Unable to parse DevID");
-    }
-
-    pciStrPtr = pciStrPtrNew + 1;
-    errno  = 0;
-
-    funcNum = strtoul(pciStrPtr, &pciStrPtr, 10);
-
-    if (errno != 0 || pciStrPtr == pciStrPtrNew)
-    {
-        throw Error(errno, "Unable to parse FuncID");
+        throw Error("Unable to parse PCI location");
     }
 
     pci_dev* dev = pciAccess->devices;
@@ -97,7 +57,11 @@ void PCIAccess::GetFromPCI_AMDGPU(const char* rlink, AMDGPUAdapterInfo& adapterI
             char deviceBuf[128];
             deviceBuf[0] = 0;
 
-            pci_lookup_name(pciAccess, deviceBuf, 128, PCI_LOOKUP_DEVICE, dev->vendor_id, dev->device_id);
+            {
+                // the first lookup loads pci.ids
+                TimingTrace::Span lookupSpan("startup", "pci.ids lookup");
+                pci_lookup_name(pciAccess, deviceBuf, 128, PCI_LOOKUP_DEVICE, dev->vendor_id, dev->device_id);
+            }
             adapterInfo.busNo = busNum;
             adapterInfo.deviceNo  = devNum;
             adapterInfo.funcNo = funcNum;
@@ -173,7 +137,11 @@ void PCIAccess::GetFromPCI(int deviceIndex, AdapterInfo& adapterInfo)
             char deviceBuf[128];
             deviceBuf[0] = 0;
 
-            pci_lookup_name(pciAccess, deviceBuf, 128, PCI_LOOKUP_DEVICE, dev->vendor_id, dev->device_id);
+            {
+                // the first lookup loads pci.ids
+                TimingTrace::Span lookupSpan("startup", "pci.ids lookup");
+                pci_lookup_name(pciAccess, deviceBuf, 128, PCI_LOOKUP_DEVICE, dev->vendor_id, dev->device_id);
+            }
 
             adapterInfo.iBusNumber = busNum;
             adapterInfo.iDeviceNumber = devNum;
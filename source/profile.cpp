@@ -0,0 +1,278 @@
+#include "profile.h"
+#include "cliparameters.h"
+
+static std::string trim(const std::string& string)
+{
+    size_t begin = string.find_first_not_of(" \t\r");
+
+    if (begin == std::string::npos)
+    {
+        return std::string();
+    }
+
+    size_t end = string.find_last_not_of(" \t\r");
+
+    return string.substr(begin, end - begin + 1);
+}
+
+std::string Profile::getLocation(int line) const
+{
+    return filename + ":" + std::to_string(line);
+}
+
+void Profile::Load(const char* _filename)
+{
+    TimingTrace::Span span("command", "load profile", _filename);
+
+    filename = _filename;
+    sections.clear();
+    entries.clear();
+
+    std::ifstream ifs(_filename, std::ios::binary);
+
+    if (!ifs)
+    {
+        throw Error((std::string("Unable to open profile '") + _filename + "'").c_str());
+    }
+
+    std::string line;
+    int lineNo = 0;
+
+    while (std::getline(ifs, line))
+    {
+        lineNo++;
+
+        const std::string text = trim(line);
+
+        if (text.empty() || text[0] == '#' || text[0] == ';')
+        {
+            continue;
+        }
+
+        if (text[0] == '[')
+        {
+            parseSection(text, lineNo);
+        }
+        else
+        {
+            parseEntry(text, lineNo);
+        }
+    }
+
+    if (ifs.bad())
+    {
+        throw Error((std::string("Unable to read profile '") + _filename + "'").c_str());
+    }
+}
+
+void Profile::parseSection(const std::string& text, int line)
+{
+    if (text.back() != ']')
+    {
+        throw Error((getLocation(line) + ": Unterminated section '" + text + "'").c_str());
+    }
+
+    const std::string inner = trim(text.substr(1, text.size() - 2));
+    const size_t space = inner.find_first_of(" \t");
+    const std::string kind = inner.substr(0, space);
+    const std::string argument = (space != std::string::npos) ? trim(inner.substr(space)) : std::string();
+
+    Section section;
+    section.domain = section.busNo = section.deviceNo = section.funcNo = section.deviceId = 0;
+    section.line = line;
+    section.text = text;
+
+    if (kind == "all" && argument.empty())
+    {
+        section.selector = Selector::ALL;
+    }
+    else if (kind == "adapter" && !argument.empty())
+    {
+        section.selector = Selector::ADAPTER;
+
+        try
+        {
+            bool allAdapters = false;
+            AdaptersList::Parse(argument.c_str(), section.adapters, allAdapters);
+
+            if (allAdapters)
+            {
+                section.selector = Selector::ALL;
+            }
+        }
+        catch(const Error& error)
+        {
+            throw Error((getLocation(line) + ": " + error.what()).c_str());
+        }
+    }
+    else if (kind == "pci" && !argument.empty())
+    {
+        section.selector = Selector::PCI;
+
+        char end = 0;
+
+        // optional PCI domain, as in /sys/bus/pci/devices, 0 without it
+        if (::sscanf(argument.c_str(), "%x:%x:%x.%x%c", &section.domain, &section.busNo, &section.deviceNo, &section.funcNo, &end) != 4)
+        {
+            section.domain = 0;
+
+            if (::sscanf(argument.c_str(), "%x:%x.%x%c", &section.busNo, &section.deviceNo, &section.funcNo, &end) != 3)
+            {
+                throw Error((getLocation(line) + ": Unable to parse PCI location '" + argument + "'").c_str());
+            }
+        }
+    }
+    else if (kind == "device" && !argument.empty())
+    {
+        section.selector = Selector::DEVICE;
+
+        char* end;
+        errno = 0;
+        section.deviceId = ::strtoul(argument.c_str(), &end, 16);
+
+        if (errno != 0 || end == argument.c_str() || *end != 0)
+        {
+            throw Error((getLocation(line) + ": Unable to parse device ID '" + argument + "'").c_str());
+        }
+    }
+    else
+    {
+        throw Error((getLocation(line) + ": Unknown section '" + text + "'").c_str());
+    }
+
+    sections.push_back(section);
+}
+
+void Profile::parseEntry(const std::string& text, int line)
+{
+    if (sections.empty())
+    {
+        throw Error((getLocation(line) + ": Parameter outside of section").c_str());
+    }
+
+    const size_t equal = text.find('=');
+
+    if (equal == std::string::npos)
+    {
+        throw Error((getLocation(line) + ": Expected 'name[:level] = value'").c_str());
+    }
+
+    const std::string key = trim(text.substr(0, equal));
+    const std::string value = trim(text.substr(equal + 1));
+    const size_t colon = key.find(':');
+
+    if (key.find(':', colon == std::string::npos ? colon : colon + 1) != std::string::npos)
+    {
+        throw Error((getLocation(line) + ": Adapter list is not allowed in profile parameter '" + key + "'").c_str());
+    }
+
+    // reuse command line syntax: name:ADAPTERS[:LEVEL]=VALUE, adapters are filled in Compile
+    std::string paramText = key.substr(0, colon) + ":0";
+
+    if (colon != std::string::npos)
+    {
+        paramText += key.substr(colon);
+    }
+
+    paramText += "=" + value;
+
+    Entry entry;
+
+    if (!CliParameters::ParseOVCParameter(paramText.c_str(), entry.param, std::cerr))
+    {
+        throw Error((getLocation(line) + ": Invalid parameter '" + text + "'").c_str());
+    }
+
+    entry.param.adapters.clear();
+    entry.param.argText = getLocation(line) + ": " + text;
+    entry.section = sections.size() - 1;
+    entry.line = line;
+
+    entries.push_back(entry);
+}
+
+bool Profile::matches(const Section& section, const AdapterIdentity& adapter) const
+{
+    switch(section.selector)
+    {
+        case Selector::ALL:
+
+            return true;
+
+        case Selector::DEVICE:
+
+            return section.deviceId == adapter.deviceId;
+
+        case Selector::PCI:
+
+            return section.domain == adapter.domain && section.busNo == adapter.busNo && section.deviceNo == adapter.deviceNo &&
+                section.funcNo == adapter.funcNo;
+
+        case Selector::ADAPTER:
+
+            return std::find(section.adapters.begin(), section.adapters.end(), adapter.index) != section.adapters.end();
+    }
+
+    return false;
+}
+
+void Profile::Compile(const std::vector<AdapterIdentity>& adapters, std::vector<OVCParameter>& ovcParameters) const
+{
+    TimingTrace::Span span("command", "compile profile");
+
+    std::vector<bool> sectionUsed(sections.size(), false);
+    std::vector<const Entry*> chosen;
+
+    for (const AdapterIdentity& adapter: adapters)
+    {
+        chosen.clear();
+
+        for (size_t i = 0; i < sections.size(); i++)
+        {
+            if (matches(sections[i], adapter))
+            {
+                sectionUsed[i] = true;
+            }
+        }
+
+        for (const Entry& entry: entries)
+        {
+            const Section& section = sections[entry.section];
+
+            if (!matches(section, adapter))
+            {
+                continue;
+            }
+
+            auto it = std::find_if(chosen.begin(), chosen.end(), [&entry](const Entry* other)
+                {
+                    return other->param.type == entry.param.type && other->param.partId == entry.param.partId;
+                });
+
+            if (it == chosen.end())
+            {
+                chosen.push_back(&entry);
+            }
+            else if (section.selector >= sections[(*it)->section].selector)
+            {
+                *it = &entry;
+            }
+        }
+
+        for (const Entry* entry: chosen)
+        {
+            OVCParameter param = entry->param;
+            param.adapters.assign(1, adapter.index);
+            param.allAdapters = false;
+            ovcParameters.push_back(param);
+        }
+    }
+
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        if (!sectionUsed[i] && sections[i].selector != Selector::ALL)
+        {
+            throw Error((getLocation(sections[i].line) + ": Section '" + sections[i].text + "' does not match any adapter").c_str());
+        }
+    }
+}
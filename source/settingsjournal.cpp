@@ -0,0 +1,219 @@
+#include "settingsjournal.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.h"
+
+SettingsJournal::SettingsJournal(const std::string& _directory) : directory(_directory), restored(0)
+{
+}
+
+SettingsJournal::~SettingsJournal()
+{
+    for (const Adapter& adapter: adapters)
+    {
+        ::close(adapter.fd);
+    }
+}
+
+/* only async-signal-safe calls */
+bool SettingsJournal::writeRaw(const AMDGPUSysfsWrite& write)
+{
+    const int fd = ::open(write.path.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // the driver parses one command per write, the newline ends it
+    const std::string& value = write.value;
+    bool good = ::write(fd, value.c_str(), value.size()) == ssize_t(value.size()) && ::write(fd, "\n", 1) == 1;
+
+    good &= ::close(fd) == 0;
+
+    return good;
+}
+
+std::string SettingsJournal::format(const AMDGPUAdapterHandle& handle, int adapterIndex, const std::vector<AMDGPUSysfsWrite>& writes)
+{
+    std::string content = "# amdcovc journal of adapter " + handle.getSlotName(adapterIndex) + "\n";
+
+    for (const AMDGPUSysfsWrite& write: writes)
+    {
+        std::string name;
+
+        if (!handle.findAttributeName(adapterIndex, write.path, name))
+        {
+            throw Error(("Unable to journal write to file '" + write.path + "'").c_str());
+        }
+
+        content += name + '\t' + write.value + '\n';
+    }
+
+    return content;
+}
+
+void SettingsJournal::parse(const std::string& content, std::vector<AMDGPUSysfsWrite>& writes)
+{
+    size_t pos = 0;
+
+    writes.clear();
+
+    while (pos < content.size())
+    {
+        size_t end = content.find('\n', pos);
+        end = (end != std::string::npos) ? end : content.size();
+
+        const std::string line = content.substr(pos, end - pos);
+        const size_t tab = line.find('\t');
+
+        pos = end + 1;
+
+        if (line.empty() || line[0] == '#' || tab == std::string::npos)
+        {
+            continue;
+        }
+
+        writes.push_back(AMDGPUSysfsWrite{ line.substr(0, tab), line.substr(tab + 1) });
+    }
+}
+
+void SettingsJournal::Begin(const AMDGPUAdapterHandle& handle, int adapterIndex)
+{
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        throw Error(errno, (std::string("Unable to create journal directory '") + directory + "'").c_str());
+    }
+
+    Adapter adapter;
+    adapter.index = adapterIndex;
+    adapter.path = directory + "/amdcovc-" + handle.getSlotName(adapterIndex) + ".journal";
+    adapter.fd = ::open(adapter.path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if (adapter.fd < 0)
+    {
+        throw Error(errno, (std::string("Unable to open journal '") + adapter.path + "'").c_str());
+    }
+
+    if (::flock(adapter.fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        ::close(adapter.fd);
+        throw Error((std::string("Adapter ") + std::to_string(adapterIndex) + " is used by another job").c_str());
+    }
+
+    // journal is closed by destructor from now
+    adapters.push_back(adapter);
+
+    Adapter& added = adapters.back();
+    std::string content;
+    char buffer[4096];
+    ssize_t readSize;
+
+    while ((readSize = ::read(added.fd, buffer, sizeof(buffer))) > 0)
+    {
+        content.append(buffer, readSize);
+    }
+
+    std::vector<AMDGPUSysfsWrite> writes;
+    parse(content, writes);
+
+    if (!writes.empty())
+    {
+        bool good = true;
+
+        for (const AMDGPUSysfsWrite& write: writes)
+        {
+            try
+            {
+                handle.writeAttribute(adapterIndex, write.path, write.value);
+            }
+            catch(const Error& error)
+            {
+                good = false;
+            }
+        }
+
+        std::cerr << (good ? "Restored" : "Unable to restore all") << " settings left by an interrupted job on adapter "
+                  << adapterIndex << std::endl;
+    }
+
+    handle.getRestoreWrites(adapterIndex, added.writes);
+
+    std::string perfLevel;
+
+    if (handle.getPerformanceLevel(adapterIndex, perfLevel) && perfLevel == "manual")
+    {
+        std::cerr << "Warning: DPM state masks of adapter " << adapterIndex << " can not be read, "
+            "all states are allowed when the job ends" << std::endl;
+    }
+    content = format(handle, adapterIndex, added.writes);
+
+    if (::ftruncate(added.fd, 0) != 0 || ::pwrite(added.fd, content.c_str(), content.size(), 0) != ssize_t(content.size()) ||
+        ::fsync(added.fd) != 0)
+    {
+        throw Error(errno, (std::string("Unable to write journal '") + added.path + "'").c_str());
+    }
+}
+
+bool SettingsJournal::Restore()
+{
+    bool good = true;
+
+    restored = 1;
+
+    for (const Adapter& adapter: adapters)
+    {
+        bool adapterGood = true;
+
+        for (const AMDGPUSysfsWrite& write: adapter.writes)
+        {
+            if (!writeRaw(write))
+            {
+                std::cerr << "Unable to restore '" << write.value << "' to file '" << write.path << "'" << std::endl;
+                adapterGood = false;
+            }
+        }
+
+        // failed journal is kept for the next job
+        if (adapterGood)
+        {
+            ::unlink(adapter.path.c_str());
+        }
+
+        good &= adapterGood;
+    }
+
+    return good;
+}
+
+void SettingsJournal::RestoreFromSignal()
+{
+    if (restored)
+    {
+        return;
+    }
+
+    restored = 1;
+
+    for (const Adapter& adapter: adapters)
+    {
+        bool good = true;
+
+        for (const AMDGPUSysfsWrite& write: adapter.writes)
+        {
+            good &= writeRaw(write);
+        }
+
+        if (good)
+        {
+            ::unlink(adapter.path.c_str());
+        }
+    }
+}
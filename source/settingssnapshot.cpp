@@ -0,0 +1,508 @@
+#include "settingssnapshot.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "error.h"
+#include "outputbuffer.h"
+#include "subcommandoptions.h"
+
+static std::string trim(const std::string& string)
+{
+    size_t begin = string.find_first_not_of(" \t\r");
+
+    if (begin == std::string::npos)
+    {
+        return std::string();
+    }
+
+    size_t end = string.find_last_not_of(" \t\r");
+
+    return string.substr(begin, end - begin + 1);
+}
+
+std::string SettingsSnapshot::getLocation(int line) const
+{
+    return filename + ":" + std::to_string(line);
+}
+
+/* as in /sys/bus/pci/devices, the domain can be omitted */
+bool SettingsSnapshot::normalizeSlotName(const std::string& text, std::string& slotName)
+{
+    unsigned int domain = 0, busNo, deviceNo, funcNo;
+    char end = 0;
+    char buffer[32];
+
+    if (::sscanf(text.c_str(), "%x:%x:%x.%x%c", &domain, &busNo, &deviceNo, &funcNo, &end) != 4 &&
+        ::sscanf(text.c_str(), "%x:%x.%x%c", &busNo, &deviceNo, &funcNo, &end) != 3)
+    {
+        return false;
+    }
+
+    ::snprintf(buffer, sizeof(buffer), "%04x:%02x:%02x.%x", domain, busNo, deviceNo, funcNo);
+    slotName = buffer;
+
+    return true;
+}
+
+void SettingsSnapshot::getWrites(const AMDGPUAdapterHandle& handle, int adapterIndex, std::vector<Write>& writes)
+{
+    std::vector<AMDGPUSysfsWrite> sysfsWrites;
+
+    handle.getRestoreWrites(adapterIndex, sysfsWrites);
+    writes.clear();
+
+    for (const AMDGPUSysfsWrite& sysfsWrite: sysfsWrites)
+    {
+        std::string name;
+
+        if (!handle.findAttributeName(adapterIndex, sysfsWrite.path, name))
+        {
+            throw Error(("Unable to save write to file '" + sysfsWrite.path + "'").c_str());
+        }
+
+        writes.push_back(Write{ name, sysfsWrite.value });
+    }
+}
+
+static bool isAttribute(const std::string& name, AMDGPUAttribute attribute)
+{
+    return name == AMDGPUAttributePaths::GetDescriptor(attribute).name;
+}
+
+static bool isLevelAttribute(const std::string& name)
+{
+    return isAttribute(name, AMDGPUAttribute::PERFORMANCE_LEVEL) || isAttribute(name, AMDGPUAttribute::PP_POWER_PROFILE_MODE);
+}
+
+/* Commands of the Overdrive table found in the current table are skipped, the commit
+ * is written only after some command. The performance level and the power profile are
+ * written together, as the profile needs the manual level. Other attributes are
+ * written if their current values differ. */
+void SettingsSnapshot::getChangedWrites(const std::vector<Write>& current, const std::vector<Write>& saved,
+                                        std::vector<Write>& writes)
+{
+    const auto contains = [&current](const Write& write)
+    {
+        for (const Write& currentWrite: current)
+        {
+            if (currentWrite.name == write.name && currentWrite.value == write.value)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    std::string currentLevels, savedLevels;
+
+    for (const Write& write: current)
+    {
+        currentLevels += isLevelAttribute(write.name) ? write.value + '\n' : "";
+    }
+
+    for (const Write& write: saved)
+    {
+        savedLevels += isLevelAttribute(write.name) ? write.value + '\n' : "";
+    }
+
+    bool tableChanged = false;
+
+    writes.clear();
+
+    for (const Write& write: saved)
+    {
+        if (isAttribute(write.name, AMDGPUAttribute::PP_OD_CLK_VOLTAGE))
+        {
+            const bool commit = write.value == "c";
+
+            if ((commit && tableChanged) || (!commit && !contains(write)))
+            {
+                writes.push_back(write);
+                tableChanged = true;
+            }
+        }
+        else if (isLevelAttribute(write.name) ? currentLevels != savedLevels : !contains(write))
+        {
+            writes.push_back(write);
+        }
+    }
+}
+
+void SettingsSnapshot::Capture(const AMDGPUAdapterHandle& handle, const std::vector<int>& adapterIndices)
+{
+    adapters.clear();
+
+    for (int adapterIndex: adapterIndices)
+    {
+        Adapter adapter{ handle.getSlotName(adapterIndex), std::vector<Write>(), 0 };
+
+        getWrites(handle, adapterIndex, adapter.writes);
+        adapters.push_back(adapter);
+    }
+}
+
+void SettingsSnapshot::Load(const char* _filename)
+{
+    filename = _filename;
+    adapters.clear();
+
+    std::ifstream ifs(_filename, std::ios::binary);
+
+    if (!ifs)
+    {
+        throw Error((std::string("Unable to open settings '") + _filename + "'").c_str());
+    }
+
+    std::string line;
+    int lineNo = 0;
+
+    while (std::getline(ifs, line))
+    {
+        lineNo++;
+
+        const std::string text = trim(line);
+
+        if (text.empty() || text[0] == '#' || text[0] == ';')
+        {
+            continue;
+        }
+
+        if (text[0] == '[')
+        {
+            std::string slotName;
+
+            if (text.compare(0, 4, "[pci") != 0 || text.back() != ']' ||
+                !normalizeSlotName(trim(text.substr(4, text.size() - 5)), slotName))
+            {
+                throw Error((getLocation(lineNo) + ": Expected '[pci DOMAIN:BUS:DEVICE.FUNCTION]'").c_str());
+            }
+
+            for (const Adapter& adapter: adapters)
+            {
+                if (adapter.slotName == slotName)
+                {
+                    throw Error((getLocation(lineNo) + ": Adapter " + slotName + " is already at line " +
+                                 std::to_string(adapter.line)).c_str());
+                }
+            }
+
+            adapters.push_back(Adapter{ slotName, std::vector<Write>(), lineNo });
+            continue;
+        }
+
+        if (adapters.empty())
+        {
+            throw Error((getLocation(lineNo) + ": Setting outside of section").c_str());
+        }
+
+        const size_t equal = text.find('=');
+
+        if (equal == std::string::npos)
+        {
+            throw Error((getLocation(lineNo) + ": Expected 'attribute = value'").c_str());
+        }
+
+        const std::string name = trim(text.substr(0, equal));
+
+        if (!AMDGPUAttributePaths::IsName(name))
+        {
+            throw Error((getLocation(lineNo) + ": Unknown attribute '" + name + "'").c_str());
+        }
+
+        adapters.back().writes.push_back(Write{ name, trim(text.substr(equal + 1)) });
+    }
+
+    if (ifs.bad())
+    {
+        throw Error((std::string("Unable to read settings '") + _filename + "'").c_str());
+    }
+}
+
+void SettingsSnapshot::Save(const char* _filename) const
+{
+    // a reboot during save leaves the old file
+    const std::string tempFilename = std::string(_filename) + ".tmp";
+    std::string content = "# amdcovc settings\n";
+
+    for (const Adapter& adapter: adapters)
+    {
+        content += "\n[pci " + adapter.slotName + "]\n";
+
+        for (const Write& write: adapter.writes)
+        {
+            content += write.name + " = " + write.value + '\n';
+        }
+    }
+
+    {
+        std::ofstream ofs(tempFilename, std::ios::binary);
+
+        if (!ofs || !(ofs << content) || !ofs.flush())
+        {
+            throw Error((std::string("Unable to write settings '") + tempFilename + "'").c_str());
+        }
+    }
+
+    if (::rename(tempFilename.c_str(), _filename) != 0)
+    {
+        throw Error(errno, (std::string("Unable to rename '") + tempFilename + "'").c_str());
+    }
+}
+
+static void getSlotNames(const AMDGPUAdapterHandle& handle, std::vector<std::string>& slotNames)
+{
+    slotNames.clear();
+
+    for (unsigned int i = 0; i < handle.getAdaptersNum(); i++)
+    {
+        try
+        {
+            slotNames.push_back(handle.getSlotName(i));
+        }
+        catch(const Error& error)
+        {
+            slotNames.push_back("");
+        }
+    }
+}
+
+static int findSlot(const std::vector<std::string>& slotNames, const std::string& slotName)
+{
+    for (size_t i = 0; i < slotNames.size(); i++)
+    {
+        if (slotNames[i] == slotName)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool SettingsSnapshot::IsPresent(const AMDGPUAdapterHandle& handle) const
+{
+    std::vector<std::string> slotNames;
+
+    getSlotNames(handle, slotNames);
+
+    for (const Adapter& adapter: adapters)
+    {
+        if (findSlot(slotNames, adapter.slotName) < 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* stops at the first failed write, the later ones (like the commit of table) depend on it */
+void SettingsSnapshot::apply(const AMDGPUAdapterHandle& handle, const Adapter& adapter, Result& result)
+{
+    std::vector<Write> current;
+
+    getWrites(handle, result.handleIndex, current);
+    getChangedWrites(current, adapter.writes, result.writes);
+
+    result.skipped = adapter.writes.size() - result.writes.size();
+
+    for (const Write& write: result.writes)
+    {
+        handle.writeAttribute(result.handleIndex, write.name, write.value);
+        result.written++;
+    }
+}
+
+bool SettingsSnapshot::Apply(const AMDGPUAdapterHandle& handle, bool verbose) const
+{
+    std::vector<std::string> slotNames;
+    std::vector<Result> results(adapters.size());
+    std::vector<std::thread> threads;
+
+    getSlotNames(handle, slotNames);
+
+    // adapters do not share attributes, they are written at the same time
+    for (size_t i = 0; i < adapters.size(); i++)
+    {
+        results[i] = Result{ findSlot(slotNames, adapters[i].slotName), 0, 0, std::vector<Write>(), "" };
+
+        if (results[i].handleIndex < 0)
+        {
+            continue;
+        }
+
+        threads.push_back(std::thread([&handle, &results, this, i]()
+        {
+            try
+            {
+                apply(handle, adapters[i], results[i]);
+            }
+            catch(const std::exception& error)
+            {
+                results[i].error = error.what();
+            }
+        }));
+    }
+
+    for (std::thread& thread: threads)
+    {
+        thread.join();
+    }
+
+    OutputBuffer out;
+    bool good = true;
+
+    for (size_t i = 0; i < adapters.size(); i++)
+    {
+        const Result& result = results[i];
+
+        if (result.handleIndex < 0)
+        {
+            std::cerr << "Adapter " << adapters[i].slotName << " is not present!" << std::endl;
+            good = false;
+            continue;
+        }
+
+        out << "Adapter " << result.handleIndex << " (" << adapters[i].slotName << "): " << result.written <<
+            " settings written, " << result.skipped << " already set\n";
+
+        if (verbose)
+        {
+            for (unsigned int w = 0; w < result.written; w++)
+            {
+                out << "  " << result.writes[w].name << " = " <<
+                    result.writes[w].value << '\n';
+            }
+        }
+
+        if (!result.error.empty())
+        {
+            std::cerr << "Adapter " << result.handleIndex << ": " << result.error << "!" << std::endl;
+            good = false;
+        }
+    }
+
+    return good;
+}
+
+int SettingsSnapshot::SaveMain(int argc, const char** argv)
+{
+    std::string adaptersText, file;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (SubcommandOptions::Get(argv, argc, i, "--adapters", adaptersText))
+        {
+            continue;
+        }
+
+        if (argv[i][0] == '-' || !file.empty())
+        {
+            throw Error((std::string("Unknown option of save '") + argv[i] + "'").c_str());
+        }
+
+        file = argv[i];
+    }
+
+    if (file.empty())
+    {
+        throw Error("Missing settings file of save");
+    }
+
+    AMDGPUAdapterHandle handle;
+    std::vector<int> adapterIndices;
+    SettingsSnapshot snapshot;
+
+    SubcommandOptions::GetAdapters(adaptersText, handle.getAdaptersNum(), adapterIndices);
+
+    snapshot.Capture(handle, adapterIndices);
+    snapshot.Save(file.c_str());
+
+    // the driver does not report the masks of DPM states, so they can not be saved
+    for (int adapterIndex: adapterIndices)
+    {
+        std::string perfLevel;
+
+        if (handle.getPerformanceLevel(adapterIndex, perfLevel) && perfLevel == "manual")
+        {
+            std::cerr << "Warning: DPM state masks of adapter " << adapterIndex << " can not be read and are not saved, "
+                "restore allows all states in the manual performance level" << std::endl;
+        }
+    }
+
+    return 0;
+}
+
+int SettingsSnapshot::RestoreMain(int argc, const char** argv)
+{
+    std::string wait, file;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (SubcommandOptions::Get(argv, argc, i, "--wait", wait))
+        {
+            continue;
+        }
+
+        if (::strcmp(argv[i], "-v") == 0 || ::strcmp(argv[i], "--verbose") == 0)
+        {
+            verbose = true;
+            continue;
+        }
+
+        if (argv[i][0] == '-' || !file.empty())
+        {
+            throw Error((std::string("Unknown option of restore '") + argv[i] + "'").c_str());
+        }
+
+        file = argv[i];
+    }
+
+    if (file.empty())
+    {
+        throw Error("Missing settings file of restore");
+    }
+
+    SettingsSnapshot snapshot;
+    snapshot.Load(file.c_str());
+
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() +
+        std::chrono::seconds(wait.empty() ? 0 : SubcommandOptions::ParseUnsigned(wait, "--wait"));
+    std::unique_ptr<AMDGPUAdapterHandle> handle;
+
+    // at boot the driver can still be probing some cards
+    while (std::chrono::steady_clock::now() < end)
+    {
+        try
+        {
+            handle.reset(new AMDGPUAdapterHandle());
+        }
+        catch(const std::exception& error)
+        {
+            handle.reset();
+        }
+
+        if (handle != nullptr && snapshot.IsPresent(*handle))
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    if (handle == nullptr)
+    {
+        handle.reset(new AMDGPUAdapterHandle());
+    }
+
+    return snapshot.Apply(*handle, verbose) ? 0 : 1;
+}
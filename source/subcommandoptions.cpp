@@ -0,0 +1,81 @@
+#include "subcommandoptions.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "adapterslist.h"
+#include "error.h"
+
+bool SubcommandOptions::Get(const char** argv, int argc, int& i, const char* name, std::string& value)
+{
+    const size_t length = ::strlen(name);
+
+    if (::strncmp(argv[i], name, length) != 0)
+    {
+        return false;
+    }
+
+    if (argv[i][length] == '=')
+    {
+        value = argv[i] + length + 1;
+        return true;
+    }
+
+    if (argv[i][length] != 0)
+    {
+        return false;
+    }
+
+    if (i + 1 >= argc)
+    {
+        throw Error((std::string("Missing value of option '") + name + "'").c_str());
+    }
+
+    value = argv[++i];
+    return true;
+}
+
+unsigned int SubcommandOptions::ParseUnsigned(const std::string& value, const char* name)
+{
+    char* end;
+    errno = 0;
+    const unsigned long result = ::strtoul(value.c_str(), &end, 10);
+
+    if (errno != 0 || end == value.c_str() || *end != 0 || result == 0)
+    {
+        throw Error((std::string("Invalid value of option '") + name + "'").c_str());
+    }
+
+    return result;
+}
+
+void SubcommandOptions::GetAdapters(const std::string& list, int adaptersNum, std::vector<int>& adapters)
+{
+    bool allAdapters = true;
+
+    adapters.clear();
+
+    if (!list.empty())
+    {
+        AdaptersList::Parse(list.c_str(), adapters, allAdapters);
+    }
+
+    if (allAdapters)
+    {
+        adapters.clear();
+
+        for (int i = 0; i < adaptersNum; i++)
+        {
+            adapters.push_back(i);
+        }
+    }
+
+    for (int adapterIndex: adapters)
+    {
+        if (adapterIndex < 0 || adapterIndex >= adaptersNum)
+        {
+            throw Error("Some adapter indices are out of range");
+        }
+    }
+}
@@ -0,0 +1,499 @@
+#include "thermalwatchdog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "error.h"
+#include "subcommandoptions.h"
+#include "throttledetector.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void handleStopSignal(int)
+{
+    stopRequested = 1;
+}
+
+ThermalWatchdog::ThermalWatchdog(WatchdogBackend& _backend, double _temperatureMargin, double _temperatureLimit,
+                                 double _stallRPM, double _stallDuty, double _stallTime) :
+    backend(_backend), stallRPM(_stallRPM), stallDuty(_stallDuty), stallTime(_stallTime),
+    temperatureMargin(_temperatureMargin), temperatureLimit(_temperatureLimit)
+{
+    for (int i = 0; i < backend.getAdaptersNum(); i++)
+    {
+        Refresh(i);
+    }
+}
+
+ThermalWatchdog::AdapterState& ThermalWatchdog::getAdapter(int adapterIndex)
+{
+    if (adapters.size() <= size_t(adapterIndex))
+    {
+        AdapterState state;
+
+        std::fill(state.limits, state.limits + WatchdogTemperaturesNum, NAN);
+        state.tripped = false;
+        state.stallStart = -1.0;
+        state.reverts = state.failedReverts = state.failedSamples = 0;
+        state.sampleFailing = false;
+
+        adapters.resize(adapterIndex + 1, state);
+    }
+
+    return adapters[adapterIndex];
+}
+
+void ThermalWatchdog::Refresh(int adapterIndex)
+{
+    AdapterState& state = getAdapter(adapterIndex);
+    double criticalTemperatures[WatchdogTemperaturesNum];
+
+    // limits are read once, only inputs are read at every sample
+    backend.getCriticalTemperatures(adapterIndex, criticalTemperatures);
+
+    for (int c = 0; c < WatchdogTemperaturesNum; c++)
+    {
+        state.limits[c] = (temperatureLimit > 0.0) ? temperatureLimit : criticalTemperatures[c] - temperatureMargin;
+    }
+}
+
+double ThermalWatchdog::GetTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned int ThermalWatchdog::check(AdapterState& state, const WatchdogSample& sample, double time, WatchdogEvent& event) const
+{
+    unsigned int trips = 0;
+
+    // the first channel at its limit is reported
+    for (int c = 0; c < WatchdogTemperaturesNum; c++)
+    {
+        if (sample.temperatures[c] >= state.limits[c] && trips == 0)
+        {
+            trips = WATCHDOG_TEMPERATURE;
+            event.channel = c + 1;
+            event.temperature = sample.temperatures[c];
+            event.limit = state.limits[c];
+        }
+    }
+
+    // a fan spinning up after zero RPM mode reads 0 for a while, unknown values never stall
+    if (sample.fanRPM < stallRPM && sample.fanDuty >= stallDuty)
+    {
+        if (state.stallStart < 0.0)
+        {
+            state.stallStart = time;
+        }
+
+        if (time - state.stallStart >= stallTime)
+        {
+            trips |= WATCHDOG_FAN_STALL;
+        }
+    }
+    else
+    {
+        state.stallStart = -1.0;
+    }
+
+    return trips;
+}
+
+static double getSystemTime()
+{
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void ThermalWatchdog::Update(int adapterIndex, std::vector<WatchdogEvent>& events)
+{
+    AdapterState& state = getAdapter(adapterIndex);
+    WatchdogSample sample;
+    const double sampleTime = GetTime();
+    WatchdogEvent event{ WatchdogEventType::TRIPPED, 0.0, adapterIndex, 0, 0, NAN, NAN, NAN, NAN, NAN, NAN, 0, "" };
+
+    try
+    {
+        backend.sample(adapterIndex, sample);
+    }
+    catch(const std::exception& error)
+    {
+        // adapter being reset fails until its uevent comes, it is reported only once
+        state.failedSamples++;
+
+        if (!state.sampleFailing)
+        {
+            state.sampleFailing = true;
+            events.push_back(WatchdogEvent{ WatchdogEventType::SAMPLE_FAILED, getSystemTime(), adapterIndex, 0, 0, NAN, NAN,
+                                            NAN, NAN, NAN, NAN, 0, error.what() });
+        }
+        return;
+    }
+
+    if (state.sampleFailing)
+    {
+        state.sampleFailing = false;
+        events.push_back(WatchdogEvent{ WatchdogEventType::SAMPLE_RESUMED, getSystemTime(), adapterIndex, 0, 0, NAN, NAN,
+                                        NAN, NAN, NAN, NAN, 0, "" });
+    }
+
+    event.fanRPM = sample.fanRPM;
+    event.fanDuty = sample.fanDuty;
+    event.trips = check(state, sample, sampleTime, event);
+
+    if (event.trips == 0)
+    {
+        if (state.tripped)
+        {
+            state.tripped = false;
+            event.type = WatchdogEventType::RECOVERED;
+            event.time = getSystemTime();
+            events.push_back(event);
+        }
+
+        state.failedReverts = 0;
+        return;
+    }
+
+    if (state.tripped)
+    {
+        return;
+    }
+
+    try
+    {
+        backend.revert(adapterIndex);
+    }
+    catch(const std::exception& error)
+    {
+        // tried again at the next sample, only the first failure is printed
+        if (state.failedReverts++ == 0)
+        {
+            event.time = getSystemTime();
+            event.attempts = 1;
+            event.error = error.what();
+            events.push_back(event);
+        }
+        return;
+    }
+
+    const double endTime = GetTime();
+
+    state.tripped = true;
+    state.reverts++;
+
+    event.time = getSystemTime();
+    event.reactionLatency = endTime - sampleTime;
+    event.faultLatency = endTime - backend.getFaultTime(adapterIndex);
+    event.attempts = state.failedReverts + 1;
+    state.failedReverts = 0;
+
+    latencies.push_back(event.reactionLatency);
+    events.push_back(event);
+}
+
+void ThermalWatchdog::WriteEvent(OutputBuffer& out, const WatchdogEvent& event)
+{
+    ThrottleDetector::WriteTime(out, event.time);
+
+    out << " adapter " << event.adapterIndex;
+
+    switch (event.type)
+    {
+        case WatchdogEventType::RECOVERED:
+            out << ": temperatures and fan are normal again\n";
+            return;
+        case WatchdogEventType::SAMPLE_FAILED:
+            out << ": unable to sample, " << event.error << '\n';
+            return;
+        case WatchdogEventType::SAMPLE_RESUMED:
+            out << ": sampled again\n";
+            return;
+        default:
+            break;
+    }
+
+    out << ": tripped by";
+
+    if ((event.trips & WATCHDOG_TEMPERATURE) != 0)
+    {
+        out << " temperature (temp" << event.channel << ' ' << event.temperature << " C, limit " << event.limit << " C)";
+    }
+
+    if ((event.trips & WATCHDOG_FAN_STALL) != 0)
+    {
+        out << " fan stall (" << event.fanRPM << " RPM at " << event.fanDuty << "% PWM)";
+    }
+
+    if (!event.error.empty())
+    {
+        out << ", " << event.error << ", trying again\n";
+        return;
+    }
+
+    out << ", reverted in " << event.reactionLatency * 1000.0 << " ms";
+
+    if (event.attempts > 1)
+    {
+        out << " at attempt " << event.attempts;
+    }
+
+    if (!std::isnan(event.faultLatency))
+    {
+        out << ", " << event.faultLatency * 1000.0 << " ms after fault";
+    }
+
+    out << '\n';
+}
+
+/* list of KIND:ADAPTER@MS, KIND is stall, overheat, sensor or revert */
+static void injectFaults(SimulatedWatchdogBackend& backend, const std::string& list)
+{
+    size_t pos = 0;
+
+    while (pos < list.size())
+    {
+        size_t end = list.find(',', pos);
+        end = (end != std::string::npos) ? end : list.size();
+
+        const std::string fault = list.substr(pos, end - pos);
+        const size_t colon = fault.find(':');
+        const size_t at = fault.find('@');
+
+        pos = end + 1;
+
+        if (colon == std::string::npos || at == std::string::npos || at < colon)
+        {
+            throw Error(("Invalid fault '" + fault + "' of option '--inject'").c_str());
+        }
+
+        static const struct
+        {
+            const char* name;
+            WatchdogFault fault;
+        } kinds[] = {
+            { "stall", WatchdogFault::FAN_STALL },
+            { "overheat", WatchdogFault::OVERHEAT },
+            { "sensor", WatchdogFault::SENSOR_FAILURE },
+            { "revert", WatchdogFault::REVERT_FAILURE }
+        };
+
+        const std::string kind = fault.substr(0, colon);
+        int kindIndex = -1;
+
+        for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++)
+        {
+            kindIndex = (kind == kinds[k].name) ? k : kindIndex;
+        }
+
+        if (kindIndex < 0)
+        {
+            throw Error(("Unknown fault '" + kind + "' of option '--inject'").c_str());
+        }
+
+        const std::string adapterText = fault.substr(colon + 1, at - colon - 1);
+        char* adapterEnd;
+        const int adapterIndex = ::strtol(adapterText.c_str(), &adapterEnd, 10);
+
+        if (adapterText.empty() || *adapterEnd != 0 || adapterIndex < 0 || adapterIndex >= backend.getAdaptersNum())
+        {
+            throw Error(("Invalid adapter of fault '" + fault + "' of option '--inject'").c_str());
+        }
+
+        backend.injectFault(adapterIndex, kinds[kindIndex].fault,
+                            SubcommandOptions::ParseUnsigned(fault.substr(at + 1), "--inject") / 1000.0);
+    }
+}
+
+int ThermalWatchdog::Main(int argc, const char** argv)
+{
+    std::string adaptersText, interval = "20", duration, temperatureMargin = "5", temperatureLimit, stallRPM = "200",
+                stallDuty = "30", stallTime = "500", simulate, faults;
+    bool simulated = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (SubcommandOptions::Get(argv, argc, i, "--adapters", adaptersText) ||
+            SubcommandOptions::Get(argv, argc, i, "--interval", interval) ||
+            SubcommandOptions::Get(argv, argc, i, "--duration", duration) ||
+            SubcommandOptions::Get(argv, argc, i, "--temp-margin", temperatureMargin) ||
+            SubcommandOptions::Get(argv, argc, i, "--temp-limit", temperatureLimit) ||
+            SubcommandOptions::Get(argv, argc, i, "--stall-rpm", stallRPM) ||
+            SubcommandOptions::Get(argv, argc, i, "--stall-duty", stallDuty) ||
+            SubcommandOptions::Get(argv, argc, i, "--stall-time", stallTime) ||
+            SubcommandOptions::Get(argv, argc, i, "--inject", faults))
+        {
+            continue;
+        }
+
+        if (::strcmp(argv[i], "--simulate") == 0 || ::strncmp(argv[i], "--simulate=", 11) == 0)
+        {
+            simulated = true;
+            simulate = (argv[i][10] == '=') ? argv[i] + 11 : "1";
+            continue;
+        }
+
+        throw Error((std::string("Unknown option of watchdog '") + argv[i] + "'").c_str());
+    }
+
+    if (!faults.empty() && !simulated)
+    {
+        throw Error("Option '--inject' needs '--simulate'");
+    }
+
+    std::unique_ptr<WatchdogBackend> backend;
+
+    if (simulated)
+    {
+        SimulatedWatchdogBackend* simulatedBackend =
+            new SimulatedWatchdogBackend(SubcommandOptions::ParseUnsigned(simulate, "--simulate"));
+        backend.reset(simulatedBackend);
+        injectFaults(*simulatedBackend, faults);
+    }
+    else
+    {
+        backend.reset(new AMDGPUWatchdogBackend());
+    }
+
+    std::vector<int> adapters, removedAdapters;
+
+    // adapters appearing later are watched only without a list
+    SubcommandOptions::GetAdapters(adaptersText, backend->getAdaptersNum(), adapters);
+
+    const bool watchNew = adaptersText.empty() || adaptersText == "all";
+
+    const unsigned int intervalMs = SubcommandOptions::ParseUnsigned(interval, "--interval");
+    const unsigned int durationS = duration.empty() ? 0 : SubcommandOptions::ParseUnsigned(duration, "--duration");
+
+    ThermalWatchdog watchdog(*backend, SubcommandOptions::ParseUnsigned(temperatureMargin, "--temp-margin"),
+                             temperatureLimit.empty() ? 0.0 : SubcommandOptions::ParseUnsigned(temperatureLimit, "--temp-limit"),
+                             SubcommandOptions::ParseUnsigned(stallRPM, "--stall-rpm"),
+                             SubcommandOptions::ParseUnsigned(stallDuty, "--stall-duty"),
+                             SubcommandOptions::ParseUnsigned(stallTime, "--stall-time") / 1000.0);
+
+    ::signal(SIGINT, handleStopSignal);
+    ::signal(SIGTERM, handleStopSignal);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point next = start;
+    unsigned long samples = 0, overruns = 0;
+    double longestPass = 0.0;
+    std::vector<WatchdogEvent> events;
+
+    while (stopRequested == 0)
+    {
+        const double passStart = GetTime();
+
+        events.clear();
+
+        for (int adapterIndex: adapters)
+        {
+            if (std::find(removedAdapters.begin(), removedAdapters.end(), adapterIndex) == removedAdapters.end())
+            {
+                watchdog.Update(adapterIndex, events);
+            }
+        }
+
+        samples++;
+        longestPass = std::max(longestPass, GetTime() - passStart);
+
+        if (!events.empty())
+        {
+            OutputBuffer out;
+
+            for (const WatchdogEvent& event: events)
+            {
+                WriteEvent(out, event);
+            }
+        }
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (durationS != 0 && now - start >= std::chrono::seconds(durationS))
+        {
+            break;
+        }
+
+        // a late pass does not shorten the next intervals
+        next += std::chrono::milliseconds(intervalMs);
+
+        if (next < now)
+        {
+            overruns++;
+            next = now;
+        }
+
+        std::vector<DeviceEvent> deviceEvents;
+
+        backend->wait(std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count(), deviceEvents);
+        std::this_thread::sleep_until(next);
+
+        for (const DeviceEvent& deviceEvent: deviceEvents)
+        {
+            const bool watched = std::find(adapters.begin(), adapters.end(), deviceEvent.adapterId) != adapters.end();
+
+            if (!watched && watchNew && deviceEvent.type == DeviceEventType::ADDED)
+            {
+                adapters.push_back(deviceEvent.adapterId);
+            }
+            else if (!watched)
+            {
+                continue;
+            }
+
+            if (deviceEvent.type == DeviceEventType::REMOVED)
+            {
+                removedAdapters.push_back(deviceEvent.adapterId);
+            }
+            else
+            {
+                // hwmon of a reset adapter can have other limits
+                removedAdapters.erase(std::remove(removedAdapters.begin(), removedAdapters.end(), deviceEvent.adapterId),
+                                      removedAdapters.end());
+                watchdog.Refresh(deviceEvent.adapterId);
+            }
+
+            OutputBuffer out;
+            static const char* const descriptions[] = { " appeared\n", " was removed\n", " was reset\n" };
+
+            ThrottleDetector::WriteTime(out, std::chrono::duration<double>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            out << " adapter " << deviceEvent.adapterId << descriptions[int(deviceEvent.type)];
+        }
+    }
+
+    ::signal(SIGINT, SIG_DFL);
+    ::signal(SIGTERM, SIG_DFL);
+
+    OutputBuffer out;
+    const std::vector<double>& latencies = watchdog.GetLatencies();
+    bool alarmed = false;
+
+    out << "Samples: " << samples << ", longest pass " << longestPass * 1000.0 << " ms, overruns " << overruns << '\n';
+
+    if (!latencies.empty())
+    {
+        double sum = 0.0;
+
+        for (double latency: latencies)
+        {
+            sum += latency;
+        }
+
+        out << "Reaction latency: min " << *std::min_element(latencies.begin(), latencies.end()) * 1000.0 << " ms, mean " <<
+            sum / latencies.size() * 1000.0 << " ms, max " << *std::max_element(latencies.begin(), latencies.end()) * 1000.0 <<
+            " ms\n";
+    }
+
+    for (int adapterIndex: adapters)
+    {
+        out << "Adapter " << adapterIndex << ": " << watchdog.GetReverts(adapterIndex) << " emergency reverts, " <<
+            watchdog.GetFailedSamples(adapterIndex) << " failed samples\n";
+        alarmed |= watchdog.GetReverts(adapterIndex) != 0 || watchdog.GetFailedSamples(adapterIndex) != 0;
+    }
+
+    return alarmed ? 1 : 0;
+}
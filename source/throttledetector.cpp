@@ -0,0 +1,313 @@
+#include "throttledetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+
+#include "deviceregistry.h"
+#include "error.h"
+#include "subcommandoptions.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void handleStopSignal(int)
+{
+    stopRequested = 1;
+}
+
+ThrottleDetector::ThrottleDetector(double _temperatureMargin, double _powerMargin, int _loadThreshold) :
+    temperatureMargin(_temperatureMargin), powerMargin(_powerMargin), loadThreshold(_loadThreshold)
+{}
+
+ThrottleDetector::AdapterState& ThrottleDetector::getAdapter(int adapterIndex)
+{
+    for (AdapterState& adapter: adapters)
+    {
+        if (adapter.adapterIndex == adapterIndex)
+        {
+            return adapter;
+        }
+    }
+
+    adapters.push_back(AdapterState{ adapterIndex, DomainState{ false, 0, 0.0, 0.0 }, DomainState{ false, 0, 0.0, 0.0 }, -1.0 });
+
+    return adapters.back();
+}
+
+unsigned int ThrottleDetector::GetReasons(const ThrottleSample& sample) const
+{
+    unsigned int reasons = 0;
+
+    if (sample.criticalTemperature > 0.0 && sample.temperature >= sample.criticalTemperature - temperatureMargin)
+    {
+        reasons |= THROTTLE_THERMAL;
+    }
+
+    if (sample.power >= 0.0 && sample.powerCap > 0.0 && sample.power >= sample.powerCap * (1.0 - powerMargin))
+    {
+        reasons |= THROTTLE_POWER;
+    }
+
+    return (reasons != 0) ? reasons : THROTTLE_UNKNOWN;
+}
+
+void ThrottleDetector::updateDomain(DomainState& state, int adapterIndex, DPMDomain domain, unsigned int clock, unsigned int target,
+                                    const ThrottleSample& sample, double time, double interval, std::vector<ThrottleEvent>& events) const
+{
+    // idle adapter runs at lower states by design
+    const bool busy = sample.load < 0 || sample.load >= loadThreshold;
+    const bool throttled = busy && target != 0 && clock < target;
+    const unsigned int reasons = throttled ? GetReasons(sample) : 0;
+
+    if (state.throttled)
+    {
+        state.throttledTime += interval;
+    }
+
+    if (throttled == state.throttled && reasons == state.reasons)
+    {
+        return;
+    }
+
+    if (throttled && !state.throttled)
+    {
+        state.startTime = time;
+    }
+
+    events.push_back(ThrottleEvent{ time, adapterIndex, domain, throttled, throttled ? reasons : state.reasons, clock, target,
+                                    sample.temperature, sample.criticalTemperature, sample.power, sample.powerCap,
+                                    throttled ? 0.0 : time - state.startTime });
+
+    state.throttled = throttled;
+    state.reasons = reasons;
+}
+
+void ThrottleDetector::Update(int adapterIndex, const ThrottleSample& sample, double time, std::vector<ThrottleEvent>& events)
+{
+    AdapterState& adapter = getAdapter(adapterIndex);
+    const double interval = (adapter.lastTime >= 0.0) ? time - adapter.lastTime : 0.0;
+
+    updateDomain(adapter.core, adapterIndex, DPMDomain::CORE, sample.coreClock, sample.coreTarget, sample, time, interval, events);
+    updateDomain(adapter.memory, adapterIndex, DPMDomain::MEMORY, sample.memoryClock, sample.memoryTarget, sample, time,
+                 interval, events);
+
+    adapter.lastTime = time;
+}
+
+void ThrottleDetector::Skip(int adapterIndex)
+{
+    getAdapter(adapterIndex).lastTime = -1.0;
+}
+
+double ThrottleDetector::GetThrottledTime(int adapterIndex, DPMDomain domain)
+{
+    const AdapterState& adapter = getAdapter(adapterIndex);
+
+    return (domain == DPMDomain::CORE) ? adapter.core.throttledTime : adapter.memory.throttledTime;
+}
+
+/* Only 'auto' and 'high' performance levels allow the highest state. Masks of DPM states
+ * (manual level) can not be read back and other levels cap the clocks, so the target
+ * is not known and such adapters are not checked. */
+void ThrottleDetector::ReadSample(const AMDGPUAdapterHandle& handle, int adapterIndex, ThrottleSample& sample)
+{
+    static const std::vector<AMDGPUAttribute> attributes =
+        { AMDGPUAttribute::TEMP1_INPUT, AMDGPUAttribute::TEMP1_CRIT, AMDGPUAttribute::POWER1_CAP };
+
+    std::vector<double> values;
+    std::string perfLevel;
+    const int power = handle.getPower(adapterIndex);
+
+    handle.getDPMClock(adapterIndex, DPMDomain::CORE, sample.coreClock, sample.coreTarget);
+    handle.getDPMClock(adapterIndex, DPMDomain::MEMORY, sample.memoryClock, sample.memoryTarget);
+    handle.getAttributes(adapterIndex, attributes, values);
+
+    if (handle.getPerformanceLevel(adapterIndex, perfLevel) && perfLevel != "auto" && perfLevel != "high")
+    {
+        sample.coreTarget = 0;
+        sample.memoryTarget = 0;
+    }
+
+    sample.load = handle.getGPULoad(adapterIndex);
+    sample.temperature = values[0];
+    sample.criticalTemperature = values[1];
+    sample.power = (power >= 0) ? power / 1000000.0 : -1.0;
+    sample.powerCap = !std::isnan(values[2]) ? values[2] : -1.0;
+}
+
+void ThrottleDetector::WriteTime(OutputBuffer& out, double time)
+{
+    const time_t seconds = time_t(time);
+    struct tm localTime;
+    char timeText[32];
+
+    ::localtime_r(&seconds, &localTime);
+    ::strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S", &localTime);
+    ::snprintf(timeText + ::strlen(timeText), 8, ".%03d", int((time - seconds) * 1000.0) % 1000);
+
+    out << timeText;
+}
+
+void ThrottleDetector::WriteEvent(OutputBuffer& out, const ThrottleEvent& event)
+{
+    WriteTime(out, event.time);
+
+    out << " adapter " << event.adapterIndex << ((event.domain == DPMDomain::CORE) ? " core" : " memory");
+
+    if (!event.throttled)
+    {
+        out << ": throttling ended after " << event.duration << " s, " << event.clock << " of " << event.target << " MHz\n";
+        return;
+    }
+
+    out << ": throttled at " << event.clock << " of " << event.target << " MHz, reasons:";
+
+    if ((event.reasons & THROTTLE_THERMAL) != 0)
+    {
+        out << " thermal (" << event.temperature << " C, critical " << event.criticalTemperature << " C)";
+    }
+
+    if ((event.reasons & THROTTLE_POWER) != 0)
+    {
+        out << " power (" << event.power << " W, cap " << event.powerCap << " W)";
+    }
+
+    if ((event.reasons & THROTTLE_UNKNOWN) != 0)
+    {
+        out << " unknown";
+    }
+
+    out << '\n';
+}
+
+int ThrottleDetector::Main(int argc, const char** argv)
+{
+    std::string adaptersText, interval = "500", duration, loadThreshold = "90", temperatureMargin = "5", powerMargin = "5";
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (SubcommandOptions::Get(argv, argc, i, "--adapters", adaptersText) ||
+            SubcommandOptions::Get(argv, argc, i, "--interval", interval) ||
+            SubcommandOptions::Get(argv, argc, i, "--duration", duration) ||
+            SubcommandOptions::Get(argv, argc, i, "--load", loadThreshold) ||
+            SubcommandOptions::Get(argv, argc, i, "--temp-margin", temperatureMargin) ||
+            SubcommandOptions::Get(argv, argc, i, "--power-margin", powerMargin))
+        {
+            continue;
+        }
+
+        throw Error((std::string("Unknown option of throttle '") + argv[i] + "'").c_str());
+    }
+
+    AMDGPUAdapterHandle handle;
+    DeviceRegistry registry(handle);
+    std::vector<int> adapters;
+
+    // ids of registry, adapters appearing later are watched only without a list
+    SubcommandOptions::GetAdapters(adaptersText, handle.getAdaptersNum(), adapters);
+
+    const bool watchNew = adaptersText.empty() || adaptersText == "all";
+
+    const unsigned int intervalMs = SubcommandOptions::ParseUnsigned(interval, "--interval");
+    const unsigned int durationS = duration.empty() ? 0 : SubcommandOptions::ParseUnsigned(duration, "--duration");
+
+    ThrottleDetector detector(SubcommandOptions::ParseUnsigned(temperatureMargin, "--temp-margin"),
+                              SubcommandOptions::ParseUnsigned(powerMargin, "--power-margin") / 100.0,
+                              SubcommandOptions::ParseUnsigned(loadThreshold, "--load"));
+
+    ::signal(SIGINT, handleStopSignal);
+    ::signal(SIGTERM, handleStopSignal);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    while (stopRequested == 0)
+    {
+        std::vector<ThrottleEvent> events;
+
+        for (int adapterId: adapters)
+        {
+            const int handleIndex = registry.GetHandleIndex(adapterId);
+            ThrottleSample sample;
+
+            // state of a removed adapter is kept until it appears again
+            if (handleIndex < 0)
+            {
+                detector.Skip(adapterId);
+                continue;
+            }
+
+            try
+            {
+                ReadSample(handle, handleIndex, sample);
+            }
+            catch(const std::exception& error)
+            {
+                detector.Skip(adapterId);
+                continue;   // adapter is being removed, its uevent comes next
+            }
+
+            const double time = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+            detector.Update(adapterId, sample, time, events);
+        }
+
+        if (!events.empty())
+        {
+            OutputBuffer out;
+
+            for (const ThrottleEvent& event: events)
+            {
+                WriteEvent(out, event);
+            }
+        }
+
+        if (durationS != 0 && std::chrono::steady_clock::now() - start >= std::chrono::seconds(durationS))
+        {
+            break;
+        }
+
+        std::vector<DeviceEvent> deviceEvents;
+        registry.Poll(intervalMs, deviceEvents);
+
+        for (const DeviceEvent& deviceEvent: deviceEvents)
+        {
+            const bool watched = std::find(adapters.begin(), adapters.end(), deviceEvent.adapterId) != adapters.end();
+
+            if (!watched && watchNew && deviceEvent.type == DeviceEventType::ADDED)
+            {
+                adapters.push_back(deviceEvent.adapterId);
+            }
+            else if (!watched)
+            {
+                continue;
+            }
+
+            detector.Skip(deviceEvent.adapterId);
+
+            OutputBuffer out;
+            static const char* const descriptions[] = { " appeared\n", " was removed\n", " was reset\n" };
+
+            WriteTime(out, std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count());
+            out << " adapter " << deviceEvent.adapterId << descriptions[int(deviceEvent.type)];
+        }
+    }
+
+    ::signal(SIGINT, SIG_DFL);
+    ::signal(SIGTERM, SIG_DFL);
+
+    OutputBuffer out;
+    bool throttled = false;
+
+    for (int adapterIndex: adapters)
+    {
+        const double coreTime = detector.GetThrottledTime(adapterIndex, DPMDomain::CORE);
+        const double memoryTime = detector.GetThrottledTime(adapterIndex, DPMDomain::MEMORY);
+
+        out << "Adapter " << adapterIndex << ": core throttled " << coreTime << " s, memory throttled " << memoryTime << " s\n";
+        throttled |= coreTime > 0.0 || memoryTime > 0.0;
+    }
+
+    return throttled ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+#include "timingtrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <unistd.h>
+
+#include "error.h"
+
+bool TimingTrace::enabled = false;
+
+std::string TimingTrace::outputFile;
+
+std::vector<TimingTrace::Event> TimingTrace::events;
+
+std::mutex TimingTrace::eventsMutex;
+
+std::chrono::steady_clock::time_point TimingTrace::origin;
+
+void TimingTrace::Enable(const char* OutputFile)
+{
+    outputFile = (OutputFile != nullptr) ? OutputFile : "";
+    origin = std::chrono::steady_clock::now();
+    events.reserve(1024);
+    enabled = true;
+}
+
+unsigned int TimingTrace::getThreadId()
+{
+    static std::atomic<unsigned int> nextThreadId(1);
+    static thread_local unsigned int threadId = nextThreadId++;
+
+    return threadId;
+}
+
+void TimingTrace::record(const char* category, std::string& name, std::chrono::steady_clock::time_point start,
+                         std::chrono::steady_clock::time_point end)
+{
+    Event event;
+    event.category = category;
+    event.name.swap(name);
+    event.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count();
+    event.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    event.threadId = getThreadId();
+
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    events.push_back(std::move(event));
+}
+
+static void writeJsonString(std::ostream& os, const std::string& str)
+{
+    os << '"';
+
+    for (char c: str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            os << '\\' << c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+        }
+        else
+        {
+            os << c;
+        }
+    }
+
+    os << '"';
+}
+
+void TimingTrace::writeChromeTrace()
+{
+    std::ofstream ofs(outputFile.c_str(), std::ios::binary);
+
+    if (!ofs)
+    {
+        throw Error((std::string("Unable to open trace file '") + outputFile + "'").c_str());
+    }
+
+    const int pid = getpid();
+
+    // timestamps in the Chrome trace-event format are in microseconds
+    ofs << std::fixed << std::setprecision(3);
+    ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const Event& event = events[i];
+
+        ofs << (i != 0 ? ",\n" : "\n") << "{\"name\":";
+        writeJsonString(ofs, event.name);
+        ofs << ",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"ts\":" << event.start / 1000.0 <<
+            ",\"dur\":" << event.duration / 1000.0 << ",\"pid\":" << pid << ",\"tid\":" << event.threadId << "}";
+    }
+
+    ofs << "\n]}\n";
+
+    if (!ofs)
+    {
+        throw Error((std::string("Unable to write trace file '") + outputFile + "'").c_str());
+    }
+}
+
+void TimingTrace::printSummary()
+{
+    struct Summary
+    {
+        const char* category;
+        size_t count;
+        int64_t total;
+        int64_t min;
+        int64_t max;
+    };
+
+    std::map<std::string, Summary> summaries;
+
+    for (const Event& event: events)
+    {
+        auto it = summaries.find(event.name);
+
+        if (it == summaries.end())
+        {
+            summaries.insert(std::make_pair(event.name, Summary{ event.category, 1, event.duration, event.duration, event.duration }));
+            continue;
+        }
+
+        Summary& summary = it->second;
+        summary.count++;
+        summary.total += event.duration;
+        summary.min = std::min(summary.min, event.duration);
+        summary.max = std::max(summary.max, event.duration);
+    }
+
+    std::vector<std::pair<std::string, Summary> > sorted(summaries.begin(), summaries.end());
+
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, Summary>& a, const std::pair<std::string, Summary>& b)
+    {
+        return a.second.total > b.second.total;
+    });
+
+    std::cerr << "Timing summary (times in ms):\n" << std::left <<
+        std::setw(10) << "Category" << std::setw(60) << "Span" << std::right <<
+        std::setw(8) << "Count" << std::setw(12) << "Total" << std::setw(11) << "Avg" <<
+        std::setw(11) << "Min" << std::setw(11) << "Max" << "\n";
+
+    std::cerr << std::fixed << std::setprecision(3);
+
+    for (const std::pair<std::string, Summary>& entry: sorted)
+    {
+        const Summary& summary = entry.second;
+
+        std::cerr << std::left << std::setw(10) << summary.category << std::setw(60) << entry.first << std::right <<
+            std::setw(8) << summary.count << std::setw(12) << summary.total / 1e6 <<
+            std::setw(11) << summary.total / 1e6 / summary.count << std::setw(11) << summary.min / 1e6 <<
+            std::setw(11) << summary.max / 1e6 << "\n";
+    }
+
+    std::cerr.flush();
+}
+
+void TimingTrace::Finish()
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    enabled = false;
+
+    std::lock_guard<std::mutex> lock(eventsMutex);
+
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b)
+    {
+        return a.start < b.start;
+    });
+
+    if (!outputFile.empty())
+    {
+        writeChromeTrace();
+    }
+
+    printSummary();
+}
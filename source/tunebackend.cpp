@@ -0,0 +1,219 @@
+#include "tunebackend.h"
+
+#include <algorithm>
+#include <string>
+
+#include "amdgpuproprocessing.h"
+
+int AMDGPUTuneBackend::getAdaptersNum() const
+{
+    return handle.getAdaptersNum();
+}
+
+void AMDGPUTuneBackend::getIdentity(int adapterIndex, AdapterIdentity& identity) const
+{
+    handle.getIdentity(adapterIndex, identity);
+}
+
+void AMDGPUTuneBackend::getRanges(int adapterIndex, TuneRanges& ranges)
+{
+    const AMDGPUAdapterInfo adapterInfo = handle.parseAdapterInfo(adapterIndex);
+    const AMDGPUODTable& table = adapterInfo.odTable;
+
+    ranges = TuneRanges();
+
+    if (table.isAvailable())
+    {
+        // highest DPM states, set by coreclk/memclk/vcore with the last level
+        if (!table.coreLevels.empty())
+        {
+            ranges.current.coreClock = table.coreLevels.back().clock;
+            ranges.coreClockMin = table.coreClockRange.min;
+            ranges.coreClockMax = table.coreClockRange.max;
+        }
+
+        if (!table.memoryLevels.empty())
+        {
+            ranges.current.memoryClock = table.memoryLevels.back().clock;
+            ranges.memoryClockMin = table.memoryClockRange.min;
+            ranges.memoryClockMax = table.memoryClockRange.max;
+        }
+
+        const std::vector<AMDGPUODLevel>& voltageLevels = table.getVoltageLevels();
+
+        if (!voltageLevels.empty() && voltageLevels.back().voltage != 0 && table.voltageRange.isSet)
+        {
+            ranges.current.voltage = voltageLevels.back().voltage / 1000.0;
+            ranges.voltageMin = table.voltageRange.min / 1000.0;
+            ranges.voltageMax = table.voltageRange.max / 1000.0;
+        }
+    }
+    else
+    {
+        // clocks are set by Overdrive percent (0-20%) of the default clocks
+        unsigned int coreClock, memoryClock;
+        handle.getPerformanceClocks(adapterIndex, coreClock, memoryClock);
+
+        ranges.current.coreClock = adapterInfo.coreClocks.empty() ? 0 : adapterInfo.coreClocks.back();
+        ranges.coreClockMin = coreClock;
+        ranges.coreClockMax = coreClock * 1.2;
+        ranges.current.memoryClock = adapterInfo.memoryClocks.empty() ? 0 : adapterInfo.memoryClocks.back();
+        ranges.memoryClockMin = memoryClock;
+        ranges.memoryClockMax = memoryClock * 1.2;
+    }
+
+    if (adapterInfo.powerCapAvailable)
+    {
+        ranges.current.powerCap = adapterInfo.powerCap / 1000000.0;
+        ranges.powerCapMin = adapterInfo.powerCapMin / 1000000.0;
+        ranges.powerCapMax = adapterInfo.powerCapMax / 1000000.0;
+    }
+}
+
+static void addParameter(std::vector<OVCParameter>& params, OVCParamType type, const char* name, int adapterIndex, double value)
+{
+    if (value <= 0.0)
+    {
+        return;
+    }
+
+    OVCParameter param;
+    param.type = type;
+    param.adapters.assign(1, adapterIndex);
+    param.allAdapters = false;
+    param.partId = (type == OVCParamType::POWER_CAP) ? 0 : LAST_PERFLEVEL;
+    param.value = value;
+    param.useDefault = false;
+    param.argText = std::string("tune: ") + name + ":" + std::to_string(adapterIndex) + "=" + std::to_string(value);
+
+    params.push_back(param);
+}
+
+void AMDGPUTuneBackend::apply(int adapterIndex, const TunePoint& point)
+{
+    std::vector<OVCParameter> params;
+
+    addParameter(params, OVCParamType::CORE_CLOCK, "coreclk", adapterIndex, point.coreClock);
+    addParameter(params, OVCParamType::MEMORY_CLOCK, "memclk", adapterIndex, point.memoryClock);
+    addParameter(params, OVCParamType::VDDC_VOLTAGE, "vcore", adapterIndex, point.voltage);
+    addParameter(params, OVCParamType::POWER_CAP, "powercap", adapterIndex, point.powerCap);
+
+    AmdGpuProProcessing::SetOvcParameters(handle, params, false, std::cerr);
+}
+
+void AMDGPUTuneBackend::sample(int adapterIndex, double& power, double& temperature)
+{
+    const int microWatts = handle.getPower(adapterIndex);
+
+    power = (microWatts >= 0) ? microWatts / 1000000.0 : -1.0;
+    temperature = handle.getTemperature(adapterIndex) / 1000.0;
+}
+
+/* model constants */
+static const double simCoreClockMin = 300.0;
+static const double simCoreClockMax = 1500.0;
+static const double simStaticPower = 25.0;      // W
+static const double simCorePower = 0.065;       // W per MHz and V^2
+static const double simMemoryPower = 0.012;     // W per MHz
+
+SimulatedTuneBackend::SimulatedTuneBackend(int adaptersNum)
+{
+    for (int i = 0; i < adaptersNum; i++)
+    {
+        // adapters need slightly different voltages
+        adapters.push_back(Adapter{ TunePoint{ 1100.0, 2000.0, 1.15, 150.0 }, 0.01 * ((i * 7) % 5) - 0.02 });
+    }
+}
+
+int SimulatedTuneBackend::getAdaptersNum() const
+{
+    return adapters.size();
+}
+
+void SimulatedTuneBackend::getIdentity(int adapterIndex, AdapterIdentity& identity) const
+{
+    identity.index = adapterIndex;
+    identity.domain = 0;
+    identity.busNo = adapterIndex + 1;
+    identity.deviceNo = 0;
+    identity.funcNo = 0;
+    identity.deviceId = 0x67df;
+}
+
+void SimulatedTuneBackend::getRanges(int adapterIndex, TuneRanges& ranges)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ranges.current = adapters[adapterIndex].point;
+    ranges.coreClockMin = simCoreClockMin;
+    ranges.coreClockMax = simCoreClockMax;
+    ranges.memoryClockMin = 300.0;
+    ranges.memoryClockMax = 2250.0;
+    ranges.voltageMin = 0.75;
+    ranges.voltageMax = 1.2;
+    ranges.powerCapMin = 50.0;
+    ranges.powerCapMax = 180.0;
+}
+
+void SimulatedTuneBackend::apply(int adapterIndex, const TunePoint& point)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    TunePoint& current = adapters[adapterIndex].point;
+
+    current.coreClock = (point.coreClock > 0.0) ? point.coreClock : current.coreClock;
+    current.memoryClock = (point.memoryClock > 0.0) ? point.memoryClock : current.memoryClock;
+    current.voltage = (point.voltage > 0.0) ? point.voltage : current.voltage;
+    current.powerCap = (point.powerCap > 0.0) ? point.powerCap : current.powerCap;
+}
+
+double SimulatedTuneBackend::getPower(const Adapter& adapter, double coreClock) const
+{
+    const TunePoint& point = adapter.point;
+
+    return simStaticPower + simCorePower * coreClock * point.voltage * point.voltage + simMemoryPower * point.memoryClock;
+}
+
+/* core clock lowered to keep the power under the cap */
+double SimulatedTuneBackend::getEffectiveCoreClock(const Adapter& adapter) const
+{
+    const TunePoint& point = adapter.point;
+
+    if (getPower(adapter, point.coreClock) <= point.powerCap)
+    {
+        return point.coreClock;
+    }
+
+    const double available = point.powerCap - simStaticPower - simMemoryPower * point.memoryClock;
+
+    return std::max(simCoreClockMin, available / (simCorePower * point.voltage * point.voltage));
+}
+
+void SimulatedTuneBackend::sample(int adapterIndex, double& power, double& temperature)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const Adapter& adapter = adapters[adapterIndex];
+
+    power = getPower(adapter, getEffectiveCoreClock(adapter));
+    temperature = 30.0 + power * 0.3;
+}
+
+bool SimulatedTuneBackend::getThroughput(int adapterIndex, double& throughput) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const Adapter& adapter = adapters[adapterIndex];
+    const double coreClock = getEffectiveCoreClock(adapter);
+    const double requiredVoltage = 0.75 + (coreClock - simCoreClockMin) / (simCoreClockMax - simCoreClockMin) * 0.4 + adapter.voltageOffset;
+
+    if (adapter.point.voltage < requiredVoltage)
+    {
+        return false;
+    }
+
+    // 70% of the work is bound by the core clock, 30% by the memory clock
+    throughput = 1000.0 / (0.7 * 1000.0 / coreClock + 0.3 * 1000.0 / (adapter.point.memoryClock * 0.5));
+
+    return true;
+}
@@ -0,0 +1,518 @@
+#include "tuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "error.h"
+#include "subcommandoptions.h"
+
+/* state shared with signal handlers */
+static Benchmark* activeBenchmark = nullptr;
+static volatile sig_atomic_t stopSignal = 0;
+
+/* the benchmark is killed, the settings are restored by Tune in the main flow */
+static void handleStopSignal(int signal)
+{
+    stopSignal = signal;
+
+    if (activeBenchmark != nullptr)
+    {
+        activeBenchmark->interrupt();
+    }
+}
+
+static void setSignalHandlers(bool install)
+{
+    static const int stopSignals[] = { SIGINT, SIGTERM, SIGHUP, SIGQUIT };
+
+    struct sigaction action;
+    ::memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = install ? handleStopSignal : SIG_DFL;
+
+    for (int signal: stopSignals)
+    {
+        ::sigaction(signal, &action, nullptr);
+    }
+}
+
+Tuner::Tuner(TuneBackend& _backend, Benchmark& _benchmark, unsigned int _steps, unsigned int _sampleInterval, bool _verbose) :
+    backend(_backend), benchmark(_benchmark), steps(_steps), sampleInterval(_sampleInterval), verbose(_verbose)
+{}
+
+/* steps values from current*low to current*high clamped to the range, rounded to unit;
+ * only 0 (not set) if current value is unknown */
+void Tuner::getValues(double current, double low, double high, double rangeMin, double rangeMax,
+                      unsigned int steps, double unit, std::vector<double>& values)
+{
+    values.clear();
+
+    if (current <= 0.0)
+    {
+        values.push_back(0.0);
+        return;
+    }
+
+    double first = current * low;
+    double last = current * high;
+
+    if (rangeMax > 0.0)
+    {
+        first = std::max(first, rangeMin);
+        last = std::min(last, rangeMax);
+    }
+
+    if (steps <= 1 || last <= first)
+    {
+        values.push_back(std::round(std::min(std::max(current, first), last) / unit) * unit);
+        return;
+    }
+
+    for (unsigned int i = 0; i < steps; i++)
+    {
+        const double value = std::round((first + (last - first) * i / (steps - 1)) / unit) * unit;
+
+        if (values.empty() || value != values.back())
+        {
+            values.push_back(value);
+        }
+    }
+}
+
+void Tuner::GetGrid(const TuneRanges& ranges, unsigned int steps, std::vector<TunePoint>& points)
+{
+    std::vector<double> coreClocks, memoryClocks, voltages, powerCaps;
+
+    getValues(ranges.current.coreClock, 0.8, 1.1, ranges.coreClockMin, ranges.coreClockMax, steps, 1.0, coreClocks);
+    getValues(ranges.current.memoryClock, 0.8, 1.1, ranges.memoryClockMin, ranges.memoryClockMax, steps, 1.0, memoryClocks);
+
+    // undervolting saves more power than the power cap, use the cap only if voltages are not settable
+    if (ranges.current.voltage > 0.0)
+    {
+        getValues(ranges.current.voltage, 0.9, 1.0, ranges.voltageMin, ranges.voltageMax, steps, 0.001, voltages);
+        powerCaps.assign(1, 0.0);
+    }
+    else
+    {
+        voltages.assign(1, 0.0);
+        getValues(ranges.current.powerCap, 0.6, 1.0, ranges.powerCapMin, ranges.powerCapMax, steps, 1.0, powerCaps);
+    }
+
+    points.clear();
+
+    for (double coreClock: coreClocks)
+    {
+        for (double memoryClock: memoryClocks)
+        {
+            for (double voltage: voltages)
+            {
+                for (double powerCap: powerCaps)
+                {
+                    points.push_back(TunePoint{ coreClock, memoryClock, voltage, powerCap });
+                }
+            }
+        }
+    }
+}
+
+void Tuner::measure(int adapterIndex, const TunePoint& point, TuneResult& result)
+{
+    result.point = point;
+    result.metric = 0.0;
+    result.power = -1.0;
+    result.temperature = 0.0;
+    result.stable = false;
+
+    backend.apply(adapterIndex, point);
+
+    std::mutex mutex;
+    std::condition_variable finishedCond;
+    bool finished = false;
+    double powerSum = 0.0;
+    unsigned int powerSamples = 0;
+
+    // samples at least once, also if benchmark ends before the first interval
+    std::thread sampler([&]()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        do
+        {
+            double power, temperature;
+            backend.sample(adapterIndex, power, temperature);
+
+            if (power >= 0.0)
+            {
+                powerSum += power;
+                powerSamples++;
+            }
+
+            result.temperature = std::max(result.temperature, temperature);
+        }
+        while (!finishedCond.wait_for(lock, std::chrono::milliseconds(sampleInterval), [&]() { return finished; }));
+    });
+
+    bool stable = false;
+    double metric = 0.0;
+
+    try
+    {
+        stable = benchmark.run(adapterIndex, metric);
+    }
+    catch(...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        finishedCond.notify_one();
+        sampler.join();
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    finishedCond.notify_one();
+    sampler.join();
+
+    result.stable = stable;
+    result.metric = stable ? metric : 0.0;
+    result.power = (powerSamples != 0) ? powerSum / powerSamples : -1.0;
+}
+
+void Tuner::GetParetoFront(const std::vector<TuneResult>& results, std::vector<TuneResult>& front)
+{
+    std::vector<TuneResult> sorted;
+
+    for (const TuneResult& result: results)
+    {
+        if (result.stable)
+        {
+            sorted.push_back(result);
+        }
+    }
+
+    // unknown power is treated as the same for all results, then the front is the highest metric
+    std::sort(sorted.begin(), sorted.end(), [](const TuneResult& r1, const TuneResult& r2)
+    {
+        const double power1 = std::max(r1.power, 0.0);
+        const double power2 = std::max(r2.power, 0.0);
+        return (power1 != power2) ? power1 < power2 : r1.metric > r2.metric;
+    });
+
+    front.clear();
+
+    for (const TuneResult& result: sorted)
+    {
+        // the first result of every power has the highest metric, later ones never pass
+        if (front.empty() || result.metric > front.back().metric)
+        {
+            front.push_back(result);
+        }
+    }
+}
+
+const TuneResult& Tuner::GetBest(const std::vector<TuneResult>& front)
+{
+    const TuneResult* best = &front.front();
+
+    for (const TuneResult& result: front)
+    {
+        if (result.power > 0.0 && best->power > 0.0)
+        {
+            if (result.metric / result.power > best->metric / best->power)
+            {
+                best = &result;
+            }
+        }
+        else if (result.metric > best->metric)
+        {
+            best = &result;
+        }
+    }
+
+    return *best;
+}
+
+void Tuner::writeResult(OutputBuffer& out, const TuneResult& result)
+{
+    const TunePoint& point = result.point;
+
+    out << "core " << point.coreClock << " MHz, memory " << point.memoryClock << " MHz";
+
+    if (point.voltage > 0.0)
+    {
+        out << ", vcore " << point.voltage << " V";
+    }
+
+    if (point.powerCap > 0.0)
+    {
+        out << ", power cap " << point.powerCap << " W";
+    }
+
+    if (!result.stable)
+    {
+        out << ": failed\n";
+        return;
+    }
+
+    out << ": metric " << result.metric;
+
+    if (result.power >= 0.0)
+    {
+        out << ", power " << result.power << " W, " << result.metric / result.power << " per W";
+    }
+
+    out << ", temperature " << result.temperature << " C\n";
+}
+
+bool Tuner::Tune(int adapterIndex, std::vector<TuneResult>& front)
+{
+    TuneRanges ranges;
+    backend.getRanges(adapterIndex, ranges);
+
+    std::vector<TunePoint> points;
+    GetGrid(ranges, steps, points);
+
+    std::vector<TuneResult> results(points.size());
+
+    try
+    {
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            measure(adapterIndex, points[i], results[i]);
+
+            if (stopSignal != 0)
+            {
+                throw Error("Tuning interrupted");
+            }
+
+            if (verbose)
+            {
+                OutputBuffer out;
+                out << "  [" << (unsigned long)(i + 1) << "/" << (unsigned long)points.size() << "] ";
+                writeResult(out, results[i]);
+            }
+        }
+    }
+    catch(...)
+    {
+        // keep the original error
+        try
+        {
+            backend.apply(adapterIndex, ranges.current);
+        }
+        catch(const std::exception& ex)
+        {
+            std::cerr << "Unable to restore settings of adapter " << adapterIndex << ": " << ex.what() << std::endl;
+        }
+
+        throw;
+    }
+
+    backend.apply(adapterIndex, ranges.current);
+
+    GetParetoFront(results, front);
+
+    return !front.empty();
+}
+
+static void appendProfileValue(std::string& profile, const char* name, double value)
+{
+    if (value > 0.0)
+    {
+        profile += name;
+        profile += " = ";
+        OutputBuffer::AppendDouble(profile, value);
+        profile += '\n';
+    }
+}
+
+static void appendProfileSection(std::string& profile, const AdapterIdentity& identity, const TuneResult& best)
+{
+    char buffer[64];
+
+    profile += "# adapter " + std::to_string(identity.index) + ": metric ";
+    OutputBuffer::AppendDouble(profile, best.metric);
+
+    if (best.power >= 0.0)
+    {
+        profile += ", power ";
+        OutputBuffer::AppendDouble(profile, best.power);
+        profile += " W";
+    }
+
+    profile += ", temperature ";
+    OutputBuffer::AppendDouble(profile, best.temperature);
+
+    ::snprintf(buffer, sizeof(buffer), " C\n[pci %04x:%02x:%02x.%x]\n", identity.domain, identity.busNo, identity.deviceNo,
+               identity.funcNo);
+    profile += buffer;
+
+    appendProfileValue(profile, "coreclk", best.point.coreClock);
+    appendProfileValue(profile, "memclk", best.point.memoryClock);
+    appendProfileValue(profile, "vcore", best.point.voltage);
+    appendProfileValue(profile, "powercap", best.point.powerCap);
+    profile += '\n';
+}
+
+int Tuner::Main(int argc, const char** argv)
+{
+    std::string command, metricPattern, adaptersText, steps = "4", saveFile, simulate, sampleInterval = "100", timeout = "600";
+    bool simulated = false;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (SubcommandOptions::Get(argv, argc, i, "--run", command) ||
+            SubcommandOptions::Get(argv, argc, i, "--metric", metricPattern) ||
+            SubcommandOptions::Get(argv, argc, i, "--adapters", adaptersText) ||
+            SubcommandOptions::Get(argv, argc, i, "--steps", steps) ||
+            SubcommandOptions::Get(argv, argc, i, "--save", saveFile) ||
+            SubcommandOptions::Get(argv, argc, i, "--sample-interval", sampleInterval) ||
+            SubcommandOptions::Get(argv, argc, i, "--timeout", timeout))
+        {
+            continue;
+        }
+
+        if (::strcmp(argv[i], "--simulate") == 0 || ::strncmp(argv[i], "--simulate=", 11) == 0)
+        {
+            simulated = true;
+            simulate = (argv[i][10] == '=') ? argv[i] + 11 : "1";
+            continue;
+        }
+
+        if (::strcmp(argv[i], "-v") == 0 || ::strcmp(argv[i], "--verbose") == 0)
+        {
+            verbose = true;
+            continue;
+        }
+
+        throw Error((std::string("Unknown option of tune '") + argv[i] + "'").c_str());
+    }
+
+    if (!simulated && (command.empty() || metricPattern.empty()))
+    {
+        throw Error("Options '--run' and '--metric' are required by tune");
+    }
+
+    std::unique_ptr<TuneBackend> backend;
+    std::unique_ptr<Benchmark> benchmark;
+
+    if (simulated)
+    {
+        SimulatedTuneBackend* simulatedBackend = new SimulatedTuneBackend(SubcommandOptions::ParseUnsigned(simulate, "--simulate"));
+        backend.reset(simulatedBackend);
+        benchmark.reset(new SimulatedBenchmark(*simulatedBackend));
+    }
+    else
+    {
+        backend.reset(new AMDGPUTuneBackend());
+        benchmark.reset(new CommandBenchmark(command, metricPattern, SubcommandOptions::ParseUnsigned(timeout, "--timeout")));
+    }
+
+    std::vector<int> adapters;
+    SubcommandOptions::GetAdapters(adaptersText, backend->getAdaptersNum(), adapters);
+
+    Tuner tuner(*backend, *benchmark, SubcommandOptions::ParseUnsigned(steps, "--steps"),
+                SubcommandOptions::ParseUnsigned(sampleInterval, "--sample-interval"), verbose);
+    std::string profile = "# generated by amdcovc tune";
+
+    profile += simulated ? " (simulation)\n\n" : ": " + command + "\n\n";
+
+    bool failed = false;
+
+    activeBenchmark = benchmark.get();
+    setSignalHandlers(true);
+
+    for (int adapterIndex: adapters)
+    {
+        AdapterIdentity identity;
+        backend->getIdentity(adapterIndex, identity);
+
+        {
+            OutputBuffer out;
+            out << "Tuning adapter " << adapterIndex << '\n';
+        }
+
+        std::vector<TuneResult> front;
+        bool stable;
+
+        try
+        {
+            stable = tuner.Tune(adapterIndex, front);
+        }
+        catch(...)
+        {
+            setSignalHandlers(false);
+            activeBenchmark = nullptr;
+
+            if (stopSignal != 0)
+            {
+                std::cerr << "Tuning interrupted by signal " << int(stopSignal) << ", settings of adapter " << adapterIndex <<
+                    " restored" << std::endl;
+                return 128 + stopSignal;
+            }
+
+            throw;
+        }
+
+        if (!stable)
+        {
+            std::cerr << "No stable settings found for adapter " << adapterIndex << "!" << std::endl;
+            failed = true;
+            continue;
+        }
+
+        const TuneResult& best = GetBest(front);
+        OutputBuffer out;
+
+        out << "Pareto front of adapter " << adapterIndex << ":\n";
+
+        for (const TuneResult& result: front)
+        {
+            out << ((&result == &best) ? "* " : "  ");
+            writeResult(out, result);
+        }
+
+        appendProfileSection(profile, identity, best);
+    }
+
+    setSignalHandlers(false);
+    activeBenchmark = nullptr;
+
+    if (saveFile.empty())
+    {
+        OutputBuffer out;
+        out << '\n' << profile;
+    }
+    else
+    {
+        std::ofstream ofs(saveFile, std::ios::binary);
+        ofs << profile;
+        ofs.close();
+
+        if (!ofs)
+        {
+            throw Error((std::string("Unable to write profile '") + saveFile + "'").c_str());
+        }
+
+        OutputBuffer out;
+        out << "Profile saved to " << saveFile << '\n';
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,321 @@
+#include "watchdogbackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "error.h"
+
+static const AMDGPUAttribute criticalAttributes[WatchdogTemperaturesNum] =
+    { AMDGPUAttribute::TEMP1_CRIT, AMDGPUAttribute::TEMP2_CRIT, AMDGPUAttribute::TEMP3_CRIT };
+
+void WatchdogBackend::wait(unsigned int timeout, std::vector<DeviceEvent>& events)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+}
+
+AMDGPUWatchdogBackend::AMDGPUWatchdogBackend() : registry(handle)
+{
+    for (unsigned int i = 0; i < registry.GetAdaptersNum(); i++)
+    {
+        probe(i);
+    }
+}
+
+int AMDGPUWatchdogBackend::getHandleIndex(int adapterId) const
+{
+    const int handleIndex = registry.GetHandleIndex(adapterId);
+
+    if (handleIndex < 0)
+    {
+        throw Error("Adapter is not present");
+    }
+
+    return handleIndex;
+}
+
+/* attributes can change after reset of adapter */
+void AMDGPUWatchdogBackend::probe(int adapterId)
+{
+    const int handleIndex = registry.GetHandleIndex(adapterId);
+    Adapter adapter{ false, false, false, false, NAN, NAN };
+
+    if (adapters.size() <= size_t(adapterId))
+    {
+        adapters.resize(adapterId + 1, adapter);
+    }
+
+    if (handleIndex < 0)
+    {
+        return;
+    }
+
+    AMDGPUODTable table;
+
+    adapter.coreOD = !std::isnan(handle.getAttribute(handleIndex, AMDGPUAttribute::PP_SCLK_OD));
+    adapter.memoryOD = !std::isnan(handle.getAttribute(handleIndex, AMDGPUAttribute::PP_MCLK_OD));
+
+    try
+    {
+        adapter.odTable = handle.getODClockVoltage(handleIndex, table);
+    }
+    catch(const Error& error)
+    {
+        adapter.odTable = false;
+    }
+
+    adapter.fan = !std::isnan(handle.getAttribute(handleIndex, AMDGPUAttribute::PWM1));
+    adapter.minPWM = handle.getAttribute(handleIndex, AMDGPUAttribute::PWM1_MIN);
+    adapter.maxPWM = handle.getAttribute(handleIndex, AMDGPUAttribute::PWM1_MAX);
+
+    adapters[adapterId] = adapter;
+}
+
+int AMDGPUWatchdogBackend::getAdaptersNum() const
+{
+    return registry.GetAdaptersNum();
+}
+
+void AMDGPUWatchdogBackend::getCriticalTemperatures(int adapterIndex, double* temperatures) const
+{
+    const int handleIndex = registry.GetHandleIndex(adapterIndex);
+
+    for (int i = 0; i < WatchdogTemperaturesNum; i++)
+    {
+        temperatures[i] = (handleIndex >= 0) ? handle.getAttribute(handleIndex, criticalAttributes[i]) : NAN;
+    }
+}
+
+void AMDGPUWatchdogBackend::sample(int adapterIndex, WatchdogSample& sample)
+{
+    // only these are read at every sample, the limits are read once
+    static const std::vector<AMDGPUAttribute> attributes =
+        { AMDGPUAttribute::TEMP1_INPUT, AMDGPUAttribute::TEMP2_INPUT, AMDGPUAttribute::TEMP3_INPUT,
+          AMDGPUAttribute::FAN1_INPUT, AMDGPUAttribute::PWM1 };
+
+    const Adapter& adapter = adapters[adapterIndex];
+
+    handle.getAttributes(getHandleIndex(adapterIndex), attributes, values);
+
+    // missing temp1_input means that hwmon is gone, NaN would never trip
+    if (std::isnan(values[0]))
+    {
+        throw Error("Unable to read temperature");
+    }
+
+    std::copy(values.begin(), values.begin() + WatchdogTemperaturesNum, sample.temperatures);
+    sample.fanRPM = values[3];
+    sample.fanDuty = (adapter.maxPWM > adapter.minPWM) ?
+        (values[4] - adapter.minPWM) * 100.0 / (adapter.maxPWM - adapter.minPWM) : NAN;
+}
+
+/* every step is tried, even if an earlier one failed */
+void AMDGPUWatchdogBackend::revert(int adapterId)
+{
+    const Adapter& adapter = adapters[adapterId];
+    const int adapterIndex = getHandleIndex(adapterId);
+    std::string failed;
+
+    if (adapter.coreOD)
+    {
+        try
+        {
+            handle.setOverdriveCoreParam(adapterIndex, 0);
+        }
+        catch(const std::exception& error)
+        {
+            failed += " coreod";
+        }
+    }
+
+    if (adapter.memoryOD)
+    {
+        try
+        {
+            handle.setOverdriveMemoryParam(adapterIndex, 0);
+        }
+        catch(const std::exception& error)
+        {
+            failed += " memod";
+        }
+    }
+
+    if (adapter.odTable)
+    {
+        try
+        {
+            handle.resetODClockVoltage(adapterIndex);
+        }
+        catch(const std::exception& error)
+        {
+            failed += " odreset";
+        }
+    }
+
+    if (adapter.fan)
+    {
+        try
+        {
+            handle.setFanSpeed(adapterIndex, 0, 100);
+        }
+        catch(const std::exception& error)
+        {
+            failed += " fanspeed";
+        }
+    }
+
+    if (!failed.empty())
+    {
+        throw Error(("Unable to revert" + failed).c_str());
+    }
+}
+
+void AMDGPUWatchdogBackend::wait(unsigned int timeout, std::vector<DeviceEvent>& events)
+{
+    const size_t eventsNum = events.size();
+
+    registry.Poll(timeout, events);
+
+    for (size_t i = eventsNum; i < events.size(); i++)
+    {
+        if (events[i].type != DeviceEventType::REMOVED)
+        {
+            probe(events[i].adapterId);
+        }
+    }
+}
+
+static const double simIdleTemperature = 60.0;   // C
+static const double simCriticalTemperature = 94.0;
+static const double simCoreODHeat = 1.5;        // C per percent of core Overdrive
+static const double simFaultHeat = 25.0;        // C
+static const double simOverheatStep = 30.0;     // C
+static const double simFanCooling = 10.0;       // C, fan at 100% against auto
+static const double simTimeConstant = 2.0;      // s
+static const double simMaxRPM = 3500.0;
+static const double simFailureTime = 0.5;       // s
+
+SimulatedWatchdogBackend::SimulatedWatchdogBackend(int adaptersNum) : startTime(getTime())
+{
+    for (int i = 0; i < adaptersNum; i++)
+    {
+        const double coreOD = 10.0;
+
+        adapters.push_back(Adapter{ simIdleTemperature + simCoreODHeat * coreOD, coreOD, 40.0, startTime, NAN, NAN, NAN, NAN });
+    }
+}
+
+double SimulatedWatchdogBackend::getTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool SimulatedWatchdogBackend::isFailing(double failureTime, double time) const
+{
+    return time >= startTime + failureTime && time < startTime + failureTime + simFailureTime;
+}
+
+void SimulatedWatchdogBackend::update(Adapter& adapter, double time) const
+{
+    const double stallTime = startTime + adapter.stallTime;
+    const double overheatTime = startTime + adapter.overheatTime;
+    const bool stalled = time >= stallTime;
+    const bool overheated = time >= overheatTime;
+
+    if (overheated && adapter.lastTime < overheatTime)
+    {
+        adapter.temperature += simOverheatStep;
+    }
+
+    const double target = simIdleTemperature + simCoreODHeat * adapter.coreOD + (stalled ? simFaultHeat : 0.0) +
+        (overheated ? simFaultHeat : 0.0) - ((adapter.fanDuty >= 100.0 && !stalled) ? simFanCooling : 0.0);
+
+    adapter.temperature = target + (adapter.temperature - target) * ::exp(-(time - adapter.lastTime) / simTimeConstant);
+    adapter.lastTime = time;
+}
+
+int SimulatedWatchdogBackend::getAdaptersNum() const
+{
+    return adapters.size();
+}
+
+void SimulatedWatchdogBackend::getCriticalTemperatures(int adapterIndex, double* temperatures) const
+{
+    temperatures[0] = simCriticalTemperature;
+    temperatures[1] = simCriticalTemperature + 16.0;
+    temperatures[2] = NAN;
+}
+
+void SimulatedWatchdogBackend::sample(int adapterIndex, WatchdogSample& sample)
+{
+    const double time = getTime();
+    Adapter& adapter = adapters[adapterIndex];
+
+    update(adapter, time);
+
+    if (isFailing(adapter.sensorFailureTime, time))
+    {
+        throw Error("Unable to read temperature");
+    }
+
+    sample.temperatures[0] = adapter.temperature;
+    sample.temperatures[1] = adapter.temperature + 8.0;     // junction
+    sample.temperatures[2] = NAN;
+    sample.fanRPM = (time >= startTime + adapter.stallTime) ? 0.0 : simMaxRPM * adapter.fanDuty / 100.0;
+    sample.fanDuty = adapter.fanDuty;
+}
+
+void SimulatedWatchdogBackend::revert(int adapterIndex)
+{
+    Adapter& adapter = adapters[adapterIndex];
+    const double time = getTime();
+
+    update(adapter, time);
+
+    if (isFailing(adapter.revertFailureTime, time))
+    {
+        throw Error("Unable to revert coreod fanspeed");
+    }
+
+    adapter.coreOD = 0.0;
+    adapter.fanDuty = 100.0;
+}
+
+double SimulatedWatchdogBackend::getFaultTime(int adapterIndex) const
+{
+    const Adapter& adapter = adapters[adapterIndex];
+    const double time = getTime();
+    double faultTime = NAN;
+
+    for (double delay: { adapter.stallTime, adapter.overheatTime })
+    {
+        if (startTime + delay <= time && (std::isnan(faultTime) || startTime + delay < faultTime))
+        {
+            faultTime = startTime + delay;
+        }
+    }
+
+    return faultTime;
+}
+
+void SimulatedWatchdogBackend::injectFault(int adapterIndex, WatchdogFault fault, double delay)
+{
+    Adapter& adapter = adapters[adapterIndex];
+
+    switch (fault)
+    {
+        case WatchdogFault::FAN_STALL:
+            adapter.stallTime = delay;
+            break;
+        case WatchdogFault::OVERHEAT:
+            adapter.overheatTime = delay;
+            break;
+        case WatchdogFault::SENSOR_FAILURE:
+            adapter.sensorFailureTime = delay;
+            break;
+        case WatchdogFault::REVERT_FAILURE:
+            adapter.revertFailureTime = delay;
+            break;
+    }
+}